@@ -0,0 +1,53 @@
+/** Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri
+ *  @file actLut.h
+ *  @brief Coefficients of the piecewise linear approximation of tangent hyperbolic and sigmoid
+ *
+ *  Generated by scripts/actLut.py --tanh-range 4 --sig-range 8 --segments 8 16 32 64 (q_frac 12), do not edit.
+ *  f(x) = (lut_m[|x|>>shift]*|x|+lut_q[|x|>>shift])>>ACT_LUT_FRAC on [0, range), select with ACT_LUT_SEGMENTS.
+ *  Errors in LSB of the output over all inputs.
+ *
+ * @author Renzo Andri (andrire)
+ */
+/// Fractional bits of the tables (inputs and outputs)
+#define ACT_LUT_FRAC 12
+#if ACT_LUT_SEGMENTS == 8
+// Tanh on [0, 4): max. error 65.17 LSB, mean error 4.425 LSB
+#define ACT_LUT_TANH_SHIFT 11
+const short lut_Tanh_m[8] = {3811, 2450, 1165, 476, 182, 68, 25, 9};
+const int lut_Tanh_q[8] = {127541, 2999564, 8183153, 12344809, 14714141, 15868454, 16389628, 16615353};
+// sig on [0, 8): max. error 33.19 LSB, mean error 4.777 LSB
+#define ACT_LUT_SIG_SHIFT 12
+const short lut_sig_m[8] = {953, 612, 291, 119, 46, 17, 6, 2};
+const int lut_sig_q[8] = {8452019, 9886994, 12478599, 14559993, 15745167, 16322605, 16583324, 16696244};
+#elif ACT_LUT_SEGMENTS == 16
+/// Same tables as pl.tanh/pl.sig
+#define ACT_LUT_PLTANH
+// Tanh on [0, 4): max. error 16.62 LSB, mean error 1.361 LSB
+#define ACT_LUT_TANH_SHIFT 10
+const short lut_Tanh_m[16] = {4021, 3563, 2835, 2070, 1418, 929, 592, 370, 228, 140, 86, 52, 32, 19, 12, 7};
+const int lut_Tanh_q[16] = {17060, 512067, 2012407, 4361003, 7021506, 9510743, 11575189, 13158594, 14311861, 15123015, 15679911, 16055709, 16306104, 16471340, 16579558, 16650000};
+// sig on [0, 4): max. error 73.67 LSB, mean error 9.711 LSB
+#define ACT_LUT_SIG_SHIFT 10
+const short lut_sig_m[16] = {1019, 988, 930, 850, 758, 660, 563, 472, 391, 319, 258, 207, 165, 131, 104, 82};
+const int lut_sig_q[16] = {8389671, 8423495, 8544906, 8789991, 9169470, 9670607, 10264318, 10914030, 11583389, 12241371, 12864661, 13437943, 13952921, 14406803, 14800713, 15138308};
+#elif ACT_LUT_SEGMENTS == 32
+// Tanh on [0, 4): max. error 5.05 LSB, mean error 0.637 LSB
+#define ACT_LUT_TANH_SHIFT 9
+const short lut_Tanh_m[32] = {4077, 3953, 3719, 3401, 3031, 2639, 2253, 1890, 1563, 1277, 1033, 829, 661, 525, 415, 327, 257, 201, 158, 123, 96, 75, 59, 46, 36, 28, 22, 17, 13, 10, 8, 6};
+const int lut_Tanh_q[32] = {2169, 69914, 312853, 803159, 1562261, 2564663, 3752183, 5051664, 6390397, 7706337, 8952867, 10099363, 11129243, 12036927, 12824672, 13499790, 14072459, 14554121, 14956396, 15290395, 15566337, 15793355, 15979452, 16131532, 16255478, 16356255, 16438022, 16504243, 16557782, 16601005, 16635850, 16663906};
+// sig on [0, 8): max. error 5.49 LSB, mean error 1.452 LSB
+#define ACT_LUT_SIG_SHIFT 10
+const short lut_sig_m[32] = {1019, 988, 930, 850, 758, 660, 563, 472, 391, 319, 258, 207, 165, 131, 104, 82, 64, 50, 39, 31, 24, 19, 15, 11, 9, 7, 5, 4, 3, 3, 2, 2};
+const int lut_sig_q[32] = {8389671, 8423495, 8544906, 8789991, 9169470, 9670607, 10264318, 10914030, 11583389, 12241371, 12864661, 13437943, 13952921, 14406803, 14800713, 15138308, 15424674, 15665532, 15866693, 16033713, 16171701, 16285224, 16378284, 16454334, 16516314, 16566709, 16607598, 16640712, 16667485, 16689099, 16706524, 16720554};
+#elif ACT_LUT_SEGMENTS == 64
+// Tanh on [0, 4): max. error 2.88 LSB, mean error 0.556 LSB
+#define ACT_LUT_TANH_SHIFT 8
+const short lut_Tanh_m[64] = {4091, 4059, 3997, 3905, 3788, 3647, 3488, 3313, 3127, 2934, 2738, 2541, 2347, 2159, 1977, 1804, 1640, 1486, 1343, 1211, 1089, 978, 876, 783, 700, 624, 556, 495, 440, 391, 347, 307, 273, 241, 214, 189, 168, 148, 131, 116, 102, 91, 80, 71, 62, 55, 49, 43, 38, 34, 30, 26, 23, 20, 18, 16, 14, 12, 11, 10, 9, 8, 7, 6};
+const int lut_Tanh_q[64] = {272, 8941, 41480, 112186, 233081, 413321, 658831, 972218, 1352917, 1797534, 2300334, 2853803, 3449235, 4077285, 4728472, 5393586, 6064009, 6731938, 7390529, 8033963, 8657455, 9257213, 9830376, 10374920, 10889557, 11373638, 11827045, 12250099, 12643472, 13008107, 13345151, 13655898, 13941736, 14204108, 14444479, 14664309, 14865034, 15048045, 15214683, 15366225, 15503883, 15628798, 15742041, 15844610, 15937434, 16021375, 16097227, 16165724, 16227541, 16283296, 16333556, 16378838, 16419616, 16456320, 16489344, 16519043, 16545742, 16569735, 16591289, 16610644, 16628020, 16643614, 16657604, 16670152};
+// sig on [0, 8): max. error 5.45 LSB, mean error 1.519 LSB
+#define ACT_LUT_SIG_SHIFT 9
+const short lut_sig_m[64] = {1023, 1015, 1000, 977, 948, 913, 873, 829, 783, 734, 685, 636, 588, 541, 495, 452, 411, 372, 337, 303, 273, 245, 219, 196, 175, 156, 139, 124, 110, 98, 87, 77, 68, 61, 54, 47, 42, 37, 33, 29, 26, 23, 20, 18, 16, 14, 12, 11, 10, 8, 7, 7, 6, 5, 5, 4, 4, 3, 3, 2, 2, 2, 2, 1};
+const int lut_sig_q[64] = {8388723, 8392892, 8408844, 8443745, 8503635, 8593119, 8715196, 8871201, 9060882, 9282569, 9533415, 9809678, 10107014, 10420756, 10746162, 11078622, 11413819, 11747845, 12077265, 12399162, 12711130, 13011265, 13298128, 13570697, 13828323, 14070675, 14297688, 14509520, 14706503, 14889107, 15057902, 15213535, 15356700, 15488116, 15608517, 15718634, 15819182, 15910861, 15994339, 16070257, 16139221, 16201802, 16258537, 16309925, 16356431, 16398487, 16436491, 16470811, 16501784, 16529720, 16554903, 16577592, 16598024, 16616416, 16632963, 16647845, 16661223, 16673246, 16684046, 16693744, 16702451, 16710265, 16717276, 16723564};
+#else
+#error "ACT_LUT_SEGMENTS: no table in actLut.h, see scripts/actLut.py"
+#endif
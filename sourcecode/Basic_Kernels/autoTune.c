@@ -0,0 +1,289 @@
+/** Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri
+ *  @file autoTune.c
+ *  @brief Per-layer autotuner for the tiling of the kernels
+ *
+ *  Runs every layer of a network with all the kernel variants (output FM tile size, input FM
+ *  tiling on/off and for LSTM and GRU layers activation on-the-fly on/off), stores the fastest one in the
+ *  tiling field of the layer and records it in a tuning cache keyed by the layer shape (type,
+ *  attributes, number of time steps and weight format), i.e. every shape is only tuned once. Layers
+ *  with int8 or int4 weights are only tuned for the output FM tile size, layers with 2:4 sparse weights
+ *  keep their tiling (their kernels have no variants). The cache can be printed as C initializer and
+ *  be included into the next build (TUNE_CACHE_INC), on the host it is loaded from and saved to a
+ *  file (TUNE_CACHE_FILE or the environment variable TUNE_CACHE).
+ *
+ *  The cache is only valid for the configuration (config.h) and platform it has been tuned on.
+ *
+ * @author Renzo Andri (andrire)
+ */
+#include <stdio.h>
+#include <config.h>
+#include "basicKernel.h"
+#include "autoTune.h"
+
+#if defined FMOUTTILING && defined MANUALLOOPUNFOLDING && !defined HOST_SIMD
+/// Largest output FM tile size and number of input FM tilings to be tuned (only the tiled kernels have variants)
+#define TUNE_OUTTILE_MAX TILE_MAXSIZE
+#define TUNE_INTILING_MIN IN_TILING_OFF
+#define TUNE_INTILING_MAX IN_TILING_ON
+#else
+#define TUNE_OUTTILE_MAX 1
+#define TUNE_INTILING_MIN IN_TILING_DEFAULT
+#define TUNE_INTILING_MAX IN_TILING_DEFAULT
+#endif
+
+/// LSTM state (h and c) or GRU state (h) of the layer which is currently tuned
+RT_L2_DATA data_t tuneState[TUNE_STATE_SIZE];
+/// Input FM of the layer which is currently tuned (output of the previous layer)
+RT_L2_DATA data_t tuneIn[BUFFER_SIZE];
+
+/** @brief Searches the entry of the layer shape in the tuning cache
+ *
+ *  @param cache Tuning cache
+ *  @param lay Layer
+ *  @param seqSize Number of time steps
+ *  @return Cache entry or NULL if the shape has not been tuned yet
+ */
+struct tuneEntry * tuneCacheLookup(struct tuneCache * cache, struct layer * lay, int seqSize)
+{
+  for(int i = 0; i < cache->size; i++)
+  {
+    struct tuneKey * key = &cache->entries[i].key;
+    int match = key->type == lay->type && key->seqSize == seqSize && key->weightFormat == lay->weightFormat;
+    for(int j = 0; j < 5; j++)
+      match &= key->attributes[j] == lay->attributes[j];
+    if(match)
+      return &cache->entries[i];
+  }
+  return NULL;
+}
+
+/** @brief Saves (or restores) the state of an LSTM, GRU or RNN layer, which is updated by every run of the layer
+ *
+ *  @param lay Layer
+ *  @param restore Restore instead of save
+ */
+static void tuneLayerState(struct layer * lay, int restore)
+{
+  if(lay->type == GRU || lay->type == RNN)
+  {
+    data_t * h = lay->parameters[lay->type == GRU ? GRU_H : RNN_H];
+    for(int i = 0; i < layerOutSize(lay); i++)
+    {
+      if(restore)
+        h[i] = tuneState[i];
+      else
+        tuneState[i] = h[i];
+    }
+    return;
+  }
+  if(lay->type != LSTM)
+    return;
+  int numHidden = lay->attributes[LAY_LSTM_HID];
+  for(int i = 0; i < numHidden; i++)
+  {
+    if(restore) {
+      lay->parameters[LSTM_H][i] = tuneState[i];
+      lay->parameters[LSTM_C][i] = tuneState[numHidden+i];
+    } else {
+      tuneState[i]           = lay->parameters[LSTM_H][i];
+      tuneState[numHidden+i] = lay->parameters[LSTM_C][i];
+    }
+  }
+}
+
+/** @brief Cycles of one layer with a given tiling (fastest of TUNE_REPEAT runs)
+ *
+ *  @param lay Layer
+ *  @param seqSize Number of time steps
+ *  @param tiling Tiling to be measured
+ *  @param inFeatures Input Feature Map
+ *  @param buffer Buffer to store intermediate results (see inferNetwork)
+ *  @return Cycles (ns on the host)
+ */
+static unsigned int tuneMeasure(struct layer * lay, int seqSize, struct tiling tiling, data_t * __restrict__ inFeatures, data_t * __restrict__ buffer)
+{
+  rt_perf_t tunePerf;
+  unsigned int best = 0;
+  lay->tiling = tiling;
+  for(int rep = 0; rep < TUNE_REPEAT; rep++)
+  {
+    tuneLayerState(lay, True);
+    rt_perf_init(&tunePerf);
+    rt_perf_conf(&tunePerf, (1<<RT_PERF_CYCLES));
+    rt_perf_reset(&tunePerf);
+    rt_perf_start(&tunePerf);
+    inferNetwork(lay, 1, seqSize, inFeatures, buffer);
+    rt_perf_stop(&tunePerf);
+    unsigned int cycles = rt_perf_get(&tunePerf, RT_PERF_CYCLES);
+    if(rep == 0 || cycles < best)
+      best = cycles;
+  }
+  return best;
+}
+
+/** @brief Selects the fastest tiling of a layer
+ *
+ *  If the shape of the layer is in the cache, the cached tiling is used, otherwise all the variants
+ *  are measured and the fastest one is added to the cache. The state of LSTM, GRU and RNN layers is restored.
+ *
+ *  @param lay Layer, the tiling field is set to the fastest tiling
+ *  @param seqSize Number of time steps
+ *  @param inFeatures Input Feature Map of the layer
+ *  @param buffer Buffer to store intermediate results (see inferNetwork)
+ *  @param cache Tuning cache
+ *  @return Fastest tiling
+ */
+struct tiling tuneLayer(struct layer * lay, int seqSize, data_t * __restrict__ inFeatures, data_t * __restrict__ buffer, struct tuneCache * cache)
+{
+  struct tuneEntry * entry = tuneCacheLookup(cache, lay, seqSize);
+  if(entry != NULL)
+  {
+    lay->tiling = entry->tiling;
+    return entry->tiling;
+  }
+  if(lay->type == ACTIVATION || (lay->weightFormat != WEIGHT_Q16 && lay->weightFormat != WEIGHT_INT8 && lay->weightFormat != WEIGHT_INT4)) // no tiling, or no tiled kernels of the weight format
+    return lay->tiling;
+  if((lay->type == LSTM && 2*lay->attributes[LAY_LSTM_HID] > TUNE_STATE_SIZE) || ((lay->type == GRU || lay->type == RNN) && layerOutSize(lay) > TUNE_STATE_SIZE))
+  {
+    printf("\033[91mERROR: recurrent state too large for the autotuner (TUNE_STATE_SIZE)\033[0m\n");
+    return lay->tiling;
+  }
+
+  int actMax = ACT_ONTHEFLY_DEFAULT;
+#ifdef DOACTONTHEFLY
+  if((lay->type == LSTM || lay->type == GRU) && lay->weightFormat == WEIGHT_Q16) actMax = ACT_ONTHEFLY_ON;
+#endif
+  int inTilingMax = lay->weightFormat == WEIGHT_Q16 ? TUNE_INTILING_MAX : TUNE_INTILING_MIN; // int8/int4: output FM tiles only
+  struct tiling best = lay->tiling;
+  unsigned int bestCycles = 0;
+  int first = True;
+  tuneLayerState(lay, False);
+  for(int outTile = 1; outTile <= TUNE_OUTTILE_MAX; outTile++)
+    for(int inTiling = TUNE_INTILING_MIN; inTiling <= inTilingMax; inTiling++)
+      for(int act = actMax == ACT_ONTHEFLY_DEFAULT ? ACT_ONTHEFLY_DEFAULT : ACT_ONTHEFLY_OFF; act <= actMax; act++)
+      {
+        struct tiling tiling = {TUNE_OUTTILE_MAX == 1 ? 0 : outTile, (enum inTilingType)inTiling, (enum actOnTheFlyType)act};
+        unsigned int cycles = tuneMeasure(lay, seqSize, tiling, inFeatures, buffer);
+        if(first || cycles < bestCycles)
+        {
+          best = tiling;
+          bestCycles = cycles;
+          first = False;
+        }
+      }
+  tuneLayerState(lay, True);
+  lay->tiling = best;
+
+  if(cache->size < TUNE_CACHE_SIZE)
+  {
+    entry = &cache->entries[cache->size++];
+    entry->key.type = lay->type;
+    for(int j = 0; j < 5; j++)
+      entry->key.attributes[j] = lay->attributes[j];
+    entry->key.seqSize = seqSize;
+    entry->key.weightFormat = lay->weightFormat;
+    entry->tiling = best;
+    entry->cycles = bestCycles;
+  }
+  return best;
+}
+
+/** @brief Selects the fastest tiling of all the layers of a network
+ *
+ *  The layers are tuned with their actual input FM, i.e. the network is run layer by layer. The state
+ *  of the LSTM, GRU and RNN layers is the same as before.
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @param seqSize Number of time steps
+ *  @param inFeatures Input Feature Map
+ *  @param buffer Buffer to store intermediate results (see inferNetwork)
+ *  @param cache Tuning cache
+ */
+void tuneNetwork(struct layer * network, int depth, int seqSize, data_t * __restrict__ inFeatures, data_t * __restrict__ buffer, struct tuneCache * cache)
+{
+  data_t * in = inFeatures;
+  for(int i = 0; i < depth; i++)
+  {
+    struct layer * lay = &network[i];
+    tuneLayer(lay, seqSize, in, buffer, cache);
+    if(i == depth-1)
+      break;
+    // input FM of the next layer, moved out of the buffer as it is overwritten by the next layer
+    tuneLayerState(lay, False);
+    data_t * out = inferNetwork(lay, 1, seqSize, in, buffer);
+    tuneLayerState(lay, True);
+    if(out == NULL)
+      return;
+    CopyTensor(seqSize*layerOutSize(lay), tuneIn, out);
+    in = tuneIn;
+  }
+}
+
+/** @brief Prints the tuning cache as C initializer of a struct tuneEntry array (one entry per line)
+ *
+ *  @param cache Tuning cache
+ */
+void tuneCachePrint(struct tuneCache * cache)
+{
+  for(int i = 0; i < cache->size; i++)
+  {
+    struct tuneEntry * e = &cache->entries[i];
+    printf("{{%d, {%d, %d, %d, %d, %d}, %d, %d}, {%d, %d, %d}, %u},\n", e->key.type,
+      e->key.attributes[0], e->key.attributes[1], e->key.attributes[2], e->key.attributes[3], e->key.attributes[4],
+      e->key.seqSize, e->key.weightFormat, e->tiling.outTile, e->tiling.inTiling, e->tiling.actOnTheFly, e->cycles);
+  }
+}
+
+#ifdef HOST
+/** @brief Loads the tuning cache from a file written by tuneCacheSave()
+ *
+ *  @param cache Tuning cache, the entries are appended
+ *  @param fileName File name
+ *  @return Number of loaded entries, -1 if the file cannot be opened
+ */
+int tuneCacheLoad(struct tuneCache * cache, const char * fileName)
+{
+  FILE * file = fopen(fileName, "r");
+  if(file == NULL)
+    return -1;
+  int loaded = 0;
+  struct tuneEntry e;
+  int type, weightFormat, inTiling, act;
+  while(cache->size < TUNE_CACHE_SIZE && fscanf(file, " {{%d, {%d, %d, %d, %d, %d}, %d, %d}, {%d, %d, %d}, %u},", &type,
+    &e.key.attributes[0], &e.key.attributes[1], &e.key.attributes[2], &e.key.attributes[3], &e.key.attributes[4],
+    &e.key.seqSize, &weightFormat, &e.tiling.outTile, &inTiling, &act, &e.cycles) == 12)
+  {
+    e.key.type = (enum layerType)type;
+    e.key.weightFormat = (enum weightFormat)weightFormat;
+    e.tiling.inTiling = (enum inTilingType)inTiling;
+    e.tiling.actOnTheFly = (enum actOnTheFlyType)act;
+    cache->entries[cache->size++] = e;
+    loaded++;
+  }
+  fclose(file);
+  return loaded;
+}
+
+/** @brief Saves the tuning cache to a file (same format as tuneCachePrint())
+ *
+ *  @param cache Tuning cache
+ *  @param fileName File name
+ *  @return 0 on success, -1 if the file cannot be written
+ */
+int tuneCacheSave(struct tuneCache * cache, const char * fileName)
+{
+  FILE * file = fopen(fileName, "w");
+  if(file == NULL)
+    return -1;
+  for(int i = 0; i < cache->size; i++)
+  {
+    struct tuneEntry * e = &cache->entries[i];
+    fprintf(file, "{{%d, {%d, %d, %d, %d, %d}, %d, %d}, {%d, %d, %d}, %u},\n", e->key.type,
+      e->key.attributes[0], e->key.attributes[1], e->key.attributes[2], e->key.attributes[3], e->key.attributes[4],
+      e->key.seqSize, e->key.weightFormat, e->tiling.outTile, e->tiling.inTiling, e->tiling.actOnTheFly, e->cycles);
+  }
+  fclose(file);
+  return 0;
+}
+#endif
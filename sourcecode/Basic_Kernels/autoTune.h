@@ -0,0 +1,59 @@
+/** Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri
+ *  @file autoTune.h
+ *  @brief Per-layer autotuner for the tiling of the kernels (see autoTune.c)
+ *
+ *  Has to be included after basicKernel.h.
+ *
+ * @author Renzo Andri (andrire)
+ */
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+/// Maximum number of layer shapes in the tuning cache
+#define TUNE_CACHE_SIZE 64
+/// Maximum size of the LSTM state (h and c) which is saved while tuning a layer
+#define TUNE_STATE_SIZE 1024
+#ifdef HOST
+/// Number of runs per variant (the fastest is taken), the wall-clock time on the host is noisy
+#define TUNE_REPEAT 5
+/// Default file of the tuning cache on the host
+#define TUNE_CACHE_FILE "tuneCache.inc"
+#else
+/// Number of runs per variant (the fastest is taken)
+#define TUNE_REPEAT 1
+#endif
+
+/// Shape of a layer, key of the tuning cache
+struct tuneKey {
+    enum layerType type;     /**< Layer Type (FC, RNN, ...) */
+    int attributes[5];       /**< Layer Attributes (see struct layer) */
+    int seqSize;             /**< Number of time steps */
+    enum weightFormat weightFormat; /**< Format of the weights (the kernels differ per format) */
+};
+/// Entry of the tuning cache
+struct tuneEntry {
+    struct tuneKey key;      /**< Layer shape */
+    struct tiling tiling;    /**< Fastest tiling */
+    unsigned int cycles;     /**< Cycles of the fastest tiling (ns on the host) */
+};
+/// Tuning cache, the entries can be stored with tuneCachePrint()/tuneCacheSave() and included again as initializer
+struct tuneCache {
+    int size;                                  /**< Number of valid entries */
+    struct tuneEntry entries[TUNE_CACHE_SIZE]; /**< Entries */
+};
+
+struct tuneEntry * tuneCacheLookup(struct tuneCache * cache, struct layer * lay, int seqSize);
+
+struct tiling tuneLayer(struct layer * lay, int seqSize, data_t * __restrict__ inFeatures, data_t * __restrict__ buffer, struct tuneCache * cache);
+
+void tuneNetwork(struct layer * network, int depth, int seqSize, data_t * __restrict__ inFeatures, data_t * __restrict__ buffer, struct tuneCache * cache);
+
+void tuneCachePrint(struct tuneCache * cache);
+
+#ifdef HOST
+int tuneCacheLoad(struct tuneCache * cache, const char * fileName);
+
+int tuneCacheSave(struct tuneCache * cache, const char * fileName);
+#endif
+
+#endif
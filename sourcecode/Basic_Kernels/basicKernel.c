@@ -15,24 +15,35 @@
 //#include <math.h>
 #include "basicKernel.h"
 #include "lut.h" // coefficients for taylor expansion
+#include "actLut.h" // coefficients of the piecewise linear tanh/sigmoid (scripts/actLut.py)
+#include "tileKernel.h" // template of the output FM tiled kernels
+#include "parallel.h" // fork/join on NUM_CORES cores
 
 #endif
 
-/** \brief Length (in time) of RNN Sequence */
-int rnn_seqSize=1; 
-/** \brief Length (in time) of LSTM Sequence */
-int lstm_seqSize=1;
+#ifndef ASIP
+/// External definitions of the inline activations, for the calls which are not inlined by the compiler (e.g. in
+/// the epilogue of the tiled kernels)
+extern data_t Tanh(data_t value);
+extern data_t sig(data_t value);
+extern int pulpRNNExt_tanh(int tanh_value);
+extern int pulpRNNExt_sig(int sig_value);
+#endif
 
+/** \brief Input projections of the time steps of a sequence (LSTMLayer) or of the streams (LSTMLayerBatch, GRULayerBatch) */
+RT_L2_DATA int32_t seqBuffer[SEQ_BUFFER_SIZE];
 
-/** \brief Piecewise Linear Approximation of tangent hyperbolic and sigmoid */
-const int lut_numelements = 16;
-const int lb_lut_numelements = 4;
 
-/** \brief Coefficients of piecewise Linear Approximation of tangent hyperbolic and sigmoid */
-const short lut_Tanh_m[16] = {4021, 3563, 2835, 2070, 1418, 929, 592, 370, 228, 140, 86, 52, 32, 19, 12, 7};
-const int lut_Tanh_q[16] = {17060, 512067, 2012407, 4361003, 7021506, 9510743, 11575189, 13158594, 14311861, 15123015, 15679911, 16055709, 16306104, 16471340, 16579558, 16650000};
-const short lut_sig_m[16] = {1019, 988, 930, 850, 758, 660, 563, 472, 391, 319, 258, 207, 165, 131, 104, 82};
-const int lut_sig_q[16] = {8389671, 8423495, 8544906, 8789991, 9169470, 9670607, 10264318, 10914030, 11583389, 12241371, 12864661, 13437943, 13952921, 14406803, 14800713, 15138308};
+/** \brief Piecewise Linear Approximation of tangent hyperbolic and sigmoid (coefficients in actLut.h) */
+const int lut_numelements = ACT_LUT_SEGMENTS;
+
+#if ACT_LUT_FRAC != q_frac
+#error "actLut.h was generated for another q_frac, regenerate it with scripts/actLut.py (reads q_frac of basicKernel.h)"
+#endif
+#ifndef ACT_LUT_PLTANH // pl.tanh/pl.sig and the tzscale extension have the 16 segment tables in hardware
+#undef PULP_USETANHSIG
+#undef ASIP_USETANHSIG
+#endif
 
 
 #ifndef ASIP
@@ -58,9 +69,9 @@ void endPerf () {
  */
 inline data_t sig(data_t value) {
   data_t a = value;
-  unsigned int lutsize = 16;
-  unsigned int value1 = 4096;
-  unsigned int value0p999 = 4095;
+  unsigned int lutsize = lut_numelements;
+  unsigned int value1 = 1<<ACT_LUT_FRAC;
+  unsigned int value0p999 = (1<<ACT_LUT_FRAC)-1;
   int m;
   int q;
   int q_signed;
@@ -75,13 +86,13 @@ inline data_t sig(data_t value) {
     abs_a = (a);
   }
 
-  tmp = abs_a>>(13-3); 
+  tmp = abs_a>>ACT_LUT_SIG_SHIFT; 
   if(tmp>=lutsize) {
     return (sign)?(data_t)0: (data_t)value1;
   } else {
     m = lut_sig_m[tmp];
     q =lut_sig_q[tmp];
-    mac_result = (m*abs_a+q)>>12;
+    mac_result = (m*abs_a+q)>>ACT_LUT_FRAC;
     mac_result_signed = (sign==1)? ~mac_result : mac_result;
     if(sign==1) {
        return  (value0p999+(mac_result_signed)); // 1-(mx+q)=4096+(~mac_result+1)=4095+(~mac_result)
@@ -98,9 +109,9 @@ inline data_t sig(data_t value) {
  */
   inline data_t Tanh(data_t value) {
     data_t x = value;
-    unsigned int lutsize = 16;
-    unsigned int value1 = 4096;
-    unsigned int value0p999 = 4095;
+    unsigned int lutsize = lut_numelements;
+    unsigned int value1 = 1<<ACT_LUT_FRAC;
+    unsigned int value0p999 = (1<<ACT_LUT_FRAC)-1;
     int m;
     int q;
     int q_signed;
@@ -114,78 +125,335 @@ inline data_t sig(data_t value) {
     } else {
       abs_x = x;
     }
-    id = abs_x>>(13-3); // get index of LUT
+    id = abs_x>>ACT_LUT_TANH_SHIFT; // get index of LUT
     if(id>=lutsize) {
        return (sign==0x1)?(int)-value1: (int)value1;
     } else {
       m = lut_Tanh_m[id];
       q =lut_Tanh_q[id];
-      mac_result = (m*abs_x+q)>>12;
+      mac_result = (m*abs_x+q)>>ACT_LUT_FRAC;
       mac_result_signed = (sign==1)? ~mac_result : mac_result;
       return mac_result_signed;
     }
 }
 
 
-/** @brief Runs a neural network
+/** @brief Size of the input FM of a layer (one time step or stream)
+ */
+int layerInSize(struct layer * lay)
+{
+  switch(lay->type) {
+    case LINEAR: return lay->attributes[LAY_LIN_IN];
+    case LSTM:   return lay->attributes[LAY_LSTM_IN];
+    case Conv2d: return lay->attributes[LAY_CONV_IN]*lay->attributes[LAY_CONV_H]*lay->attributes[LAY_CONV_W];
+    case ACTIVATION: return lay->attributes[LAY_ACT_SIZE];
+    case GRU:    return lay->attributes[LAY_GRU_IN];
+    case RNN:    return lay->attributes[LAY_RNN_IN];
+    default:     return 0;
+  }
+}
+
+/** @brief Size of the output FM of a layer (one time step or stream)
+ */
+int layerOutSize(struct layer * lay)
+{
+  switch(lay->type) {
+    case LINEAR: return lay->attributes[LAY_LIN_OUT];
+    case LSTM:   return lay->attributes[LAY_LSTM_HID];
+    case Conv2d: return lay->attributes[LAY_CONV_OUT]*lay->attributes[LAY_CONV_H]*lay->attributes[LAY_CONV_W];
+    case ACTIVATION: return lay->attributes[LAY_ACT_SIZE];
+    case GRU:    return lay->attributes[LAY_GRU_HID];
+    case RNN:    return lay->attributes[LAY_RNN_HID];
+    default:     return 0;
+  }
+}
+
+/** @brief Size of the intermediate nodes of a layer (LSTM: 4 gates, GRU: 2 gates and the hidden part of the candidate,
+ *  RNN: recurrent part)
+ */
+static int layerScratchSize(struct layer * lay)
+{
+  switch(lay->type) {
+    case LSTM: return 4*lay->attributes[LAY_LSTM_HID];
+    case GRU:  return 3*lay->attributes[LAY_GRU_HID];
+    case RNN:  return lay->attributes[LAY_RNN_HID];
+    default:   return 0;
+  }
+}
+
+/** @brief Fractional bits of a tensor of a layer
+ *
+ *  @param q Formats of the layer
+ *  @param frac Field of q of the tensor (q->in, q->weight or q->out)
+ *  @return frac if q->set, q_frac otherwise
+ */
+int qFrac(const struct qFormat * q, int frac)
+{
+  return q->set ? frac : q_frac;
+}
+
+/** @brief Shift of the accumulators (and left shift of the bias) of a layer
  *
- *  Iterates through all the layers while passing the intermediate FM with a double 
- *  buffering approach
+ *  The products of the input FM and the weights have qFrac(in)+qFrac(weight) fractional bits, the
+ *  output FM and the bias qFrac(out), i.e. q_fraqP1 with the default formats.
+ */
+int layerShift(struct layer * lay)
+{
+  struct qFormat * q = &lay->qFormat;
+  return qFrac(q, q->weight)+qFrac(q, q->in)-qFrac(q, q->out);
+}
+
+/** @brief Checks the Q-formats of the layers of a network (see struct qFormat)
  *
  *  @param network Array of concecutive layers of the current neural network
  *  @param depth Number of Layers (aka array size)
- *  @param inFeatures Input Feature Map
- *  @param buffer Buffer to store intermediate results
- *  @return Output Feature Map
+ *  @return 0 if the formats fit, -1 otherwise
  */
-data_t * NOINLINE inferNetwork(
-  struct layer * network, 
-  int depth, 
+static int checkQFormats(struct layer * network, int depth)
+{
+  for(int i = 0; i < depth; i++) {
+    struct qFormat * q = &network[i].qFormat;
+    // 16-bit tensors: Q15.0 (integer) to Q0.15
+    if(q->set && (q->in < 0 || q->in > 15 || q->weight < 0 || q->weight > 15 || q->out < 0 || q->out > 15)) {
+      printf("\033[91mERROR: fractional bits of layer %d not in [0, 15]\033[0m\n", i);
+      return -1;
+    }
+    struct qFormat * prev = i > 0 ? &network[i-1].qFormat : q;
+    if(i > 0 && qFrac(q, q->in) != qFrac(prev, prev->out)) {
+      printf("\033[91mERROR: input format of layer %d differs from the output format of layer %d\033[0m\n", i, i-1);
+      return -1;
+    }
+    // the gates and the state of the LSTM, the GRU and the RNN are Q3.12 (activation LUTs), only the weights can be scaled
+    if((network[i].type == LSTM || network[i].type == GRU || network[i].type == RNN) && (qFrac(q, q->in) != q_frac || qFrac(q, q->out) != q_frac)) {
+      printf("\033[91mERROR: recurrent layer %d needs Q%d.%d input and output\033[0m\n", i, q_int, q_frac);
+      return -1;
+    }
+    // tanh, sigmoid, hard sigmoid and hard tanh of the epilogue are defined on Q3.12, ReLU and leaky ReLU on any format
+    int act = network[i].epilogue.act;
+    if((act == ACT_TANH || act == ACT_SIG || act == ACT_HSIG || act == ACT_HTANH) && qFrac(q, q->out) != q_frac) {
+      printf("\033[91mERROR: activation of layer %d needs Q%d.%d output\033[0m\n", i, q_int, q_frac);
+      return -1;
+    }
+    if(network[i].type == ACTIVATION && qFrac(q, q->in) != qFrac(q, q->out)) {
+      printf("\033[91mERROR: input and output format of activation layer %d differ\033[0m\n", i);
+      return -1;
+    }
+    if(layerShift(&network[i]) < 0) {
+      printf("\033[91mERROR: output of layer %d has more fractional bits than its products\033[0m\n", i);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/** @brief Checks that the Linear and LSTM layers with compressed weights carry the parameters of
+ *  their weight format: the scales (int8/int4) or the positions of the weights (2:4 sparse), not both
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @return 0 if the parameters fit, -1 otherwise
+ */
+static int checkWeightFormats(struct layer * network, int depth)
+{
+  for(int i = 0; i < depth; i++) {
+    data_t ** p = network[i].parameters;
+    int hasScale, hasIndex, anyIndex;
+    if(network[i].type == LINEAR) {
+      hasScale = p[LAY_LIN_SCALE] != NULL;
+      hasIndex = anyIndex = p[LAY_LIN_INDEX] != NULL;
+    } else if(network[i].type == LSTM) {
+      hasScale = p[LSTM_SCALE_IH] != NULL || p[LSTM_SCALE_HH] != NULL;
+      hasIndex = p[LSTM_INDEX_IH] != NULL && p[LSTM_INDEX_HH] != NULL;
+      anyIndex = p[LSTM_INDEX_IH] != NULL || p[LSTM_INDEX_HH] != NULL;
+    } else
+      continue;
+    enum weightFormat format = network[i].weightFormat;
+    if(format == WEIGHT_2OF4 && (hasScale || !hasIndex)) {
+      printf("\033[91mERROR: 2:4 sparse layer %d needs the positions of its weights and no scales\033[0m\n", i);
+      return -1;
+    }
+    if(format != WEIGHT_2OF4 && anyIndex) {
+      printf("\033[91mERROR: layer %d carries positions of 2:4 sparse weights but has weight format %d\033[0m\n", i, format);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/** @brief Checks that all the layers of a network support the number of time steps
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @param seqSize Number of time steps
+ *  @return 0 if the layers support seqSize time steps, -1 otherwise (Conv2d layers only support 1)
+ */
+static int checkSeqSize(struct layer * network, int depth, int seqSize)
+{
+  for(int i = 0; i < depth; i++) {
+    if(network[i].type == Conv2d && seqSize > 1) {
+      printf("\033[91mERROR: Conv2d layer %d does not support sequences\033[0m\n", i);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/** @brief Computes the memory plan of a network, i.e. the offsets of all the intermediate FMs in
+ *  one arena
+ *
+ *  The output FM of layer i is live while layer i and i+1 are computed (the last one until the end),
+ *  the intermediate nodes of an LSTM or GRU layer (layerScratchSize) only while layer i is computed. The tensors
+ *  are placed greedily by decreasing size at the lowest offset which does not overlap with an
+ *  already placed tensor of overlapping lifetime. Offsets and sizes are rounded to 2 elements (v2s).
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @param rows Number of time steps or streams of the FMs
+ *  @param plan Memory plan (output)
+ *  @return Required arena size (data_t), -1 if the network is too deep (MEMPLAN_MAXDEPTH), the Q-formats
+ *  of the layers do not fit (see struct qFormat) or the parameters do not fit their weight format
+ *  (see checkWeightFormats)
+ */
+int planNetwork(struct layer * network, int depth, int rows, struct memPlan * plan)
+{
+  if(depth > MEMPLAN_MAXDEPTH) {
+    printf("\033[91mERROR: network too deep for the memory planner (MEMPLAN_MAXDEPTH)\033[0m\n");
+    return -1;
+  }
+  if(checkQFormats(network, depth) < 0 || checkWeightFormats(network, depth) < 0)
+    return -1;
+  // tensor 2*i: output FM of layer i, tensor 2*i+1: intermediate nodes of layer i
+  int size[2*MEMPLAN_MAXDEPTH], first[2*MEMPLAN_MAXDEPTH], last[2*MEMPLAN_MAXDEPTH], offset[2*MEMPLAN_MAXDEPTH];
+  int order[2*MEMPLAN_MAXDEPTH];
+  int numTensors = 2*depth;
+  for(int i = 0; i < depth; i++) {
+    size[2*i]    = rows*layerOutSize(&network[i]);
+    first[2*i]   = i;
+    last[2*i]    = i == depth-1 ? depth : i+1;
+    size[2*i+1]  = layerScratchSize(&network[i]);
+    first[2*i+1] = i;
+    last[2*i+1]  = i;
+  }
+  for(int t = 0; t < numTensors; t++) {
+    size[t] = (size[t]+1) & ~1;
+    offset[t] = -1;
+    order[t] = t;
+  }
+  // largest tensors first (insertion sort, stable)
+  for(int t = 1; t < numTensors; t++)
+    for(int k = t; k > 0 && size[order[k]] > size[order[k-1]]; k--) {
+      int tmp = order[k]; order[k] = order[k-1]; order[k-1] = tmp;
+    }
+
+  plan->depth = depth;
+  plan->rows = rows;
+  plan->arenaSize = 0;
+  for(int n = 0; n < numTensors; n++) {
+    int t = order[n];
+    if(size[t] == 0) {
+      offset[t] = 0;
+      continue;
+    }
+    // lowest offset above all the conflicting tensors which overlap with the candidate
+    int candidate = 0;
+    int moved = True;
+    while(moved) {
+      moved = False;
+      for(int u = 0; u < numTensors; u++) {
+        if(offset[u] < 0 || size[u] == 0 || last[u] < first[t] || last[t] < first[u]) continue;
+        if(candidate < offset[u]+size[u] && offset[u] < candidate+size[t]) {
+          candidate = offset[u]+size[u];
+          moved = True;
+        }
+      }
+    }
+    offset[t] = candidate;
+    if(candidate+size[t] > plan->arenaSize)
+      plan->arenaSize = candidate+size[t];
+  }
+  for(int i = 0; i < depth; i++) {
+    plan->outOffset[i]     = offset[2*i];
+    plan->scratchOffset[i] = offset[2*i+1];
+  }
+  return plan->arenaSize;
+}
+
+/** @brief Prints a memory plan (offset and size of the output FM and the intermediate nodes of each layer)
+ *
+ *  @param network Array of concecutive layers the plan has been computed for
+ *  @param plan Memory plan
+ */
+void PrintMemPlan(struct layer * network, struct memPlan * plan)
+{
+  printf("layer, out offset, out size, scratch offset, scratch size\n");
+  for(int i = 0; i < plan->depth; i++)
+    printf("%d, %d, %d, %d, %d\n", i, plan->outOffset[i], plan->rows*layerOutSize(&network[i]), plan->scratchOffset[i],
+      layerScratchSize(&network[i]));
+  printf("arena size: %d (BUFFER_SIZE %d)\n", plan->arenaSize, BUFFER_SIZE);
+}
+
+/** @brief Runs a neural network with the FMs placed in the arena by planNetwork()
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @param rows Number of time steps (batchStates NULL) or streams
+ *  @param inFeatures Input Feature Map [rows x input neurons]
+ *  @param batchStates LSTM and GRU states of the streams (see inferNetworkBatch) or NULL for sequences
+ *  @param plan Memory plan of the network for rows
+ *  @param arena Arena of at least plan->arenaSize elements
+ *  @return Output Feature Map [rows x output neurons], NULL if a layer does not support the time steps
+ *  or has no state for the streams
+ */
+data_t * NOINLINE inferNetworkPlanned(
+  struct layer * network,
+  int depth,
+  int rows,
   data_t * __restrict__ inFeatures,
-  data_t * __restrict__ buffer)
+  data_t ** batchStates,
+  struct memPlan * plan,
+  data_t * __restrict__ arena)
 {
- //printf("delete, just for test1");
   data_t * in = inFeatures;
-  data_t * out = &buffer[BUFFER_SIZE2];
-
-  short toFIRST = False;
   for(int i = 0; i < depth; i++)
   {
-      //printf("delete, just for test 2");
     struct layer lay = network[i];
-    if(lay.type == LINEAR)
+    data_t * out   = &arena[plan->outOffset[i]];
+    data_t * nodes = &arena[plan->scratchOffset[i]];
+    if(lay.weightFormat != WEIGHT_Q16)
+    {
+      if(batchStates != NULL && lay.type == LSTM && batchStates[i] == NULL) {
+        printf("\033[91mERROR: no state for the streams of LSTM layer %d\033[0m\n", i);
+        return NULL;
+      }
+      if(batchStates != NULL && lay.type == Conv2d) {
+        // no state, one stream at a time (QuantizedLayer takes rows without state as time steps)
+        for(int b = 0; b < rows; b++)
+          if(QuantizedLayer(&lay, 1, &in[b*layerInSize(&lay)], &out[b*layerOutSize(&lay)], nodes, NULL) < 0)
+            return NULL;
+      }
+      else if(QuantizedLayer(&lay, rows, in, out, nodes, batchStates != NULL ? batchStates[i] : NULL) < 0)
+        return NULL;
+    }
+    else if(lay.type == LINEAR)
     {
-
 #ifdef DEBUG_LSTM
       printf("Linear (%i, %i)\n", lay.attributes[LAY_LIN_IN], lay.attributes[LAY_LIN_OUT]);
       printf("Inputs in: ");
       PrintTensor(lay.attributes[LAY_LIN_IN], in);
 #endif
-      // startPerf();
-      LinearLayer(lay.attributes[LAY_LIN_IN], lay.attributes[LAY_LIN_OUT], True, 
+      LinearLayerParallel(lay.attributes[LAY_LIN_IN], lay.attributes[LAY_LIN_OUT], rows, True,
         lay.parameters[LAY_LIN_WEIGHTS],
-        lay.parameters[LAY_LIN_BIAS], 
+        lay.parameters[LAY_LIN_BIAS],
         // Input and Output Features
-        in, //inFeatures,
-        out); // outFeatures 
-      // endPerf();
+        in,
+        out,
+        layerShift(&lay),
+        lay.epilogue,
+        lay.tiling);
 #ifdef DEBUG_LSTM
       printf("Results in: ");
       PrintTensor(lay.attributes[LAY_LIN_OUT], out);
 #endif
-      toFIRST ^= 1; 
-
-      // switch buffer (double buffering)
-      if(toFIRST) 
-      {
-        in  = &buffer[BUFFER_SIZE2];
-        out = &buffer[0];
-      }
-      else 
-      {
-        in  = &buffer[0];
-        out = &buffer[BUFFER_SIZE2];
-      }
     }
     else if (lay.type == LSTM)
     {
@@ -194,77 +462,205 @@ data_t * NOINLINE inferNetwork(
       printf("Inputs in: ");
       PrintTensor(lay.attributes[LAY_LSTM_IN], in);
 #endif
-      
-      // startPerf();
       int numHidden = lay.attributes[LAY_LSTM_HID];
-      LSTMLayer (
-        // Layer Attributes
-        lay.attributes[LAY_LSTM_IN], numHidden,
-        // Layer Parameters
-        lay.parameters[LSTM_WGHT_IH],
-        lay.parameters[LSTM_WGHT_HH],
-        lay.parameters[LSTM_BIAS_IH],
-        lay.parameters[LSTM_BIAS_HH],
-        // Input and Output Features
-        in,
-        lay.parameters[LSTM_H],
-        // Hidden Features
-        lay.parameters[LSTM_C],
-        // intermediate nodes
-        out + 1*numHidden*1, //f
-        out + 2*numHidden*1, //i
-        out + 3*numHidden*1, //g
-        out //o
-        );
-      in  =  (data_t *)lay.parameters[LSTM_H];
-        // endPerf();
-
+      if(batchStates != NULL)
+      {
+        if(batchStates[i] == NULL) {
+          printf("\033[91mERROR: no state for the streams of LSTM layer %d\033[0m\n", i);
+          return NULL;
+        }
+        LSTMLayerBatch(lay.attributes[LAY_LSTM_IN], numHidden, rows,
+          lay.parameters[LSTM_WGHT_IH],
+          lay.parameters[LSTM_WGHT_HH],
+          lay.parameters[LSTM_BIAS_IH],
+          lay.parameters[LSTM_BIAS_HH],
+          in,
+          out,
+          batchStates[i],                    // h
+          batchStates[i] + rows*numHidden,   // c
+          nodes,
+          layerShift(&lay),
+          lay.tiling);
+      }
+      else
+      {
+        LSTMLayer (
+          // Layer Attributes
+          lay.attributes[LAY_LSTM_IN], numHidden, rows,
+          // Layer Parameters
+          lay.parameters[LSTM_WGHT_IH],
+          lay.parameters[LSTM_WGHT_HH],
+          lay.parameters[LSTM_BIAS_IH],
+          lay.parameters[LSTM_BIAS_HH],
+          // Input and Output Features
+          in,
+          out,
+          lay.parameters[LSTM_H],
+          // Hidden Features
+          lay.parameters[LSTM_C],
+          // intermediate nodes
+          nodes + 1*numHidden, //f
+          nodes + 2*numHidden, //i
+          nodes + 3*numHidden, //g
+          nodes, //o
+          layerShift(&lay),
+          lay.tiling);
+      }
 #ifdef DEBUG_LSTM
       printf("Results at: ");
-      PrintTensor(lay.attributes[LAY_LSTM_HID], lay.parameters[LSTM_H]);
+      PrintTensor(numHidden, out);
 #endif
     }
     else if(lay.type == Conv2d)
     {
-    #ifdef DEBUG_LSTM
+      // no weight reuse across the streams, no sequences
+      if(batchStates == NULL && rows > 1) {
+        printf("\033[91mERROR: Conv2d layer %d does not support sequences\033[0m\n", i);
+        return NULL;
+      }
+      int inSize  = lay.attributes[LAY_CONV_IN]*lay.attributes[LAY_CONV_H]*lay.attributes[LAY_CONV_W];
+      int outSize = layerOutSize(&lay);
+#ifdef DEBUG_LSTM
       printf("Conv2D (%i->%i, ker=%i^2, h*w=%i*%i)\n", lay.attributes[LAY_LIN_IN], lay.attributes[LAY_LIN_OUT], lay.attributes[LAY_CONV_KER],lay.attributes[LAY_CONV_H],lay.attributes[LAY_CONV_W]);
       printf("Inputs in: ");
-      PrintTensor(lay.attributes[LAY_LIN_IN]*lay.attributes[LAY_CONV_H]*lay.attributes[LAY_CONV_W], in);
+      PrintTensor(inSize, in);
 #endif
-      Conv2dLayer(&lay, lay.attributes[LAY_CONV_H], lay.attributes[LAY_CONV_W], in, out);
+      for(int b = 0; b < (batchStates != NULL ? rows : 1); b++)
+        Conv2dLayerParallel(&lay, &in[b*inSize], &out[b*outSize]);
 #ifdef DEBUG_LSTM
-      printf("Conv2D (%i->%i, ker=%i^2, h*w=%i*%i)\n", lay.attributes[LAY_LIN_IN], lay.attributes[LAY_LIN_OUT], lay.attributes[LAY_CONV_KER],lay.attributes[LAY_CONV_H],lay.attributes[LAY_CONV_W]);
       printf("Results in: ");
-      PrintTensor(lay.attributes[LAY_CONV_OUT]*lay.attributes[LAY_CONV_H]*lay.attributes[LAY_CONV_W], out);
+      PrintTensor(outSize, out);
 #endif
-      toFIRST ^= 1; 
-
-      // switch buffers
-      if(toFIRST) 
+    }
+    else if(lay.type == GRU)
+    {
+      int inSize    = lay.attributes[LAY_GRU_IN];
+      int numHidden = lay.attributes[LAY_GRU_HID];
+      if(batchStates != NULL)
       {
-        in  = &buffer[BUFFER_SIZE2];
-        out = &buffer[0];
+        if(batchStates[i] == NULL) {
+          printf("\033[91mERROR: no state for the streams of GRU layer %d\033[0m\n", i);
+          return NULL;
+        }
+        // one time step per stream with its own hidden state [rows x numHidden]
+        GRULayerBatch(inSize, numHidden, rows, lay.parameters[GRU_WGHT_IH], lay.parameters[GRU_WGHT_HH],
+          lay.parameters[GRU_BIAS_IH], lay.parameters[GRU_BIAS_HH], in, out,
+          batchStates[i], nodes, layerShift(&lay), lay.tiling);
       }
-      else 
-      {
-        in  = &buffer[0];
-        out = &buffer[BUFFER_SIZE2];
+      else
+        GRULayer(inSize, numHidden, rows, lay.parameters[GRU_WGHT_IH], lay.parameters[GRU_WGHT_HH],
+          lay.parameters[GRU_BIAS_IH], lay.parameters[GRU_BIAS_HH], in, out,
+          lay.parameters[GRU_H], nodes, layerShift(&lay), lay.tiling);
+    }
+    else if(lay.type == RNN)
+    {
+      if(batchStates != NULL) {
+        printf("\033[91mERROR: RNN layer %d does not support streams\033[0m\n", i);
+        return NULL;
       }
-
-      // printf("inconv=%i, ", in[0]);
-
-
+      RNNLayer(lay.attributes[LAY_RNN_IN], lay.attributes[LAY_RNN_HID], rows,
+        lay.parameters[RNN_WGHT_IH], lay.parameters[RNN_WGHT_HH], lay.parameters[RNN_BIAS_IH], lay.parameters[RNN_BIAS_HH],
+        in, out, lay.parameters[RNN_H], nodes, layerShift(&lay), lay.tiling);
+    }
+    else if(lay.type == ACTIVATION)
+    {
+      // element-wise, all the time steps or streams at once
+      ActivationLayer(rows*lay.attributes[LAY_ACT_SIZE], in, out, lay.epilogue);
     }
-// #endif
     else
     {
       printf("\033[91mERROR: not a valid layer\033[0m\n");
+      continue;
     }
+    in = out;
+  }
+  return &in[0]; // return address of output feature map
+}
 
+/** @brief Runs a neural network
+ *
+ *  Iterates through all the layers while passing the intermediate FMs in buffer, the offsets are
+ *  computed by the memory planner (planNetwork).
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @param seqSize Number of time steps (Linear and LSTM layers are applied to all of them, Conv2d layers only support 1)
+ *  @param inFeatures Input Feature Map [seqSize x input neurons]
+ *  @param buffer Buffer to store intermediate results (BUFFER_SIZE)
+ *  @return Output Feature Map [seqSize x output neurons], NULL if the FMs do not fit into buffer or
+ *  a layer does not support sequences
+ */
+data_t * NOINLINE inferNetwork(
+  struct layer * network, 
+  int depth, 
+  int seqSize,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ buffer)
+{
+  if(checkSeqSize(network, depth, seqSize) < 0)
+    return NULL;
+  struct memPlan plan;
+  int arenaSize = planNetwork(network, depth, seqSize, &plan);
+  if(arenaSize < 0 || arenaSize > BUFFER_SIZE) {
+    printf("\033[91mERROR: intermediate FMs (%d) too large for BUFFER_SIZE\033[0m\n", arenaSize);
+    return NULL;
+  }
+  return inferNetworkPlanned(network, depth, seqSize, inFeatures, NULL, &plan, buffer);
+}
 
-    
+/** @brief Runs a neural network for a batch of independent input streams (e.g. antennas or
+ *  frequency bands)
+ *
+ *  Same as inferNetwork() with [batchSize x features] FMs, but every layer is computed for all the
+ *  streams at once, i.e. the weights are reused for all the streams (see LinearLayerSeq and
+ *  LSTMLayerBatch). The LSTM state of each stream is kept in batchStates instead of the layer.
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @param batchSize Number of streams
+ *  @param inFeatures Input Feature Map [batchSize x input neurons]
+ *  @param batchStates LSTM and GRU states per layer (NULL for the other layers): h [batchSize x hidden], followed by c [batchSize x hidden] (LSTM)
+ *  @param buffer Buffer to store intermediate results (BUFFER_SIZE)
+ *  @return Output Feature Map [batchSize x output neurons], NULL if the FMs do not fit into buffer
+ */
+data_t * NOINLINE inferNetworkBatch(
+  struct layer * network,
+  int depth,
+  int batchSize,
+  data_t * __restrict__ inFeatures,
+  data_t ** batchStates,
+  data_t * __restrict__ buffer)
+{
+  struct memPlan plan;
+  int arenaSize = planNetwork(network, depth, batchSize, &plan);
+  if(arenaSize < 0 || arenaSize > BUFFER_SIZE) {
+    printf("\033[91mERROR: intermediate FMs (%d) too large for BUFFER_SIZE\033[0m\n", arenaSize);
+    return NULL;
   }
-return &in[0]; // return address of output feature map
+  return inferNetworkPlanned(network, depth, batchSize, inFeatures, batchStates, &plan, buffer);
+}
+
+/// Activation of the LSTM gates in TwoLinearLayersAccumulate (only possible with DOACTONTHEFLY)
+static inline int tilingActOnTheFly(struct tiling tiling) {
+#ifdef DOACTONTHEFLY
+  return tiling.actOnTheFly != ACT_ONTHEFLY_OFF;
+#else
+  (void)tiling;
+  return 0;
+#endif
+}
+
+/** @brief Sets the tiling of all the layers of a network (e.g. to sweep the tile sizes without
+ *  rebuilding)
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @param tiling Tiling to be used for all layers
+ */
+void setNetworkTiling(struct layer * network, int depth, struct tiling tiling)
+{
+  for(int i = 0; i < depth; i++)
+    network[i].tiling = tiling;
 }
 
 
@@ -285,14 +681,191 @@ return &in[0]; // return address of output feature map
  //|_____ |_____| |     | |_____/ |  |  | |     | |_____         \/   |_____ __|__ |__|__|   // 
  //                                                                                          //
  //////////////////////////////////////////////////////////////////////////////////////////////
-#if defined FMOUTTILING && !defined(ASIP) && defined MANUALLOOPUNFOLDING && defined VLIWEXT // obv vliw
+#if defined HOST_SIMD && defined FixedPt && defined SIMD // x86 host
+/** @brief acc[o] += sum_i weight[o][i]*inFeatures[i] for 8 output neurons per block with AVX2
+ *
+ *  One ymm accumulator per output neuron (8 of the 16 ymm registers), the input FM is loaded once
+ *  for all the 8 neurons of the block, all additions are modulo 2^32 (same as the sdotp chain).
+ *  Left over output neurons are done with hostSumDotp2N.
+ */
+static void __attribute__ ((target ("avx2"))) hostMatVecAcc_AVX2(int outFeaturesSize, int inFeaturesSizeP2, v2s * weight, v2s * inFeatures, int32_t * acc) {
+  int o = 0;
+  __m256i tailMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(inFeaturesSizeP2%8), _mm256_setr_epi32(0,1,2,3,4,5,6,7));
+  for(; o+8<=outFeaturesSize; o+=8) {
+    __m256i temp[8];
+    int i = 0;
+#pragma GCC unroll 8
+    for(int o_rel=0; o_rel<8; o_rel++) temp[o_rel] = _mm256_setzero_si256();
+    for(; i+8<=inFeaturesSizeP2; i+=8) {
+      __m256i inF_temp = _mm256_loadu_si256((__m256i*)&inFeatures[i]);
+#pragma GCC unroll 8
+      for(int o_rel=0; o_rel<8; o_rel++)
+        temp[o_rel] = _mm256_add_epi32(temp[o_rel], _mm256_madd_epi16(inF_temp, _mm256_loadu_si256((__m256i*)&weight[inFeaturesSizeP2*(o+o_rel)+i])));
+    }
+    if(i < inFeaturesSizeP2) { // left over input pairs (masked, one v2s per 32-bit lane)
+      __m256i inF_temp = _mm256_maskload_epi32((int*)&inFeatures[i], tailMask);
+#pragma GCC unroll 8
+      for(int o_rel=0; o_rel<8; o_rel++)
+        temp[o_rel] = _mm256_add_epi32(temp[o_rel], _mm256_madd_epi16(inF_temp, _mm256_maskload_epi32((int*)&weight[inFeaturesSizeP2*(o+o_rel)+i], tailMask)));
+    }
+    // reduce the 8 accumulators to one register (lane o_rel = neuron o+o_rel)
+    __m256i sum01   = _mm256_hadd_epi32(temp[0], temp[1]);
+    __m256i sum23   = _mm256_hadd_epi32(temp[2], temp[3]);
+    __m256i sum45   = _mm256_hadd_epi32(temp[4], temp[5]);
+    __m256i sum67   = _mm256_hadd_epi32(temp[6], temp[7]);
+    __m256i sum0123 = _mm256_hadd_epi32(sum01, sum23);
+    __m256i sum4567 = _mm256_hadd_epi32(sum45, sum67);
+    __m256i sum     = _mm256_add_epi32(_mm256_permute2x128_si256(sum0123, sum4567, 0x20), _mm256_permute2x128_si256(sum0123, sum4567, 0x31));
+    _mm256_storeu_si256((__m256i*)&acc[o], _mm256_add_epi32(sum, _mm256_loadu_si256((__m256i*)&acc[o])));
+  }
+  for(; o<outFeaturesSize; o++)
+    acc[o] = hostSumDotp2N(inFeatures, &weight[inFeaturesSizeP2*o], inFeaturesSizeP2, acc[o]);
+}
+
+/** @brief Body of the AVX-512 kernels for 16 output neurons per block
+ *
+ *  One zmm accumulator per output neuron (16 of the 32 zmm registers), SIMD_MAC(acc, a, b) is either
+ *  vpmaddwd+vpaddd or vpdpwssd (VNNI, non-saturating), both are modulo 2^32.
+ */
+#define HOST_MATVECACC_AVX512(SIMD_MAC) \
+  int o = 0; \
+  __mmask16 tailMask = (__mmask16)((1<<(inFeaturesSizeP2%16))-1); \
+  for(; o+16<=outFeaturesSize; o+=16) { \
+    __m512i temp[16]; \
+    int i = 0; \
+    _Pragma("GCC unroll 16") \
+    for(int o_rel=0; o_rel<16; o_rel++) temp[o_rel] = _mm512_setzero_si512(); \
+    for(; i+16<=inFeaturesSizeP2; i+=16) { \
+      __m512i inF_temp = _mm512_loadu_si512(&inFeatures[i]); \
+      _Pragma("GCC unroll 16") \
+      for(int o_rel=0; o_rel<16; o_rel++) \
+        temp[o_rel] = SIMD_MAC(temp[o_rel], inF_temp, _mm512_loadu_si512(&weight[inFeaturesSizeP2*(o+o_rel)+i])); \
+    } \
+    if(i < inFeaturesSizeP2) { /* left over input pairs (masked, one v2s per 32-bit lane) */ \
+      __m512i inF_temp = _mm512_maskz_loadu_epi32(tailMask, &inFeatures[i]); \
+      _Pragma("GCC unroll 16") \
+      for(int o_rel=0; o_rel<16; o_rel++) \
+        temp[o_rel] = SIMD_MAC(temp[o_rel], inF_temp, _mm512_maskz_loadu_epi32(tailMask, &weight[inFeaturesSizeP2*(o+o_rel)+i])); \
+    } \
+    /* reduce the 16 accumulators to one register (lane o_rel = neuron o+o_rel) */ \
+    __m512i sum2[8], sum4[4]; \
+    _Pragma("GCC unroll 8") \
+    for(int k=0; k<8; k++) sum2[k] = _mm512_add_epi32(_mm512_unpacklo_epi32(temp[2*k], temp[2*k+1]), _mm512_unpackhi_epi32(temp[2*k], temp[2*k+1])); \
+    _Pragma("GCC unroll 4") \
+    for(int k=0; k<4; k++) sum4[k] = _mm512_add_epi32(_mm512_unpacklo_epi64(sum2[2*k], sum2[2*k+1]), _mm512_unpackhi_epi64(sum2[2*k], sum2[2*k+1])); \
+    __m512i sum01 = _mm512_add_epi32(_mm512_shuffle_i32x4(sum4[0], sum4[1], _MM_SHUFFLE(2,0,2,0)), _mm512_shuffle_i32x4(sum4[0], sum4[1], _MM_SHUFFLE(3,1,3,1))); \
+    __m512i sum23 = _mm512_add_epi32(_mm512_shuffle_i32x4(sum4[2], sum4[3], _MM_SHUFFLE(2,0,2,0)), _mm512_shuffle_i32x4(sum4[2], sum4[3], _MM_SHUFFLE(3,1,3,1))); \
+    __m512i sum   = _mm512_add_epi32(_mm512_shuffle_i32x4(sum01, sum23, _MM_SHUFFLE(2,0,2,0)), _mm512_shuffle_i32x4(sum01, sum23, _MM_SHUFFLE(3,1,3,1))); \
+    _mm512_storeu_si512(&acc[o], _mm512_add_epi32(sum, _mm512_loadu_si512(&acc[o]))); \
+  } \
+  for(; o<outFeaturesSize; o++) \
+    acc[o] = hostSumDotp2N(inFeatures, &weight[inFeaturesSizeP2*o], inFeaturesSizeP2, acc[o]);
+
+#define HOST_MAC_MADD(acc, a, b) _mm512_add_epi32(acc, _mm512_madd_epi16(a, b))
+#define HOST_MAC_VNNI(acc, a, b) _mm512_dpwssd_epi32(acc, a, b)
+
+/** @brief acc[o] += sum_i weight[o][i]*inFeatures[i] for 16 output neurons per block with AVX-512 (vpmaddwd)
+ */
+static void __attribute__ ((target ("avx512f,avx512bw"))) hostMatVecAcc_AVX512(int outFeaturesSize, int inFeaturesSizeP2, v2s * weight, v2s * inFeatures, int32_t * acc) {
+  HOST_MATVECACC_AVX512(HOST_MAC_MADD)
+}
+/** @brief acc[o] += sum_i weight[o][i]*inFeatures[i] for 16 output neurons per block with AVX-512 VNNI (vpdpwssd)
+ */
+static void __attribute__ ((target ("avx512f,avx512bw,avx512vnni"))) hostMatVecAcc_AVX512VNNI(int outFeaturesSize, int inFeaturesSizeP2, v2s * weight, v2s * inFeatures, int32_t * acc) {
+  HOST_MATVECACC_AVX512(HOST_MAC_VNNI)
+}
+
+/** @brief acc[o] += sum_i weight[o][i]*inFeatures[i] with the best x86 kernel of the CPU (see hostIsaLevel)
+ *
+ *  @param outFeaturesSize Number of output neurons
+ *  @param inFeaturesSizeP2 Number of input neuron pairs (v2s)
+ *  @param weight Pointer to weights (outFeaturesSize x inFeaturesSizeP2 v2s)
+ *  @param inFeatures Input Feature Map
+ *  @param acc int32 accumulators (e.g. initialized with the bias)
+ */
+static void hostMatVecAcc(int outFeaturesSize, int inFeaturesSizeP2, v2s * weight, v2s * inFeatures, int32_t * acc) {
+  switch(hostIsaLevel()) {
+    case HOST_ISA_AVX512VNNI: hostMatVecAcc_AVX512VNNI(outFeaturesSize, inFeaturesSizeP2, weight, inFeatures, acc); break;
+    case HOST_ISA_AVX512:     hostMatVecAcc_AVX512(outFeaturesSize, inFeaturesSizeP2, weight, inFeatures, acc); break;
+    case HOST_ISA_AVX2:       hostMatVecAcc_AVX2(outFeaturesSize, inFeaturesSizeP2, weight, inFeatures, acc); break;
+    default:
+      for (int o=0; o<outFeaturesSize; o++)
+        acc[o] = hostSumDotp2N(inFeatures, &weight[inFeaturesSizeP2*o], inFeaturesSizeP2, acc[o]);
+  }
+}
+
+// shift, activation and clamping of the accumulators in the SIMD registers (with the activation layers below)
+static void hostShiftEpilogueN(const int32_t * acc, int n, int shift, struct epilogue epilogue, data_t * out);
+
+/// Number of output neurons which are calculated per call of hostMatVecAcc (int32 accumulators on the stack)
+#define HOST_OUTPUTBUFFER 256
+
+/** @brief Calculates a Fully-Connected (or Linear Layer) 
+ *  
+ *  Calculates a fully conntected Layer on the x86 host with AVX-512 VNNI, AVX-512, AVX2 or SSE2
+ *  (selected at runtime with CPUID), bit-exact to the RISC-Y kernels (int32 accumulation of the
+ *  Q3.12 products starting from bias<<shift, then >>shift and truncation to data_t or saturation
+ *  with SATURATE), the epilogue is applied in the SIMD registers before the store (hostShiftEpilogueN)
+ *  Supports the following configurations:
+ *  HOST and HOST_SIMD, FixedPt and SIMD only
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param outFeaturesSize Number of output neurons
+ *  @param hasBias FC with bias or not?
+ *  @param weight Pointer to weights
+ *  @param bias Pointer to bias
+ *  @param inFeatures Input Feature Map
+ *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+void NOINLINE LinearLayer (
+        // Layer Attributes
+  int inFeaturesSize, int outFeaturesSize,
+  short hasBias,
+        // Layer Parameters
+  data_t * __restrict__ weight,
+  data_t * __restrict__ bias,
+        // Input and Output Features
+  data_t * __restrict__ inFeatures,
+        data_t * __restrict__ outFeatures, //property(functional)
+        int shift,
+        struct epilogue epilogue,
+        struct tiling tiling)
+{
+  PROFILING_LINEAR_START
+  (void)tiling; // blocks of HOST_OUTPUTBUFFER neurons for all the tilings
+
+  int inFeaturesSizeP2 = inFeaturesSize/2;
+  int32_t temp[HOST_OUTPUTBUFFER];
+
+  for (int o_tile=0; o_tile<outFeaturesSize; o_tile+=HOST_OUTPUTBUFFER) {
+    int outFeaturesPerTile = Min(outFeaturesSize-o_tile, HOST_OUTPUTBUFFER);
+    for (int o_rel=0; o_rel<outFeaturesPerTile; o_rel++)
+      temp[o_rel] = hasBias ? (int32_t)bias[o_tile+o_rel]<<(shift) : 0;
+    hostMatVecAcc(outFeaturesPerTile, inFeaturesSizeP2, &((v2s*)weight)[inFeaturesSizeP2*o_tile], (v2s*)inFeatures, temp);
+    hostShiftEpilogueN(temp, outFeaturesPerTile, shift, epilogue, &outFeatures[o_tile]);
+  }
+
+  PROFILING_LINEAR_END
+}
+#elif defined FMOUTTILING && !defined(ASIP) && defined MANUALLOOPUNFOLDING // RISCY implementation (VLIW or plain sdotp)
+TILE_KERNEL_FAMILY(LINEAR_TILE_KERNEL)
+/// LinearLayer kernels of all the output FM tile sizes (index: tile size)
+static void (* const linearLayerTiles[TILE_MAXSIZE+1])(int, int, data_t *, data_t *, data_t *, data_t *, int, struct epilogue, int) = TILE_KERNEL_TABLE(LinearLayerTile);
+/// LinearLayer is made of calls to linearLayerTiles (see compileNetwork)
+#define LINEAR_TILES
+
 /** @brief Calculates a Fully-Connected (or Linear Layer) 
  *  
- *  Calculates a fully conntected Layer with the custom VLIW instructions for load and MAC
+ *  Calculates a fully conntected Layer with output FM tiling, the kernel of each tile size is
+ *  generated from the template in tileKernel.h (with VLIWEXT the custom VLIW instructions for load
+ *  and MAC are used)
  *  Supports the following configurations:
- *  INPUTFMTILING false/true with input tile size 2
- *  OUTPUTFMTILING false/true with output tile sizes 1,2,4,8,10,12,14 (odd are currently not
- *                 supported as the SPR would need to be switched)
+ *  INPUTFMTILING false/true with input tile size 2 (selected per layer)
+ *  OUTPUTFMTILING true with output tile sizes 1..16 selected per layer (remaining neurons are
+ *                 calculated with tile sizes 8, 4, 2 and 1)
  *  FixedPt and SIMD and MANUALLOOPUNFOLDING only
  *
  *  @param inFeaturesSize Number of input neurons
@@ -302,6 +875,9 @@ return &in[0]; // return address of output feature map
  *  @param bias Pointer to bias
  *  @param inFeatures Input Feature Map
  *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (see struct tiling)
  */
 void NOINLINE LinearLayer (
         // Layer Attributes
@@ -312,547 +888,264 @@ void NOINLINE LinearLayer (
   data_t * __restrict__ bias,
         // Input and Output Features
   data_t * __restrict__ inFeatures,
-        data_t * __restrict__ outFeatures) //property(functional)
+        data_t * __restrict__ outFeatures, //property(functional)
+        int shift,
+        struct epilogue epilogue,
+        struct tiling tiling)
 {
   PROFILING_LINEAR_START
 
   int inFeaturesSizeP2 = inFeaturesSize/2;
-  #ifdef FMINTILING
-  int inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-  #else
-  int inFeaturesSizeP4 = inFeaturesSizeP2;   // no input FM tiling
-  #endif
+  int inTiling = tilingInTiling(tiling);
 
-  #if OUTPUTBUFFER > 8
-  int tileOptions[] = {OUTPUTBUFFER,8,4,2,1};
-  #elif OUTPUTBUFFER > 4
-  int tileOptions[] = {OUTPUTBUFFER,4,2,1};
-  #else
-  int tileOptions[] = {OUTPUTBUFFER,2,1};
-  #endif
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(tiling), tileOptions);
 
-  data_t  * bias_ptr   = bias;
+  data_t  * bias_ptr   = hasBias ? bias : NULL; // NULL: the tile kernels start from 0
   v2s     * weight_ptr = (v2s*)weight;
   data_t  * outFeatures_ptr = outFeatures;
   int outFeaturesPerTile = 1;
 
-  // register definition for manual loop unfolding
-  register_attribute int32_t   temp0, temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8, temp9, temp10, temp11, temp12, temp13, temp14;
-  register_attribute uint32_t  addr0, addr1, addr2, addr3, addr4, addr5, addr6, addr7, addr8, addr9, addr10, addr11, addr12, addr13, addr14;
-  register_attribute uint32_t  in_addr;
-
-  // register null
-  register int x0 asm("x0");
-
   int outFeatureTiles;
   int outFeaturesSize_remain = outFeaturesSize;
 
   // Tile with largest tileOption
-  for(unsigned int i=0; i<sizeof(tileOptions)/sizeof(int); i++) {
+  for(int i=0; i<numTileOptions; i++) {
     outFeaturesPerTile = tileOptions[i];
     outFeatureTiles = outFeaturesSize_remain/outFeaturesPerTile;
     
     if(outFeatureTiles == 0) continue;
 
-    // Select Tile Size
-    switch(outFeaturesPerTile) {
-     #if OUTPUTBUFFER > 2
-     case OUTPUTBUFFER:
-     for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-     {
-      // Manual loop unfolding
-      // Inititalize accumulation registers with bias and shift accordingly
-          #if OUTPUTBUFFER > 2
-      temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 3
-      temp1 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 4
-      temp2 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 5
-      temp3 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 6
-      temp4 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+4]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 7
-      temp5 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+5]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 8
-      temp6 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+6]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 9
-      temp7 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+7]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 10
-      temp8 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+8]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 11
-      temp9 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+9]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 12
-      temp10 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+10]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 13
-      temp11 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+11]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 14
-      temp12 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+12]<<(q_fraqP1);
-          #endif
-      temp13 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+OUTPUTBUFFER-2]<<(q_fraqP1);
-      temp14 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+OUTPUTBUFFER-1]<<(q_fraqP1);
-
-      addr0  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 0))];
-      addr1  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 1))];
-      addr2  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 2))];
-      addr3  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 3))];
-      addr4  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 4))];
-      addr5  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 5))];
-      addr6  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 6))];
-      addr7  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 7))];
-      addr8  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 8))];
-      addr9  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 9))];
-      addr10 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+10))];
-      addr11 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+11))];
-      addr12 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+12))];
-      addr13 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+OUTPUTBUFFER-2))];
-      addr14 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+OUTPUTBUFFER-1))];
-
-          asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-          asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
-
-          in_addr = (uint32_t) (((v2s*)inFeatures));
-          for(int i=0; i<inFeaturesSizeP4; i++) {
-              v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-              v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
-
-
-              // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-  #ifdef FMINTILING
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-  #endif
-              // MANUAL loop unfolding
-               #if OUTPUTBUFFER > 2
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 3
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 4
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 5
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 6
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 7
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp) ); 
-               #endif
-               #if OUTPUTBUFFER > 9
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr8) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 9
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr9) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 10
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp8),  "+r" (addr10) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 11
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp9),  "+r" (addr11) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 12
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp10),  "+r" (addr12) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 13
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp11),  "+r" (addr13) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 14
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp12),  "+r" (addr14) : "r" (inF_temp) );
-               #endif
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp13),  "+r" (addr0) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp14),  "+r" (addr1) : "r" (inF_temp) );
-// do it twice for FMINTILING
-  #ifdef FMINTILING
-               #if OUTPUTBUFFER > 2
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 3
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 4
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 5
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 6
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 7
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp2) ); 
-               #endif
-               #if OUTPUTBUFFER > 9
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr8) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 9
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr9) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 10
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp8),  "+r" (addr10) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 11
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp9),  "+r" (addr11) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 12
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp10),  "+r" (addr12) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 13
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp11),  "+r" (addr13) : "r" (inF_temp2) );
-               #endif
-               #if OUTPUTBUFFER > 14
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp12),  "+r" (addr14) : "r" (inF_temp2) );
-               #endif
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp13),  "+r" (addr0) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp14),  "+r" (addr1) : "r" (inF_temp2) );
-  #endif
-            // }
-            }
-  #ifdef FMINTILING
-          if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-               v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-               // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-               asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-               // asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-               
-               // MANUAL loop unfolding
-               // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-               // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-               #if OUTPUTBUFFER > 2
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 3
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 4
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 5
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 6
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 7
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp) ); 
-               #endif
-               #if OUTPUTBUFFER > 9
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr8) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 9
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr9) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 10
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp8),  "+r" (addr10) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 11
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp9),  "+r" (addr11) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 12
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp10),  "+r" (addr12) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 13
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp11),  "+r" (addr13) : "r" (inF_temp) );
-               #endif
-               #if OUTPUTBUFFER > 14
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp12),  "+r" (addr14) : "r" (inF_temp) );
-               #endif
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp13),  "+r" (addr0) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp14),  "+r" (addr1) : "r" (inF_temp) );
-             }
-
-  #endif
+    linearLayerTiles[outFeaturesPerTile](outFeatureTiles, inFeaturesSizeP2, (data_t*)weight_ptr, bias_ptr, inFeatures, outFeatures_ptr, shift, epilogue, inTiling);
 
-// Store the final results back to the memory
-        // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-                #if OUTPUTBUFFER > 2
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 3
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = temp1>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 4
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 5
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 6
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+4)] = temp4>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 7
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+5)] = temp5>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 8
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+6)] = temp6>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 9
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+7)] = temp7>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 10
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+8)] = temp8>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 11
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+9)] = temp9>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 12
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+10)] = temp10>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 13
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+11)] = temp11>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 14
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+12)] = temp12>>(q_fraqP1);
-                #endif
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+OUTPUTBUFFER-2)] = temp13>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+OUTPUTBUFFER-1)] = temp14>>(q_fraqP1);
-                // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-        // }
+  // move pointers for next iteration
+    if(bias_ptr != NULL)
+      bias_ptr              = &bias_ptr[outFeatureTiles*outFeaturesPerTile];
+    weight_ptr              = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(outFeatureTiles*outFeaturesPerTile))];
+    outFeatures_ptr         = &outFeatures_ptr[(outFeatureTiles*outFeaturesPerTile)];
+    outFeaturesSize_remain -= outFeatureTiles*outFeaturesPerTile;
+    if (outFeaturesSize_remain==0) break;
+  }
 
-           }
-           break;
-     #endif
-     #if OUTPUTBUFFER > 8
-           case 8:
-           for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-           {
+  PROFILING_LINEAR_END
+}
+#elif defined ASIP && defined FMOUTTILING // LinearLayer Implementation for the ASIP tool and 
+/** @brief Calculates a Fully-Connected (or Linear Layer) 
+ *  
+ *  Calculates a fully conntected Layer with for the ASIP designer (extended tzscale)
+ *  Supports the following configurations:
+ *  INPUTFMTILING false (no input FM tiling support as not needed)
+ *  OUTPUTFMTILING false/true with output tile sizes 1,2,4,8,10
+ *  MANUALLOOPUNFOLDING false/true
+ *  FixedPt and SIMD and  only
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param outFeaturesSize Number of output neurons
+ *  @param hasBias FC with bias or not?
+ *  @param weight Pointer to weights
+ *  @param bias Pointer to bias
+ *  @param inFeatures Input Feature Map
+ *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+  void NOINLINE LinearLayer (
+        // Layer Attributes
+    int inFeaturesSize, int outFeaturesSize,
+    short hasBias,
+        // Layer Parameters
+    data_t * __restrict__ weight,
+    data_t * __restrict__ bias,
+        // Input and Output Features
+    data_t * __restrict__ inFeatures,
+        data_t * __restrict__ outFeatures, //property(functional)
+        int shift,
+        struct epilogue epilogue,
+        struct tiling tiling)
+  {
+    PROFILING_LINEAR_START
 
-            temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-            temp1 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-            temp2 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-            temp3 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-            temp4 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+4]<<(q_fraqP1);
-            temp5 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+5]<<(q_fraqP1);
-            temp6 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+6]<<(q_fraqP1);
-            temp7 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+7]<<(q_fraqP1);
-
-          // }
-          // printf("wght=%i, addr before=%i (+%i)=%i\n", weight, addr0, inFeaturesSizeP2*outFeaturesPerTile, addr0+4*inFeaturesSizeP2*outFeaturesPerTile);
-            addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-            addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-            addr2 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-            addr3 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-            addr4 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+4))];
-            addr5 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+5))];
-            addr6 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+6))];
-            addr7 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+7))];
-
-
-          asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-          asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload 2nd weight
-
-          in_addr = (((v2s*)inFeatures));
-          for(int i=0; i<inFeaturesSizeP4; i++) {
-              v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-              v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
-
-              // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-  #ifdef FMINTILING
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-  #endif
-              // MANUAL loop unfolding
-              // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-              // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp) ); 
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp) );
-  #ifdef FMINTILING
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp2) ); 
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp2) );
-  #endif
-            // }
-            }
-  #ifdef FMINTILING
-          if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-               v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-               asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp) ); 
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp) );
+    int inFeaturesSizeP2 = inFeaturesSize/2;
 
-             }
-  #endif
-        // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = temp1>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+4)] = temp4>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+5)] = temp5>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+6)] = temp6>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+7)] = temp7>>(q_fraqP1);
-        // }
-           }
-           break;
-     #endif
-     #if OUTPUTBUFFER > 4
-           case 4:
-           for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-           {
+//  _  __    _                                                               _   
+// / | \ \  | | ___   ___  _ __     _____   _____ _ __    ___     ___  _   _| |_ 
+// | |  | | | |/ _ \ / _ \| '_ \   / _ \ \ / / _ \ '__|  / __|   / _ \| | | | __|
+// | |  | | | | (_) | (_) | |_) | | (_) \ V /  __/ |    | (__   | (_) | |_| | |_ 
+// |_|  | | |_|\___/ \___/| .__/   \___/ \_/ \___|_|     \___|__ \___/ \__,_|\__|
+//     /_/                |_|                                |__|              
 
-            temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-            temp1 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-            temp2 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-            temp3 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
+//----------------------------------------------------------------
+// 1a) Tile Output Channels
+//----------------------------------------------------------------
 
-          // }
-            addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-            addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-            addr2 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-            addr3 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
+    int tileOptions[] = {10,8,4,2, 1};
+    int outFeaturesPerTile = 1;
+    for(unsigned int i=0; i<sizeof(tileOptions)/sizeof(int); i++) {
+     if(outFeaturesSize % tileOptions[i] == 0) {
+      outFeaturesPerTile = tileOptions[i];
+      break;
+    }
+  }
 
+  int outFeatureTiles = outFeaturesSize/outFeaturesPerTile;
 
-          asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-          asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
 
-          in_addr = (uint32_t)(((v2s*)inFeatures));
-          for(int i=0; i<inFeaturesSizeP4; i++) {
-              v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-              v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
+  switch(outFeaturesPerTile) {
+   case 10:
+   for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
+    int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;
+    int32_t register_attribute ra2;int32_t register_attribute rb2;int32_t register_attribute rc2;int32_t register_attribute rd2;
+    int32_t register_attribute rc3;int32_t register_attribute rd3;
+    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(shift);
+    rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(shift);
+    rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(shift);
+    rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(shift);
+    ra2 = (int32_t)bias[o_tile*outFeaturesPerTile+4]<<(shift);
+    rb2 = (int32_t)bias[o_tile*outFeaturesPerTile+5]<<(shift);
+    rc2 = (int32_t)bias[o_tile*outFeaturesPerTile+6]<<(shift);
+    rd2 = (int32_t)bias[o_tile*outFeaturesPerTile+7]<<(shift);
+    rc3 = (int32_t)bias[o_tile*outFeaturesPerTile+8]<<(shift);
+    rd3 = (int32_t)bias[o_tile*outFeaturesPerTile+9]<<(shift);
 
 
-              // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-  #ifdef FMINTILING
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-  #endif
-              // MANUAL loop unfolding
-              // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-              // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr0) : "r" (inF_temp) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr1) : "r" (inF_temp) );
-  #ifdef FMINTILING
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr0) : "r" (inF_temp2) );
-              asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr1) : "r" (inF_temp2) );
-  #endif
-            // }
-            }
-  #ifdef FMINTILING
-          if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-               v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-               asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr0) : "r" (inF_temp) );
-               asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr1) : "r" (inF_temp) );
+    for(int i=0; i<inFeaturesSizeP2; i++) { 
+     v2s inF_temp = ((v2s*)inFeatures)[i];                                                          
 
+               ra=ext_dotp_(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i], ra); // lwinc x23, 0(x20)
+               rb = rb + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1)) + i]);      // lwinc x25, 0(x11); sdotp x7, x23, x25 
+               rc = rc + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2)) + i]);      // lwinc x24, 0(x11); sdotp x7, x23, x24 
+               rd = rd + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3)) + i]);      // lwinc xA, 0(xB); sdotp xC, x23, xB
+               ra2 = ra2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+4)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
+               rb2 = rb2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+5)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
+               rc2 = rc2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+6)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
+               rd2 = rd2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+7)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
+               rc3 = rc3 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+8)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
+               rd3 = rd3 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+9)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
              }
-  #endif
-        // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = temp1>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-               // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-        // }
-           }
-           break;
-     #endif
-           case 2:
-           for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-           {
+             outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
+             outFeatures[(o_tile*outFeaturesPerTile+1)] = shiftAndEpilogue(rb, shift, epilogue);
+             outFeatures[(o_tile*outFeaturesPerTile+2)] = shiftAndEpilogue(rc, shift, epilogue);
+             outFeatures[(o_tile*outFeaturesPerTile+3)] = shiftAndEpilogue(rd, shift, epilogue);
+             outFeatures[(o_tile*outFeaturesPerTile+4)] = shiftAndEpilogue(ra2, shift, epilogue);
+             outFeatures[(o_tile*outFeaturesPerTile+5)] = shiftAndEpilogue(rb2, shift, epilogue);
+             outFeatures[(o_tile*outFeaturesPerTile+6)] = shiftAndEpilogue(rc2, shift, epilogue);
+             outFeatures[(o_tile*outFeaturesPerTile+7)] = shiftAndEpilogue(rd2, shift, epilogue);
+             outFeatures[(o_tile*outFeaturesPerTile+8)] = shiftAndEpilogue(rc3, shift, epilogue);
+             outFeatures[(o_tile*outFeaturesPerTile+9)] = shiftAndEpilogue(rd3, shift, epilogue);
 
-            temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-            temp1 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-          // temp2 = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-          // temp3 = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-          // }
-            addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-            addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-          // addr2 = &((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-          // addr3 = &((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-          asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload no compute
-          asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload no compute
-          for(int i=0; i<inFeaturesSizeP2; i++) {
-            v2s inF_temp = ((v2s*)inFeatures)[i];
-            
-            // int o_rel;
-            // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr0) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr1) : "r" (inF_temp) );
-               // asm volatile("pl.sdotsp.h %0, %1, %2" : "+r" (temp2) : "r" (addr3), "r" (inF_temp) );
-               // asm volatile("pl.sdotsp.h %0, %1, %2" : "+r" (temp3) : "r" (addr0), "r" (inF_temp) );
-            // }
-          }
-        // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-          outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-          outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = temp1>>(q_fraqP1);
-                // outFeatures[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-                // outFeatures[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-                // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-        // }
 
-        }
-        break;
-        case 1:
-        for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-        {
-          temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-          for(int i=0; i<inFeaturesSizeP2; i++) {
-            v2s inF_temp = ((v2s*)inFeatures)[i];
-            temp0 = __SUMDOTP2(inF_temp, ((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile)) + i], temp0);
-          }
-          outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-        }
-        break;
-      }
+   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
+   break;
 
-  // move pointers for next iteration
-      bias_ptr                = &bias_ptr[outFeatureTiles*outFeaturesPerTile];
-      weight_ptr              = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(outFeatureTiles*outFeaturesPerTile))];
-      outFeatures_ptr         = &outFeatures_ptr[(outFeatureTiles*outFeaturesPerTile)];
-      outFeaturesSize_remain -= outFeatureTiles*outFeaturesPerTile;
-      if (outFeaturesSize_remain==0) break;
-    }
+   case 8:
+   for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
+    int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;
+    int32_t register_attribute ra2;int32_t register_attribute rb2;int32_t register_attribute rc2;int32_t register_attribute rd2;
+    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(shift);
+    rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(shift);
+    rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(shift);
+    rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(shift);
+    ra2 = (int32_t)bias[o_tile*outFeaturesPerTile+4]<<(shift);
+    rb2 = (int32_t)bias[o_tile*outFeaturesPerTile+5]<<(shift);
+    rc2 = (int32_t)bias[o_tile*outFeaturesPerTile+6]<<(shift);
+    rd2 = (int32_t)bias[o_tile*outFeaturesPerTile+7]<<(shift);
+    for(int i=0; i<inFeaturesSizeP2; i++) { 
+     v2s inF_temp = ((v2s*)inFeatures)[i];
+     ra = ra + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i]);
+     rb = rb + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1)) + i]);
+     rc = rc + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2)) + i]);
+     rd = rd + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3)) + i]);
+     ra2 = ra2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+4)) + i]);
+     rb2 = rb2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+5)) + i]);
+     rc2 = rc2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+6)) + i]);
+     rd2 = rd2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+7)) + i]);
+      } // for(int i=0; i<inFeaturesSizeP2; i++)
+      outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+1)] = shiftAndEpilogue(rb, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+2)] = shiftAndEpilogue(rc, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+3)] = shiftAndEpilogue(rd, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+4)] = shiftAndEpilogue(ra2, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+5)] = shiftAndEpilogue(rb2, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+6)] = shiftAndEpilogue(rc2, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+7)] = shiftAndEpilogue(rd2, shift, epilogue);
+   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
+   break;
+   case 4:
+   for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
+    int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;
+    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(shift);
+    rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(shift);
+    rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(shift);
+    rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(shift);
+    for(int i=0; i<inFeaturesSizeP2; i++) { 
+     v2s inF_temp = ((v2s*)inFeatures)[i];
+     ra = ra + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i]);
+     rb = rb + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1)) + i]);
+     rc = rc + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2)) + i]);
+     rd = rd + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3)) + i]);
+      } // for(int i=0; i<inFeaturesSizeP2; i++)
+      outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+1)] = shiftAndEpilogue(rb, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+2)] = shiftAndEpilogue(rc, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+3)] = shiftAndEpilogue(rd, shift, epilogue);
+   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
+   break;
+ case 2: // HOWTO duplicate and comment out not needed lines
+ for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
+      int32_t register_attribute ra;int32_t register_attribute rb;//int32_t register_attribute rc;int32_t register_attribute rd;
+      ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(shift);
+      rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(shift);
+      // rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(shift);
+      // rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(shift);
+      for(int i=0; i<inFeaturesSizeP2; i++) { 
+       v2s inF_temp = ((v2s*)inFeatures)[i];
+       ra = ra + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i]);
+       rb = rb + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1)) + i]);
+               // rc = rc + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2)) + i]);
+               // rd = rd + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3)) + i]);
+      } // }
+       // for(int i=0; i<inFeaturesSizeP2; i++)
+      outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+1)] = shiftAndEpilogue(rb, shift, epilogue);
+      // outFeatures[(o_tile*outFeaturesPerTile+2)] = rc>>(shift);
+      // outFeatures[(o_tile*outFeaturesPerTile+3)] = rd>>(shift);
+   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
+   case 1: // HOWTO duplicate and comment out not needed lines
+   for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
+    int32_t register_attribute ra;
+    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(shift);
 
+    for(int i=0; i<inFeaturesSizeP2; i++) chess_loop_range(1,) { 
 
-    PROFILING_LINEAR_END
-  }
-// new implementation for output FM tiling and input FM tiling without VLIW!
-#elif defined FMOUTTILING && !defined(ASIP) && defined MANUALLOOPUNFOLDING && !defined VLIWEXT 
+     v2s inF_temp = ((v2s*)inFeatures)[i];
+     ra = ra + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i]);
+   } 
+   outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
+   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
+   break;
+
+}// switch outFeaturesPerTile
+
+
+}
+
+ ///////////////////////////////////////////////////////////////////////////////////////////////
+ // ______  _______ _______ _______ _     _        _______      _____ _______  _____          //
+ // |     \ |______ |______ |_____| |     | |         |           |   |  |  | |_____] |       //
+ // |_____/ |______ |       |     | |_____| |_____    |         __|__ |  |  | |       |_____  //
+ //                                                                                           //
+ ///////////////////////////////////////////////////////////////////////////////////////////////
+#else // any other case
 /** @brief Calculates a Fully-Connected (or Linear Layer) 
  *  
- *  Calculates a fully conntected Layer with the custom VLIW instructions for load and MAC
+ *  Calculates a fully conntected Layer (standard implementation)
  *  Supports the following configurations:
- *  INPUTFMTILING false/true with input tile size 2
- *  OUTPUTFMTILING false/true with output tile sizes 1,2,4,8,10,12,14 (odd are currently not
- *                 supported as the SPR would need to be switched)
- *  FixedPt and SIMD and MANUALLOOPUNFOLDING only
+ *  => (PULP-RISCY && !VLIWEXT || ASIP && !FMOUTTILING) && !FMINTILING
+ *  => FMOUTINILING false (no input FM tiling support as not needed)
+ *  => FMOUTTILING false/true with output tile sizes 1,2,4,8,10
+ *  => FixedPt, SIMD || FLOAT
+ *  => MANUALLOOPUNFOLDING not supported for non-SIMD
  *
  *  @param inFeaturesSize Number of input neurons
  *  @param outFeaturesSize Number of output neurons
@@ -861,784 +1154,25 @@ void NOINLINE LinearLayer (
  *  @param bias Pointer to bias
  *  @param inFeatures Input Feature Map
  *  @param outFeatures Output Feature Map
- */
-void NOINLINE LinearLayer (
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */void NOINLINE LinearLayer (
         // Layer Attributes
-  int inFeaturesSize, int outFeaturesSize,
-  short hasBias,
+int inFeaturesSize, int outFeaturesSize,
+short hasBias,
         // Layer Parameters
-  data_t * __restrict__ weight,
-  data_t * __restrict__ bias,
-        // Input and Output Features
-  data_t * __restrict__ inFeatures,
-        data_t * __restrict__ outFeatures) //property(functional)
-{
-  PROFILING_LINEAR_START
-  int inFeaturesSizeP2 = inFeaturesSize/2;
-  #ifdef FMINTILING
-  int inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-  #else
-  int inFeaturesSizeP4 = inFeaturesSizeP2;   // no input FM tiling
-  #endif
-
-  #if OUTPUTBUFFER > 8
-  int tileOptions[] = {OUTPUTBUFFER,8,4,2,1};
-  #elif OUTPUTBUFFER > 4
-  int tileOptions[] = {OUTPUTBUFFER,4,2,1};
-  #else
-  int tileOptions[] = {OUTPUTBUFFER,2,1};
-  #endif
-
-  data_t  * bias_ptr   = bias;
-  v2s     * weight_ptr = (v2s*)weight;
-  data_t  * outFeatures_ptr = outFeatures;
-  int outFeaturesPerTile = 1;
-
-  // register definition for manual loop unfolding
-  register_attribute int32_t   temp0, temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8, temp9, temp10, temp11, temp12, temp13, temp14;
-  register_attribute uint32_t  addr0, addr1, addr2, addr3, addr4, addr5, addr6, addr7, addr8, addr9, addr10, addr11, addr12, addr13, addr14;
-  register_attribute uint32_t  in_addr;
-
-  // register null
-  register int x0 asm("x0");
-
-  int outFeatureTiles;
-  int outFeaturesSize_remain = outFeaturesSize;
-
-  // Tile with largest tileOption
-  for(unsigned int i=0; i<sizeof(tileOptions)/sizeof(int); i++) {
-    outFeaturesPerTile = tileOptions[i];
-    outFeatureTiles = outFeaturesSize_remain/outFeaturesPerTile;
-    
-    if(outFeatureTiles == 0) continue;
-
-    // Select Tile Size
-    switch(outFeaturesPerTile) {
-     #if OUTPUTBUFFER > 2
-     case OUTPUTBUFFER:
-     for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-     {
-      // Manual loop unfolding
-      // Inititalize accumulation registers with bias and shift accordingly
-          #if OUTPUTBUFFER > 2
-      temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 3
-      temp1 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 4
-      temp2 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 5
-      temp3 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 6
-      temp4 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+4]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 7
-      temp5 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+5]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 8
-      temp6 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+6]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 9
-      temp7 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+7]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 10
-      temp8 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+8]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 11
-      temp9 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+9]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 12
-      temp10 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+10]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 13
-      temp11 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+11]<<(q_fraqP1);
-          #endif
-          #if OUTPUTBUFFER > 14
-      temp12 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+12]<<(q_fraqP1);
-          #endif
-      temp13 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+OUTPUTBUFFER-2]<<(q_fraqP1);
-      temp14 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+OUTPUTBUFFER-1]<<(q_fraqP1);
-
-      addr0  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 0))];
-      addr1  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 1))];
-      addr2  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 2))];
-      addr3  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 3))];
-      addr4  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 4))];
-      addr5  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 5))];
-      addr6  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 6))];
-      addr7  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 7))];
-      addr8  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 8))];
-      addr9  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 9))];
-      addr10 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+10))];
-      addr11 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+11))];
-      addr12 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+12))];
-      addr13 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+OUTPUTBUFFER-2))];
-      addr14 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+OUTPUTBUFFER-1))];
-
-          // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-          // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
-
-          in_addr = (uint32_t)(((v2s*)inFeatures));
-          for(int i=0; i<inFeaturesSizeP4; i++) {
-              v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-              v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
-
-
-              // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-  #ifdef FMINTILING
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-  #endif
-              // MANUAL loop unfolding
-               #if OUTPUTBUFFER > 2
-              SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 3
-              SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 4
-              SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 5
-              SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 6
-              SDOTP_GENERIC(temp4, ((v2s*)addr4)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 7
-              SDOTP_GENERIC(temp5, ((v2s*)addr5)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 9
-              SDOTP_GENERIC(temp6, ((v2s*)addr6)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 9
-              SDOTP_GENERIC(temp7, ((v2s*)addr7)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 10
-              SDOTP_GENERIC(temp8, ((v2s*)addr8)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 11
-              SDOTP_GENERIC(temp9, ((v2s*)addr9)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 12
-              SDOTP_GENERIC(temp10, ((v2s*)addr10)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 13
-              SDOTP_GENERIC(temp11, ((v2s*)addr11)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 14
-              SDOTP_GENERIC(temp12, ((v2s*)addr12)[i], inF_temp);
-               #endif
-              SDOTP_GENERIC(temp13, ((v2s*)addr13)[i],inF_temp);
-              SDOTP_GENERIC(temp14, ((v2s*)addr14)[i],inF_temp);
-// do it twice for FMINTILING
-  #ifdef FMINTILING
-                #if OUTPUTBUFFER > 2
-              SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 3
-              SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 4
-              SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 5
-              SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 6
-              SDOTP_GENERIC(temp4, ((v2s*)addr4)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 7
-              SDOTP_GENERIC(temp5, ((v2s*)addr5)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 9
-              SDOTP_GENERIC(temp6, ((v2s*)addr6)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 9
-              SDOTP_GENERIC(temp7, ((v2s*)addr7)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 10
-              SDOTP_GENERIC(temp8, ((v2s*)addr8)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 11
-              SDOTP_GENERIC(temp9, ((v2s*)addr9)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 12
-              SDOTP_GENERIC(temp10, ((v2s*)addr10)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 13
-              SDOTP_GENERIC(temp11, ((v2s*)addr11)[i], inF_temp2);
-               #endif
-               #if OUTPUTBUFFER > 14
-              SDOTP_GENERIC(temp12, ((v2s*)addr12)[i], inF_temp2);
-               #endif
-              SDOTP_GENERIC(temp13, ((v2s*)addr13)[i],inF_temp2);
-              SDOTP_GENERIC(temp14, ((v2s*)addr14)[i],inF_temp2);
-  #endif
-            // }
-            }
-  #ifdef FMINTILING
-          if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-               v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-               // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-               asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-               // asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-               
-               // MANUAL loop unfolding
-               // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-               // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-             #if OUTPUTBUFFER > 2
-              SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 3
-              SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 4
-              SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 5
-              SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 6
-              SDOTP_GENERIC(temp4, ((v2s*)addr4)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 7
-              SDOTP_GENERIC(temp5, ((v2s*)addr5)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 9
-              SDOTP_GENERIC(temp6, ((v2s*)addr6)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 9
-              SDOTP_GENERIC(temp7, ((v2s*)addr7)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 10
-              SDOTP_GENERIC(temp8, ((v2s*)addr8)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 11
-              SDOTP_GENERIC(temp9, ((v2s*)addr9)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 12
-              SDOTP_GENERIC(temp10, ((v2s*)addr10)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 13
-              SDOTP_GENERIC(temp11, ((v2s*)addr11)[i], inF_temp);
-               #endif
-               #if OUTPUTBUFFER > 14
-              SDOTP_GENERIC(temp12, ((v2s*)addr12)[i], inF_temp);
-               #endif
-              SDOTP_GENERIC(temp13, ((v2s*)addr13)[i],inF_temp);
-              SDOTP_GENERIC(temp14, ((v2s*)addr14)[i],inF_temp);
-             }
-
-  #endif
-
-// Store the final results back to the memory
-        // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-                #if OUTPUTBUFFER > 2
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 3
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = temp1>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 4
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 5
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 6
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+4)] = temp4>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 7
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+5)] = temp5>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 8
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+6)] = temp6>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 9
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+7)] = temp7>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 10
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+8)] = temp8>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 11
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+9)] = temp9>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 12
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+10)] = temp10>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 13
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+11)] = temp11>>(q_fraqP1);
-                #endif
-                #if OUTPUTBUFFER > 14
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+12)] = temp12>>(q_fraqP1);
-                #endif
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+OUTPUTBUFFER-2)] = temp13>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+OUTPUTBUFFER-1)] = temp14>>(q_fraqP1);
-                // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-        // }
-
-           }
-           break;
-     #endif
-     #if OUTPUTBUFFER > 8
-           case 8:
-           for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-           {
-
-            temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-            temp1 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-            temp2 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-            temp3 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-            temp4 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+4]<<(q_fraqP1);
-            temp5 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+5]<<(q_fraqP1);
-            temp6 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+6]<<(q_fraqP1);
-            temp7 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+7]<<(q_fraqP1);
-
-          // }
-          // printf("wght=%i, addr before=%i (+%i)=%i\n", weight, addr0, inFeaturesSizeP2*outFeaturesPerTile, addr0+4*inFeaturesSizeP2*outFeaturesPerTile);
-            addr0 = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-            addr1 = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-            addr2 = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-            addr3 = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-            addr4 = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+4))];
-            addr5 = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+5))];
-            addr6 = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+6))];
-            addr7 = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+7))];
-
-
-          // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-          // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload 2nd weight
-
-          in_addr = (((v2s*)inFeatures));
-          for(int i=0; i<inFeaturesSizeP4; i++) {
-              v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-              v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
-
-              // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-  #ifdef FMINTILING
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-  #endif
-              // MANUAL loop unfolding
-              // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-              // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-              SDOTP_GENERIC(temp0, ((v2s *)addr0)[i], inF_temp) ;
-              SDOTP_GENERIC(temp1, ((v2s *)addr1)[i], inF_temp) ;
-              SDOTP_GENERIC(temp2, ((v2s *)addr2)[i], inF_temp) ;
-              SDOTP_GENERIC(temp3, ((v2s *)addr3)[i], inF_temp) ;
-              SDOTP_GENERIC(temp4, ((v2s *)addr4)[i], inF_temp) ;
-              SDOTP_GENERIC(temp5, ((v2s *)addr5)[i], inF_temp) ;
-              SDOTP_GENERIC(temp6, ((v2s *)addr6)[i], inF_temp) ;
-              SDOTP_GENERIC(temp7, ((v2s *)addr7)[i], inF_temp) ;
-  #ifdef FMINTILING
-              SDOTP_GENERIC(temp0, ((v2s *)addr0)[i], inF_temp2);
-              SDOTP_GENERIC(temp1, ((v2s *)addr1)[i], inF_temp2);
-              SDOTP_GENERIC(temp2, ((v2s *)addr2)[i], inF_temp2);
-              SDOTP_GENERIC(temp3, ((v2s *)addr3)[i], inF_temp2);
-              SDOTP_GENERIC(temp4, ((v2s *)addr4)[i], inF_temp2);
-              SDOTP_GENERIC(temp5, ((v2s *)addr5)[i], inF_temp2);
-              SDOTP_GENERIC(temp6, ((v2s *)addr6)[i], inF_temp2);
-              SDOTP_GENERIC(temp7, ((v2s *)addr7)[i], inF_temp2);
-  #endif
-            // }
-            }
-  #ifdef FMINTILING
-          if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-               v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-               asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-              SDOTP_GENERIC(temp0, ((v2s *)addr0)[i], inF_temp) ;
-              SDOTP_GENERIC(temp1, ((v2s *)addr1)[i], inF_temp) ;
-              SDOTP_GENERIC(temp2, ((v2s *)addr2)[i], inF_temp) ;
-              SDOTP_GENERIC(temp3, ((v2s *)addr3)[i], inF_temp) ;
-              SDOTP_GENERIC(temp4, ((v2s *)addr4)[i], inF_temp) ;
-              SDOTP_GENERIC(temp5, ((v2s *)addr5)[i], inF_temp) ;
-              SDOTP_GENERIC(temp6, ((v2s *)addr6)[i], inF_temp) ;
-              SDOTP_GENERIC(temp7, ((v2s *)addr7)[i], inF_temp) ;
-  #endif
-        // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = temp1>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+4)] = temp4>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+5)] = temp5>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+6)] = temp6>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+7)] = temp7>>(q_fraqP1);
-        // }
-           }
-           break;
-     #endif
-     #if OUTPUTBUFFER > 4
-           case 4:
-           for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-           {
-
-            temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-            temp1 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-            temp2 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-            temp3 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-
-          // }
-            addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-            addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-            addr2 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-            addr3 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-
-
-          // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-          // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
-
-          in_addr = (uint32_t) (((v2s*)inFeatures));
-          for(int i=0; i<inFeaturesSizeP4; i++) {
-              v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-              v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
-
-
-              // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-  #ifdef FMINTILING
-              asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-  #endif
-              // MANUAL loop unfolding
-              // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-              // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-              SDOTP_GENERIC(temp0, ((v2s *)addr0)[i], inF_temp) ;
-              SDOTP_GENERIC(temp1, ((v2s *)addr1)[i], inF_temp) ;
-              SDOTP_GENERIC(temp2, ((v2s *)addr2)[i], inF_temp) ;
-              SDOTP_GENERIC(temp3, ((v2s *)addr3)[i], inF_temp) ;
-  #ifdef FMINTILING
-              SDOTP_GENERIC(temp0, ((v2s *)addr0)[i], inF_temp2);
-              SDOTP_GENERIC(temp1, ((v2s *)addr1)[i], inF_temp2);
-              SDOTP_GENERIC(temp2, ((v2s *)addr2)[i], inF_temp2);
-              SDOTP_GENERIC(temp3, ((v2s *)addr3)[i], inF_temp2);
-  #endif
-            // }
-            }
-  #ifdef FMINTILING
-          if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-               v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-               asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-              SDOTP_GENERIC(temp0, ((v2s *)addr0)[i], inF_temp) ;
-              SDOTP_GENERIC(temp1, ((v2s *)addr1)[i], inF_temp) ;
-              SDOTP_GENERIC(temp2, ((v2s *)addr2)[i], inF_temp) ;
-              SDOTP_GENERIC(temp3, ((v2s *)addr3)[i], inF_temp) ;
-
-             }
-  #endif
-        // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = temp1>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-             outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-               // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-        // }
-           }
-           break;
-     #endif
-           case 2:
-           for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-           {
-
-            temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-            temp1 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-          // temp2 = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-          // temp3 = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-          // }
-            addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-            addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-          // addr2 = &((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-          // addr3 = &((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-          // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload no compute
-          // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload no compute
-          for(int i=0; i<inFeaturesSizeP2; i++) {
-            v2s inF_temp = ((v2s*)inFeatures)[i];
-            
-            // int o_rel;
-            // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-              SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp) ;
-              SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp) ;
-               // asm volatile("pl.sdotsp.h %0, %1, %2" : "+r" (temp2) : "r" (addr3), "r" (inF_temp) );
-               // asm volatile("pl.sdotsp.h %0, %1, %2" : "+r" (temp3) : "r" (addr0), "r" (inF_temp) );
-            // }
-          }
-        // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-          outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-          outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = temp1>>(q_fraqP1);
-                // outFeatures[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-                // outFeatures[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-                // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-        // }
-
-        }
-        break;
-        case 1:
-        for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-        {
-          temp0 = (int32_t)bias_ptr[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-          for(int i=0; i<inFeaturesSizeP2; i++) {
-            v2s inF_temp = ((v2s*)inFeatures)[i];
-            SDOTP_GENERIC(temp0, ((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile)) + i], inF_temp) ;
-          }
-          outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = temp0>>(q_fraqP1);
-        }
-        break;
-      }
-
-  // move pointers for next iteration
-      bias_ptr                = &bias_ptr[outFeatureTiles*outFeaturesPerTile];
-      weight_ptr              = &((v2s*)weight_ptr)[(inFeaturesSizeP2*(outFeatureTiles*outFeaturesPerTile))];
-      outFeatures_ptr         = &outFeatures_ptr[(outFeatureTiles*outFeaturesPerTile)];
-      outFeaturesSize_remain -= outFeatureTiles*outFeaturesPerTile;
-      if (outFeaturesSize_remain==0) break;
-    }
-
-
-    PROFILING_LINEAR_END
-  }
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// _______ _______ _____  _____       _  _  _ _____ _______ _     _      _______ _______       _____  _     _ _______      _______ _____        _____ __   _  ///
-// |_____| |______   |   |_____]      |  |  |   |      |    |_____|      |______ |  |  |      |     | |     |    |            |      |   |        |   | \  |  ///
-// |     | ______| __|__ |            |__|__| __|__    |    |     |      |       |  |  |      |_____| |_____|    |            |    __|__ |_____ __|__ |  \_|  ///
-//                                                                                                                                                            ///
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-#elif defined ASIP && defined FMOUTTILING // LinearLayer Implementation for the ASIP tool and 
-/** @brief Calculates a Fully-Connected (or Linear Layer) 
- *  
- *  Calculates a fully conntected Layer with for the ASIP designer (extended tzscale)
- *  Supports the following configurations:
- *  INPUTFMTILING false (no input FM tiling support as not needed)
- *  OUTPUTFMTILING false/true with output tile sizes 1,2,4,8,10
- *  MANUALLOOPUNFOLDING false/true
- *  FixedPt and SIMD and  only
- *
- *  @param inFeaturesSize Number of input neurons
- *  @param outFeaturesSize Number of output neurons
- *  @param hasBias FC with bias or not?
- *  @param weight Pointer to weights
- *  @param bias Pointer to bias
- *  @param inFeatures Input Feature Map
- *  @param outFeatures Output Feature Map
- */
-  void NOINLINE LinearLayer (
-        // Layer Attributes
-    int inFeaturesSize, int outFeaturesSize,
-    short hasBias,
-        // Layer Parameters
-    data_t * __restrict__ weight,
-    data_t * __restrict__ bias,
-        // Input and Output Features
-    data_t * __restrict__ inFeatures,
-        data_t * __restrict__ outFeatures) //property(functional)
-  {
-    PROFILING_LINEAR_START
-
-    int inFeaturesSizeP2 = inFeaturesSize/2;
-
-//  _  __    _                                                               _   
-// / | \ \  | | ___   ___  _ __     _____   _____ _ __    ___     ___  _   _| |_ 
-// | |  | | | |/ _ \ / _ \| '_ \   / _ \ \ / / _ \ '__|  / __|   / _ \| | | | __|
-// | |  | | | | (_) | (_) | |_) | | (_) \ V /  __/ |    | (__   | (_) | |_| | |_ 
-// |_|  | | |_|\___/ \___/| .__/   \___/ \_/ \___|_|     \___|__ \___/ \__,_|\__|
-//     /_/                |_|                                |__|              
-
-//----------------------------------------------------------------
-// 1a) Tile Output Channels
-//----------------------------------------------------------------
-
-    int tileOptions[] = {10,8,4,2, 1};
-    int outFeaturesPerTile = 1;
-    for(unsigned int i=0; i<sizeof(tileOptions)/sizeof(int); i++) {
-     if(outFeaturesSize % tileOptions[i] == 0) {
-      outFeaturesPerTile = tileOptions[i];
-      break;
-    }
-  }
-
-  int outFeatureTiles = outFeaturesSize/outFeaturesPerTile;
-
-
-  switch(outFeaturesPerTile) {
-   case 10:
-   for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
-    int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;
-    int32_t register_attribute ra2;int32_t register_attribute rb2;int32_t register_attribute rc2;int32_t register_attribute rd2;
-    int32_t register_attribute rc3;int32_t register_attribute rd3;
-    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-    rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-    rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-    rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-    ra2 = (int32_t)bias[o_tile*outFeaturesPerTile+4]<<(q_fraqP1);
-    rb2 = (int32_t)bias[o_tile*outFeaturesPerTile+5]<<(q_fraqP1);
-    rc2 = (int32_t)bias[o_tile*outFeaturesPerTile+6]<<(q_fraqP1);
-    rd2 = (int32_t)bias[o_tile*outFeaturesPerTile+7]<<(q_fraqP1);
-    rc3 = (int32_t)bias[o_tile*outFeaturesPerTile+8]<<(q_fraqP1);
-    rd3 = (int32_t)bias[o_tile*outFeaturesPerTile+9]<<(q_fraqP1);
-
-
-    for(int i=0; i<inFeaturesSizeP2; i++) { 
-     v2s inF_temp = ((v2s*)inFeatures)[i];                                                          
-
-               ra=ext_dotp_(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i], ra); // lwinc x23, 0(x20)
-               rb = rb + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1)) + i]);      // lwinc x25, 0(x11); sdotp x7, x23, x25 
-               rc = rc + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2)) + i]);      // lwinc x24, 0(x11); sdotp x7, x23, x24 
-               rd = rd + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3)) + i]);      // lwinc xA, 0(xB); sdotp xC, x23, xB
-               ra2 = ra2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+4)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
-               rb2 = rb2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+5)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
-               rc2 = rc2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+6)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
-               rd2 = rd2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+7)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
-               rc3 = rc3 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+8)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
-               rd3 = rd3 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+9)) + i]);    // lwinc xA, 0(xB); sdotp xC, x23, xB
-             }
-             outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1);
-             outFeatures[(o_tile*outFeaturesPerTile+1)] = rb>>(q_fraqP1);
-             outFeatures[(o_tile*outFeaturesPerTile+2)] = rc>>(q_fraqP1);
-             outFeatures[(o_tile*outFeaturesPerTile+3)] = rd>>(q_fraqP1);
-             outFeatures[(o_tile*outFeaturesPerTile+4)] = ra2>>(q_fraqP1);
-             outFeatures[(o_tile*outFeaturesPerTile+5)] = rb2>>(q_fraqP1);
-             outFeatures[(o_tile*outFeaturesPerTile+6)] = rc2>>(q_fraqP1);
-             outFeatures[(o_tile*outFeaturesPerTile+7)] = rd2>>(q_fraqP1);
-             outFeatures[(o_tile*outFeaturesPerTile+8)] = rc3>>(q_fraqP1);
-             outFeatures[(o_tile*outFeaturesPerTile+9)] = rd3>>(q_fraqP1);
-
-
-   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
-   break;
-
-   case 8:
-   for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
-    int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;
-    int32_t register_attribute ra2;int32_t register_attribute rb2;int32_t register_attribute rc2;int32_t register_attribute rd2;
-    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-    rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-    rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-    rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-    ra2 = (int32_t)bias[o_tile*outFeaturesPerTile+4]<<(q_fraqP1);
-    rb2 = (int32_t)bias[o_tile*outFeaturesPerTile+5]<<(q_fraqP1);
-    rc2 = (int32_t)bias[o_tile*outFeaturesPerTile+6]<<(q_fraqP1);
-    rd2 = (int32_t)bias[o_tile*outFeaturesPerTile+7]<<(q_fraqP1);
-    for(int i=0; i<inFeaturesSizeP2; i++) { 
-     v2s inF_temp = ((v2s*)inFeatures)[i];
-     ra = ra + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i]);
-     rb = rb + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1)) + i]);
-     rc = rc + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2)) + i]);
-     rd = rd + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3)) + i]);
-     ra2 = ra2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+4)) + i]);
-     rb2 = rb2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+5)) + i]);
-     rc2 = rc2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+6)) + i]);
-     rd2 = rd2 + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+7)) + i]);
-      } // for(int i=0; i<inFeaturesSizeP2; i++)
-      outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+1)] = rb>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+2)] = rc>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+3)] = rd>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+4)] = ra2>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+5)] = rb2>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+6)] = rc2>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+7)] = rd2>>(q_fraqP1);
-   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
-   break;
-   case 4:
-   for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
-    int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;
-    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-    rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-    rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-    rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-    for(int i=0; i<inFeaturesSizeP2; i++) { 
-     v2s inF_temp = ((v2s*)inFeatures)[i];
-     ra = ra + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i]);
-     rb = rb + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1)) + i]);
-     rc = rc + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2)) + i]);
-     rd = rd + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3)) + i]);
-      } // for(int i=0; i<inFeaturesSizeP2; i++)
-      outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+1)] = rb>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+2)] = rc>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+3)] = rd>>(q_fraqP1);
-   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
-   break;
- case 2: // HOWTO duplicate and comment out not needed lines
- for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
-      int32_t register_attribute ra;int32_t register_attribute rb;//int32_t register_attribute rc;int32_t register_attribute rd;
-      ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-      rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
-      // rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-      // rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-      for(int i=0; i<inFeaturesSizeP2; i++) { 
-       v2s inF_temp = ((v2s*)inFeatures)[i];
-       ra = ra + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i]);
-       rb = rb + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1)) + i]);
-               // rc = rc + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2)) + i]);
-               // rd = rd + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3)) + i]);
-      } // }
-       // for(int i=0; i<inFeaturesSizeP2; i++)
-      outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+1)] = rb>>(q_fraqP1);
-      // outFeatures[(o_tile*outFeaturesPerTile+2)] = rc>>(q_fraqP1);
-      // outFeatures[(o_tile*outFeaturesPerTile+3)] = rd>>(q_fraqP1);
-   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
-   case 1: // HOWTO duplicate and comment out not needed lines
-   for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
-    int32_t register_attribute ra;
-    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
-
-    for(int i=0; i<inFeaturesSizeP2; i++) chess_loop_range(1,) { 
-
-     v2s inF_temp = ((v2s*)inFeatures)[i];
-     ra = ra + (inF_temp * ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0)) + i]);
-   } 
-   outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1);
-   } // for (int o_tile=0; o_tile< outFeatureTiles; o_tile++)
-   break;
-
-}// switch outFeaturesPerTile
-
-
-}
-
- ///////////////////////////////////////////////////////////////////////////////////////////////
- // ______  _______ _______ _______ _     _        _______      _____ _______  _____          //
- // |     \ |______ |______ |_____| |     | |         |           |   |  |  | |_____] |       //
- // |_____/ |______ |       |     | |_____| |_____    |         __|__ |  |  | |       |_____  //
- //                                                                                           //
- ///////////////////////////////////////////////////////////////////////////////////////////////
-#else // any other case
-/** @brief Calculates a Fully-Connected (or Linear Layer) 
- *  
- *  Calculates a fully conntected Layer (standard implementation)
- *  Supports the following configurations:
- *  => (PULP-RISCY && !VLIWEXT || ASIP && !FMOUTTILING) && !FMINTILING
- *  => FMOUTINILING false (no input FM tiling support as not needed)
- *  => FMOUTTILING false/true with output tile sizes 1,2,4,8,10
- *  => FixedPt, SIMD || FLOAT
- *  => MANUALLOOPUNFOLDING not supported for non-SIMD
- *
- *  @param inFeaturesSize Number of input neurons
- *  @param outFeaturesSize Number of output neurons
- *  @param hasBias FC with bias or not?
- *  @param weight Pointer to weights
- *  @param bias Pointer to bias
- *  @param inFeatures Input Feature Map
- *  @param outFeatures Output Feature Map
- */void NOINLINE LinearLayer (
-        // Layer Attributes
-int inFeaturesSize, int outFeaturesSize,
-short hasBias,
-        // Layer Parameters
-data_t * __restrict__ weight,
-data_t * __restrict__ bias,
+data_t * __restrict__ weight,
+data_t * __restrict__ bias,
         // Input and Output Features
 data_t * __restrict__ inFeatures,
-        data_t * __restrict__ outFeatures) //property(functional)
+        data_t * __restrict__ outFeatures, //property(functional)
+        int shift,
+        struct epilogue epilogue,
+        struct tiling tiling)
  {
   PROFILING_LINEAR_START
+  (void)tiling; // output FM tiles of OUTPUTBUFFER neurons
 
 
 // TODO: currently it is not supporte to halve odd number of feature map size with SIMD
@@ -1691,54 +1225,54 @@ data_t * __restrict__ inFeatures,
 // manual loop unfolding to full utilize the registers
 #ifdef MANUALLOOPUNFOLDING
     register int32_t ra,rb,rc,rd,re,rf,rg,rh, ri, rj, rk,rl, rm,rn,ro;
-    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(q_fraqP1);
+    ra = (int32_t)bias[o_tile*outFeaturesPerTile+0]<<(shift);
 # if OUTPUTBUFFER>1
-    rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(q_fraqP1);
+    rb = (int32_t)bias[o_tile*outFeaturesPerTile+1]<<(shift);
 # endif
 # if OUTPUTBUFFER>2
-    rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
+    rc = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(shift);
 # endif
 # if OUTPUTBUFFER>3
-    rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
+    rd = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(shift);
 # endif
 # if OUTPUTBUFFER>4
-    re = (int32_t)bias[o_tile*outFeaturesPerTile+4]<<(q_fraqP1);
+    re = (int32_t)bias[o_tile*outFeaturesPerTile+4]<<(shift);
 # endif
 # if OUTPUTBUFFER>5
-    rf = (int32_t)bias[o_tile*outFeaturesPerTile+5]<<(q_fraqP1);
+    rf = (int32_t)bias[o_tile*outFeaturesPerTile+5]<<(shift);
 # endif
 # if OUTPUTBUFFER>6
-    rg = (int32_t)bias[o_tile*outFeaturesPerTile+6]<<(q_fraqP1);
+    rg = (int32_t)bias[o_tile*outFeaturesPerTile+6]<<(shift);
 # endif
 # if OUTPUTBUFFER>7
-    rh = (int32_t)bias[o_tile*outFeaturesPerTile+7]<<(q_fraqP1);
+    rh = (int32_t)bias[o_tile*outFeaturesPerTile+7]<<(shift);
 # endif
 # if OUTPUTBUFFER>8
-    ri = (int32_t)bias[o_tile*outFeaturesPerTile+8]<<(q_fraqP1);
+    ri = (int32_t)bias[o_tile*outFeaturesPerTile+8]<<(shift);
 # endif
 # if OUTPUTBUFFER>9
-    rj = (int32_t)bias[o_tile*outFeaturesPerTile+9]<<(q_fraqP1);
+    rj = (int32_t)bias[o_tile*outFeaturesPerTile+9]<<(shift);
 # endif
 # if OUTPUTBUFFER>10
-    rk = (int32_t)bias[o_tile*outFeaturesPerTile+10]<<(q_fraqP1);
+    rk = (int32_t)bias[o_tile*outFeaturesPerTile+10]<<(shift);
 # endif
 # if OUTPUTBUFFER>11
-    rl = (int32_t)bias[o_tile*outFeaturesPerTile+11]<<(q_fraqP1);
+    rl = (int32_t)bias[o_tile*outFeaturesPerTile+11]<<(shift);
 # endif
 # if OUTPUTBUFFER>12
-    rm = (int32_t)bias[o_tile*outFeaturesPerTile+12]<<(q_fraqP1);
+    rm = (int32_t)bias[o_tile*outFeaturesPerTile+12]<<(shift);
 # endif
 # if OUTPUTBUFFER>13
-    rn = (int32_t)bias[o_tile*outFeaturesPerTile+13]<<(q_fraqP1);
+    rn = (int32_t)bias[o_tile*outFeaturesPerTile+13]<<(shift);
 # endif
 # if OUTPUTBUFFER>14
-    ro = (int32_t)bias[o_tile*outFeaturesPerTile+14]<<(q_fraqP1);
+    ro = (int32_t)bias[o_tile*outFeaturesPerTile+14]<<(shift);
 # endif
 
 #else 
     int32_t  temp[OUTPUTBUFFER];
     for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-      temp[o_rel] = (int32_t)bias[o_tile*outFeaturesPerTile+o_rel]<<(q_fraqP1);
+      temp[o_rel] = (int32_t)bias[o_tile*outFeaturesPerTile+o_rel]<<(shift);
     }
 #endif
 
@@ -1882,54 +1416,54 @@ for (int o_rel=0; o_rel < outFeaturesPerTile; o_rel++) { // chess_loop_count(4)
 #if !defined MANUALLOOPUNFOLDING || !defined FixedPt
 for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
 # ifdef FixedPt
-  outFeatures[(o_tile*outFeaturesPerTile+o_rel)] = temp[o_rel]>>(q_fraqP1);
+  outFeatures[(o_tile*outFeaturesPerTile+o_rel)] = shiftAndEpilogue(temp[o_rel], shift, epilogue);
 # else
   outFeatures[(o_tile*outFeaturesPerTile+o_rel)] = temp[o_rel];
 #endif
 }
 #else
-outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
 #       if OUTPUTBUFFER>1
-outFeatures[(o_tile*outFeaturesPerTile+1)] = rb>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+1)] = shiftAndEpilogue(rb, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>2
-outFeatures[(o_tile*outFeaturesPerTile+2)] = rc>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+2)] = shiftAndEpilogue(rc, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>3
-outFeatures[(o_tile*outFeaturesPerTile+3)] = rd>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+3)] = shiftAndEpilogue(rd, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>4
-outFeatures[(o_tile*outFeaturesPerTile+4)] = re>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+4)] = shiftAndEpilogue(re, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>5
-outFeatures[(o_tile*outFeaturesPerTile+5)] = rf>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+5)] = shiftAndEpilogue(rf, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>6
-outFeatures[(o_tile*outFeaturesPerTile+6)] = rg>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+6)] = shiftAndEpilogue(rg, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>7
-outFeatures[(o_tile*outFeaturesPerTile+7)] = rh>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+7)] = shiftAndEpilogue(rh, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>8
-outFeatures[(o_tile*outFeaturesPerTile+8)] = ri>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+8)] = shiftAndEpilogue(ri, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>9
-outFeatures[(o_tile*outFeaturesPerTile+9)] = rj>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+9)] = shiftAndEpilogue(rj, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>10
-outFeatures[(o_tile*outFeaturesPerTile+10)] = rk>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+10)] = shiftAndEpilogue(rk, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>11
-outFeatures[(o_tile*outFeaturesPerTile+11)] = rl>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+11)] = shiftAndEpilogue(rl, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>12
-outFeatures[(o_tile*outFeaturesPerTile+12)] = rm>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+12)] = shiftAndEpilogue(rm, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>13
-outFeatures[(o_tile*outFeaturesPerTile+13)] = rn>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+13)] = shiftAndEpilogue(rn, shift, epilogue);
 #       endif
 #       if OUTPUTBUFFER>14
-outFeatures[(o_tile*outFeaturesPerTile+14)] = ro>>(q_fraqP1);
+outFeatures[(o_tile*outFeaturesPerTile+14)] = shiftAndEpilogue(ro, shift, epilogue);
 #       endif
 
 #endif
@@ -1942,505 +1476,1122 @@ PROFILING_LINEAR_END
 }
 #endif
 
+#if !defined ASIP && defined FixedPt && defined SIMD && defined FMOUTTILING && !defined HOST_SIMD
+/// LinearLayerSeq reads the weights once per tile of time steps
+#define LINEAR_SEQTILES
+TILE_KERNEL_FAMILY(LINEAR_SEQ_TILE_KERNEL)
+/// LinearLayerSeq kernels of all the tile sizes (index: time steps per tile)
+static void (* const linearLayerSeqTiles[TILE_MAXSIZE+1])(int, int, int, data_t *, data_t *, data_t *, data_t *,
+  int32_t *, int, struct epilogue, int) = TILE_KERNEL_TABLE(LinearLayerSeqTile);
 
+/** @brief Linear Layer for all the time steps of a sequence with the weight stationary kernels
+ *
+ *  The output FM tile size of the tiling is used as number of time steps per tile.
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param outFeaturesSize Number of output neurons
+ *  @param seqSize Number of time steps
+ *  @param weight Pointer to weights
+ *  @param bias Pointer to bias (NULL: no bias)
+ *  @param inFeatures Input Feature Map [seqSize x inFeaturesSize]
+ *  @param outFeatures Output Feature Map [seqSize x outFeaturesSize] (if outAcc is NULL)
+ *  @param outAcc Accumulators without shift [seqSize x outFeaturesSize] or NULL
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+static void LinearLayerSeqTiled(int inFeaturesSize, int outFeaturesSize, int seqSize,
+  data_t * __restrict__ weight, data_t * __restrict__ bias, data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures, int32_t * __restrict__ outAcc, int shift, struct epilogue epilogue, struct tiling tiling)
+{
+  int inTiling = tilingInTiling(tiling);
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(tiling), tileOptions);
+  int seqRemain = seqSize;
+  for(int i=0; i<numTileOptions && seqRemain>0; i++) {
+    int seqPerTile = tileOptions[i];
+    int seqTiles = seqRemain/seqPerTile;
+    if(seqTiles == 0) continue;
+    int seq = seqSize-seqRemain;
+    linearLayerSeqTiles[seqPerTile](seqTiles, inFeaturesSize, outFeaturesSize, weight, bias, &inFeatures[seq*inFeaturesSize],
+      outAcc ? NULL : &outFeatures[seq*outFeaturesSize], outAcc ? &outAcc[seq*outFeaturesSize] : NULL, shift, epilogue, inTiling);
+    seqRemain -= seqTiles*seqPerTile;
+  }
+}
+#endif
+
+/** @brief Calculates a Linear Layer for all the time steps of a sequence, i.e. a matrix-matrix
+ *  product with the inputs of all the time steps
+ *
+ *  With the tiled kernels (LINEAR_SEQTILES) the weights are read once per tile of time steps
+ *  (weight stationary), otherwise LinearLayer is called for every time step.
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param outFeaturesSize Number of output neurons
+ *  @param seqSize Number of time steps
+ *  @param hasBias FC with bias or not?
+ *  @param weight Pointer to weights
+ *  @param bias Pointer to bias
+ *  @param inFeatures Input Feature Map [seqSize x inFeaturesSize]
+ *  @param outFeatures Output Feature Map [seqSize x outFeaturesSize]
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+void NOINLINE LinearLayerSeq (
+  int inFeaturesSize, int outFeaturesSize, int seqSize,
+  short hasBias,
+  data_t * __restrict__ weight,
+  data_t * __restrict__ bias,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct epilogue epilogue,
+  struct tiling tiling)
+{
+#ifdef LINEAR_SEQTILES
+  if(seqSize > 1) {
+    PROFILING_LINEAR_START
+    LinearLayerSeqTiled(inFeaturesSize, outFeaturesSize, seqSize, weight, hasBias ? bias : NULL, inFeatures, outFeatures, NULL,
+      shift, epilogue, tiling);
+    PROFILING_LINEAR_END
+    return;
+  }
+#endif
+  for(int seq=0; seq<seqSize; seq++)
+    LinearLayer(inFeaturesSize, outFeaturesSize, hasBias, weight, bias,
+      &inFeatures[seq*inFeaturesSize], &outFeatures[seq*outFeaturesSize], shift, epilogue, tiling);
+}
+
+/// Weights of the output neurons from row on (same row pitch as the kernels)
+#ifdef SIMD
+#define WEIGHT_ROWS(weight, row, inSize) ((data_t*)&((v2s*)(weight))[((inSize)/2)*(row)])
+#define WEIGHT_ROW_SIZE(inSize) (2*((inSize)/2))
+#else
+#define WEIGHT_ROWS(weight, row, inSize) (&(weight)[(inSize)*(row)])
+#define WEIGHT_ROW_SIZE(inSize) (inSize)
+#endif
 
 /////////////////////////////////////////////////////////////////////////////////////////////
+// Multi-core: the output neurons (or time steps) of a layer split across NUM_CORES cores
 /////////////////////////////////////////////////////////////////////////////////////////////
-/////   ____                 ____     _ _                           /////////////////////////
-/////  / ___|___  _ ____   _|___ \ __| | |    __ _ _   _  ___ _ __  /////////////////////////
-///// | |   / _ \| '_ \ \ / / __) / _` | |   / _` | | | |/ _ \ '__| /////////////////////////
-///// | |__| (_) | | | \ V / / __/ (_| | |__| (_| | |_| |  __/ |    /////////////////////////
-/////  \____\___/|_| |_|\_/ |_____\__,_|_____\__,_|\__, |\___|_|    /////////////////////////
-/////                                              |___/            /////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined NUM_CORES || (defined WEIGHT_STREAM && !defined ASIP)
+/// Arguments of the layer which is currently computed by all the cores
+struct parallelJob {
+  int inSize1, inSize2, outSize, rows;
+  short hasBias;
+  data_t * weight1, * weight2, * bias1, * bias2;
+  int32_t * scale1, * scale2;
+  data_t * in1, * in2, * out;
+  int32_t * acc;
+  data_t * state;
+  struct layer lay;
+  int shift;
+  struct epilogue epilogue;
+  struct tiling tiling;
+};
+/// Only one layer is computed at a time, in L2 to be accessible by the cluster
+RT_L2_DATA static struct parallelJob parallelJob;
+#endif
+
+#ifdef NUM_CORES
+
+/// Task of a Linear layer: output neurons of a single time step, otherwise time steps
+static void parallelLinear(void * arg, int first, int count)
+{
+  struct parallelJob * job = (struct parallelJob *)arg;
+  if(job->rows == 1)
+    LinearLayer(job->inSize1, count, job->hasBias, WEIGHT_ROWS(job->weight1, first, job->inSize1), &job->bias1[first],
+      job->in1, &job->out[first], job->shift, job->epilogue, job->tiling);
+  else
+    LinearLayerSeq(job->inSize1, job->outSize, count, job->hasBias, job->weight1, job->bias1,
+      &job->in1[first*job->inSize1], &job->out[first*job->outSize], job->shift, job->epilogue, job->tiling);
+}
+
+/// Task of TwoLinearLayersAccumulate: output neurons
+static void parallelTwoLinear(void * arg, int first, int count)
+{
+  struct parallelJob * job = (struct parallelJob *)arg;
+  TwoLinearLayersAccumulate(job->inSize1, job->inSize2, count, job->epilogue,
+    WEIGHT_ROWS(job->weight1, first, job->inSize1), WEIGHT_ROWS(job->weight2, first, job->inSize2),
+    &job->bias1[first], &job->bias2[first], job->in1, job->in2, &job->out[first], job->shift, job->tiling);
+}
+
+/// Task of a Linear layer with int8 weights: output neurons of a single time step, otherwise time steps
+static void parallelLinearInt8(void * arg, int first, int count)
+{
+  struct parallelJob * job = (struct parallelJob *)arg;
+  int8_t * weight = (int8_t *)job->weight1;
+  if(job->rows == 1)
+    LinearLayerInt8(job->inSize1, count, job->hasBias, &weight[first*job->inSize1], &job->scale1[first], &job->bias1[first],
+      job->in1, &job->out[first], job->shift, job->epilogue, job->tiling);
+  else
+    for(int seq=first; seq<first+count; seq++)
+      LinearLayerInt8(job->inSize1, job->outSize, job->hasBias, weight, job->scale1, job->bias1,
+        &job->in1[seq*job->inSize1], &job->out[seq*job->outSize], job->shift, job->epilogue, job->tiling);
+}
+
+/// Task of TwoLinearLayersAccumulateInt8: output neurons
+static void parallelTwoLinearInt8(void * arg, int first, int count)
+{
+  struct parallelJob * job = (struct parallelJob *)arg;
+  TwoLinearLayersAccumulateInt8(job->inSize1, job->inSize2, count, job->epilogue,
+    &((int8_t *)job->weight1)[first*job->inSize1], &((int8_t *)job->weight2)[first*job->inSize2],
+    &job->scale1[first], &job->scale2[first], &job->bias1[first], &job->bias2[first],
+    job->in1, job->in2, &job->out[first], job->shift, job->tiling);
+}
+
+/// Task of a Linear layer with packed int4 weights: output neurons of a single time step, otherwise time steps
+static void parallelLinearInt4(void * arg, int first, int count)
+{
+  struct parallelJob * job = (struct parallelJob *)arg;
+  uint8_t * weight = (uint8_t *)job->weight1;
+  if(job->rows == 1)
+    LinearLayerInt4(job->inSize1, count, job->hasBias, &weight[first*INT4_ROW_BYTES(job->inSize1)], &job->scale1[first], &job->bias1[first],
+      job->in1, &job->out[first], job->shift, job->epilogue, job->tiling);
+  else
+    for(int seq=first; seq<first+count; seq++)
+      LinearLayerInt4(job->inSize1, job->outSize, job->hasBias, weight, job->scale1, job->bias1,
+        &job->in1[seq*job->inSize1], &job->out[seq*job->outSize], job->shift, job->epilogue, job->tiling);
+}
+
+/// Task of TwoLinearLayersAccumulateInt4: output neurons
+static void parallelTwoLinearInt4(void * arg, int first, int count)
+{
+  struct parallelJob * job = (struct parallelJob *)arg;
+  TwoLinearLayersAccumulateInt4(job->inSize1, job->inSize2, count, job->epilogue,
+    &((uint8_t *)job->weight1)[first*INT4_ROW_BYTES(job->inSize1)], &((uint8_t *)job->weight2)[first*INT4_ROW_BYTES(job->inSize2)],
+    &job->scale1[first], &job->scale2[first], &job->bias1[first], &job->bias2[first],
+    job->in1, job->in2, &job->out[first], job->shift, job->tiling);
+}
+
+/// Task of a Conv2d layer (data_t or int8 weights): output channels
+static void parallelConv2d(void * arg, int first, int count)
+{
+  struct parallelJob * job = (struct parallelJob *)arg;
+  struct layer part = job->lay;
+  int kernelSize = part.attributes[LAY_CONV_KER];
+  int filterSize = kernelSize*kernelSize*part.attributes[LAY_CONV_IN];
+  part.attributes[LAY_CONV_OUT] = count;
+  part.parameters[CONV_BIAS] = &part.parameters[CONV_BIAS][first];
+  data_t * out = &job->out[first*part.attributes[LAY_CONV_H]*part.attributes[LAY_CONV_W]];
+  if(part.weightFormat == WEIGHT_INT8) {
+    part.parameters[CONV_WGHT]  = (data_t *)&((int8_t *)part.parameters[CONV_WGHT])[first*filterSize];
+    part.parameters[CONV_SCALE] = (data_t *)&((int32_t *)part.parameters[CONV_SCALE])[first];
+    Conv2dLayerInt8(&part, job->in1, out);
+    return;
+  }
+  part.parameters[CONV_WGHT] = WEIGHT_ROWS(part.parameters[CONV_WGHT], first, filterSize);
+  Conv2dLayer(&part, part.attributes[LAY_CONV_H], part.attributes[LAY_CONV_W], job->in1, out);
+}
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////////////////
+// Weight streaming: the weight rows of the next chunk of output neurons are transferred from L2
+// to L1 (cluster DMA) while all the cores compute the current chunk
 /////////////////////////////////////////////////////////////////////////////////////////////
-//         _____  _______ ______  _______ _______ _______      _    _        _____ _  _  _ //
-// |      |     | |_____| |     \ |  |  | |_____| |             \  /  |        |   |  |  | //
-// |_____ |_____| |     | |_____/ |  |  | |     | |_____         \/   |_____ __|__ |__|__| //
-//                                                                                         //
-/////////////////////////////////////////////////////////////////////////////////////////////                                                                                      
-#if defined(VLIWEXT) // RISCY implementation with the lw-sdopt-VLIW
-/** @brief Calculates a 2D Convolution Layer PULP+VLIW+(SIMD)
- *  input channels need to be multiple of 4 or 2 (with/without FMINTILING)
- *  Supporte configurations:
- *  > VLIWEXT 
- *  > SIMD only
- *  > FMIN and FMOUTILING
- *  > MANUALLOOPUNFOLDING true
+
+#if defined WEIGHT_STREAM && !defined ASIP
+#ifndef HOST
+#include "rt/rt_api.h"
+#endif
+/// Double buffer of the weight rows in L1
+RT_L1_DATA static data_t weightStreamBuffer[2][WEIGHT_STREAM_SIZE] __attribute__ ((aligned (4)));
+
+/// Starts the transfer of size weights from L2 to L1
+static inline void weightStreamFetch(data_t * dst, data_t * src, int size, rt_dma_copy_t * copy)
+{
+  rt_dma_memcpy((uintptr_t)src, (uintptr_t)dst, size*sizeof(data_t), RT_DMA_DIR_EXT2LOC, 0, copy);
+}
+
+/** @brief Output neurons per chunk of the streamed weights: whole output FM tiles which fit into
+ *  one buffer
+ *
+ *  @param rowSize Weights per output neuron (of both weight matrices of TwoLinearLayersAccumulate)
+ *  @param outFeaturesSize Number of output neurons
+ *  @param tiling Tiling of the layer (see struct tiling)
+ *  @return Output neurons per chunk, 0 if the layer is computed from L2 (its weights fit into one
+ *  buffer or a single tile does not)
+ */
+static int weightStreamRows(int rowSize, int outFeaturesSize, struct tiling tiling)
+{
+  if(outFeaturesSize*rowSize <= WEIGHT_STREAM_SIZE)
+    return 0;
+  return WEIGHT_STREAM_SIZE/rowSize/tilingOutTile(tiling)*tilingOutTile(tiling);
+}
+
+/// Starts the transfer of the weights of the chunk from output neuron first on into buffer buf
+static void weightStreamFetchChunk(struct parallelJob * job, int first, int buf, rt_dma_copy_t * copy)
+{
+  int count = Min(job->rows, job->outSize-first);
+  weightStreamFetch(weightStreamBuffer[buf], WEIGHT_ROWS(job->weight1, first, job->inSize1),
+    count*WEIGHT_ROW_SIZE(job->inSize1), &copy[0]);
+  if(job->weight2 != NULL)
+    weightStreamFetch(&weightStreamBuffer[buf][job->rows*WEIGHT_ROW_SIZE(job->inSize1)],
+      WEIGHT_ROWS(job->weight2, first, job->inSize2), count*WEIGHT_ROW_SIZE(job->inSize2), &copy[1]);
+}
+
+/** @brief Runs on every core: LinearLayer (or TwoLinearLayersAccumulate if job->weight2 is set)
+ *  with the weights streamed through the L1 double buffer
+ *
+ *  The output neurons are computed in chunks of job->rows neurons (see weightStreamRows), the rows
+ *  of both weight matrices of a chunk are stored in the same buffer (weight1 first). Core 0
+ *  transfers chunk k+1 while every core computes its output FM tiles of chunk k from L1. The
+ *  barrier per chunk makes sure that chunk k has arrived and that no core still reads the buffer
+ *  which is overwritten next.
+ */
+static void weightStreamWorker(void * arg, int core, int numCores)
+{
+  struct parallelJob * job = (struct parallelJob *)arg;
+  int rowSize1 = WEIGHT_ROW_SIZE(job->inSize1);
+  rt_dma_copy_t copy[2][2];
+  if(core == 0)
+    weightStreamFetchChunk(job, 0, 0, copy[0]);
+  for(int first=0, cur=0; first<job->outSize; first+=job->rows, cur^=1)
+  {
+    if(core == 0) {
+      rt_dma_wait(&copy[cur][0]);
+      if(job->weight2 != NULL)
+        rt_dma_wait(&copy[cur][1]);
+    }
+    parallelBarrier();
+    if(core == 0 && first+job->rows < job->outSize)
+      weightStreamFetchChunk(job, first+job->rows, cur^1, copy[cur^1]);
+    int part;
+    int count = parallelSplit(Min(job->rows, job->outSize-first), tilingOutTile(job->tiling), core, numCores, &part);
+    if(count == 0)
+      continue;
+    data_t * weight1 = WEIGHT_ROWS(weightStreamBuffer[cur], part, job->inSize1);
+    if(job->weight2 != NULL)
+      TwoLinearLayersAccumulate(job->inSize1, job->inSize2, count, job->epilogue,
+        weight1, WEIGHT_ROWS(&weightStreamBuffer[cur][job->rows*rowSize1], part, job->inSize2),
+        &job->bias1[first+part], &job->bias2[first+part], job->in1, job->in2, &job->out[first+part],
+        job->shift, job->tiling);
+    else
+      LinearLayer(job->inSize1, count, job->hasBias, weight1, &job->bias1[first+part],
+        job->in1, &job->out[first+part], job->shift, job->epilogue, job->tiling);
+  }
+}
+
+/** @brief LinearLayer (single time step) with the weights streamed through L1 on all the cores
+ *  (one PE without NUM_CORES), returns after all the cores are done
+ *
+ *  Same parameters as LinearLayer, rows: output neurons per chunk (see weightStreamRows).
+ */
+static void LinearLayerStreamed (
+  int inFeaturesSize, int outFeaturesSize,
+  short hasBias,
+  data_t * __restrict__ weight,
+  data_t * __restrict__ bias,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct epilogue epilogue,
+  struct tiling tiling,
+  int rows)
+{
+  struct parallelJob job = {0};
+  job.inSize1  = inFeaturesSize;
+  job.outSize  = outFeaturesSize;
+  job.rows     = rows;
+  job.hasBias  = hasBias;
+  job.weight1  = weight;
+  job.bias1    = bias;
+  job.in1      = inFeatures;
+  job.out      = outFeatures;
+  job.shift    = shift;
+  job.epilogue = epilogue;
+  job.tiling   = tiling;
+  parallelJob = job;
+  parallelRun(weightStreamWorker, &parallelJob);
+}
+
+/** @brief TwoLinearLayersAccumulate with the weights streamed through L1 on all the cores (one PE
+ *  without NUM_CORES), returns after all the cores are done
+ *
+ *  Same parameters as TwoLinearLayersAccumulate, rows: output neurons per chunk (see
+ *  weightStreamRows).
+ */
+static void TwoLinearLayersAccumulateStreamed (
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+  data_t * __restrict__ weight1,
+  data_t * __restrict__ weight2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling,
+  int rows)
+{
+  struct parallelJob job = {0};
+  job.inSize1  = inFeaturesSize1;
+  job.inSize2  = inFeaturesSize2;
+  job.outSize  = outFeaturesSize;
+  job.rows     = rows;
+  job.epilogue = epilogue;
+  job.weight1  = weight1;
+  job.weight2  = weight2;
+  job.bias1    = bias1;
+  job.bias2    = bias2;
+  job.in1      = inFeatures1;
+  job.in2      = inFeatures2;
+  job.out      = outFeatures;
+  job.shift    = shift;
+  job.tiling   = tiling;
+  parallelJob = job;
+  parallelRun(weightStreamWorker, &parallelJob);
+}
+#endif
+
+/** @brief LinearLayerSeq on NUM_CORES cores
+ *
+ *  A single time step is split into tasks of output FM tiles, sequences into tasks of time steps
+ *  (the weights are read by every task), which are scheduled with work stealing (parallelRunTasks).
+ *  Returns after all the cores are done. Without NUM_CORES, if the layer is not larger than one
+ *  tile or if the caller is already one of the cores (e.g. a pipeline stage) LinearLayerSeq is called.
+ *  With WEIGHT_STREAM a single time step whose weights do not fit into one L1 buffer streams them
+ *  through L1 on all the cores instead (LinearLayerStreamed).
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param outFeaturesSize Number of output neurons
+ *  @param seqSize Number of time steps
+ *  @param hasBias FC with bias or not?
+ *  @param weight Pointer to weights
+ *  @param bias Pointer to bias
+ *  @param inFeatures Input Feature Map [seqSize x inFeaturesSize]
+ *  @param outFeatures Output Feature Map [seqSize x outFeaturesSize]
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+void NOINLINE LinearLayerParallel (
+  int inFeaturesSize, int outFeaturesSize, int seqSize,
+  short hasBias,
+  data_t * __restrict__ weight,
+  data_t * __restrict__ bias,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct epilogue epilogue,
+  struct tiling tiling)
+{
+#if defined WEIGHT_STREAM && !defined ASIP
+  int rows = seqSize == 1 && !parallelInside() ? weightStreamRows(WEIGHT_ROW_SIZE(inFeaturesSize), outFeaturesSize, tiling) : 0;
+  if(rows > 0) {
+    LinearLayerStreamed(inFeaturesSize, outFeaturesSize, hasBias, weight, bias, inFeatures, outFeatures, shift, epilogue, tiling, rows);
+    return;
+  }
+#endif
+#ifdef NUM_CORES
+  if(!parallelInside() && (seqSize == 1 ? outFeaturesSize : seqSize) > tilingOutTile(tiling)) {
+    struct parallelJob job = {0};
+    job.inSize1  = inFeaturesSize;
+    job.outSize  = outFeaturesSize;
+    job.rows     = seqSize;
+    job.hasBias  = hasBias;
+    job.weight1  = weight;
+    job.bias1    = bias;
+    job.in1      = inFeatures;
+    job.out      = outFeatures;
+    job.shift    = shift;
+    job.epilogue = epilogue;
+    job.tiling   = tiling;
+    parallelJob = job;
+    parallelRunTasks(parallelLinear, &parallelJob, seqSize == 1 ? outFeaturesSize : seqSize, tilingOutTile(tiling));
+    return;
+  }
+#endif
+  LinearLayerSeq(inFeaturesSize, outFeaturesSize, seqSize, hasBias, weight, bias, inFeatures, outFeatures, shift, epilogue, tiling);
+}
+
+/** @brief TwoLinearLayersAccumulate on NUM_CORES cores (tasks of output FM tiles), returns after
+ *  all the cores are done
+ *
+ *  With WEIGHT_STREAM the weights which do not fit into one L1 buffer are streamed through L1 on
+ *  all the cores instead (TwoLinearLayersAccumulateStreamed).
+ *
+ *  Same parameters as TwoLinearLayersAccumulate.
+ */
+void NOINLINE TwoLinearLayersAccumulateParallel (
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+  data_t * __restrict__ weight1,
+  data_t * __restrict__ weight2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling)
+{
+#if defined WEIGHT_STREAM && !defined ASIP
+  int rows = !parallelInside() ? weightStreamRows(WEIGHT_ROW_SIZE(inFeaturesSize1)+WEIGHT_ROW_SIZE(inFeaturesSize2),
+    outFeaturesSize, tiling) : 0;
+  if(rows > 0) {
+    TwoLinearLayersAccumulateStreamed(inFeaturesSize1, inFeaturesSize2, outFeaturesSize, epilogue,
+      weight1, weight2, bias1, bias2, inFeatures1, inFeatures2, outFeatures, shift, tiling, rows);
+    return;
+  }
+#endif
+#ifdef NUM_CORES
+  if(!parallelInside() && outFeaturesSize > tilingOutTile(tiling)) {
+    struct parallelJob job = {0};
+    job.inSize1  = inFeaturesSize1;
+    job.inSize2  = inFeaturesSize2;
+    job.outSize  = outFeaturesSize;
+    job.epilogue = epilogue;
+    job.weight1  = weight1;
+    job.weight2  = weight2;
+    job.bias1    = bias1;
+    job.bias2    = bias2;
+    job.in1      = inFeatures1;
+    job.in2      = inFeatures2;
+    job.out      = outFeatures;
+    job.shift    = shift;
+    job.tiling   = tiling;
+    parallelJob = job;
+    parallelRunTasks(parallelTwoLinear, &parallelJob, outFeaturesSize, tilingOutTile(tiling));
+    return;
+  }
+#endif
+  TwoLinearLayersAccumulate(inFeaturesSize1, inFeaturesSize2, outFeaturesSize, epilogue,
+    weight1, weight2, bias1, bias2, inFeatures1, inFeatures2, outFeatures, shift, tiling);
+}
+
+/** @brief Conv2dLayer (or Conv2dLayerInt8 for int8 weights) on NUM_CORES cores (tasks of output
+ *  channel tiles), returns after all the cores are done
  *
  *  @param _layer Layer Properties
- *  @param h_im Image Height
- *  @param w_im Image Width
  *  @param inFeatures Input Feature Map
  *  @param outFeatures Output Feature Map
  */
-int NOINLINE Conv2dLayer (
+void NOINLINE Conv2dLayerParallel (
   struct layer * _layer,
-  int h_im,
-  int w_im,
   data_t * __restrict__ inFeatures,
-  data_t * __restrict__ outFeatures) {
-
-   #if OUTPUTBUFFER > 8
- int tileOptions[] = {OUTPUTBUFFER,8,4,2,1};
-   #elif OUTPUTBUFFER > 4
- int tileOptions[] = {OUTPUTBUFFER,4,2,1};
-   #elif OUTPUTBUFFER > 2
- int tileOptions[] = {OUTPUTBUFFER,2,1};
-   #elif OUTPUTBUFFER > 1
- int tileOptions[] = {2,1};
-   #else
- int tileOptions[] = {1};
-   #endif
- int outFeaturesPerTile = 1;
- int h_im_out = h_im;
- int w_im_out = w_im;
- int h_ker_half = (int)(_layer->attributes[LAY_CONV_KER]/2);
-   int w_ker_half = h_ker_half; // TODO: symmetric kernel only
-   data_t * bias_ptr   = _layer->parameters[CONV_BIAS];
-   v2s* param_simd = (v2s*) _layer->parameters[CONV_WGHT];
-   data_t  * outFeatures_ptr = outFeatures;
-
-   unsigned int output_channel_offset = _layer->attributes[LAY_CONV_KER]*_layer->attributes[LAY_CONV_KER]*_layer->attributes[LAY_CONV_IN]/2;
-   unsigned int kernel_H_offset = _layer->attributes[LAY_CONV_KER]*_layer->attributes[LAY_CONV_IN]/2;
-   unsigned int kernel_W_offset = _layer->attributes[LAY_CONV_IN]/2;
+  data_t * __restrict__ outFeatures)
+{
+#ifdef NUM_CORES
+  if(!parallelInside() && _layer->attributes[LAY_CONV_OUT] > tilingOutTile(_layer->tiling)) {
+    struct parallelJob job = {0};
+    job.lay    = *_layer;
+    job.in1    = inFeatures;
+    job.out    = outFeatures;
+    job.tiling = _layer->tiling;
+    parallelJob = job;
+    parallelRunTasks(parallelConv2d, &parallelJob, _layer->attributes[LAY_CONV_OUT], tilingOutTile(_layer->tiling));
+    return;
+  }
+#endif
+  if(_layer->weightFormat == WEIGHT_INT8)
+    Conv2dLayerInt8(_layer, inFeatures, outFeatures);
+  else
+    Conv2dLayer(_layer, _layer->attributes[LAY_CONV_H], _layer->attributes[LAY_CONV_W], inFeatures, outFeatures);
+}
 
-   int c_in_max;
-   c_in_max = _layer->attributes[LAY_CONV_IN];
-   #ifdef FMINTILING
-   c_in_max = _layer->attributes[LAY_CONV_IN]/4;
-   #else
-   c_in_max = _layer->attributes[LAY_CONV_IN]/2;
-   #endif
-   register int x0 asm("x0");
-   register int32_t temp, temp1, temp2, temp3, temp4, temp5, temp6, temp7;
-   register uint32_t  addr0, addr1, addr2, addr3, addr4, addr5, addr6, addr7;
-   // const int outFeaturesPerTile = 2;
-   unsigned int param_kh_base = 0;
-   int outFeatureTiles;
-   int outFeaturesSize_remain = _layer->attributes[LAY_CONV_OUT];
+#if !defined ASIP && defined SIMD && defined FMOUTTILING && !defined HOST_SIMD
+/// The layers with int8, int4 and 2:4 sparse weights are made of calls to the tile kernels of tileKernel.h (see LinearLayerInt8)
+#define PACKED_TILES
+static void (* const linearLayerInt8Tiles[TILE_MAXSIZE+1])(int, int, int, uint8_t *, int32_t *, data_t *, data_t *, data_t *,
+  int, struct epilogue);
+static void (* const linearLayerInt4Tiles[TILE_MAXSIZE+1])(int, int, int, uint8_t *, int32_t *, data_t *, data_t *, data_t *,
+  int, struct epilogue);
+#endif
 
-  // Tile with largest tileOption
-   for(unsigned int i=0; i<sizeof(tileOptions)/sizeof(int); i++) {
-    outFeaturesPerTile = tileOptions[i];
-    outFeatureTiles = outFeaturesSize_remain/outFeaturesPerTile;
-    
-    if(outFeatureTiles == 0) continue;
-    switch(outFeaturesPerTile) {
-     #if OUTPUTBUFFER > 2
-     case OUTPUTBUFFER:
-     for(int c_out = 0; c_out < outFeatureTiles; c_out++) {
-       for(int h_out =0; h_out < h_im_out; h_out++) 
-       {
-         for(int w_out=0;w_out<w_im_out; w_out++)
-         {
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Execution plan: the layers of a network compiled to a flat list of kernel calls
+/////////////////////////////////////////////////////////////////////////////////////////////
 
-           int kh_slide_start = Max(-h_out, -h_ker_half);                  // Handle borders
-           int kh_slide_stop = Min(h_im_out-1-h_out,h_ker_half);           // Handle borders
+/// Input FM of a step (the input of the network is only known when the plan is run)
+#define PLAN_STEP_IN(step, netIn) ((step)->in != NULL ? (step)->in : (netIn))
 
-            #if OUTPUTBUFFER > 2
-           temp = bias_ptr[outFeaturesPerTile*c_out] << q_fraqP1;
-            #endif
-            #if OUTPUTBUFFER > 3
-           temp1 = bias_ptr[outFeaturesPerTile*c_out+1] << q_fraqP1;
-            #endif
-            #if OUTPUTBUFFER > 4
-           temp2 = bias_ptr[outFeaturesPerTile*c_out+2] << q_fraqP1;
-            #endif
-            #if OUTPUTBUFFER > 5
-           temp3 = bias_ptr[outFeaturesPerTile*c_out+3] << q_fraqP1;
-            #endif
-            #if OUTPUTBUFFER > 6
-           temp4 = bias_ptr[outFeaturesPerTile*c_out+4] << q_fraqP1;
-            #endif
-            #if OUTPUTBUFFER > 7
-           temp5 = bias_ptr[outFeaturesPerTile*c_out+5] << q_fraqP1;
-            #endif
-           temp6 = bias_ptr[outFeaturesPerTile*c_out+OUTPUTBUFFER-2]<<(q_fraqP1);
-           temp7 = bias_ptr[outFeaturesPerTile*c_out+OUTPUTBUFFER-1]<<(q_fraqP1);
+#if defined LINEAR_TILES && !defined NUM_CORES && !defined WEIGHT_STREAM
+/** @brief Step: output FM tile of a Linear layer (one time step), calls the kernel of the tile size directly
+ */
+static void planStepLinearTile(struct planStep * step, data_t * netIn)
+{
+  PROFILING_LINEAR_START
+  step->tileKernel(step->tiles, step->inSize/2, step->weight, step->bias, PLAN_STEP_IN(step, netIn), step->out, step->shift, step->lay->epilogue, step->inTiling);
+  PROFILING_LINEAR_END
+}
+#endif
 
-           unsigned int param_kw_base = param_kh_base \
-           + (kh_slide_start+h_ker_half) * kernel_H_offset;
-           unsigned int feat_kw_base = (h_out+kh_slide_start)*w_im_out*_layer->attributes[LAY_CONV_IN]/2;
-           for(int kh=kh_slide_start; kh <= kh_slide_stop;kh++)
-           {
-              int kw_slide_start = Max(-w_out, -w_ker_half);           // Handle borders
-              int kw_slide_stop = Min(w_im_out-1-w_out,w_ker_half);           // Handle borders
-              
-              int param_id_base = param_kw_base \
-                                            +(kw_slide_start+w_ker_half)*kernel_W_offset; // filter tap
-                                            int param_id_base1 = param_id_base+output_channel_offset;
-                                            int feat_id_base  = feat_kw_base \
-                                            +(w_out+kw_slide_start)* _layer->attributes[LAY_CONV_IN]/2;
-                                            for(int kw=kw_slide_start; kw <= kw_slide_stop;kw++)
-                                            {
-                                             addr0  = (uint32_t) &((v2s*)param_simd)[param_id_base];
-                                             addr1  = (uint32_t) &((v2s*)param_simd)[param_id_base+1*output_channel_offset];
-                                             addr2  = (uint32_t) &((v2s*)param_simd)[param_id_base+2*output_channel_offset];
-                                             addr3  = (uint32_t) &((v2s*)param_simd)[param_id_base+3*output_channel_offset];
-                                             addr4  = (uint32_t) &((v2s*)param_simd)[param_id_base+4*output_channel_offset];
-                                             addr5  = (uint32_t) &((v2s*)param_simd)[param_id_base+5*output_channel_offset];
-                                             addr6  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*(OUTPUTBUFFER-2)];
-                                             addr7  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*(OUTPUTBUFFER-1)];
-
-                 asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-                 asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
-                 v2s* in_addr = &((v2s*)inFeatures)[feat_id_base];
-                 for(int i=0; i <  c_in_max;i++) // i=c_in
-                 {
-                  // loop unfolding
-                  // temp  = __SUMDOTP2(((v2s*)inFeatures)[feat_id_base + i], \
-                  //  param_simd[param_id_base + i], temp);
-                  // temp1 = __SUMDOTP2(((v2s*)inFeatures)[feat_id_base + i], \
-                  //  param_simd[param_id_base1 + i], temp1);
-                   // v2s inF_temp = ((v2s*)inFeatures)[feat_id_base + i];
-                   // temp  = __SUMDOTP2(inF_temp, \
-                   // param_simd[param_id_base + i], temp);
-                   // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp),  "+r" (addr0) : "r" (inF_temp) ); 
-                   // temp1 = __SUMDOTP2(inF_temp, \
-                   // param_simd[param_id_base1 + i], temp1);
-                   // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr1) : "r" (inF_temp) ); 
-                   // v2s inF_temp = ((v2s*)inFeatures)[feat_id_base + i];
-                 v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-                 v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
+#if defined PACKED_TILES && !defined NUM_CORES
+/** @brief Step: output FM tile of a Linear layer with int8 or int4 weights (one time step), calls the kernel of the tile size directly
+ */
+static void planStepLinearPackedTile(struct planStep * step, data_t * netIn)
+{
+  PROFILING_LINEAR_START
+  int rowBytes = step->lay->weightFormat == WEIGHT_INT4 ? INT4_ROW_BYTES(step->inSize) : step->inSize;
+  step->packedTileKernel(step->tiles, step->inSize, rowBytes, (uint8_t *)step->weight, step->scale, step->bias,
+    PLAN_STEP_IN(step, netIn), step->out, step->shift, step->lay->epilogue);
+  PROFILING_LINEAR_END
+}
+#endif
 
+/** @brief Step: Linear layer
+ */
+static void planStepLinear(struct planStep * step, data_t * netIn)
+{
+  LinearLayerParallel(step->inSize, step->outSize, step->rows, True, step->weight, step->bias,
+    PLAN_STEP_IN(step, netIn), step->out, step->shift, step->lay->epilogue, step->lay->tiling);
+}
 
-                 // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-                 asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-                 #ifdef FMINTILING
-                    asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-                 #endif
-                 #if OUTPUTBUFFER > 2
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp),  "+r" (addr2) : "r" (inF_temp) );
-                 #endif
-                 #if OUTPUTBUFFER > 3
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-                 #endif
-                 #if OUTPUTBUFFER > 4
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp) );
-                 #endif
-                 #if OUTPUTBUFFER > 5
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp) );
-                 #endif
-                 #if OUTPUTBUFFER > 6
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp) );
-                 #endif
-                 #if OUTPUTBUFFER > 7
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp) ); 
-                 #endif
-
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp) );
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp) );
-// do it twice for FMINTILING
-#ifdef FMINTILING
-                 #if OUTPUTBUFFER > 2
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp),  "+r" (addr2) : "r" (inF_temp2) );
-                 #endif
-                 #if OUTPUTBUFFER > 3
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp2) );
-                 #endif
-                 #if OUTPUTBUFFER > 4
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp2) );
-                 #endif
-                 #if OUTPUTBUFFER > 5
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp2) );
-                 #endif
-                 #if OUTPUTBUFFER > 6
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp2) );
-                 #endif
-                 #if OUTPUTBUFFER > 7
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp2) ); 
-                 #endif
-
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp2) );
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp2) );
+/** @brief Step: Linear layer with int8 weights
+ */
+static void planStepLinearInt8(struct planStep * step, data_t * netIn)
+{
+  LinearLayerInt8Parallel(step->inSize, step->outSize, step->rows, True, (int8_t *)step->weight, step->scale, step->bias,
+    PLAN_STEP_IN(step, netIn), step->out, step->shift, step->lay->epilogue, step->lay->tiling);
+}
 
+/** @brief Step: Linear layer with int4 weights
+ */
+static void planStepLinearInt4(struct planStep * step, data_t * netIn)
+{
+  LinearLayerInt4Parallel(step->inSize, step->outSize, step->rows, True, (uint8_t *)step->weight, step->scale, step->bias,
+    PLAN_STEP_IN(step, netIn), step->out, step->shift, step->lay->epilogue, step->lay->tiling);
+}
 
-#endif
-                  }
-              param_id_base  += kernel_W_offset; // filter tap
-              param_id_base1 += kernel_W_offset; // filter tap
-              feat_id_base   +=  _layer->attributes[LAY_CONV_IN]/2;
-            }
+/** @brief Step: LSTM layer
+ */
+static void planStepLSTM(struct planStep * step, data_t * netIn)
+{
+  struct layer * lay = step->lay;
+  int numHidden = step->outSize;
+  LSTMLayer(step->inSize, numHidden, step->rows,
+    lay->parameters[LSTM_WGHT_IH], lay->parameters[LSTM_WGHT_HH], lay->parameters[LSTM_BIAS_IH], lay->parameters[LSTM_BIAS_HH],
+    PLAN_STEP_IN(step, netIn), step->out, lay->parameters[LSTM_H], lay->parameters[LSTM_C],
+    step->nodes + 1*numHidden, //f
+    step->nodes + 2*numHidden, //i
+    step->nodes + 3*numHidden, //g
+    step->nodes,               //o
+    step->shift,
+    lay->tiling);
+}
 
-                  #if OUTPUTBUFFER > 2
-            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp) >> q_fraqP1);
-                  #endif
-                  #if OUTPUTBUFFER > 3
-            outFeatures_ptr[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp1) >> q_fraqP1);
-                  #endif
-                  #if OUTPUTBUFFER > 4
-            outFeatures_ptr[(outFeaturesPerTile*c_out+2)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp2) >> q_fraqP1);
-                  #endif
-                  #if OUTPUTBUFFER > 5
-            outFeatures_ptr[(outFeaturesPerTile*c_out+3)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp3) >> q_fraqP1);
-                  #endif
-                  #if OUTPUTBUFFER > 6
-            outFeatures_ptr[(outFeaturesPerTile*c_out+4)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp4) >> q_fraqP1);
-                  #endif
-                  #if OUTPUTBUFFER > 7
-            outFeatures_ptr[(outFeaturesPerTile*c_out+5)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp5) >> q_fraqP1);
-                  #endif
+/** @brief Step: layer with compressed weights (see QuantizedLayer)
+ */
+static void planStepQuantized(struct planStep * step, data_t * netIn)
+{
+  QuantizedLayer(step->lay, step->rows, PLAN_STEP_IN(step, netIn), step->out, step->nodes, NULL);
+}
 
-            outFeatures_ptr[(outFeaturesPerTile*c_out+OUTPUTBUFFER-2)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp6) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+OUTPUTBUFFER-1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp7) >> q_fraqP1);
-            param_kw_base += kernel_H_offset;
-            feat_kw_base  += w_im_out*_layer->attributes[LAY_CONV_IN]/2;
-          }
-        }
-      }
-      param_kh_base += outFeaturesPerTile * output_channel_offset;
-    }  
-    break;
-     #endif
-     #if OUTPUTBUFFER > 4
-    case 4:
-    for(int c_out = 0; c_out < outFeatureTiles; c_out++) {
-     for(int h_out =0; h_out < h_im_out; h_out++) 
-     {
-       for(int w_out=0;w_out<w_im_out; w_out++)
-       {
+/** @brief Step: 2D convolution layer
+ */
+static void planStepConv2d(struct planStep * step, data_t * netIn)
+{
+  Conv2dLayerParallel(step->lay, PLAN_STEP_IN(step, netIn), step->out);
+}
 
-           int kh_slide_start = Max(-h_out, -h_ker_half);                  // Handle borders
-           int kh_slide_stop = Min(h_im_out-1-h_out,h_ker_half);           // Handle borders
-           temp = bias_ptr[outFeaturesPerTile*c_out] << q_fraqP1;
-           temp1 =  bias_ptr[(outFeaturesPerTile*c_out+1)] << q_fraqP1;
-           temp = bias_ptr[outFeaturesPerTile*c_out] << q_fraqP1;
-           temp1 = bias_ptr[outFeaturesPerTile*c_out+1] << q_fraqP1;
-           temp6 = bias_ptr[outFeaturesPerTile*c_out+2]<<(q_fraqP1);
-           temp7 = bias_ptr[outFeaturesPerTile*c_out+3]<<(q_fraqP1);
+/** @brief Step: GRU layer
+ */
+static void planStepGRU(struct planStep * step, data_t * netIn)
+{
+  struct layer * lay = step->lay;
+  GRULayer(step->inSize, step->outSize, step->rows,
+    lay->parameters[GRU_WGHT_IH], lay->parameters[GRU_WGHT_HH], lay->parameters[GRU_BIAS_IH], lay->parameters[GRU_BIAS_HH],
+    PLAN_STEP_IN(step, netIn), step->out, lay->parameters[GRU_H], step->nodes, step->shift, lay->tiling);
+}
 
-           unsigned int param_kw_base = param_kh_base \
-           + (kh_slide_start+h_ker_half) * kernel_H_offset;
-           unsigned int feat_kw_base = (h_out+kh_slide_start)*w_im_out*_layer->attributes[LAY_CONV_IN]/2;
-           for(int kh=kh_slide_start; kh <= kh_slide_stop;kh++)
-           {
-              int kw_slide_start = Max(-w_out, -w_ker_half);           // Handle borders
-              int kw_slide_stop = Min(w_im_out-1-w_out,w_ker_half);           // Handle borders
-              
-              int param_id_base = param_kw_base \
-                                            +(kw_slide_start+w_ker_half)*kernel_W_offset; // filter tap
-                                            int param_id_base1 = param_id_base+output_channel_offset;
-                                            int feat_id_base  = feat_kw_base \
-                                            +(w_out+kw_slide_start)* _layer->attributes[LAY_CONV_IN]/2;
-                                            for(int kw=kw_slide_start; kw <= kw_slide_stop;kw++)
-                                            {
-                                             addr0  = (uint32_t) &((v2s*)param_simd)[param_id_base];
-                                             addr1  = (uint32_t) &((v2s*)param_simd)[param_id_base+1*output_channel_offset];
-                                             addr6  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*2];
-                                             addr7  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*3];
+/** @brief Step: RNN layer
+ */
+static void planStepRNN(struct planStep * step, data_t * netIn)
+{
+  struct layer * lay = step->lay;
+  RNNLayer(step->inSize, step->outSize, step->rows,
+    lay->parameters[RNN_WGHT_IH], lay->parameters[RNN_WGHT_HH], lay->parameters[RNN_BIAS_IH], lay->parameters[RNN_BIAS_HH],
+    PLAN_STEP_IN(step, netIn), step->out, lay->parameters[RNN_H], step->nodes, step->shift, lay->tiling);
+}
 
-                 asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-                 asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
-                 v2s* in_addr = &((v2s*)inFeatures)[feat_id_base];
-                 v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-                 v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
+/** @brief Step: activation layer
+ */
+static void planStepActivation(struct planStep * step, data_t * netIn)
+{
+  ActivationLayer(step->rows*step->outSize, PLAN_STEP_IN(step, netIn), step->out, step->lay->epilogue);
+}
 
+#if ((defined LINEAR_TILES && !defined WEIGHT_STREAM) || defined PACKED_TILES) && !defined NUM_CORES
+/** @brief Adds one step per output FM tile size of a Linear layer (one time step) to the plan
+ *
+ *  Same decomposition into output FM tiles as LinearLayer, LinearLayerInt8 and LinearLayerInt4, the
+ *  tile steps call the kernel of their tile size directly.
+ *
+ *  @param plan Execution plan
+ *  @param step Step of the whole layer (planStepLinear, planStepLinearInt8 or planStepLinearInt4)
+ *  @return 0, -1 if the plan is full (EXECPLAN_MAXSTEPS)
+ */
+static int planLinearTiles(struct execPlan * plan, struct planStep * step)
+{
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(step->lay->tiling), tileOptions);
+  int outRemain = step->outSize;
+  for(int k = 0; k < numTileOptions && outRemain > 0; k++)
+  {
+    int tiles = outRemain/tileOptions[k];
+    if(tiles == 0) continue;
+    int o = step->outSize-outRemain;
+    struct planStep tile = *step;
+    tile.tiles = tiles;
+    tile.bias  = &step->bias[o];
+    tile.out   = &step->out[o];
+#ifdef PACKED_TILES
+    if(step->run == planStepLinearInt8)
+    {
+      tile.run              = planStepLinearPackedTile;
+      tile.packedTileKernel = linearLayerInt8Tiles[tileOptions[k]];
+      tile.weight           = (data_t*)&((int8_t*)step->weight)[step->inSize*o];
+      tile.scale            = &step->scale[o];
+    }
+    if(step->run == planStepLinearInt4)
+    {
+      tile.run              = planStepLinearPackedTile;
+      tile.packedTileKernel = linearLayerInt4Tiles[tileOptions[k]];
+      tile.weight           = (data_t*)&((uint8_t*)step->weight)[INT4_ROW_BYTES(step->inSize)*o];
+      tile.scale            = &step->scale[o];
+    }
+#endif
+#if defined LINEAR_TILES && !defined WEIGHT_STREAM
+    if(step->run == planStepLinear)
+    {
+      tile.run        = planStepLinearTile;
+      tile.tileKernel = linearLayerTiles[tileOptions[k]];
+      tile.inTiling   = tilingInTiling(step->lay->tiling);
+      tile.weight     = (data_t*)&((v2s*)step->weight)[(step->inSize/2)*o];
+    }
+#endif
+    if(plan->numSteps == EXECPLAN_MAXSTEPS) return -1;
+    plan->steps[plan->numSteps++] = tile;
+    outRemain -= tiles*tileOptions[k];
+  }
+  return 0;
+}
+#endif
 
-                 for(int i=0; i <  c_in_max;i++) // i=c_in
-                 {
-                 // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-                 asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-                 #ifdef FMINTILING
-                    asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-                 #endif
-                  // loop unfolding
-                  // temp  = __SUMDOTP2(((v2s*)inFeatures)[feat_id_base + i], \
-                  //  param_simd[param_id_base + i], temp);
-                  // temp1 = __SUMDOTP2(((v2s*)inFeatures)[feat_id_base + i], \
-                  //  param_simd[param_id_base1 + i], temp1);
-                   // v2s inF_temp = ((v2s*)inFeatures)[feat_id_base + i];
-                   // temp  = __SUMDOTP2(inF_temp, \
-                   // param_simd[param_id_base + i], temp);
-                   // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp),  "+r" (addr0) : "r" (inF_temp) ); 
-                   // temp1 = __SUMDOTP2(inF_temp, \
-                   // param_simd[param_id_base1 + i], temp1);
-                   // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr1) : "r" (inF_temp) ); 
-                   // v2s inF_temp = ((v2s*)inFeatures)[feat_id_base + i];
+/** @brief Compiles a network to an execution plan
+ *
+ *  Places the intermediate FMs in the arena (planNetwork) and translates every layer to kernel calls
+ *  with all the arguments resolved: pointers to the FMs in the arena and the parameters, the kernel
+ *  function and with the tiled Linear kernels (single time step) one call per output FM tile size of
+ *  the selected tiling (not with NUM_CORES, the layer is split across the cores instead). The plan
+ *  has to be compiled again if the tiling of a layer changes.
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @param seqSize Number of time steps
+ *  @param arena Arena for the intermediate FMs
+ *  @param arenaSize Size of the arena (data_t)
+ *  @param plan Execution plan (output)
+ *  @return Number of steps, -1 if the network does not fit into the arena or the plan (EXECPLAN_MAXSTEPS)
+ *  or a layer does not support sequences
+ */
+int compileNetwork(struct layer * network, int depth, int seqSize, data_t * arena, int arenaSize, struct execPlan * plan)
+{
+  if(checkSeqSize(network, depth, seqSize) < 0)
+    return -1;
+  int required = planNetwork(network, depth, seqSize, &plan->mem);
+  if(required < 0 || required > arenaSize) {
+    printf("\033[91mERROR: intermediate FMs (%d) too large for the arena (%d)\033[0m\n", required, arenaSize);
+    return -1;
+  }
+  plan->numSteps = 0;
+  int overflow = False;
+  data_t * in = NULL; // input of the network
+  for(int i = 0; i < depth; i++)
+  {
+    struct layer * lay = &network[i];
+    data_t * out = &arena[plan->mem.outOffset[i]];
+    struct planStep step = {0};
+    step.lay   = lay;
+    step.in    = in;
+    step.out   = out;
+    step.nodes = &arena[plan->mem.scratchOffset[i]];
+    step.rows  = seqSize;
+    step.shift = layerShift(lay);
+    if((lay->weightFormat == WEIGHT_INT8 || lay->weightFormat == WEIGHT_INT4) && lay->type == LINEAR)
+    {
+      step.run     = lay->weightFormat == WEIGHT_INT8 ? planStepLinearInt8 : planStepLinearInt4;
+      step.inSize  = lay->attributes[LAY_LIN_IN];
+      step.outSize = lay->attributes[LAY_LIN_OUT];
+      step.weight  = lay->parameters[LAY_LIN_WEIGHTS];
+      step.scale   = (int32_t *)lay->parameters[LAY_LIN_SCALE];
+      step.bias    = lay->parameters[LAY_LIN_BIAS];
+#if defined PACKED_TILES && !defined NUM_CORES
+      if(seqSize == 1)
+      {
+        if(planLinearTiles(plan, &step) < 0) { overflow = True; break; }
+        in = out;
+        continue;
+      }
+#endif
+    }
+    else if(lay->weightFormat != WEIGHT_Q16)
+    {
+      step.run     = planStepQuantized;
+      step.inSize  = layerInSize(lay);
+      step.outSize = layerOutSize(lay);
+    }
+    else if(lay->type == LINEAR)
+    {
+      step.run     = planStepLinear;
+      step.inSize  = lay->attributes[LAY_LIN_IN];
+      step.outSize = lay->attributes[LAY_LIN_OUT];
+      step.weight  = lay->parameters[LAY_LIN_WEIGHTS];
+      step.bias    = lay->parameters[LAY_LIN_BIAS];
+#if defined LINEAR_TILES && !defined NUM_CORES && !defined WEIGHT_STREAM
+      if(seqSize == 1)
+      {
+        if(planLinearTiles(plan, &step) < 0) { overflow = True; break; }
+        in = out;
+        continue;
+      }
+#endif
+    }
+    else if(lay->type == LSTM)
+    {
+      step.run     = planStepLSTM;
+      step.inSize  = lay->attributes[LAY_LSTM_IN];
+      step.outSize = lay->attributes[LAY_LSTM_HID];
+    }
+    else if(lay->type == Conv2d)
+    {
+      if(seqSize > 1)
+        printf("\033[91mERROR: Conv2d layer does not support sequences\033[0m\n");
+      step.run = planStepConv2d;
+    }
+    else if(lay->type == GRU)
+    {
+      step.run     = planStepGRU;
+      step.inSize  = lay->attributes[LAY_GRU_IN];
+      step.outSize = lay->attributes[LAY_GRU_HID];
+    }
+    else if(lay->type == RNN)
+    {
+      step.run     = planStepRNN;
+      step.inSize  = lay->attributes[LAY_RNN_IN];
+      step.outSize = lay->attributes[LAY_RNN_HID];
+    }
+    else if(lay->type == ACTIVATION)
+    {
+      step.run     = planStepActivation;
+      step.inSize  = lay->attributes[LAY_ACT_SIZE];
+      step.outSize = lay->attributes[LAY_ACT_SIZE];
+    }
+    else
+    {
+      printf("\033[91mERROR: not a valid layer\033[0m\n");
+      continue;
+    }
+    if(plan->numSteps == EXECPLAN_MAXSTEPS) { overflow = True; break; }
+    plan->steps[plan->numSteps++] = step;
+    in = out;
+  }
+  if(overflow) {
+    printf("\033[91mERROR: network too large for the execution plan (EXECPLAN_MAXSTEPS)\033[0m\n");
+    return -1;
+  }
+  plan->out = in;
+  return plan->numSteps;
+}
 
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp),   "+r" (addr2) : "r" (inF_temp) );
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp) );
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp) );
-                    #ifdef FMINTILING
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp),   "+r" (addr2) : "r" (inF_temp2) );
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp2) );
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp2) );
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp2) );
-                    #endif
+/** @brief Runs a network compiled with compileNetwork()
+ *
+ *  @param plan Execution plan
+ *  @param inFeatures Input Feature Map [seqSize x input neurons]
+ *  @return Output Feature Map [seqSize x output neurons] (in the arena)
+ */
+data_t * NOINLINE runPlan(struct execPlan * plan, data_t * __restrict__ inFeatures)
+{
+  struct planStep * step = plan->steps;
+  for(int i = 0; i < plan->numSteps; i++, step++)
+    step->run(step, inFeatures);
+  return plan->out;
+}
 
-                  }
-              param_id_base  += kernel_W_offset; // filter tap
-              param_id_base1 += kernel_W_offset; // filter tap
-              feat_id_base   +=  _layer->attributes[LAY_CONV_IN]/2;
-            }
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Pipeline: consecutive layers per stage, the samples of a stream flow through ring buffers
+/////////////////////////////////////////////////////////////////////////////////////////////
 
-            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp1) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+2)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp6) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+3)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp7) >> q_fraqP1);
+/// Number of MACs of a layer for one sample (cost model of the stage partitioning)
+static int layerMacs(struct layer * lay)
+{
+  switch(lay->type) {
+    case LINEAR:
+      if(lay->weightFormat == WEIGHT_SPARSE) // non-zero blocks only
+        return 2*SPARSE_BLOCK_OUT*((int32_t *)lay->parameters[LAY_LIN_BLOCK_ROWS])[(lay->attributes[LAY_LIN_OUT]+SPARSE_BLOCK_OUT-1)/SPARSE_BLOCK_OUT];
+      if(lay->weightFormat == WEIGHT_2OF4)
+        return NM_ROW_WEIGHTS(lay->attributes[LAY_LIN_IN])*lay->attributes[LAY_LIN_OUT];
+      return lay->attributes[LAY_LIN_IN]*lay->attributes[LAY_LIN_OUT];
+    case LSTM:
+      if(lay->weightFormat == WEIGHT_2OF4)
+        return 4*lay->attributes[LAY_LSTM_HID]*(NM_ROW_WEIGHTS(lay->attributes[LAY_LSTM_IN])+NM_ROW_WEIGHTS(lay->attributes[LAY_LSTM_HID]));
+      return 4*lay->attributes[LAY_LSTM_HID]*(lay->attributes[LAY_LSTM_IN]+lay->attributes[LAY_LSTM_HID]);
+    case Conv2d: return layerOutSize(lay)*lay->attributes[LAY_CONV_IN]*lay->attributes[LAY_CONV_KER]*lay->attributes[LAY_CONV_KER];
+    case GRU:    return 3*lay->attributes[LAY_GRU_HID]*(lay->attributes[LAY_GRU_IN]+lay->attributes[LAY_GRU_HID]);
+    case RNN:    return lay->attributes[LAY_RNN_HID]*(lay->attributes[LAY_RNN_IN]+lay->attributes[LAY_RNN_HID]);
+    default:     return 0;
+  }
+}
 
-            param_kw_base += kernel_H_offset;
-            feat_kw_base  += w_im_out*_layer->attributes[LAY_CONV_IN]/2;
-          }
+/** @brief Compiles a network to a pipeline
+ *
+ *  The layers are partitioned into numStages groups of consecutive layers such that the largest
+ *  number of MACs of a stage is minimal. Every stage gets its own arena (memory plan of its layers
+ *  for one sample) and the output FMs of a stage are passed to the next one in a ring buffer of
+ *  PIPE_SLOTS FMs, i.e. at most PIPE_SLOTS samples are in flight between two stages. Arenas and
+ *  ring buffers are placed in arena.
+ *
+ *  @param network Array of concecutive layers of the current neural network
+ *  @param depth Number of Layers (aka array size)
+ *  @param numStages Number of stages (limited to NUM_CORES, PIPE_MAXSTAGES and depth)
+ *  @param arena Arena for the intermediate FMs and the ring buffers
+ *  @param arenaSize Size of the arena (data_t)
+ *  @param pipe Pipeline (output)
+ *  @return Number of stages, -1 if the network does not fit into the arena or the Q-formats do not fit
+ */
+int compilePipeline(struct layer * network, int depth, int numStages, data_t * arena, int arenaSize, struct pipeline * pipe)
+{
+#ifdef NUM_CORES
+  numStages = Min(numStages, NUM_CORES);
+#else
+  numStages = 1;
+#endif
+  numStages = Max(1, Min(numStages, Min(depth, PIPE_MAXSTAGES)));
+  if(depth > MEMPLAN_MAXDEPTH) {
+    printf("\033[91mERROR: network too deep for the pipeline (MEMPLAN_MAXDEPTH)\033[0m\n");
+    return -1;
+  }
+  // the stages are planned separately, the formats are checked across the stage boundaries
+  if(checkQFormats(network, depth) < 0)
+    return -1;
+
+  // cost[s][i]: smallest largest stage cost of the layers 0..i-1 in s stages, split[s][i]: first layer of the last stage
+  int macs[MEMPLAN_MAXDEPTH+1];
+  int cost[PIPE_MAXSTAGES+1][MEMPLAN_MAXDEPTH+1];
+  int split[PIPE_MAXSTAGES+1][MEMPLAN_MAXDEPTH+1];
+  macs[0] = 0;
+  for(int i = 0; i < depth; i++)
+    macs[i+1] = macs[i] + layerMacs(&network[i]);
+  for(int i = 0; i <= depth; i++) {
+    cost[1][i]  = macs[i];
+    split[1][i] = 0;
+  }
+  for(int s = 2; s <= numStages; s++)
+    for(int i = s; i <= depth; i++) {
+      cost[s][i] = -1;
+      for(int j = s-1; j < i; j++) {
+        int c = Max(cost[s-1][j], macs[i]-macs[j]);
+        if(cost[s][i] < 0 || c < cost[s][i]) {
+          cost[s][i]  = c;
+          split[s][i] = j;
         }
       }
-      param_kh_base += outFeaturesPerTile * output_channel_offset;
-    }  
-    break;
-#endif
-    case 2:
-    for(int c_out = 0; c_out < outFeatureTiles; c_out++) {
-     for(int h_out =0; h_out < h_im_out; h_out++) 
-     {
-       for(int w_out=0;w_out<w_im_out; w_out++)
-       {
-
-           int kh_slide_start = Max(-h_out, -h_ker_half);                  // Handle borders
-           int kh_slide_stop = Min(h_im_out-1-h_out,h_ker_half);           // Handle borders
-           
-           temp6 = bias_ptr[outFeaturesPerTile*c_out+0]<<(q_fraqP1);
-           temp7 = bias_ptr[outFeaturesPerTile*c_out+1]<<(q_fraqP1);
-
-           unsigned int param_kw_base = param_kh_base \
-           + (kh_slide_start+h_ker_half) * kernel_H_offset;
-           unsigned int feat_kw_base = (h_out+kh_slide_start)*w_im_out*_layer->attributes[LAY_CONV_IN]/2;
-           for(int kh=kh_slide_start; kh <= kh_slide_stop;kh++)
-           {
-              int kw_slide_start = Max(-w_out, -w_ker_half);           // Handle borders
-              int kw_slide_stop = Min(w_im_out-1-w_out,w_ker_half);           // Handle borders
-              
-              int param_id_base = param_kw_base \
-                                            +(kw_slide_start+w_ker_half)*kernel_W_offset; // filter tap
-                                            int param_id_base1 = param_id_base+output_channel_offset;
-                                            int feat_id_base  = feat_kw_base \
-                                            +(w_out+kw_slide_start)* _layer->attributes[LAY_CONV_IN]/2;
-                                            for(int kw=kw_slide_start; kw <= kw_slide_stop;kw++)
-                                            {
+    }
+  pipe->network   = network;
+  pipe->numStages = numStages;
+  pipe->firstLayer[numStages] = depth;
+  for(int s = numStages; s >= 1; s--)
+    pipe->firstLayer[s-1] = split[s][pipe->firstLayer[s]];
+
+  int offset = 0;
+  for(int s = 0; s < numStages; s++)
+  {
+    int first = pipe->firstLayer[s];
+    int size = planNetwork(&network[first], pipe->firstLayer[s+1]-first, 1, &pipe->plan[s]);
+    if(size < 0)
+      return -1;
+    pipe->arena[s] = &arena[offset];
+    offset += (size+1)&~1;
+    if(s == numStages-1)
+      break;
+    struct pipeRing * ring = &pipe->ring[s];
+    ring->head = 0;
+    ring->tail = 0;
+    ring->slotSize = (layerOutSize(&network[pipe->firstLayer[s+1]-1])+1)&~1;
+    ring->slots = &arena[offset];
+    offset += PIPE_SLOTS*ring->slotSize;
+  }
+  if(offset > arenaSize) {
+    printf("\033[91mERROR: pipeline (%d) too large for the arena (%d)\033[0m\n", offset, arenaSize);
+    return -1;
+  }
+  pipe->inSize  = layerInSize(&network[0]);
+  pipe->outSize = layerOutSize(&network[depth-1]);
+  return numStages;
+}
 
-                                             addr6  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*0];
-                                             addr7  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*1];
+/// Runs the layers of stage s for one sample, returns the output FM (in the arena of the stage)
+static data_t * pipelineStage(struct pipeline * pipe, int s, data_t * inFeatures)
+{
+  int first = pipe->firstLayer[s];
+  return inferNetworkPlanned(&pipe->network[first], pipe->firstLayer[s+1]-first, 1, inFeatures, NULL, &pipe->plan[s], pipe->arena[s]);
+}
 
-                 asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr6) : "r" (x0) ); // preload first weight
-                 asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr7) : "r" (x0) ); // preload first weight
+#ifdef NUM_CORES
+/// Slot of the next FM to be written, waits while the ring buffer is full (producer)
+static data_t * pipeRingWriteSlot(struct pipeRing * ring)
+{
+  while(ring->head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == PIPE_SLOTS)
+    PARALLEL_PAUSE();
+  return &ring->slots[(ring->head%PIPE_SLOTS)*ring->slotSize];
+}
 
-                 v2s* in_addr = &((v2s*)inFeatures)[feat_id_base];
-                 v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-                 v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
+/// Publishes the written FM to the consumer
+static void pipeRingPush(struct pipeRing * ring)
+{
+  __atomic_store_n(&ring->head, ring->head+1, __ATOMIC_RELEASE);
+}
 
+/// Slot of the next FM to be read, waits while the ring buffer is empty (consumer)
+static data_t * pipeRingReadSlot(struct pipeRing * ring)
+{
+  while(__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == ring->tail)
+    PARALLEL_PAUSE();
+  return &ring->slots[(ring->tail%PIPE_SLOTS)*ring->slotSize];
+}
 
-                 for(int i=0; i <  c_in_max;i++) // i=c_in
-                 {
-                 // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-                 asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-                 #ifdef FMINTILING
-                    asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-                 #endif
-                  // loop unfolding
-                  // temp  = __SUMDOTP2(((v2s*)inFeatures)[feat_id_base + i], \
-                  //  param_simd[param_id_base + i], temp);
-                  // temp1 = __SUMDOTP2(((v2s*)inFeatures)[feat_id_base + i], \
-                  //  param_simd[param_id_base1 + i], temp1);
-                   // v2s inF_temp = ((v2s*)inFeatures)[feat_id_base + i];
-                   // temp  = __SUMDOTP2(inF_temp, \
-                   // param_simd[param_id_base + i], temp);
-                   // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp),  "+r" (addr0) : "r" (inF_temp) ); 
-                   // temp1 = __SUMDOTP2(inF_temp, \
-                   // param_simd[param_id_base1 + i], temp1);
-                   // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr1) : "r" (inF_temp) ); 
-                   // v2s inF_temp = ((v2s*)inFeatures)[feat_id_base + i];
+/// Releases the read FM to the producer
+static void pipeRingPop(struct pipeRing * ring)
+{
+  __atomic_store_n(&ring->tail, ring->tail+1, __ATOMIC_RELEASE);
+}
 
+/// Core: runs its stage for all the samples (the cores without a stage return immediately)
+static void pipelineCore(void * arg, int core, int numCores)
+{
+  struct pipeline * pipe = (struct pipeline *)arg;
+  (void)numCores;
+  if(core >= pipe->numStages)
+    return;
+  int last = core == pipe->numStages-1;
+  for(int n = 0; n < pipe->numSamples; n++)
+  {
+    data_t * in = core == 0 ? &pipe->in[n*pipe->inSize] : pipeRingReadSlot(&pipe->ring[core-1]);
+    data_t * out = pipelineStage(pipe, core, in);
+    if(core > 0)
+      pipeRingPop(&pipe->ring[core-1]);
+    if(last) {
+      CopyTensor(pipe->outSize, &pipe->out[n*pipe->outSize], out);
+    } else {
+      CopyTensor(pipe->ring[core].slotSize, pipeRingWriteSlot(&pipe->ring[core]), out);
+      pipeRingPush(&pipe->ring[core]);
+    }
+  }
+}
+#endif
 
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr6) : "r" (inF_temp) );
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr7) : "r" (inF_temp) );
-                    #ifdef FMINTILING
-                    asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr6) : "r" (inF_temp2) );
-                    asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr7) : "r" (inF_temp2) );
-                    #endif
+/** @brief Runs a stream of samples through a pipeline compiled with compilePipeline()
+ *
+ *  Every stage runs on its own core and processes the samples in order (the LSTM states are
+ *  updated sample by sample as with inferNetwork), the layers within a stage are run on a single
+ *  core. With a single stage the samples are run one after the other.
+ *
+ *  @param pipe Pipeline
+ *  @param numSamples Number of samples
+ *  @param inFeatures Input Feature Maps [numSamples x input neurons]
+ *  @param outFeatures Output Feature Maps [numSamples x output neurons]
+ */
+void NOINLINE runPipeline(struct pipeline * pipe, int numSamples, data_t * __restrict__ inFeatures, data_t * __restrict__ outFeatures)
+{
+#ifdef NUM_CORES
+  if(pipe->numStages > 1) {
+    pipe->numSamples = numSamples;
+    pipe->in  = inFeatures;
+    pipe->out = outFeatures;
+    for(int s = 0; s < pipe->numStages-1; s++) {
+      pipe->ring[s].head = 0;
+      pipe->ring[s].tail = 0;
+    }
+    parallelRun(pipelineCore, pipe);
+    return;
+  }
+#endif
+  for(int n = 0; n < numSamples; n++)
+  {
+    data_t * fm = &inFeatures[n*pipe->inSize];
+    for(int s = 0; s < pipe->numStages; s++)
+      fm = pipelineStage(pipe, s, fm);
+    CopyTensor(pipe->outSize, &outFeatures[n*pipe->outSize], fm);
+  }
+}
 
-                  }
-              param_id_base  += kernel_W_offset; // filter tap
-              param_id_base1 += kernel_W_offset; // filter tap
-              feat_id_base   +=  _layer->attributes[LAY_CONV_IN]/2;
-            }
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////   ____                 ____     _ _                           /////////////////////////
+/////  / ___|___  _ ____   _|___ \ __| | |    __ _ _   _  ___ _ __  /////////////////////////
+///// | |   / _ \| '_ \ \ / / __) / _` | |   / _` | | | |/ _ \ '__| /////////////////////////
+///// | |__| (_) | | | \ V / / __/ (_| | |__| (_| | |_| |  __/ |    /////////////////////////
+/////  \____\___/|_| |_|\_/ |_____\__,_|_____\__,_|\__, |\___|_|    /////////////////////////
+/////                                              |___/            /////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+//         _____  _______ ______  _______ _______ _______      _    _        _____ _  _  _ //
+// |      |     | |_____| |     \ |  |  | |_____| |             \  /  |        |   |  |  | //
+// |_____ |_____| |     | |_____/ |  |  | |     | |_____         \/   |_____ __|__ |__|__| //
+//                                                                                         //
+/////////////////////////////////////////////////////////////////////////////////////////////                                                                                      
+#if defined FMOUTTILING && !defined(ASIP) && defined MANUALLOOPUNFOLDING && defined FixedPt && defined SIMD // RISCY implementation (VLIW or plain sdotp)
+TILE_KERNEL_FAMILY(CONV2D_TILE_KERNEL)
+/// Conv2dLayer kernels of all the output FM tile sizes (index: tile size)
+static void (* const conv2dLayerTiles[TILE_MAXSIZE+1])(int, int, int, int, int, data_t *, data_t *, data_t *, data_t *, int, struct epilogue, int) = TILE_KERNEL_TABLE(Conv2dLayerTile);
 
-            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp6) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp7) >> q_fraqP1);
-            param_kw_base += kernel_H_offset;
-            feat_kw_base  += w_im_out*_layer->attributes[LAY_CONV_IN]/2;
-          }
-        }
-      }
-      param_kh_base += outFeaturesPerTile * output_channel_offset;
-    }  
-    break;
-    case 1:
-    for(int c_out = 0; c_out < outFeatureTiles; c_out++) {
-     for(int h_out =0; h_out < h_im_out; h_out++) 
-     {
-       for(int w_out=0;w_out<w_im_out; w_out++)
-       {
+/** @brief Calculates a 2D Convolution Layer PULP+(VLIW)+SIMD
+ *  The kernel of each output channel tile size is generated from the template in tileKernel.h
+ *  Supporte configurations:
+ *  > VLIWEXT true/false
+ *  > SIMD only
+ *  > FMIN and FMOUTILING (tile sizes selected per layer with _layer->tiling)
+ *  > MANUALLOOPUNFOLDING true
+ *
+ *  @param _layer Layer Properties
+ *  @param h_im Image Height
+ *  @param w_im Image Width
+ *  @param inFeatures Input Feature Map
+ *  @param outFeatures Output Feature Map
+ */
+int NOINLINE Conv2dLayer (
+  struct layer * _layer,
+  int h_im,
+  int w_im,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures) {
 
-           int kh_slide_start = Max(-h_out, -h_ker_half);                  // Handle borders
-           int kh_slide_stop = Min(h_im_out-1-h_out,h_ker_half);           // Handle borders
-           
-           temp6 = bias_ptr[outFeaturesPerTile*c_out+0]<<(q_fraqP1);
-          // temp7 = bias_ptr[outFeaturesPerTile*c_out+1]<<(q_fraqP1);
+  int inTiling = tilingInTiling(_layer->tiling);
+  int shift = layerShift(_layer);
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(_layer->tiling), tileOptions);
 
-           unsigned int param_kw_base = param_kh_base \
-           + (kh_slide_start+h_ker_half) * kernel_H_offset;
-           unsigned int feat_kw_base = (h_out+kh_slide_start)*w_im_out*_layer->attributes[LAY_CONV_IN]/2;
-           for(int kh=kh_slide_start; kh <= kh_slide_stop;kh++)
-           {
-              int kw_slide_start = Max(-w_out, -w_ker_half);           // Handle borders
-              int kw_slide_stop = Min(w_im_out-1-w_out,w_ker_half);           // Handle borders
-              
-              int param_id_base = param_kw_base \
-                                            +(kw_slide_start+w_ker_half)*kernel_W_offset; // filter tap
-                                            int param_id_base1 = param_id_base+output_channel_offset;
-                                            int feat_id_base  = feat_kw_base \
-                                            +(w_out+kw_slide_start)* _layer->attributes[LAY_CONV_IN]/2;
-                                            for(int kw=kw_slide_start; kw <= kw_slide_stop;kw++)
-                                            {
+  int kernelSize = _layer->attributes[LAY_CONV_KER];
+  data_t * bias_ptr   = _layer->parameters[CONV_BIAS];
+  v2s    * weight_ptr = (v2s*) _layer->parameters[CONV_WGHT];
+  data_t * outFeatures_ptr = outFeatures;
+  unsigned int output_channel_offset = kernelSize*kernelSize*_layer->attributes[LAY_CONV_IN]/2;
 
-                 // addr6  = &((v2s*)param_simd)[param_id_base+output_channel_offset*0];
-                #ifdef FMINTILING
-                for(int i=0; i <  2*c_in_max;i++) // i=c_in                              
-                #else
-                for(int i=0; i <  c_in_max;i++) // i=c_in                             
-                #endif
-                 
-                 {
-                  temp6  = __SUMDOTP2(((v2s*)inFeatures)[feat_id_base + i], \
-                   param_simd[param_id_base + i], temp6);
-                }
-              param_id_base  += kernel_W_offset; // filter tap
-              param_id_base1 += kernel_W_offset; // filter tap
-              feat_id_base   +=  _layer->attributes[LAY_CONV_IN]/2;
-            }
+  int outFeaturesPerTile = 1;
+  int outFeatureTiles;
+  int outFeaturesSize_remain = _layer->attributes[LAY_CONV_OUT];
 
-            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp6) >> q_fraqP1);
-            param_kw_base += kernel_H_offset;
-            feat_kw_base  += w_im_out*_layer->attributes[LAY_CONV_IN]/2;
-          }
-        }
-      }
-      param_kh_base += outFeaturesPerTile * output_channel_offset;
-    }  
-    break;
-  }
+  // Tile with largest tileOption
+  for(int i=0; i<numTileOptions; i++) {
+    outFeaturesPerTile = tileOptions[i];
+    outFeatureTiles = outFeaturesSize_remain/outFeaturesPerTile;
 
+    if(outFeatureTiles == 0) continue;
 
-      // move pointers for next iteration
-  bias_ptr                = &bias_ptr[outFeaturesPerTile*outFeatureTiles];
-      // param_simd              = &((v2s*)param_simd)[output_channel_offset*(outFeatureTiles*outFeaturesPerTile)];
-  outFeatures_ptr         = &outFeatures_ptr[outFeaturesPerTile*outFeatureTiles*h_im_out*w_im_out];
-  outFeaturesSize_remain -= outFeatureTiles*outFeaturesPerTile;
+    conv2dLayerTiles[outFeaturesPerTile](outFeatureTiles, _layer->attributes[LAY_CONV_IN], kernelSize, h_im, w_im,
+      (data_t*)weight_ptr, bias_ptr, inFeatures, outFeatures_ptr, shift, _layer->epilogue, inTiling);
 
-  if (outFeaturesSize_remain==0) break;
-}
-return 0;
+    // move pointers for next iteration
+    bias_ptr                = &bias_ptr[outFeatureTiles*outFeaturesPerTile];
+    weight_ptr              = &weight_ptr[output_channel_offset*outFeatureTiles*outFeaturesPerTile];
+    outFeatures_ptr         = &outFeatures_ptr[outFeatureTiles*outFeaturesPerTile*h_im*w_im];
+    outFeaturesSize_remain -= outFeatureTiles*outFeaturesPerTile;
+    if (outFeaturesSize_remain==0) break;
+  }
+  return 0;
 }
 #elif defined(FMOUTTILING) // RISCY implementation with the lw-sdopt-VLIW
 /** @brief Calculates a 2D Convolution Layer PULP+VLIW+(SIMD)
@@ -2464,6 +2615,7 @@ int NOINLINE Conv2dLayer (
   data_t * __restrict__ inFeatures,
   data_t * __restrict__ outFeatures) {
 
+  int shift = layerShift(_layer);
    #if OUTPUTBUFFER > 8
  int tileOptions[] = {OUTPUTBUFFER,8,4,2,1};
    #elif OUTPUTBUFFER > 4
@@ -2497,7 +2649,7 @@ int NOINLINE Conv2dLayer (
    // #endif
    
    register_attribute int32_t temp, temp1, temp2, temp3, temp4, temp5, temp6, temp7;
-   register_attribute uint32_t  addr0, addr1, addr2, addr3, addr4, addr5, addr6, addr7;
+   register_attribute uintptr_t  addr0, addr1, addr2, addr3, addr4, addr5, addr6, addr7;
    // const int outFeaturesPerTile = 2;
    unsigned int param_kh_base = 0;
    int outFeatureTiles;
@@ -2522,25 +2674,25 @@ int NOINLINE Conv2dLayer (
            int kh_slide_stop = Min(h_im_out-1-h_out,h_ker_half);           // Handle borders
 
             #if OUTPUTBUFFER > 2
-           temp = bias_ptr[outFeaturesPerTile*c_out] << q_fraqP1;
+           temp = bias_ptr[outFeaturesPerTile*c_out] << shift;
             #endif
             #if OUTPUTBUFFER > 3
-           temp1 = bias_ptr[outFeaturesPerTile*c_out+1] << q_fraqP1;
+           temp1 = bias_ptr[outFeaturesPerTile*c_out+1] << shift;
             #endif
             #if OUTPUTBUFFER > 4
-           temp2 = bias_ptr[outFeaturesPerTile*c_out+2] << q_fraqP1;
+           temp2 = bias_ptr[outFeaturesPerTile*c_out+2] << shift;
             #endif
             #if OUTPUTBUFFER > 5
-           temp3 = bias_ptr[outFeaturesPerTile*c_out+3] << q_fraqP1;
+           temp3 = bias_ptr[outFeaturesPerTile*c_out+3] << shift;
             #endif
             #if OUTPUTBUFFER > 6
-           temp4 = bias_ptr[outFeaturesPerTile*c_out+4] << q_fraqP1;
+           temp4 = bias_ptr[outFeaturesPerTile*c_out+4] << shift;
             #endif
             #if OUTPUTBUFFER > 7
-           temp5 = bias_ptr[outFeaturesPerTile*c_out+5] << q_fraqP1;
+           temp5 = bias_ptr[outFeaturesPerTile*c_out+5] << shift;
             #endif
-           temp6 = bias_ptr[outFeaturesPerTile*c_out+OUTPUTBUFFER-2]<<(q_fraqP1);
-           temp7 = bias_ptr[outFeaturesPerTile*c_out+OUTPUTBUFFER-1]<<(q_fraqP1);
+           temp6 = bias_ptr[outFeaturesPerTile*c_out+OUTPUTBUFFER-2]<<(shift);
+           temp7 = bias_ptr[outFeaturesPerTile*c_out+OUTPUTBUFFER-1]<<(shift);
 
            unsigned int param_kw_base = param_kh_base \
            + (kh_slide_start+h_ker_half) * kernel_H_offset;
@@ -2557,14 +2709,14 @@ int NOINLINE Conv2dLayer (
                                             +(w_out+kw_slide_start)* _layer->attributes[LAY_CONV_IN]/2;
                                             for(int kw=kw_slide_start; kw <= kw_slide_stop;kw++)
                                             {
-                                             addr0  = (uint32_t) &((v2s*)param_simd)[param_id_base];
-                                             addr1  = (uint32_t) &((v2s*)param_simd)[param_id_base+1*output_channel_offset];
-                                             addr2  = (uint32_t) &((v2s*)param_simd)[param_id_base+2*output_channel_offset];
-                                             addr3  = (uint32_t) &((v2s*)param_simd)[param_id_base+3*output_channel_offset];
-                                             addr4  = (uint32_t) &((v2s*)param_simd)[param_id_base+4*output_channel_offset];
-                                             addr5  = (uint32_t) &((v2s*)param_simd)[param_id_base+5*output_channel_offset];
-                                             addr6  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*(OUTPUTBUFFER-2)];
-                                             addr7  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*(OUTPUTBUFFER-1)];
+                                             addr0  = (uintptr_t) &((v2s*)param_simd)[param_id_base];
+                                             addr1  = (uintptr_t) &((v2s*)param_simd)[param_id_base+1*output_channel_offset];
+                                             addr2  = (uintptr_t) &((v2s*)param_simd)[param_id_base+2*output_channel_offset];
+                                             addr3  = (uintptr_t) &((v2s*)param_simd)[param_id_base+3*output_channel_offset];
+                                             addr4  = (uintptr_t) &((v2s*)param_simd)[param_id_base+4*output_channel_offset];
+                                             addr5  = (uintptr_t) &((v2s*)param_simd)[param_id_base+5*output_channel_offset];
+                                             addr6  = (uintptr_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*(OUTPUTBUFFER-2)];
+                                             addr7  = (uintptr_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*(OUTPUTBUFFER-1)];
 
                  // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
                  // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
@@ -2589,7 +2741,7 @@ int NOINLINE Conv2dLayer (
 
 
                  // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-                 asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
+                 P_LW_INCR(inF_temp, in_addr);  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
                  // #ifdef FMINTILING
                  //    asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
                  // #endif
@@ -2644,7 +2796,7 @@ int NOINLINE Conv2dLayer (
           if(_layer->attributes[LAY_CONV_IN]%4!=0) { // add contribution of left over input channel (input channels not multiple of 4)
                v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
                // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-               asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
+               P_LW_INCR(inF_temp, in_addr);  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
                // asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
                
                // MANUAL loop unfolding
@@ -2680,26 +2832,26 @@ int NOINLINE Conv2dLayer (
             }
 
                   #if OUTPUTBUFFER > 2
-            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp, shift, _layer->epilogue);
                   #endif
                   #if OUTPUTBUFFER > 3
-            outFeatures_ptr[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp1) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp1, shift, _layer->epilogue);
                   #endif
                   #if OUTPUTBUFFER > 4
-            outFeatures_ptr[(outFeaturesPerTile*c_out+2)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp2) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+2)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp2, shift, _layer->epilogue);
                   #endif
                   #if OUTPUTBUFFER > 5
-            outFeatures_ptr[(outFeaturesPerTile*c_out+3)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp3) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+3)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp3, shift, _layer->epilogue);
                   #endif
                   #if OUTPUTBUFFER > 6
-            outFeatures_ptr[(outFeaturesPerTile*c_out+4)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp4) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+4)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp4, shift, _layer->epilogue);
                   #endif
                   #if OUTPUTBUFFER > 7
-            outFeatures_ptr[(outFeaturesPerTile*c_out+5)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp5) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+5)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp5, shift, _layer->epilogue);
                   #endif
 
-            outFeatures_ptr[(outFeaturesPerTile*c_out+OUTPUTBUFFER-2)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp6) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+OUTPUTBUFFER-1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp7) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+OUTPUTBUFFER-2)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp6, shift, _layer->epilogue);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+OUTPUTBUFFER-1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp7, shift, _layer->epilogue);
             param_kw_base += kernel_H_offset;
             feat_kw_base  += w_im_out*_layer->attributes[LAY_CONV_IN]/2;
           }
@@ -2719,12 +2871,12 @@ int NOINLINE Conv2dLayer (
 
            int kh_slide_start = Max(-h_out, -h_ker_half);                  // Handle borders
            int kh_slide_stop = Min(h_im_out-1-h_out,h_ker_half);           // Handle borders
-           temp = bias_ptr[outFeaturesPerTile*c_out] << q_fraqP1;
-           temp1 =  bias_ptr[(outFeaturesPerTile*c_out+1)] << q_fraqP1;
-           temp = bias_ptr[outFeaturesPerTile*c_out] << q_fraqP1;
-           temp1 = bias_ptr[outFeaturesPerTile*c_out+1] << q_fraqP1;
-           temp6 = bias_ptr[outFeaturesPerTile*c_out+2]<<(q_fraqP1);
-           temp7 = bias_ptr[outFeaturesPerTile*c_out+3]<<(q_fraqP1);
+           temp = bias_ptr[outFeaturesPerTile*c_out] << shift;
+           temp1 =  bias_ptr[(outFeaturesPerTile*c_out+1)] << shift;
+           temp = bias_ptr[outFeaturesPerTile*c_out] << shift;
+           temp1 = bias_ptr[outFeaturesPerTile*c_out+1] << shift;
+           temp6 = bias_ptr[outFeaturesPerTile*c_out+2]<<(shift);
+           temp7 = bias_ptr[outFeaturesPerTile*c_out+3]<<(shift);
 
            unsigned int param_kw_base = param_kh_base \
            + (kh_slide_start+h_ker_half) * kernel_H_offset;
@@ -2741,10 +2893,10 @@ int NOINLINE Conv2dLayer (
                                             +(w_out+kw_slide_start)* _layer->attributes[LAY_CONV_IN]/2;
                                             for(int kw=kw_slide_start; kw <= kw_slide_stop;kw++)
                                             {
-                                             addr0  = (uint32_t) &((v2s*)param_simd)[param_id_base];
-                                             addr1  = (uint32_t) &((v2s*)param_simd)[param_id_base+1*output_channel_offset];
-                                             addr6  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*2];
-                                             addr7  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*3];
+                                             addr0  = (uintptr_t) &((v2s*)param_simd)[param_id_base];
+                                             addr1  = (uintptr_t) &((v2s*)param_simd)[param_id_base+1*output_channel_offset];
+                                             addr6  = (uintptr_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*2];
+                                             addr7  = (uintptr_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*3];
 
                  // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
                  // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
@@ -2756,7 +2908,7 @@ int NOINLINE Conv2dLayer (
                  for(int i=0; i <  c_in_max;i++) // i=c_in
                  {
                  // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-                 asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
+                 P_LW_INCR(inF_temp, in_addr);  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
                  // #ifdef FMINTILING
                  //    asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
                  // #endif
@@ -2808,10 +2960,10 @@ int NOINLINE Conv2dLayer (
               feat_id_base   +=  _layer->attributes[LAY_CONV_IN]/2;
             }
 
-            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp1) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+2)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp6) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+3)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp7) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp, shift, _layer->epilogue);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp1, shift, _layer->epilogue);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+2)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp6, shift, _layer->epilogue);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+3)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp7, shift, _layer->epilogue);
 
             param_kw_base += kernel_H_offset;
             feat_kw_base  += w_im_out*_layer->attributes[LAY_CONV_IN]/2;
@@ -2832,8 +2984,8 @@ int NOINLINE Conv2dLayer (
            int kh_slide_start = Max(-h_out, -h_ker_half);                  // Handle borders
            int kh_slide_stop = Min(h_im_out-1-h_out,h_ker_half);           // Handle borders
            
-           temp6 = bias_ptr[outFeaturesPerTile*c_out+0]<<(q_fraqP1);
-           temp7 = bias_ptr[outFeaturesPerTile*c_out+1]<<(q_fraqP1);
+           temp6 = bias_ptr[outFeaturesPerTile*c_out+0]<<(shift);
+           temp7 = bias_ptr[outFeaturesPerTile*c_out+1]<<(shift);
 
            unsigned int param_kw_base = param_kh_base \
            + (kh_slide_start+h_ker_half) * kernel_H_offset;
@@ -2851,8 +3003,8 @@ int NOINLINE Conv2dLayer (
                                             for(int kw=kw_slide_start; kw <= kw_slide_stop;kw++)
                                             {
 
-                                             addr6  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*0];
-                                             addr7  = (uint32_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*1];
+                                             addr6  = (uintptr_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*0];
+                                             addr7  = (uintptr_t) &((v2s*)param_simd)[param_id_base+output_channel_offset*1];
 
                  // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr6) : "r" (x0) ); // preload first weight
                  // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr7) : "r" (x0) ); // preload first weight
@@ -2865,7 +3017,7 @@ int NOINLINE Conv2dLayer (
                  for(int i=0; i <  c_in_max;i++) // i=c_in
                  {
                  // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-                 asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
+                 P_LW_INCR(inF_temp, in_addr);  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
                  // #ifdef FMINTILING
                  //    asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
                  // #endif
@@ -2912,8 +3064,8 @@ int NOINLINE Conv2dLayer (
               feat_id_base   +=  _layer->attributes[LAY_CONV_IN]/2;
             }
 
-            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp6) >> q_fraqP1);
-            outFeatures_ptr[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp7) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp6, shift, _layer->epilogue);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp7, shift, _layer->epilogue);
             param_kw_base += kernel_H_offset;
             feat_kw_base  += w_im_out*_layer->attributes[LAY_CONV_IN]/2;
           }
@@ -2932,8 +3084,8 @@ int NOINLINE Conv2dLayer (
            int kh_slide_start = Max(-h_out, -h_ker_half);                  // Handle borders
            int kh_slide_stop = Min(h_im_out-1-h_out,h_ker_half);           // Handle borders
            
-           temp6 = bias_ptr[outFeaturesPerTile*c_out+0]<<(q_fraqP1);
-          // temp7 = bias_ptr[outFeaturesPerTile*c_out+1]<<(q_fraqP1);
+           temp6 = bias_ptr[outFeaturesPerTile*c_out+0]<<(shift);
+          // temp7 = bias_ptr[outFeaturesPerTile*c_out+1]<<(shift);
 
            unsigned int param_kw_base = param_kh_base \
            + (kh_slide_start+h_ker_half) * kernel_H_offset;
@@ -2967,7 +3119,7 @@ int NOINLINE Conv2dLayer (
               feat_id_base   +=  _layer->attributes[LAY_CONV_IN]/2;
             }
 
-            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp6) >> q_fraqP1);
+            outFeatures_ptr[(outFeaturesPerTile*c_out+0)*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue(temp6, shift, _layer->epilogue);
             param_kw_base += kernel_H_offset;
             feat_kw_base  += w_im_out*_layer->attributes[LAY_CONV_IN]/2;
           }
@@ -3022,6 +3174,7 @@ int NOINLINE Conv2dLayer (
   data_t * __restrict__ outFeatures) {
   //          printf("delete, just for test 4");
  int h_im_out = h_im;
+ int shift = layerShift(_layer);
  int w_im_out = w_im;
  int h_ker_half = (int)(_layer->attributes[LAY_CONV_KER]/2);
    int w_ker_half = h_ker_half; // TODO: symmetric kernel only
@@ -3119,7 +3272,7 @@ int NOINLINE Conv2dLayer (
                                     + (kh+h_ker_half) * kernel_H_offset\
                                     +(kw+w_ker_half)*kernel_W_offset)] \
                                   * inFeatures[((h_out+kh)*w_im_out* _layer->attributes[LAY_CONV_IN]\
-                                  +(w_out+kw)* _layer->attributes[LAY_CONV_IN] + i)]));// >> (q_fraqP1));
+                                  +(w_out+kw)* _layer->attributes[LAY_CONV_IN] + i)]));// >> (shift));
 
 #endif // FixedPt
 
@@ -3133,10 +3286,10 @@ int NOINLINE Conv2dLayer (
 
 
 #ifdef SIMD
-                            outFeatures[outFeaturesPerTile*c_out*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp) >> q_fraqP1)+ _layer->parameters[CONV_BIAS][outFeaturesPerTile*c_out];
-               // outFeatures[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp1) >> q_fraqP1)+ _layer->parameters[CONV_BIAS][(outFeaturesPerTile*c_out+1)];
+                            outFeatures[outFeaturesPerTile*c_out*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue((((int32_t)temp) >> shift)+ _layer->parameters[CONV_BIAS][outFeaturesPerTile*c_out], 0, _layer->epilogue);
+               // outFeatures[(outFeaturesPerTile*c_out+1)*h_im_out*w_im_out+h_out*w_im_out+w_out] = (((int32_t)temp1) >> shift)+ _layer->parameters[CONV_BIAS][(outFeaturesPerTile*c_out+1)];
 #else
-                            outFeatures[c_out*h_im_out*w_im_out+h_out*w_im_out+w_out] = (temp >> (q_fraqP1))+ _layer->parameters[CONV_BIAS][c_out];
+                            outFeatures[c_out*h_im_out*w_im_out+h_out*w_im_out+w_out] = shiftAndEpilogue((temp >> (shift))+ _layer->parameters[CONV_BIAS][c_out], 0, _layer->epilogue);
 #endif // end SIMD
                           }
                         }
@@ -3173,7 +3326,7 @@ int NOINLINE Conv2dLayer (
  *  @param inFeaturesSize1 Input FM size for layer 1
  *  @param inFeaturesSize2 Input FM size for layer 2
  *  @param outFeaturesSize Output FM size
- *  @param activationFunction Type of activation Function (tanh, sigmoid, none)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
  *  @param weight1 pointer to weight parameters of layer 1
  *  @param weight2 pointer to weight parameters of layer 2
  *  @param bias1 pointer to bias parametsr of layer 1
@@ -3181,12 +3334,47 @@ int NOINLINE Conv2dLayer (
  *  @param inFeatures1 pointer to input FM of layer 1
  *  @param inFeatures2 pointer to input FM of layer 2
  *  @param outFeatures pointer where to write to the output FM
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (see struct tiling)
  */
 #ifdef FixedPt
-#if defined FixedPt && defined FMOUTTILING && !defined VLIWEXT && defined ASIP
+#if defined HOST_SIMD && defined SIMD // x86 host
+void NOINLINE TwoLinearLayersAccumulate (
+        // Layer Attributes
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue, 
+        // Layer Parameters
+  data_t * __restrict__ weight1,
+  data_t * __restrict__ weight2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+        // Input and Output Features
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling)
+{
+  PROFILING_TWOLINEAR_START
+  (void)tiling; // blocks of HOST_OUTPUTBUFFER neurons for all the tilings
+  int inFeaturesSize1P2=inFeaturesSize1/2;
+  int inFeaturesSize2P2=inFeaturesSize2/2;
+  int32_t temp[HOST_OUTPUTBUFFER];
+  for (int o_tile=0; o_tile<outFeaturesSize; o_tile+=HOST_OUTPUTBUFFER) 
+  {
+    int outFeaturesPerTile = Min(outFeaturesSize-o_tile, HOST_OUTPUTBUFFER);
+    for (int o_rel=0; o_rel<outFeaturesPerTile; o_rel++)
+      temp[o_rel] = ((int32_t)bias1[o_tile+o_rel]+(int32_t)bias2[o_tile+o_rel])<<(shift);
+    // AVX-512/AVX2/SSE2 (see hostMatVecAcc)
+    hostMatVecAcc(outFeaturesPerTile, inFeaturesSize1P2, &((v2s*)weight1)[inFeaturesSize1P2*o_tile], (v2s*)inFeatures1, temp);
+    hostMatVecAcc(outFeaturesPerTile, inFeaturesSize2P2, &((v2s*)weight2)[inFeaturesSize2P2*o_tile], (v2s*)inFeatures2, temp);
+    hostShiftEpilogueN(temp, outFeaturesPerTile, shift, epilogue, &outFeatures[o_tile]);
+  }
+  PROFILING_TWOLINEAR_END
+}
+#elif defined FixedPt && defined FMOUTTILING && !defined VLIWEXT && defined ASIP
                     void NOINLINE TwoLinearLayersAccumulate (
         // Layer Attributes
-                      int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, int activationFunction, 
+                      int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue, 
         // Layer Parameters
                       data_t * __restrict__ weight1,
                       data_t * __restrict__ weight2,
@@ -3195,7 +3383,9 @@ int NOINLINE Conv2dLayer (
         // Input and Output Features
                       data_t * __restrict__ inFeatures1,
                       data_t * __restrict__ inFeatures2,
-                      data_t * __restrict__ outFeatures)
+                      data_t * __restrict__ outFeatures,
+                      int shift,
+                      struct tiling tiling)
                     {
                       int tileOptions[] = {10,8,4,2, 1};
 
@@ -3218,16 +3408,16 @@ int NOINLINE Conv2dLayer (
                       for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
                         int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;int32_t register_attribute re;
                         int32_t register_attribute rf;int32_t register_attribute rg;int32_t register_attribute rh;int32_t register_attribute ri;int32_t register_attribute rj;
-                        ra = ((int32_t)bias1[o_tile*outFeaturesPerTile+0]+(int32_t)bias2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-                        rb = ((int32_t)bias1[o_tile*outFeaturesPerTile+1]+(int32_t)bias2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-                        rc = ((int32_t)bias1[o_tile*outFeaturesPerTile+2]+(int32_t)bias2[o_tile*outFeaturesPerTile+2])<<(q_fraqP1);
-                        rd = ((int32_t)bias1[o_tile*outFeaturesPerTile+3]+(int32_t)bias2[o_tile*outFeaturesPerTile+3])<<(q_fraqP1);
-                        re = ((int32_t)bias1[o_tile*outFeaturesPerTile+4]+(int32_t)bias2[o_tile*outFeaturesPerTile+4])<<(q_fraqP1);
-                        rf = ((int32_t)bias1[o_tile*outFeaturesPerTile+5]+(int32_t)bias2[o_tile*outFeaturesPerTile+5])<<(q_fraqP1);
-                        rg = ((int32_t)bias1[o_tile*outFeaturesPerTile+6]+(int32_t)bias2[o_tile*outFeaturesPerTile+6])<<(q_fraqP1);
-                        rh = ((int32_t)bias1[o_tile*outFeaturesPerTile+7]+(int32_t)bias2[o_tile*outFeaturesPerTile+7])<<(q_fraqP1);
-                        ri = ((int32_t)bias1[o_tile*outFeaturesPerTile+8]+(int32_t)bias2[o_tile*outFeaturesPerTile+8])<<(q_fraqP1);
-                        rj = ((int32_t)bias1[o_tile*outFeaturesPerTile+9]+(int32_t)bias2[o_tile*outFeaturesPerTile+9])<<(q_fraqP1);
+                        ra = ((int32_t)bias1[o_tile*outFeaturesPerTile+0]+(int32_t)bias2[o_tile*outFeaturesPerTile+0])<<(shift);
+                        rb = ((int32_t)bias1[o_tile*outFeaturesPerTile+1]+(int32_t)bias2[o_tile*outFeaturesPerTile+1])<<(shift);
+                        rc = ((int32_t)bias1[o_tile*outFeaturesPerTile+2]+(int32_t)bias2[o_tile*outFeaturesPerTile+2])<<(shift);
+                        rd = ((int32_t)bias1[o_tile*outFeaturesPerTile+3]+(int32_t)bias2[o_tile*outFeaturesPerTile+3])<<(shift);
+                        re = ((int32_t)bias1[o_tile*outFeaturesPerTile+4]+(int32_t)bias2[o_tile*outFeaturesPerTile+4])<<(shift);
+                        rf = ((int32_t)bias1[o_tile*outFeaturesPerTile+5]+(int32_t)bias2[o_tile*outFeaturesPerTile+5])<<(shift);
+                        rg = ((int32_t)bias1[o_tile*outFeaturesPerTile+6]+(int32_t)bias2[o_tile*outFeaturesPerTile+6])<<(shift);
+                        rh = ((int32_t)bias1[o_tile*outFeaturesPerTile+7]+(int32_t)bias2[o_tile*outFeaturesPerTile+7])<<(shift);
+                        ri = ((int32_t)bias1[o_tile*outFeaturesPerTile+8]+(int32_t)bias2[o_tile*outFeaturesPerTile+8])<<(shift);
+                        rj = ((int32_t)bias1[o_tile*outFeaturesPerTile+9]+(int32_t)bias2[o_tile*outFeaturesPerTile+9])<<(shift);
 
                         for(int i=0; i<inFeaturesSize1P2; i++) { 
                           v2s inF_temp = ((v2s*)inFeatures1)[i];         
@@ -3259,75 +3449,30 @@ int NOINLINE Conv2dLayer (
 
       }
 
-#ifdef DOACTONTHEFLY
-      ra = ra>>(q_fraqP1);
-      rb = rb>>(q_fraqP1);
-      rc = rc>>(q_fraqP1);
-      rd = rd>>(q_fraqP1);
-      re = re>>(q_fraqP1);
-      rf = rf>>(q_fraqP1);
-      rg = rg>>(q_fraqP1);
-      rh = rh>>(q_fraqP1);
-      ri = ri>>(q_fraqP1);
-      rj = rj>>(q_fraqP1);
-      switch(activationFunction) {
-        case ACT_NONE: outFeatures[(o_tile*outFeaturesPerTile+0)] = ra; 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = rb;
-        outFeatures[(o_tile*outFeaturesPerTile+2)] = rc; 
-        outFeatures[(o_tile*outFeaturesPerTile+3)] = rd;
-        outFeatures[(o_tile*outFeaturesPerTile+4)] = re; 
-        outFeatures[(o_tile*outFeaturesPerTile+5)] = rf;
-        outFeatures[(o_tile*outFeaturesPerTile+6)] = rg; 
-        outFeatures[(o_tile*outFeaturesPerTile+7)] = rh;
-        outFeatures[(o_tile*outFeaturesPerTile+8)] = ri; 
-        outFeatures[(o_tile*outFeaturesPerTile+9)] = rj; break;
-        case ACT_TANH: outFeatures[(o_tile*outFeaturesPerTile+0)] = generic_tanh(ra); 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = generic_tanh(rb);
-        outFeatures[(o_tile*outFeaturesPerTile+2)] = generic_tanh(rc); 
-        outFeatures[(o_tile*outFeaturesPerTile+3)] = generic_tanh(rd);
-        outFeatures[(o_tile*outFeaturesPerTile+4)] = generic_tanh(re); 
-        outFeatures[(o_tile*outFeaturesPerTile+5)] = generic_tanh(rf);
-        outFeatures[(o_tile*outFeaturesPerTile+6)] = generic_tanh(rg); 
-        outFeatures[(o_tile*outFeaturesPerTile+7)] = generic_tanh(rh);
-        outFeatures[(o_tile*outFeaturesPerTile+8)] = generic_tanh(ri); 
-        outFeatures[(o_tile*outFeaturesPerTile+9)] = generic_tanh(rj); break;
-        case ACT_SIG:  outFeatures[(o_tile*outFeaturesPerTile+0)] = generic_sig(ra); 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = generic_sig(rb);
-        outFeatures[(o_tile*outFeaturesPerTile+2)] = generic_sig(rc); 
-        outFeatures[(o_tile*outFeaturesPerTile+3)] = generic_sig(rd);
-        outFeatures[(o_tile*outFeaturesPerTile+4)] = generic_sig(re); 
-        outFeatures[(o_tile*outFeaturesPerTile+5)] = generic_sig(rf);
-        outFeatures[(o_tile*outFeaturesPerTile+6)] = generic_sig(rg); 
-        outFeatures[(o_tile*outFeaturesPerTile+7)] = generic_sig(rh);
-        outFeatures[(o_tile*outFeaturesPerTile+8)] = generic_sig(ri); 
-        outFeatures[(o_tile*outFeaturesPerTile+9)] = generic_sig(rj); break;
-      }
-#else
-      outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1); 
-      outFeatures[(o_tile*outFeaturesPerTile+1)] = rb>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+2)] = rc>>(q_fraqP1); 
-      outFeatures[(o_tile*outFeaturesPerTile+3)] = rd>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+4)] = re>>(q_fraqP1); 
-      outFeatures[(o_tile*outFeaturesPerTile+5)] = rf>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+6)] = rg>>(q_fraqP1); 
-      outFeatures[(o_tile*outFeaturesPerTile+7)] = rh>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+8)] = ri>>(q_fraqP1); 
-      outFeatures[(o_tile*outFeaturesPerTile+9)] = rj>>(q_fraqP1); 
-#endif
+      outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+1)] = shiftAndEpilogue(rb, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+2)] = shiftAndEpilogue(rc, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+3)] = shiftAndEpilogue(rd, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+4)] = shiftAndEpilogue(re, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+5)] = shiftAndEpilogue(rf, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+6)] = shiftAndEpilogue(rg, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+7)] = shiftAndEpilogue(rh, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+8)] = shiftAndEpilogue(ri, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+9)] = shiftAndEpilogue(rj, shift, epilogue);
     }
 break; // case 10
 case 8:
 for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
   int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;int32_t register_attribute re;
   int32_t register_attribute rf;int32_t register_attribute rg;int32_t register_attribute rh;int32_t register_attribute ri;int32_t register_attribute rj;
-  ra = ((int32_t)bias1[o_tile*outFeaturesPerTile+0]+(int32_t)bias2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-  rb = ((int32_t)bias1[o_tile*outFeaturesPerTile+1]+(int32_t)bias2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-  rc = ((int32_t)bias1[o_tile*outFeaturesPerTile+2]+(int32_t)bias2[o_tile*outFeaturesPerTile+2])<<(q_fraqP1);
-  rd = ((int32_t)bias1[o_tile*outFeaturesPerTile+3]+(int32_t)bias2[o_tile*outFeaturesPerTile+3])<<(q_fraqP1);
-  re = ((int32_t)bias1[o_tile*outFeaturesPerTile+4]+(int32_t)bias2[o_tile*outFeaturesPerTile+4])<<(q_fraqP1);
-  rf = ((int32_t)bias1[o_tile*outFeaturesPerTile+5]+(int32_t)bias2[o_tile*outFeaturesPerTile+5])<<(q_fraqP1);
-  rg = ((int32_t)bias1[o_tile*outFeaturesPerTile+6]+(int32_t)bias2[o_tile*outFeaturesPerTile+6])<<(q_fraqP1);
-  rh = ((int32_t)bias1[o_tile*outFeaturesPerTile+7]+(int32_t)bias2[o_tile*outFeaturesPerTile+7])<<(q_fraqP1);
+  ra = ((int32_t)bias1[o_tile*outFeaturesPerTile+0]+(int32_t)bias2[o_tile*outFeaturesPerTile+0])<<(shift);
+  rb = ((int32_t)bias1[o_tile*outFeaturesPerTile+1]+(int32_t)bias2[o_tile*outFeaturesPerTile+1])<<(shift);
+  rc = ((int32_t)bias1[o_tile*outFeaturesPerTile+2]+(int32_t)bias2[o_tile*outFeaturesPerTile+2])<<(shift);
+  rd = ((int32_t)bias1[o_tile*outFeaturesPerTile+3]+(int32_t)bias2[o_tile*outFeaturesPerTile+3])<<(shift);
+  re = ((int32_t)bias1[o_tile*outFeaturesPerTile+4]+(int32_t)bias2[o_tile*outFeaturesPerTile+4])<<(shift);
+  rf = ((int32_t)bias1[o_tile*outFeaturesPerTile+5]+(int32_t)bias2[o_tile*outFeaturesPerTile+5])<<(shift);
+  rg = ((int32_t)bias1[o_tile*outFeaturesPerTile+6]+(int32_t)bias2[o_tile*outFeaturesPerTile+6])<<(shift);
+  rh = ((int32_t)bias1[o_tile*outFeaturesPerTile+7]+(int32_t)bias2[o_tile*outFeaturesPerTile+7])<<(shift);
 
 
   for(int i=0; i<inFeaturesSize1P2; i++)
@@ -3357,2145 +3502,2641 @@ for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
           SDOTP_GENERIC(rh, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+7)) + i]);
         }
 
-#ifdef DOACTONTHEFLY
-        ra = ra>>(q_fraqP1);
-        rb = rb>>(q_fraqP1);
-        rc = rc>>(q_fraqP1);
-        rd = rd>>(q_fraqP1);
-        re = re>>(q_fraqP1);
-        rf = rf>>(q_fraqP1);
-        rg = rg>>(q_fraqP1);
-        rh = rh>>(q_fraqP1);
-        switch(activationFunction) {
-          case ACT_NONE: outFeatures[(o_tile*outFeaturesPerTile+0)] = ra; 
-          outFeatures[(o_tile*outFeaturesPerTile+1)] = rb;
-          outFeatures[(o_tile*outFeaturesPerTile+2)] = rc; 
-          outFeatures[(o_tile*outFeaturesPerTile+3)] = rd;
-          outFeatures[(o_tile*outFeaturesPerTile+4)] = re; 
-          outFeatures[(o_tile*outFeaturesPerTile+5)] = rf;
-          outFeatures[(o_tile*outFeaturesPerTile+6)] = rg; 
-          outFeatures[(o_tile*outFeaturesPerTile+7)] = rh; break;
-          case ACT_TANH: outFeatures[(o_tile*outFeaturesPerTile+0)] = generic_tanh(ra); 
-          outFeatures[(o_tile*outFeaturesPerTile+1)] = generic_tanh(rb);
-          outFeatures[(o_tile*outFeaturesPerTile+2)] = generic_tanh(rc); 
-          outFeatures[(o_tile*outFeaturesPerTile+3)] = generic_tanh(rd);
-          outFeatures[(o_tile*outFeaturesPerTile+4)] = generic_tanh(re); 
-          outFeatures[(o_tile*outFeaturesPerTile+5)] = generic_tanh(rf);
-          outFeatures[(o_tile*outFeaturesPerTile+6)] = generic_tanh(rg); 
-          outFeatures[(o_tile*outFeaturesPerTile+7)] = generic_tanh(rh); break;
-          case ACT_SIG:  outFeatures[(o_tile*outFeaturesPerTile+0)] = generic_sig(ra); 
-          outFeatures[(o_tile*outFeaturesPerTile+1)] = generic_sig(rb);
-          outFeatures[(o_tile*outFeaturesPerTile+2)] = generic_sig(rc); 
-          outFeatures[(o_tile*outFeaturesPerTile+3)] = generic_sig(rd);
-          outFeatures[(o_tile*outFeaturesPerTile+4)] = generic_sig(re); 
-          outFeatures[(o_tile*outFeaturesPerTile+5)] = generic_sig(rf);
-          outFeatures[(o_tile*outFeaturesPerTile+6)] = generic_sig(rg); 
-          outFeatures[(o_tile*outFeaturesPerTile+7)] = generic_sig(rh); break;
-        }
+        outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
+        outFeatures[(o_tile*outFeaturesPerTile+1)] = shiftAndEpilogue(rb, shift, epilogue);
+        outFeatures[(o_tile*outFeaturesPerTile+2)] = shiftAndEpilogue(rc, shift, epilogue);
+        outFeatures[(o_tile*outFeaturesPerTile+3)] = shiftAndEpilogue(rd, shift, epilogue);
+        outFeatures[(o_tile*outFeaturesPerTile+4)] = shiftAndEpilogue(re, shift, epilogue);
+        outFeatures[(o_tile*outFeaturesPerTile+5)] = shiftAndEpilogue(rf, shift, epilogue);
+        outFeatures[(o_tile*outFeaturesPerTile+6)] = shiftAndEpilogue(rg, shift, epilogue);
+        outFeatures[(o_tile*outFeaturesPerTile+7)] = shiftAndEpilogue(rh, shift, epilogue);
+      }
+break; // case 8
+
+case 4:
+for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
+  int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;int32_t register_attribute re;
+  int32_t register_attribute rf;int32_t register_attribute rg;int32_t register_attribute rh;int32_t register_attribute ri;int32_t register_attribute rj;
+  ra = ((int32_t)bias1[o_tile*outFeaturesPerTile+0]+(int32_t)bias2[o_tile*outFeaturesPerTile+0])<<(shift);
+  rb = ((int32_t)bias1[o_tile*outFeaturesPerTile+1]+(int32_t)bias2[o_tile*outFeaturesPerTile+1])<<(shift);
+  rc = ((int32_t)bias1[o_tile*outFeaturesPerTile+2]+(int32_t)bias2[o_tile*outFeaturesPerTile+2])<<(shift);
+  rd = ((int32_t)bias1[o_tile*outFeaturesPerTile+3]+(int32_t)bias2[o_tile*outFeaturesPerTile+3])<<(shift);
+
+
+
+
+
+  for(int i=0; i<inFeaturesSize1P2; i++)
+  {
+    v2s inF_temp = ((v2s*)inFeatures1)[i];         
+    SDOTP_GENERIC(ra, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+0)) + i]);
+    SDOTP_GENERIC(rb, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+1)) + i]);
+    SDOTP_GENERIC(rc, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+2)) + i]);
+    SDOTP_GENERIC(rd, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+3)) + i]);
+
+      } // for(int i=0; i<inFeaturesSizeP2; i++)
+      
+      for(int i=0; i<inFeaturesSize2P2; i++)
+      {
+        v2s inF_temp = ((v2s*)inFeatures2)[i];         
+        SDOTP_GENERIC(ra, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+0)) + i]);
+        SDOTP_GENERIC(rb, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+1)) + i]);
+        SDOTP_GENERIC(rc, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+2)) + i]);
+        SDOTP_GENERIC(rd, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+3)) + i]);
+      }
+
+      outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+1)] = shiftAndEpilogue(rb, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+2)] = shiftAndEpilogue(rc, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+3)] = shiftAndEpilogue(rd, shift, epilogue);
+    }
+break; // case 4
+
+
+case 2:
+for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
+  int32_t register_attribute ra;int32_t register_attribute rb;
+  ra = ((int32_t)bias1[o_tile*outFeaturesPerTile+0]+(int32_t)bias2[o_tile*outFeaturesPerTile+0])<<(shift);
+  rb = ((int32_t)bias1[o_tile*outFeaturesPerTile+1]+(int32_t)bias2[o_tile*outFeaturesPerTile+1])<<(shift);   
+  for(int i=0; i<inFeaturesSize1P2; i++)
+  {
+    v2s inF_temp = ((v2s*)inFeatures1)[i];         
+    SDOTP_GENERIC(ra, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+0)) + i]);
+    SDOTP_GENERIC(rb, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+1)) + i]);
+      } // for(int i=0; i<inFeaturesSizeP2; i++)
+
+      for(int i=0; i<inFeaturesSize2P2; i++)
+      {
+
+        v2s inF_temp = ((v2s*)inFeatures2)[i];         
+        SDOTP_GENERIC(ra, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+0)) + i]);
+        SDOTP_GENERIC(rb, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+1)) + i]);      
+      }
+      outFeatures[(o_tile*outFeaturesPerTile+0)] = shiftAndEpilogue(ra, shift, epilogue);
+      outFeatures[(o_tile*outFeaturesPerTile+1)] = shiftAndEpilogue(rb, shift, epilogue);
+    }
+break; // case 2
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+} // swtich(outFeaturesPerTile)
+} // TwoLinearLayersAccumulate
+
+ ///////////////////////////////////////////////////////////////////////////////////////////////
+ //         _____  _______ ______  _______ _______ _______      _    _        _____ _  _  _   //
+ // |      |     | |_____| |     \ |  |  | |_____| |             \  /  |        |   |  |  |   //
+ // |_____ |_____| |     | |_____/ |  |  | |     | |_____         \/   |_____ __|__ |__|__|   //
+ //                                                                                           //
+ /////////////////////////////////////////////////////////////////////////////////////////////// 
+#elif !defined(ASIP) && defined(SIMD) && defined(FMOUTTILING)
+TILE_KERNEL_FAMILY(TWOLINEAR_TILE_KERNEL)
+/// TwoLinearLayersAccumulate kernels of all the output FM tile sizes (index: tile size)
+static void (* const twoLinearLayersAccumulateTiles[TILE_MAXSIZE+1])(int, int, int, struct epilogue, data_t *, data_t *,
+  data_t *, data_t *, data_t *, data_t *, data_t *, int, int) = TILE_KERNEL_TABLE(TwoLinearLayersAccumulateTile);
+
+/** @brief Calculates two Linear Layers and accumulates them on-the-fly. (PULP and VLIW implementation)
+ *  This is a helper function for efficient LSTM implementation. It calculates two linear layers in
+ *  parallel and accumulates them on-the-fly. The kernel of each tile size is generated from the
+ *  template in tileKernel.h.
+ *  Supported Configurations:
+ *  SIMD (with or without VLIW)
+ *  FMOUTTILING true with output tile sizes 1..16 (selected per layer)
+ *  FMINTILING false, true (selected per layer)
+ *
+ *  @param inFeaturesSize1 Input FM size for layer 1
+ *  @param inFeaturesSize2 Input FM size for layer 2
+ *  @param outFeaturesSize Output FM size
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param weight1 pointer to weight parameters of layer 1
+ *  @param weight2 pointer to weight parameters of layer 2
+ *  @param bias1 pointer to bias parametsr of layer 1
+ *  @param bias2 pointer to bias parametsr of layer 2
+ *  @param inFeatures1 pointer to input FM of layer 1
+ *  @param inFeatures2 pointer to input FM of layer 2
+ *  @param outFeatures pointer where to write to the output FM
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+void NOINLINE TwoLinearLayersAccumulate (
+        // Layer Attributes
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue, 
+        // Layer Parameters
+  data_t * __restrict__ weight1,
+  data_t * __restrict__ weight2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+        // Input and Output Features
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling)
+{
+
+  PROFILING_TWOLINEAR_START
+
+  int inTiling = tilingInTiling(tiling);
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(tiling), tileOptions);
+
+  int inFeaturesSize1P2 = inFeaturesSize1/2;
+  int inFeaturesSize2P2 = inFeaturesSize2/2;
+  data_t  * bias_ptr1   = bias1;
+  data_t  * bias_ptr2   = bias2;
+  v2s     * weight_ptr1 = (v2s*)weight1;
+  v2s     * weight_ptr2 = (v2s*)weight2;
+  data_t  * outFeatures_ptr = outFeatures;
+  int outFeaturesPerTile = 1;
+
+  int outFeatureTiles;
+  int outFeaturesSize_remain = outFeaturesSize;
+
+  for(int i=0; i<numTileOptions; i++) {
+    outFeaturesPerTile = tileOptions[i];
+    outFeatureTiles = outFeaturesSize_remain/outFeaturesPerTile;
+    if(outFeatureTiles == 0) continue;
+
+    twoLinearLayersAccumulateTiles[outFeaturesPerTile](outFeatureTiles, inFeaturesSize1P2, inFeaturesSize2P2, epilogue,
+      (data_t*)weight_ptr1, (data_t*)weight_ptr2, bias_ptr1, bias_ptr2, inFeatures1, inFeatures2, outFeatures_ptr, shift, inTiling);
+
+    // update pointer for next iteration
+    bias_ptr1               = &bias_ptr1[outFeatureTiles*outFeaturesPerTile];
+    bias_ptr2               = &bias_ptr2[outFeatureTiles*outFeaturesPerTile];
+    weight_ptr1             = &weight_ptr1[(inFeaturesSize1P2*(outFeatureTiles*outFeaturesPerTile))];
+    weight_ptr2             = &weight_ptr2[(inFeaturesSize2P2*(outFeatureTiles*outFeaturesPerTile))];
+    outFeatures_ptr         = &outFeatures_ptr[(outFeatureTiles*outFeaturesPerTile)];
+    outFeaturesSize_remain -= outFeatureTiles*outFeaturesPerTile;
+    if (outFeaturesSize_remain==0) break;
+  }
+  PROFILING_TWOLINEAR_END
+}
+ ///////////////////////////////////////////////////////////////////////////////////////////////
+ // ______  _______ _______ _______ _     _        _______      _____ _______  _____          //
+ // |     \ |______ |______ |_____| |     | |         |           |   |  |  | |_____] |       //
+ // |_____/ |______ |       |     | |_____| |_____    |         __|__ |  |  | |       |_____  //
+ //                                                                                           //
+ ///////////////////////////////////////////////////////////////////////////////////////////////
+#else // no FM Tiling or not ASIP
+/** @brief Calculates Two Linear Layers which are accumulated.
+ *
+ *  Some networks like LSTM calculate a FC layer for two different input (e.g. x and c)
+ *  which are then summed together to calculate the output feature map. 
+ *  This is an optimization to avoid storing back all the intermediate output FM's to
+ *  calculate the 2nd layer.
+ *
+ *  @param inFeaturesSize1 Number of input neurons of the FC layer 1
+ *  @param inFeaturesSize2 Number of input neurons of the FC layer 2
+ *  @param outFeaturesSize Number of output neurons
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param weight1 Weights of FC1
+ *  @param weight2 Weights of FC2
+ *  @param bias1 Bias FC1
+ *  @param bias2 Bias FC2
+ *  @param inFeatures1 Pointer to input FM for FC1
+ *  @param inFeatures2 Pointer to input FM for FC2
+ *  @param outFeatures Pointer where to store output FM
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+void NOINLINE TwoLinearLayersAccumulate (
+        // Layer Attributes
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue, 
+        // Layer Parameters
+  data_t * __restrict__ weight1,
+  data_t * __restrict__ weight2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+        // Input and Output Features
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling)
+{
+
+
+  PROFILING_TWOLINEAR_START
+  (void)tiling; // no tiling
+  int inFeaturesSize1P2=inFeaturesSize1/2;
+  int inFeaturesSize2P2=inFeaturesSize2/2;
+  for (int o=0; o< outFeaturesSize; o++) 
+  {
+    outFeatures[o] = True?
+    bias1[o]+bias2[o]:
+    ((data_t)0);
+    int32_t temp;
+    temp = ((int32_t)bias1[o]+(int32_t)bias2[o])<<(shift);
+
+#ifdef SIMD
+
+    for(int i=0; i<inFeaturesSize1P2; i++)
+#else
+      for(int i=0; i<inFeaturesSize1; i++)
+#endif
+      {
+#ifdef SIMD
+#ifdef ASIP 
+        temp = temp + ((v2s*)inFeatures1)[i] * ((v2s*)weight1)[(inFeaturesSize1P2*o) + i];
+#else //not ASIP
+        temp = __SUMDOTP2(((v2s*)inFeatures1)[i], ((v2s*)weight1)[(inFeaturesSize1P2*o) + i], temp);
+#endif //ASIP
+#else // not SIMD
+        temp += inFeatures1[i]*weight1[inFeaturesSize1*o + i];
+#endif  
+      }
+
+#ifdef SIMD
+      for(int i=0; i<inFeaturesSize2P2; i++)
 #else
-        outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1); 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = rb>>(q_fraqP1);
-        outFeatures[(o_tile*outFeaturesPerTile+2)] = rc>>(q_fraqP1); 
-        outFeatures[(o_tile*outFeaturesPerTile+3)] = rd>>(q_fraqP1);
-        outFeatures[(o_tile*outFeaturesPerTile+4)] = re>>(q_fraqP1); 
-        outFeatures[(o_tile*outFeaturesPerTile+5)] = rf>>(q_fraqP1);
-        outFeatures[(o_tile*outFeaturesPerTile+6)] = rg>>(q_fraqP1); 
-        outFeatures[(o_tile*outFeaturesPerTile+7)] = rh>>(q_fraqP1);
+        for(int i=0; i<inFeaturesSize2; i++)
+#endif
+        {
+#ifdef SIMD
+#ifdef ASIP 
+          temp = temp + ((v2s*)inFeatures2)[i] * ((v2s*)weight2)[(inFeaturesSize2P2*o) + i];
+#else // not ASIP
+          temp = __SUMDOTP2(((v2s*)inFeatures2)[i], ((v2s*)weight2)[(inFeaturesSize2P2*o) + i], temp);
+#endif //ASIP
+#else // not SIMD
+          temp += inFeatures2[i]*weight2[inFeaturesSize2*o + i];
+#endif // end SIMD
+
+        }
+
+
+
+        outFeatures[o] = shiftAndEpilogue(temp, shift, epilogue);
+
+
+
+      }
+      PROFILING_TWOLINEAR_END
+    }
+#endif
+#endif
+
+#ifndef FixedPt
+    void NOINLINE TwoLinearLayersAccumulate (
+        // Layer Attributes
+      int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+        // Layer Parameters
+      data_t * __restrict__ weight1,
+      data_t * __restrict__ weight2,
+      data_t * __restrict__ bias1,
+      data_t * __restrict__ bias2,
+        // Input and Output Features
+      data_t * __restrict__ inFeatures1,
+      data_t * __restrict__ inFeatures2,
+      data_t * __restrict__ outFeatures,
+      int shift,
+      struct tiling tiling)
+    {
+
+      PROFILING_TWOLINEAR_START
+      int inFeaturesSize1P2=inFeaturesSize1/2;
+      int inFeaturesSize2P2=inFeaturesSize2/2;
+      for (int o=0; o< outFeaturesSize; o++) 
+      {
+        outFeatures[o] = True?
+        bias1[o]+bias2[o]:
+        ((data_t)0);
+        data_t temp;
+        temp = bias1[o]+bias2[o];
+
+
+
+        for(int i=0; i<inFeaturesSize1; i++)
+        {
+         temp += inFeatures1[i]*weight1[inFeaturesSize1*o + i];
+       }
+       for(int i=0; i<inFeaturesSize2; i++)
+       {
+         temp += inFeatures2[i]*weight2[inFeaturesSize2*o + i];
+       }
+       outFeatures[o] = temp;
+
+     }
+     PROFILING_TWOLINEAR_END
+   }
 #endif
-      }
-break; // case 8
 
-case 4:
-for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
-  int32_t register_attribute ra;int32_t register_attribute rb;int32_t register_attribute rc;int32_t register_attribute rd;int32_t register_attribute re;
-  int32_t register_attribute rf;int32_t register_attribute rg;int32_t register_attribute rh;int32_t register_attribute ri;int32_t register_attribute rj;
-  ra = ((int32_t)bias1[o_tile*outFeaturesPerTile+0]+(int32_t)bias2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-  rb = ((int32_t)bias1[o_tile*outFeaturesPerTile+1]+(int32_t)bias2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-  rc = ((int32_t)bias1[o_tile*outFeaturesPerTile+2]+(int32_t)bias2[o_tile*outFeaturesPerTile+2])<<(q_fraqP1);
-  rd = ((int32_t)bias1[o_tile*outFeaturesPerTile+3]+(int32_t)bias2[o_tile*outFeaturesPerTile+3])<<(q_fraqP1);
 
 
 
 
+/** @brief Calculates point-wise Addition of Tensors (A+=B)
+ *
+ *  With SATURATE the sums saturate to the range of data_t (paddsw on the host, p.clip on RISC-Y)
+ *
+ *  @param TensorSize Input Value
+ *  @param FeaturesA Accumulation Tensor
+ *  @param FeaturesB Addend Tensor
+ */
+    void NOINLINE AddTensor (
+        // Layer Attributes
+      int TensorSize,
+        // Layer Parameters
+      data_t * __restrict__ FeaturesA,
+      data_t * __restrict__ FeaturesB)
+    {
+      PROFILING_ADDT_START
 
-  for(int i=0; i<inFeaturesSize1P2; i++)
-  {
-    v2s inF_temp = ((v2s*)inFeatures1)[i];         
-    SDOTP_GENERIC(ra, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+0)) + i]);
-    SDOTP_GENERIC(rb, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+1)) + i]);
-    SDOTP_GENERIC(rc, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+2)) + i]);
-    SDOTP_GENERIC(rd, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+3)) + i]);
+#ifdef ASIP
+  // TODO implement SIMD add on tzscale
+      for(int o=0; o<TensorSize; o++)
+        FeaturesA[o] = SATURATE_DATA(FeaturesA[o] + FeaturesB[o]);
 
-      } // for(int i=0; i<inFeaturesSizeP2; i++)
-      
-      for(int i=0; i<inFeaturesSize2P2; i++)
-      {
-        v2s inF_temp = ((v2s*)inFeatures2)[i];         
-        SDOTP_GENERIC(ra, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+0)) + i]);
-        SDOTP_GENERIC(rb, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+1)) + i]);
-        SDOTP_GENERIC(rc, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+2)) + i]);
-        SDOTP_GENERIC(rd, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+3)) + i]);
-      }
+      return;
+#else //ASIP
 
-#ifdef DOACTONTHEFLY
-      ra = ra>>(q_fraqP1);
-      rb = rb>>(q_fraqP1);
-      rc = rc>>(q_fraqP1);
-      rd = rd>>(q_fraqP1);
-      switch(activationFunction) {
-        case ACT_NONE: outFeatures[(o_tile*outFeaturesPerTile+0)] = ra; 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = rb;
-        outFeatures[(o_tile*outFeaturesPerTile+2)] = rc; 
-        outFeatures[(o_tile*outFeaturesPerTile+3)] = rd; break;
-        case ACT_TANH: outFeatures[(o_tile*outFeaturesPerTile+0)] = generic_tanh(ra); 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = generic_tanh(rb);
-        outFeatures[(o_tile*outFeaturesPerTile+2)] = generic_tanh(rc); 
-        outFeatures[(o_tile*outFeaturesPerTile+3)] = generic_tanh(rd); break;
-        case ACT_SIG:  outFeatures[(o_tile*outFeaturesPerTile+0)] = generic_sig(ra); 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = generic_sig(rb);
-        outFeatures[(o_tile*outFeaturesPerTile+2)] = generic_sig(rc); 
-        outFeatures[(o_tile*outFeaturesPerTile+3)] = generic_sig(rd); break;
-      }
+#if defined SATURATE && defined FixedPt && defined HOST
+      // paddsw
+      hostAddClip16N(FeaturesA, FeaturesB, TensorSize);
+#elif defined SATURATE && defined FixedPt
+      // no saturating pv.add => add and p.clip per element
+      for(int o=0; o<TensorSize; o++)
+        FeaturesA[o] = CLIP16(FeaturesA[o] + FeaturesB[o]);
+#elif defined SIMD
+      int TensorSizeP2 = TensorSize/2;
+      v2s * SIMD_FeaturesA = (v2s*) FeaturesA;
+      v2s * SIMD_FeaturesB = (v2s*) FeaturesB;
+      for(int o=0; o<TensorSizeP2; o++)
+        SIMD_FeaturesA[o] += SIMD_FeaturesB[o];
 #else
-      outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1); 
-      outFeatures[(o_tile*outFeaturesPerTile+1)] = rb>>(q_fraqP1);
-      outFeatures[(o_tile*outFeaturesPerTile+2)] = rc>>(q_fraqP1); 
-      outFeatures[(o_tile*outFeaturesPerTile+3)] = rd>>(q_fraqP1);
+      for(int o=0; o<TensorSize; o++)
+        FeaturesA[o] += FeaturesB[o];
+#endif
+      PROFILING_ADDT_END
 #endif
     }
-break; // case 4
-
-
-case 2:
-for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) {
-  int32_t register_attribute ra;int32_t register_attribute rb;
-  ra = ((int32_t)bias1[o_tile*outFeaturesPerTile+0]+(int32_t)bias2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-  rb = ((int32_t)bias1[o_tile*outFeaturesPerTile+1]+(int32_t)bias2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);   
-  for(int i=0; i<inFeaturesSize1P2; i++)
-  {
-    v2s inF_temp = ((v2s*)inFeatures1)[i];         
-    SDOTP_GENERIC(ra, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+0)) + i]);
-    SDOTP_GENERIC(rb, inF_temp, ((v2s*)weight1)[(inFeaturesSize1P2*(o_tile*outFeaturesPerTile+1)) + i]);
-      } // for(int i=0; i<inFeaturesSizeP2; i++)
 
-      for(int i=0; i<inFeaturesSize2P2; i++)
+/** @brief Calculates point-wise Multiplication of Tensors (A*=B) also known as Hadamard Product
+ *
+ *  With SATURATE the products saturate to the range of data_t
+ *
+ *  @param TensorSize Input Value
+ *  @param FeaturesA Accumulation Tensor
+ *  @param FeaturesB Multiplicand Tensor
+ */
+    void NOINLINE HadMulTensor (
+        // Layer Attributes
+      int TensorSize,
+        // Layer Parameters
+      data_t * __restrict__ FeaturesA,
+      data_t * __restrict__ FeaturesB)
+    {
+      PROFILING_HADM_START
+      for (int o=0; o< TensorSize; o++) 
       {
-
-        v2s inF_temp = ((v2s*)inFeatures2)[i];         
-        SDOTP_GENERIC(ra, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+0)) + i]);
-        SDOTP_GENERIC(rb, inF_temp, ((v2s*)weight2)[(inFeaturesSize2P2*(o_tile*outFeaturesPerTile+1)) + i]);      
-      }
-#ifdef DOACTONTHEFLY
-      ra = ra>>(q_fraqP1);
-      rb = rb>>(q_fraqP1);
-      switch(activationFunction) {
-        case ACT_NONE: outFeatures[(o_tile*outFeaturesPerTile+0)] = ra; 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = rb;  break;
-        case ACT_TANH: outFeatures[(o_tile*outFeaturesPerTile+0)] = generic_tanh(ra); 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = generic_tanh(rb);  break;
-        case ACT_SIG:  outFeatures[(o_tile*outFeaturesPerTile+0)] = generic_sig(ra); 
-        outFeatures[(o_tile*outFeaturesPerTile+1)] = generic_sig(rb); break;
-      }
+#ifdef FixedPt
+       FeaturesA[o] = SATURATE_DATA((FeaturesA[o]*FeaturesB[o])>>(q_fraqP1));
 #else
-      outFeatures[(o_tile*outFeaturesPerTile+0)] = ra>>(q_fraqP1);; 
-      outFeatures[(o_tile*outFeaturesPerTile+1)] = rb>>(q_fraqP1);;
+       FeaturesA[o] *= FeaturesB[o];
 #endif
-    }
-break; // case 2
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-} // swtich(outFeaturesPerTile)
-} // TwoLinearLayersAccumulate
+     }
+     PROFILING_HADM_END
+   }
 
- ///////////////////////////////////////////////////////////////////////////////////////////////
- //         _____  _______ ______  _______ _______ _______      _    _        _____ _  _  _   //
- // |      |     | |_____| |     \ |  |  | |_____| |             \  /  |        |   |  |  |   //
- // |_____ |_____| |     | |_____/ |  |  | |     | |_____         \/   |_____ __|__ |__|__|   //
- //                                                                                           //
- /////////////////////////////////////////////////////////////////////////////////////////////// 
-#elif !defined(ASIP) && defined(SIMD) && defined(VLIWEXT) && defined(FMOUTTILING)
-/** @brief Calculates two Linear Layers and accumulates them on-the-fly. (PULP and VLIW implementation)
- *  This is a helper function for efficient LSTM implementation. It calculates two linear layers in
- *  parallel and accumulates them on-the-fly.
- *  Supported Configurations:
- *  VLIW+SIMD
- *  FMOUTTILING false, true
- *  FMINTILING true
+
+/** @brief Copy of Tensor A to B
  *
- *  @param inFeaturesSize1 Input FM size for layer 1
- *  @param inFeaturesSize2 Input FM size for layer 2
- *  @param outFeaturesSize Output FM size
- *  @param activationFunction Type of activation Function (tanh, sigmoid, none)
- *  @param weight1 pointer to weight parameters of layer 1
- *  @param weight2 pointer to weight parameters of layer 2
- *  @param bias1 pointer to bias parametsr of layer 1
- *  @param bias2 pointer to bias parametsr of layer 2
- *  @param inFeatures1 pointer to input FM of layer 1
- *  @param inFeatures2 pointer to input FM of layer 2
- *  @param outFeatures pointer where to write to the output FM
+ *  @param TensorSize Input Value
+ *  @param FeaturesA Source Tensor
+ *  @param FeaturesB Destination Tensor
  */
-void NOINLINE TwoLinearLayersAccumulate (
+   void NOINLINE CopyTensor (
         // Layer Attributes
-  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, int activationFunction, 
+    int TensorSize,
         // Layer Parameters
-  data_t * __restrict__ weight1,
-  data_t * __restrict__ weight2,
-  data_t * __restrict__ bias1,
-  data_t * __restrict__ bias2,
-        // Input and Output Features
-  data_t * __restrict__ inFeatures1,
-  data_t * __restrict__ inFeatures2,
-  data_t * __restrict__ outFeatures)
+    data_t * __restrict__ FeaturesA,
+    data_t * __restrict__ FeaturesB)
+   {
+    PROFILING_COPY_START
+    for (int o=0; o< TensorSize; o++) 
+    {
+      FeaturesA[o] = FeaturesB[o];
+    }
+    PROFILING_COPY_END
+  }
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Branch-free Tanh() and sig() for TanhLayer and SigLayer (same results as the scalar functions)
+// mac = (m[id]*|x|+q[id])>>ACT_LUT_FRAC with id = |x|>>shift, the sign and the saturation (id >= ACT_LUT_SEGMENTS)
+// select the result with masks: tanh(x<0) = ~mac, sig(x<0) = 0.999+~mac, saturated: 1, -1 (tanh) or 0 (sig)
+/////////////////////////////////////////////////////////////////////////////////////////////
+/// Offset of the negative inputs and saturation value of the negative inputs of tanh and sigmoid
+#define PWL_TANH_NEGOFS 0
+#define PWL_TANH_SATNEG (-(1<<ACT_LUT_FRAC))
+#define PWL_SIG_NEGOFS  ((1<<ACT_LUT_FRAC)-1)
+#define PWL_SIG_SATNEG  0
+
+/** @brief Branch-free piecewise linear activation of one value (Tanh() or sig(), see PWL_TANH_NEGOFS)
+ */
+static inline data_t pwlAct(data_t x, const short * m, const int * q, int shift, int negOfs, int satNeg)
 {
+  int s = x>>15;                   // 0 or -1
+  int a = (x^s)-s;                 // |x|
+  int id = a>>shift;
+  int sat = -(id>=lut_numelements);
+  int mac = (m[id&(ACT_LUT_SEGMENTS-1)]*a+q[id&(ACT_LUT_SEGMENTS-1)])>>ACT_LUT_FRAC;
+  return ((((1<<ACT_LUT_FRAC)&~s)|(satNeg&s))&sat) | (((mac^s)+(negOfs&s))&~sat);
+}
 
+#if defined HOST_SIMD && defined FixedPt && defined __SSSE3__ // x86 host
+/// pshufb tables of 16 entries
+#define PWL_CHUNKS ((ACT_LUT_SEGMENTS+15)/16)
+/// 16-bit entries of a LUT selected by the byte indices in ctrl (pshufb of the low and the high bytes)
+#define PWL_LOOKUP128(lo, hi, ctrl) _mm_or_si128(_mm_and_si128(_mm_shuffle_epi8(lo, ctrl), _mm_set1_epi16(0xff)), _mm_slli_epi16(_mm_shuffle_epi8(hi, ctrl), 8))
+#define PWL_LOOKUP256(lo, hi, ctrl) _mm256_or_si256(_mm256_and_si256(_mm256_shuffle_epi8(lo, ctrl), _mm256_set1_epi16(0xff)), _mm256_slli_epi16(_mm256_shuffle_epi8(hi, ctrl), 8))
 
-  PROFILING_TWOLINEAR_START
+/** @brief pshufb tables and parameters of pwlAct on the x86 host (see hostPwlInit)
+ *
+ *  The LUT is split into the bytes of m, q>>F and q&(2^F-1) with F = ACT_LUT_FRAC (16 entries per
+ *  table, larger LUTs select the table with id>>4).
+ */
+struct hostPwlLut {
+#if defined __AVX2__
+  __m256i t256[PWL_CHUNKS][6];
+#endif
+  __m128i t128[PWL_CHUNKS][6];
+  int shift, negOfs, satNeg;
+};
+
+/** @brief Fills the pshufb tables of the LUT m, q (parameters as pwlAct)
+ */
+static void hostPwlInit(struct hostPwlLut * lut, const short * m, const int * q, int shift, int negOfs, int satNeg)
+{
+  uint8_t tab[PWL_CHUNKS][6][16] = {0}; // m, q>>F and q&(2^F-1), low and high byte
+  for(int k=0; k<ACT_LUT_SEGMENTS; k++) {
+    uint8_t * t = &tab[k/16][0][k%16];
+    t[0*16] = m[k]&0xff;                 t[1*16] = (m[k]>>8)&0xff;
+    t[2*16] = (q[k]>>ACT_LUT_FRAC)&0xff; t[3*16] = (q[k]>>(ACT_LUT_FRAC+8))&0xff;
+    t[4*16] = q[k]&0xff;                 t[5*16] = (q[k]>>8)&((1<<(ACT_LUT_FRAC-8))-1);
+  }
+  for(int c=0; c<PWL_CHUNKS; c++)
+    for(int k=0; k<6; k++) {
+#if defined __AVX2__
+      lut->t256[c][k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)tab[c][k]));
+#endif
+      lut->t128[c][k] = _mm_loadu_si128((const __m128i*)tab[c][k]);
+    }
+  lut->shift = shift;
+  lut->negOfs = negOfs;
+  lut->satNeg = satNeg;
+}
+
+#if defined __AVX2__
+/** @brief pwlAct of 16 values with the pshufb lookup (AVX2)
+ *
+ *  m*|x| is formed from pmullw/pmulhw such that all the operations are 16 bit:
+ *  mac = (q>>F) + (hi<<(16-F)) + (lo>>F) + (((lo&(2^F-1))+(q&(2^F-1)))>>F).
+ */
+static inline __m256i hostPwl256(__m256i v, const struct hostPwlLut * lut)
+{
+  __m256i s   = _mm256_srai_epi16(v, 15);
+  __m256i a   = _mm256_sub_epi16(_mm256_xor_si256(v, s), s);
+  __m256i id  = _mm256_srli_epi16(a, lut->shift);
+  __m256i sat = _mm256_cmpgt_epi16(id, _mm256_set1_epi16(ACT_LUT_SEGMENTS-1));
+  __m256i ctrl = _mm256_and_si256(id, _mm256_set1_epi16(0xf));
+  ctrl = _mm256_or_si256(ctrl, _mm256_slli_epi16(ctrl, 8));
+  __m256i mm = PWL_LOOKUP256(lut->t256[0][0], lut->t256[0][1], ctrl);
+  __m256i qh = PWL_LOOKUP256(lut->t256[0][2], lut->t256[0][3], ctrl);
+  __m256i ql = PWL_LOOKUP256(lut->t256[0][4], lut->t256[0][5], ctrl);
+#if PWL_CHUNKS > 1
+  for(int c=1; c<PWL_CHUNKS; c++) {
+    __m256i sel = _mm256_cmpeq_epi16(_mm256_srli_epi16(id, 4), _mm256_set1_epi16(c));
+    mm = _mm256_blendv_epi8(mm, PWL_LOOKUP256(lut->t256[c][0], lut->t256[c][1], ctrl), sel);
+    qh = _mm256_blendv_epi8(qh, PWL_LOOKUP256(lut->t256[c][2], lut->t256[c][3], ctrl), sel);
+    ql = _mm256_blendv_epi8(ql, PWL_LOOKUP256(lut->t256[c][4], lut->t256[c][5], ctrl), sel);
+  }
+#endif
+  __m256i lo = _mm256_mullo_epi16(mm, a);
+  __m256i mac = _mm256_add_epi16(qh, _mm256_slli_epi16(_mm256_mulhi_epi16(mm, a), 16-ACT_LUT_FRAC));
+  mac = _mm256_add_epi16(mac, _mm256_srli_epi16(lo, ACT_LUT_FRAC));
+  mac = _mm256_add_epi16(mac, _mm256_srli_epi16(_mm256_add_epi16(_mm256_and_si256(lo, _mm256_set1_epi16((1<<ACT_LUT_FRAC)-1)), ql), ACT_LUT_FRAC));
+  mac = _mm256_add_epi16(_mm256_xor_si256(mac, s), _mm256_and_si256(_mm256_set1_epi16(lut->negOfs), s));
+  __m256i satVal = _mm256_blendv_epi8(_mm256_set1_epi16(1<<ACT_LUT_FRAC), _mm256_set1_epi16(lut->satNeg), s);
+  return _mm256_blendv_epi8(mac, satVal, sat);
+}
+#endif
+
+/** @brief pwlAct of 8 values with the pshufb lookup (SSSE3, see hostPwl256)
+ */
+static inline __m128i hostPwl128(__m128i v, const struct hostPwlLut * lut)
+{
+  __m128i s   = _mm_srai_epi16(v, 15);
+  __m128i a   = _mm_sub_epi16(_mm_xor_si128(v, s), s);
+  __m128i id  = _mm_srli_epi16(a, lut->shift);
+  __m128i sat = _mm_cmpgt_epi16(id, _mm_set1_epi16(ACT_LUT_SEGMENTS-1));
+  __m128i ctrl = _mm_and_si128(id, _mm_set1_epi16(0xf));
+  ctrl = _mm_or_si128(ctrl, _mm_slli_epi16(ctrl, 8));
+  __m128i mm = PWL_LOOKUP128(lut->t128[0][0], lut->t128[0][1], ctrl);
+  __m128i qh = PWL_LOOKUP128(lut->t128[0][2], lut->t128[0][3], ctrl);
+  __m128i ql = PWL_LOOKUP128(lut->t128[0][4], lut->t128[0][5], ctrl);
+#if PWL_CHUNKS > 1
+  for(int c=1; c<PWL_CHUNKS; c++) {
+    __m128i sel = _mm_cmpeq_epi16(_mm_srli_epi16(id, 4), _mm_set1_epi16(c));
+    mm = _mm_or_si128(_mm_andnot_si128(sel, mm), _mm_and_si128(sel, PWL_LOOKUP128(lut->t128[c][0], lut->t128[c][1], ctrl)));
+    qh = _mm_or_si128(_mm_andnot_si128(sel, qh), _mm_and_si128(sel, PWL_LOOKUP128(lut->t128[c][2], lut->t128[c][3], ctrl)));
+    ql = _mm_or_si128(_mm_andnot_si128(sel, ql), _mm_and_si128(sel, PWL_LOOKUP128(lut->t128[c][4], lut->t128[c][5], ctrl)));
+  }
+#endif
+  __m128i lo = _mm_mullo_epi16(mm, a);
+  __m128i mac = _mm_add_epi16(qh, _mm_slli_epi16(_mm_mulhi_epi16(mm, a), 16-ACT_LUT_FRAC));
+  mac = _mm_add_epi16(mac, _mm_srli_epi16(lo, ACT_LUT_FRAC));
+  mac = _mm_add_epi16(mac, _mm_srli_epi16(_mm_add_epi16(_mm_and_si128(lo, _mm_set1_epi16((1<<ACT_LUT_FRAC)-1)), ql), ACT_LUT_FRAC));
+  mac = _mm_add_epi16(_mm_xor_si128(mac, s), _mm_and_si128(_mm_set1_epi16(lut->negOfs), s));
+  __m128i satVal = _mm_or_si128(_mm_andnot_si128(s, _mm_set1_epi16(1<<ACT_LUT_FRAC)), _mm_and_si128(s, _mm_set1_epi16(lut->satNeg)));
+  return _mm_or_si128(_mm_and_si128(sat, satVal), _mm_andnot_si128(sat, mac));
+}
+
+/** @brief In-place pwlAct of n values on the x86 host, 16 (AVX2) or 8 (SSSE3) values per iteration
+ *
+ *  The LUT is held in registers and looked up with pshufb (see hostPwlInit and hostPwl256).
+ */
+static void hostPwlActN(data_t * x, int n, const short * m, const int * q, int shift, int negOfs, int satNeg)
+{
+  struct hostPwlLut lut;
+  hostPwlInit(&lut, m, q, shift, negOfs, satNeg);
+  int i = 0;
+#if defined __AVX2__
+  for(; i+16<=n; i+=16)
+    _mm256_storeu_si256((__m256i*)&x[i], hostPwl256(_mm256_loadu_si256((const __m256i*)&x[i]), &lut));
+#endif
+  for(; i+8<=n; i+=8)
+    _mm_storeu_si128((__m128i*)&x[i], hostPwl128(_mm_loadu_si128((const __m128i*)&x[i]), &lut));
+  for(; i<n; i++)
+    x[i] = pwlAct(x[i], m, q, shift, negOfs, satNeg);
+}
+#elif defined SIMD && defined FixedPt && !defined ASIP && !defined PULP_USETANHSIG // the callers use pl.tanh/pl.sig otherwise
+/// Unsigned packed 2x16-bit vector (logical shifts of pwlActV2s)
+typedef unsigned short pwl_v2u __attribute__((vector_size (4)));
+
+/** @brief In-place pwlAct of n values, a v2s pair per iteration (RISC-Y without pl.tanh/pl.sig)
+ *
+ *  Sign, absolute value, LUT index, saturation and the selection of the result are packed SIMD
+ *  operations, the two MACs are done per lane (no packed 16x16->32 multiplication).
+ */
+static void pwlActV2s(data_t * x, int n, const short * m, const int * q, int shift, int negOfs, int satNeg)
+{
+  v2s vNegOfs = {negOfs, negOfs};
+  v2s vSatPos = {1<<ACT_LUT_FRAC, 1<<ACT_LUT_FRAC};
+  v2s vSatNeg = {satNeg, satNeg};
+  v2s vMaxId = {ACT_LUT_SEGMENTS-1, ACT_LUT_SEGMENTS-1};
+  for(int i=0; i<n/2; i++) {
+    v2s v = ((v2s*)x)[i];
+    v2s s = v>>15;
+    v2s a = (v^s)-s;
+    v2s id = (v2s)((pwl_v2u)a>>shift);
+    v2s sat = id>vMaxId;
+    int id0 = id[0]&(ACT_LUT_SEGMENTS-1), id1 = id[1]&(ACT_LUT_SEGMENTS-1);
+    v2s mac = {(m[id0]*(unsigned short)a[0]+q[id0])>>ACT_LUT_FRAC, (m[id1]*(unsigned short)a[1]+q[id1])>>ACT_LUT_FRAC};
+    mac = (mac^s)+(vNegOfs&s);
+    ((v2s*)x)[i] = (((vSatPos&~s)|(vSatNeg&s))&sat) | (mac&~sat);
+  }
+  if(n%2 == 1)
+    x[n-1] = pwlAct(x[n-1], m, q, shift, negOfs, satNeg);
+}
+#endif
+
+/** @brief In-Place application of tangent hyperbolic on Tensor
+ *
+ *  Without the tzscale extension: pshufb lookup on the x86 host (HOST_SIMD), pl.tanh on RISC-Y
+ *  (PULP_USETANHSIG), else the branch-free Tanh() on v2s pairs, all with the same results as Tanh()
+ *
+ *  @param TensorSize Input Value
+ *  @param Features Input and Output of Activation Fucntion
+ */
+#ifdef ASIP_USETANHSIG
+  void NOINLINE TanhLayer (
+        // Layer Attributes
+    int TensorSize,
+    data_t * __restrict__ Features)
+  {
+    PROFILING_TANH_START
+    for(int i=0; i<TensorSize; i++) {
+      Features[i] = tzscale_tanh(Features[i]); //tzscale_tanh(Features[i],0);
+    }
+    PROFILING_TANH_END
+  }
+#else
+  void NOINLINE TanhLayer (
+        // Layer Attributes
+    int TensorSize,
+    data_t * __restrict__ Features)
+  {
+    PROFILING_TANH_START
+#if defined HOST_SIMD && defined FixedPt && defined __SSSE3__
+    hostPwlActN(Features, TensorSize, lut_Tanh_m, lut_Tanh_q, ACT_LUT_TANH_SHIFT, PWL_TANH_NEGOFS, PWL_TANH_SATNEG);
+#elif defined PULP_USETANHSIG
+    for (int o=0; o< TensorSize; o++) 
+      Features[o] = generic_tanh(Features[o]);
+#elif defined SIMD && defined FixedPt && !defined ASIP
+    pwlActV2s(Features, TensorSize, lut_Tanh_m, lut_Tanh_q, ACT_LUT_TANH_SHIFT, PWL_TANH_NEGOFS, PWL_TANH_SATNEG);
+#else
+    for (int o=0; o< TensorSize; o++) 
+      Features[o] = Tanh(Features[o]);
+#endif
+    PROFILING_TANH_END
+  }
+#endif
 
-#if OUTPUTBUFFER > 8
-  int tileOptions[] = {OUTPUTBUFFER,8,4,2,1};
-#elif OUTPUTBUFFER > 4
-  int tileOptions[] = {OUTPUTBUFFER,4,2,1};
+
+
+/** @brief In-Place application of sigmoid activation on Tensor
+ *
+ *  Implementations like TanhLayer, same results as sig()
+ *
+ *  @param TensorSize Input Value
+ *  @param Features Input and Output of Activation Fucntion
+ */
+#ifdef ASIP_USETANHSIG
+  void NOINLINE SigLayer (
+        // Layer Attributes
+    int TensorSize,
+    data_t * __restrict__ Features)
+  {
+    PROFILING_TANH_START
+
+    for(int i=0; i<TensorSize; i++) {
+      //ext_nop();chess_separator_scheduler();
+      Features[i] = tzscale_sig(Features[i]); //tzscale_tanh(Features[i],0);
+    }
+    PROFILING_TANH_END
+  }
+#else
+  void NOINLINE SigLayer (
+        // Layer Attributes
+    int TensorSize,
+    data_t * __restrict__ Features)
+  {
+    PROFILING_TANH_START
+#if defined HOST_SIMD && defined FixedPt && defined __SSSE3__
+    hostPwlActN(Features, TensorSize, lut_sig_m, lut_sig_q, ACT_LUT_SIG_SHIFT, PWL_SIG_NEGOFS, PWL_SIG_SATNEG);
+#elif defined PULP_USETANHSIG
+    for (int o=0; o< TensorSize; o++) 
+      Features[o] = generic_sig(Features[o]);
+#elif defined SIMD && defined FixedPt && !defined ASIP
+    pwlActV2s(Features, TensorSize, lut_sig_m, lut_sig_q, ACT_LUT_SIG_SHIFT, PWL_SIG_NEGOFS, PWL_SIG_SATNEG);
 #else
-  int tileOptions[] = {OUTPUTBUFFER,2,1};
+    for (int o=0; o< TensorSize; o++) 
+      Features[o] = sig(Features[o]);
+#endif
+    PROFILING_TANH_END
+  }
 #endif
 
 
 
-// todo add loop tiling
-  data_t * bias_ptr1   = bias1;
-
-  data_t * bias_ptr2   = bias2;
-
-  data_t  * outFeatures_ptr = outFeatures;
-  int outFeaturesPerTile = 1;
-
-  register int32_t   temp0, temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8, temp9, temp10, temp11, temp12, temp13, temp14;
-  register uint32_t  addr0, addr1, addr2, addr3, addr4, addr5, addr6, addr7, addr8, addr9, addr10, addr11, addr12, addr13, addr14;
-  register uint32_t  in_addr;
-  register int x0 asm("x0");
-  int outFeatureTiles;
-  int outFeaturesSize_remain = outFeaturesSize;
-  v2s     * weight_ptr; 
-  v2s     * weight_ptr1=(v2s*)weight1;
-  v2s     * weight_ptr2=(v2s*)weight2;
-  int inFeaturesSizeP2, inFeaturesSizeP4;
-  data_t     * inFeatures;
-
-  for(unsigned int i=0; i<sizeof(tileOptions)/sizeof(int); i++) {
-    outFeaturesPerTile = tileOptions[i];
-    outFeatureTiles = outFeaturesSize_remain/outFeaturesPerTile;
-    if(outFeatureTiles == 0) continue;
-
-    switch(outFeaturesPerTile) {
-   #if OUTPUTBUFFER > 2
-     case OUTPUTBUFFER:
-
-     for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-     {
-        // printf("o_tile=%i\n", o_tile);
-        #if OUTPUTBUFFER > 2
-      temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 3
-      temp1 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 4
-      temp2 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+2]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+2])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 5
-      temp3 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+3]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+3])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 6
-      temp4 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+4]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+4])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 7
-      temp5 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+5]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+5])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 8
-      temp6 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+6]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+6])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 9
-      temp7 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+7]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+7])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 10
-      temp8 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+8]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+8])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 11
-      temp9 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+9]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+9])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 12
-      temp10 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+10]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+10])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 13
-      temp11 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+11]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+11])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 14
-      temp12 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+12]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+12])<<(q_fraqP1);
-        #endif
-      temp13 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+OUTPUTBUFFER-2]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+OUTPUTBUFFER-2])<<(q_fraqP1);
-      temp14 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+OUTPUTBUFFER-1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+OUTPUTBUFFER-1])<<(q_fraqP1);
-
-
-
-      for(int turn=0; turn<2; turn++) {
-        if(turn==0) {
-          weight_ptr = weight_ptr1;
-          inFeaturesSizeP2 = inFeaturesSize1/2;
-          inFeatures = inFeatures1;
-        #ifdef FMINTILING
-        inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        #endif
-      } else {
-        weight_ptr = weight_ptr2;
-        inFeatures = inFeatures2;
-        inFeaturesSizeP2 = inFeaturesSize2/2;
-        #ifdef FMINTILING
-        inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        #endif
-      }
-
 
 
-      addr0  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 0))];
-      addr1  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 1))];
-      addr2  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 2))];
-      addr3  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 3))];
-      addr4  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 4))];
-      addr5  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 5))];
-      addr6  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 6))];
-      addr7  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 7))];
-      addr8  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 8))];
-      addr9  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 9))];
-      addr10 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+10))];
-      addr11 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+11))];
-      addr12 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+12))];
-      addr13 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+OUTPUTBUFFER-2))];
-      addr14 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+OUTPUTBUFFER-1))];
-        asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-        asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
-        in_addr = (uint32_t)(((v2s*)inFeatures));
-        for(int i=0; i<inFeaturesSizeP4; i++) {
-          v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-          v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
-
-
-            // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-#ifdef FMINTILING
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-#endif
-            // MANUAL loop unfolding
-            // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-            // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-             #if OUTPUTBUFFER > 2
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 3
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 4
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 5
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 6
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 7
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp) ); 
-             #endif
-             #if OUTPUTBUFFER > 9
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr8) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 9
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr9) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 10
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp8),  "+r" (addr10) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 11
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp9),  "+r" (addr11) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 12
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp10),  "+r" (addr12) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 13
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp11),  "+r" (addr13) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 14
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp12),  "+r" (addr14) : "r" (inF_temp) );
-             #endif
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp13),  "+r" (addr0) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp14),  "+r" (addr1) : "r" (inF_temp) );
-
-#ifdef FMINTILING
-             #if OUTPUTBUFFER > 2
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 3
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 4
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 5
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 6
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 7
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp2) ); 
-             #endif
-             #if OUTPUTBUFFER > 9
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr8) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 9
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr9) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 10
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp8),  "+r" (addr10) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 11
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp9),  "+r" (addr11) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 12
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp10),  "+r" (addr12) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 13
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp11),  "+r" (addr13) : "r" (inF_temp2) );
-             #endif
-             #if OUTPUTBUFFER > 14
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp12),  "+r" (addr14) : "r" (inF_temp2) );
-             #endif
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp13),  "+r" (addr0) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp14),  "+r" (addr1) : "r" (inF_temp2) );
+/////////////////////////////////////////////////////////////////////////////////////////////
+// ReLU, leaky ReLU, hard sigmoid and hard tanh with the clamping of an epilogue on SIMD vectors
+// (ActivationLayer and the output stage of LinearLayer on the host, same results as generic_act)
+/////////////////////////////////////////////////////////////////////////////////////////////
+/// Slope of ACT_LEAKY_RELU of an epilogue (0: LEAKY_RELU_SLOPE)
+#define EPILOGUE_SLOPE(epilogue) ((epilogue).slope ? (epilogue).slope : LEAKY_RELU_SLOPE)
+/// Bound of the clamping of an epilogue in the range of data_t (packed 16-bit min/max)
+#define EPILOGUE_BOUND(x) ((x) < -32768 ? -32768 : ((x) > 32767 ? 32767 : (x)))
+
+#if defined HOST_SIMD && defined FixedPt // x86 host
+#if defined __AVX2__
+/** @brief ReLU, leaky ReLU, hard sigmoid or hard tanh and clamping (epilogue) of 16 values (AVX2)
+ *
+ *  The leaky ReLU (x*slope)>>q_frac is formed from pmulhw/pmullw, the hard sigmoid x*HSIG_SLOPE>>16
+ *  is pmulhw, the rest are packed min/max. Other activations are left to the caller (clamping only).
+ */
+static inline __m256i hostAct256(__m256i v, int act, int slope, int clamp, int clampMin, int clampMax)
+{
+  switch(act) {
+    case ACT_RELU: v = _mm256_max_epi16(v, _mm256_setzero_si256()); break;
+    case ACT_LEAKY_RELU: {
+      __m256i vSlope = _mm256_set1_epi16(slope);
+      __m256i neg = _mm256_or_si256(_mm256_slli_epi16(_mm256_mulhi_epi16(v, vSlope), 16-q_frac), _mm256_srli_epi16(_mm256_mullo_epi16(v, vSlope), q_frac));
+      v = _mm256_blendv_epi8(v, neg, _mm256_srai_epi16(v, 15));
+      break; }
+    case ACT_HSIG:
+      v = _mm256_add_epi16(_mm256_mulhi_epi16(v, _mm256_set1_epi16(HSIG_SLOPE)), _mm256_set1_epi16(1<<(q_frac-1)));
+      v = _mm256_min_epi16(_mm256_max_epi16(v, _mm256_setzero_si256()), _mm256_set1_epi16(1<<q_frac));
+      break;
+    case ACT_HTANH: v = _mm256_min_epi16(_mm256_max_epi16(v, _mm256_set1_epi16(-(1<<q_frac))), _mm256_set1_epi16(1<<q_frac)); break;
+  }
+  if(clamp)
+    v = _mm256_min_epi16(_mm256_max_epi16(v, _mm256_set1_epi16(clampMin)), _mm256_set1_epi16(clampMax));
+  return v;
+}
 #endif
-          // }
-          }
-#ifdef FMINTILING
-        if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-                    v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-            // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-            // asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-            
-            // MANUAL loop unfolding
-            // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-            // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-             #if OUTPUTBUFFER > 2
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 3
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 4
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 5
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 6
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 7
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp) ); 
-             #endif
-             #if OUTPUTBUFFER > 9
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr8) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 9
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr9) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 10
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp8),  "+r" (addr10) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 11
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp9),  "+r" (addr11) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 12
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp10),  "+r" (addr12) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 13
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp11),  "+r" (addr13) : "r" (inF_temp) );
-             #endif
-             #if OUTPUTBUFFER > 14
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp12),  "+r" (addr14) : "r" (inF_temp) );
-             #endif
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp13),  "+r" (addr0) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp14),  "+r" (addr1) : "r" (inF_temp) );
 
-          }
+/** @brief ReLU, leaky ReLU, hard sigmoid or hard tanh and clamping (epilogue) of 8 values (SSE2, see
+ *  hostAct256)
+ */
+static inline __m128i hostAct128(__m128i v, int act, int slope, int clamp, int clampMin, int clampMax)
+{
+  switch(act) {
+    case ACT_RELU: v = _mm_max_epi16(v, _mm_setzero_si128()); break;
+    case ACT_LEAKY_RELU: {
+      __m128i vSlope = _mm_set1_epi16(slope);
+      __m128i neg = _mm_or_si128(_mm_slli_epi16(_mm_mulhi_epi16(v, vSlope), 16-q_frac), _mm_srli_epi16(_mm_mullo_epi16(v, vSlope), q_frac));
+      __m128i s = _mm_srai_epi16(v, 15);
+      v = _mm_or_si128(_mm_and_si128(s, neg), _mm_andnot_si128(s, v));
+      break; }
+    case ACT_HSIG:
+      v = _mm_add_epi16(_mm_mulhi_epi16(v, _mm_set1_epi16(HSIG_SLOPE)), _mm_set1_epi16(1<<(q_frac-1)));
+      v = _mm_min_epi16(_mm_max_epi16(v, _mm_setzero_si128()), _mm_set1_epi16(1<<q_frac));
+      break;
+    case ACT_HTANH: v = _mm_min_epi16(_mm_max_epi16(v, _mm_set1_epi16(-(1<<q_frac))), _mm_set1_epi16(1<<q_frac)); break;
+  }
+  if(clamp)
+    v = _mm_min_epi16(_mm_max_epi16(v, _mm_set1_epi16(clampMin)), _mm_set1_epi16(clampMax));
+  return v;
+}
 
+/** @brief ReLU, leaky ReLU, hard sigmoid or hard tanh and clamping (epilogue) of n values on the x86
+ *  host, 16 (AVX2) or 8 (SSE2) values per iteration
+ */
+static void hostActN(data_t * inFeatures, data_t * outFeatures, int n, struct epilogue epilogue)
+{
+  int act = epilogue.act, slope = EPILOGUE_SLOPE(epilogue), clamp = epilogue.clampMin != epilogue.clampMax;
+  int clampMin = EPILOGUE_BOUND(epilogue.clampMin), clampMax = EPILOGUE_BOUND(epilogue.clampMax);
+  int i = 0;
+#if defined __AVX2__
+  for(; i+16<=n; i+=16)
+    _mm256_storeu_si256((__m256i*)&outFeatures[i], hostAct256(_mm256_loadu_si256((const __m256i*)&inFeatures[i]), act, slope, clamp, clampMin, clampMax));
 #endif
-} // loop for fm1 and fm2
-      // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-              #if OUTPUTBUFFER > 2
-outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 3
-outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = shiftAndAct(temp1, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 4
-outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = shiftAndAct(temp2, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 5
-outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = shiftAndAct(temp3, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 6
-outFeatures_ptr[(o_tile*outFeaturesPerTile+4)] = shiftAndAct(temp4, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 7
-outFeatures_ptr[(o_tile*outFeaturesPerTile+5)] = shiftAndAct(temp5, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 8
-outFeatures_ptr[(o_tile*outFeaturesPerTile+6)] = shiftAndAct(temp6, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 9
-outFeatures_ptr[(o_tile*outFeaturesPerTile+7)] = shiftAndAct(temp7, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 10
-outFeatures_ptr[(o_tile*outFeaturesPerTile+8)] = shiftAndAct(temp8, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 11
-outFeatures_ptr[(o_tile*outFeaturesPerTile+9)] = shiftAndAct(temp9, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 12
-outFeatures_ptr[(o_tile*outFeaturesPerTile+10)] = shiftAndAct(temp10, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 13
-outFeatures_ptr[(o_tile*outFeaturesPerTile+11)] = shiftAndAct(temp11, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 14
-outFeatures_ptr[(o_tile*outFeaturesPerTile+12)] = shiftAndAct(temp12, activationFunction);
-              #endif
-outFeatures_ptr[(o_tile*outFeaturesPerTile+OUTPUTBUFFER-2)] = shiftAndAct(temp13, activationFunction);
-outFeatures_ptr[(o_tile*outFeaturesPerTile+OUTPUTBUFFER-1)] = shiftAndAct(temp14, activationFunction);
-              // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-      // }
-
+  for(; i+8<=n; i+=8)
+    _mm_storeu_si128((__m128i*)&outFeatures[i], hostAct128(_mm_loadu_si128((const __m128i*)&inFeatures[i]), act, slope, clamp, clampMin, clampMax));
+  for(; i<n; i++)
+    outFeatures[i] = shiftAndEpilogue(inFeatures[i], 0, epilogue);
 }
-break;
-   #endif
-   #if OUTPUTBUFFER > 8
-case 8:
 
-for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
+/** @brief Output stage of LinearLayer and TwoLinearLayersAccumulate on the x86 host: out[i] =
+ *  shiftAndEpilogue(acc[i], shift, epilogue) for n accumulators, 16 (AVX2) or 8 (SSE2) per iteration
+ *
+ *  The accumulators are shifted with psrad and packed to data_t (packssdw saturates with SATURATE,
+ *  else the low 16 bits are sign-extended first to wrap around), the activation (hostPwl256 for
+ *  tanh and sigmoid, hostAct256) and the clamping are applied in the registers before the store.
+ *  Tanh and sigmoid without SSSE3 (no pshufb) are scalar.
+ */
+static void hostShiftEpilogueN(const int32_t * acc, int n, int shift, struct epilogue epilogue, data_t * out)
 {
-
-  temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-  temp1 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-  temp2 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+2]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+2])<<(q_fraqP1);
-  temp3 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+3]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+3])<<(q_fraqP1);
-  temp4 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+4]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+4])<<(q_fraqP1);
-  temp5 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+5]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+5])<<(q_fraqP1);
-  temp6 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+6]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+6])<<(q_fraqP1);
-  temp7 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+7]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+7])<<(q_fraqP1);
-
-        // }
-        // printf("wght=%i, addr before=%i (+%i)=%i\n", weight, addr0, inFeaturesSizeP2*outFeaturesPerTile, addr0+4*inFeaturesSizeP2*outFeaturesPerTile);
-  for(int turn=0; turn<2; turn++) {
-    if(turn==0) {
-      weight_ptr = weight_ptr1;
-      inFeaturesSizeP2 = inFeaturesSize1/2;
-      inFeatures = inFeatures1;
-        #ifdef FMINTILING
-        inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        #endif
-      } else {
-        weight_ptr = weight_ptr2;
-        inFeatures = inFeatures2;
-        inFeaturesSizeP2 = inFeaturesSize2/2;
-        #ifdef FMINTILING
-        inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        #endif
-      }
-      addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-      addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-      addr2 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-      addr3 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-      addr4 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+4))];
-      addr5 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+5))];
-      addr6 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+6))];
-      addr7 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+7))];
-
-
-        asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-        asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
-
-        in_addr = (((v2s*)inFeatures));
-        for(int i=0; i<inFeaturesSizeP4; i++) {
-          v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-          v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
-
-
-            // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-#ifdef FMINTILING
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
+  int act = epilogue.act, slope = EPILOGUE_SLOPE(epilogue), clamp = epilogue.clampMin != epilogue.clampMax;
+  int clampMin = EPILOGUE_BOUND(epilogue.clampMin), clampMax = EPILOGUE_BOUND(epilogue.clampMax);
+  int pwl = act == ACT_TANH || act == ACT_SIG;
+  int nVec = n;
+#if defined __SSSE3__
+  struct hostPwlLut lut;
+  if(act == ACT_TANH)
+    hostPwlInit(&lut, lut_Tanh_m, lut_Tanh_q, ACT_LUT_TANH_SHIFT, PWL_TANH_NEGOFS, PWL_TANH_SATNEG);
+  else if(act == ACT_SIG)
+    hostPwlInit(&lut, lut_sig_m, lut_sig_q, ACT_LUT_SIG_SHIFT, PWL_SIG_NEGOFS, PWL_SIG_SATNEG);
+#else
+  if(pwl)
+    nVec = 0;
 #endif
-            // MANUAL loop unfolding
-            // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-            // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp) ); 
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp) );
-#ifdef FMINTILING
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp2) ); 
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp2) );
+  __m128i vShift = _mm_cvtsi32_si128(shift);
+  int i = 0;
+#if defined __AVX2__
+  for(; i+16<=nVec; i+=16) {
+    __m256i lo = _mm256_sra_epi32(_mm256_loadu_si256((const __m256i*)&acc[i]), vShift);
+    __m256i hi = _mm256_sra_epi32(_mm256_loadu_si256((const __m256i*)&acc[i+8]), vShift);
+#ifndef SATURATE
+    lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+    hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
 #endif
-          // }
-          }
-#ifdef FMINTILING
-        if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-            v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr4) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr5) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp4),  "+r" (addr6) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp5),  "+r" (addr7) : "r" (inF_temp) ); 
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp6),  "+r" (addr0) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp7),  "+r" (addr1) : "r" (inF_temp) );
-
-          }
+    __m256i v = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8); // packssdw works per 128-bit lane
+    if(pwl)
+      v = hostPwl256(v, &lut);
+    _mm256_storeu_si256((__m256i*)&out[i], hostAct256(v, act, slope, clamp, clampMin, clampMax));
+  }
 #endif
-      } // fm in1 and in2
-      // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = shiftAndAct(temp1, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = shiftAndAct(temp2, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = shiftAndAct(temp3, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+4)] = shiftAndAct(temp4, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+5)] = shiftAndAct(temp5, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+6)] = shiftAndAct(temp6, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+7)] = shiftAndAct(temp7, activationFunction);
-      // }
-    }
-    break;
-   #endif
-   #if OUTPUTBUFFER > 4
-    case 4:
-
-    for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-    {
-
-      temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-      temp1 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-      temp2 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+2]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+2])<<(q_fraqP1);
-      temp3 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+3]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+3])<<(q_fraqP1);
-      for(int turn=0; turn<2; turn++) {
-        if(turn==0) {
-          weight_ptr = weight_ptr1;
-          inFeaturesSizeP2 = inFeaturesSize1/2;
-          inFeatures = inFeatures1;
-          #ifdef FMINTILING
-          inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-          #else
-          inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-          #endif
-        } else {
-          weight_ptr = weight_ptr2;
-          inFeatures = inFeatures2;
-          inFeaturesSizeP2 = inFeaturesSize2/2;
-          #ifdef FMINTILING
-          inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-          #else
-          inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-          #endif
-        }
-        // }
-        addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-        addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-        addr2 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-        addr3 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-
-
-       asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-       asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
-
-       in_addr = (uint32_t)(((v2s*)inFeatures));
-       for(int i=0; i<inFeaturesSizeP4; i++) {
-            v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-            v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
-
-
-            // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-#ifdef FMINTILING
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
+  for(; i+8<=nVec; i+=8) {
+    __m128i lo = _mm_sra_epi32(_mm_loadu_si128((const __m128i*)&acc[i]), vShift);
+    __m128i hi = _mm_sra_epi32(_mm_loadu_si128((const __m128i*)&acc[i+4]), vShift);
+#ifndef SATURATE
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
 #endif
-            // MANUAL loop unfolding
-            // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-            // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr0) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr1) : "r" (inF_temp) );
-#ifdef FMINTILING
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr0) : "r" (inF_temp2) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr1) : "r" (inF_temp2) );
+    __m128i v = _mm_packs_epi32(lo, hi);
+#if defined __SSSE3__
+    if(pwl)
+      v = hostPwl128(v, &lut);
 #endif
-          // }
-          }
-# ifdef FMINTILING
-        if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-            v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr2) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr3) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp2),  "+r" (addr0) : "r" (inF_temp) );
-            asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp3),  "+r" (addr1) : "r" (inF_temp) );
+    _mm_storeu_si128((__m128i*)&out[i], hostAct128(v, act, slope, clamp, clampMin, clampMax));
+  }
+  for(; i<n; i++)
+    out[i] = shiftAndEpilogue(acc[i], shift, epilogue);
+}
+#elif defined SIMD && defined FixedPt && !defined ASIP
+/// Packed max/min of v2s (select with the compare masks)
+#define V2S_MAX(a, b) (((a)&((a)>(b)))|((b)&~((a)>(b))))
+#define V2S_MIN(a, b) (((a)&((a)<(b)))|((b)&~((a)<(b))))
 
-          }
-# endif
-      } // fm in1 and in2
-      // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = shiftAndAct(temp1, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = shiftAndAct(temp2, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = shiftAndAct(temp3, activationFunction);
-              // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-      // }
+/** @brief ReLU, leaky ReLU, hard sigmoid or hard tanh and clamping (epilogue) of n values, a v2s
+ *  pair per iteration (RISC-Y)
+ *
+ *  ReLU, hard tanh and the clamping are packed SIMD operations, the multiplications of the leaky ReLU
+ *  and the hard sigmoid are done per lane (no packed 16x16->32 multiplication).
+ */
+static void actV2s(data_t * inFeatures, data_t * outFeatures, int n, struct epilogue epilogue)
+{
+  int act = epilogue.act, slope = EPILOGUE_SLOPE(epilogue), clamp = epilogue.clampMin != epilogue.clampMax;
+  v2s vMin = {EPILOGUE_BOUND(epilogue.clampMin), EPILOGUE_BOUND(epilogue.clampMin)};
+  v2s vMax = {EPILOGUE_BOUND(epilogue.clampMax), EPILOGUE_BOUND(epilogue.clampMax)};
+  v2s vZero = {0, 0};
+  v2s vOne = {1<<q_frac, 1<<q_frac};
+  v2s vMinusOne = {-(1<<q_frac), -(1<<q_frac)};
+  for(int i=0; i<n/2; i++) {
+    v2s v = ((v2s*)inFeatures)[i];
+    v2s s = v>>15;
+    switch(act) {
+      case ACT_RELU: v = v&~s; break;
+      case ACT_LEAKY_RELU: {
+        v2s neg = {(v[0]*slope)>>q_frac, (v[1]*slope)>>q_frac};
+        v = (neg&s)|(v&~s);
+        break; }
+      case ACT_HSIG: {
+        v2s t = {((v[0]*HSIG_SLOPE)>>16)+(1<<(q_frac-1)), ((v[1]*HSIG_SLOPE)>>16)+(1<<(q_frac-1))};
+        v = V2S_MIN(V2S_MAX(t, vZero), vOne);
+        break; }
+      case ACT_HTANH: v = V2S_MIN(V2S_MAX(v, vMinusOne), vOne); break;
     }
-    break;
+    if(clamp)
+      v = V2S_MIN(V2S_MAX(v, vMin), vMax);
+    ((v2s*)outFeatures)[i] = v;
+  }
+  if(n%2 == 1)
+    outFeatures[n-1] = shiftAndEpilogue(inFeatures[n-1], 0, epilogue);
+}
 #endif
-    case 2:
-
-    for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-    {
-
-      temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-      temp1 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-        // temp2 = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-        // temp3 = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-        // }
-
-      for(int turn=0; turn<2; turn++) {
-        if(turn==0) {
-          weight_ptr = &weight_ptr1[0];
-          inFeaturesSizeP2 = inFeaturesSize1/2;
-          inFeatures = inFeatures1;
-          #ifdef FMINTILING
-          inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-          #else
-          inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-          #endif
-        } else {
-          weight_ptr = &weight_ptr2[0];
-          inFeatures = inFeatures2;
-          inFeaturesSizeP2 = inFeaturesSize2/2;
-          #ifdef FMINTILING
-          inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-          #else
-          inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-          #endif
-        }
-        addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-        addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-        // addr2 = &((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-        // addr3 = &((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-        asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload no compute
-        asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload no compute
-        for(int i=0; i<inFeaturesSizeP2; i++) {
-          v2s inF_temp = ((v2s*)inFeatures)[i];
-          
-          // int o_rel;
-          // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-          asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (temp0),  "+r" (addr0) : "r" (inF_temp) );
-          asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (temp1),  "+r" (addr1) : "r" (inF_temp) );
-             // asm volatile("pl.sdotsp.h %0, %1, %2" : "+r" (temp2) : "r" (addr3), "r" (inF_temp) );
-             // asm volatile("pl.sdotsp.h %0, %1, %2" : "+r" (temp3) : "r" (addr0), "r" (inF_temp) );
-          // }
-        }
-      } // fm in1 in2 
-      // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = shiftAndAct(temp1, activationFunction);
-              // outFeatures[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-              // outFeatures[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-              // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-      // }
-
-    }
-    break;
-    case 1:
 
-
-    for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-    {
-     for(int turn=0; turn<2; turn++) {
-      if(turn==0) {
-        weight_ptr = &weight_ptr1[0];
-        inFeaturesSizeP2 = inFeaturesSize1/2;
-        inFeatures = inFeatures1;
-        #ifdef FMINTILING
-        inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        #endif
-      } else {
-        weight_ptr = &weight_ptr2[0];
-        inFeatures = inFeatures2;
-        inFeaturesSizeP2 = inFeaturesSize2/2;
-        #ifdef FMINTILING
-        inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        #endif
-      }
-      temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-      for(int i=0; i<inFeaturesSizeP2; i++) {
-        v2s inF_temp = ((v2s*)inFeatures)[i];
-        temp0 = __SUMDOTP2(inF_temp, ((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile)) + i], temp0);
-      }
-   } // fm in1 and in2 
-   outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
- }
- break;
-}
- // updat pointer for next iteration
-bias_ptr1                = &bias_ptr1[outFeatureTiles*outFeaturesPerTile];
-bias_ptr2                = &bias_ptr2[outFeatureTiles*outFeaturesPerTile];
-weight_ptr1              = &weight_ptr1[(inFeaturesSize1/2*(outFeatureTiles*outFeaturesPerTile))];
-weight_ptr2              = &weight_ptr2[(inFeaturesSize2/2*(outFeatureTiles*outFeaturesPerTile))];
-outFeatures_ptr         = &outFeatures_ptr[(outFeatureTiles*outFeaturesPerTile)];
-outFeaturesSize_remain -= outFeatureTiles*outFeaturesPerTile;
-if (outFeaturesSize_remain==0) break;
-}
-PROFILING_TWOLINEAR_END
-}
-#elif !defined(ASIP) && defined(SIMD) && !defined(VLIWEXT) && defined(FMOUTTILING)
-/** @brief Calculates two Linear Layers and accumulates them on-the-fly. (PULP and VLIW implementation)
- *  This is a helper function for efficient LSTM implementation. It calculates two linear layers in
- *  parallel and accumulates them on-the-fly.
- *  Supported Configurations:
- *  VLIW+SIMD
- *  FMOUTTILING false, true
- *  FMINTILING true
+/** @brief Element-wise activation and clamping of an epilogue (Activation layer, e.g. after an LSTM)
  *
- *  @param inFeaturesSize1 Input FM size for layer 1
- *  @param inFeaturesSize2 Input FM size for layer 2
- *  @param outFeaturesSize Output FM size
- *  @param activationFunction Type of activation Function (tanh, sigmoid, none)
- *  @param weight1 pointer to weight parameters of layer 1
- *  @param weight2 pointer to weight parameters of layer 2
- *  @param bias1 pointer to bias parametsr of layer 1
- *  @param bias2 pointer to bias parametsr of layer 2
- *  @param inFeatures1 pointer to input FM of layer 1
- *  @param inFeatures2 pointer to input FM of layer 2
- *  @param outFeatures pointer where to write to the output FM
+ *  Tanh and sigmoid with TanhLayer/SigLayer, ReLU, leaky ReLU, hard sigmoid, hard tanh and the
+ *  clamping with SSE2/AVX2 on the x86 host (HOST_SIMD) and with v2s on RISC-Y, all with the same
+ *  results as the fused epilogue of the Linear and Conv2d layers (shiftAndEpilogue).
+ *
+ *  @param TensorSize Number of neurons
+ *  @param inFeatures Input Feature Map
+ *  @param outFeatures Output Feature Map (may be inFeatures)
+ *  @param epilogue Activation and clamping (see struct epilogue)
  */
-void NOINLINE TwoLinearLayersAccumulate (
+void NOINLINE ActivationLayer (
         // Layer Attributes
-  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, int activationFunction, 
-        // Layer Parameters
-  data_t * __restrict__ weight1,
-  data_t * __restrict__ weight2,
-  data_t * __restrict__ bias1,
-  data_t * __restrict__ bias2,
+    int TensorSize,
         // Input and Output Features
-  data_t * __restrict__ inFeatures1,
-  data_t * __restrict__ inFeatures2,
-  data_t * __restrict__ outFeatures)
+    data_t * inFeatures,
+    data_t * outFeatures,
+    struct epilogue epilogue)
 {
-
-  PROFILING_TWOLINEAR_START
-
-#if OUTPUTBUFFER > 8
-  int tileOptions[] = {OUTPUTBUFFER,8,4,2,1};
-#elif OUTPUTBUFFER > 4
-  int tileOptions[] = {OUTPUTBUFFER,4,2,1};
+  if(epilogue.act == ACT_TANH || epilogue.act == ACT_SIG)
+  {
+    if(outFeatures != inFeatures)
+      CopyTensor(TensorSize, outFeatures, inFeatures);
+    if(epilogue.act == ACT_TANH)
+      TanhLayer(TensorSize, outFeatures);
+    else
+      SigLayer(TensorSize, outFeatures);
+    epilogue.act = ACT_NONE; // clamping only
+    inFeatures = outFeatures;
+  }
+#if defined HOST_SIMD && defined FixedPt
+  hostActN(inFeatures, outFeatures, TensorSize, epilogue);
+#elif defined SIMD && defined FixedPt && !defined ASIP
+  actV2s(inFeatures, outFeatures, TensorSize, epilogue);
 #else
-  int tileOptions[] = {OUTPUTBUFFER,2,1};
+  for (int o=0; o< TensorSize; o++)
+    outFeatures[o] = shiftAndEpilogue(inFeatures[o], 0, epilogue);
 #endif
+}
 
+/** @brief Fills Tensor with contstant
+ *
+ *  @param TensorSize Input Value
+ *  @param Tensor Input and Output of Activation Fucntion
+ *  @param fillValue constant value
+ */
+  void NOINLINE fillTensor (
+  // Layer Attributes
+    int TensorSize,
+    data_t * __restrict__ Tensor,
+    data_t fillValue)
+  {
+    PROFILING_FILL_START
+    for (int o=0; o< TensorSize; o++) 
+    {
+      Tensor[o] = fillValue;
+    }
+    PROFILING_FILL_END
+  }
 
 
-// todo add loop tiling
-  data_t * bias_ptr1   = bias1;
-
-  data_t * bias_ptr2   = bias2;
-
-  data_t  * outFeatures_ptr = outFeatures;
-  int outFeaturesPerTile = 1;
-
-  register_attribute int32_t   temp0, temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8, temp9, temp10, temp11, temp12, temp13, temp14;
-  register_attribute uint32_t  addr0, addr1, addr2, addr3, addr4, addr5, addr6, addr7, addr8, addr9, addr10, addr11, addr12, addr13, addr14;
-  register_attribute uint32_t  in_addr;
 
-  int outFeatureTiles;
-  int outFeaturesSize_remain = outFeaturesSize;
-  v2s     * weight_ptr; 
-  v2s     * weight_ptr1=(v2s*)weight1;
-  v2s     * weight_ptr2=(v2s*)weight2;
-  int inFeaturesSizeP2, inFeaturesSizeP4;
-  data_t     * inFeatures;
 
-  for(unsigned int i=0; i<sizeof(tileOptions)/sizeof(int); i++) {
-    outFeaturesPerTile = tileOptions[i];
-    outFeatureTiles = outFeaturesSize_remain/outFeaturesPerTile;
-    if(outFeatureTiles == 0) continue;
 
-    switch(outFeaturesPerTile) {
-   #if OUTPUTBUFFER > 2
-     case OUTPUTBUFFER:
 
-     for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-     {
-        // printf("o_tile=%i\n", o_tile);
-        #if OUTPUTBUFFER > 2
-      temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 3
-      temp1 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 4
-      temp2 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+2]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+2])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 5
-      temp3 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+3]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+3])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 6
-      temp4 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+4]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+4])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 7
-      temp5 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+5]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+5])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 8
-      temp6 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+6]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+6])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 9
-      temp7 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+7]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+7])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 10
-      temp8 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+8]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+8])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 11
-      temp9 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+9]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+9])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 12
-      temp10 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+10]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+10])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 13
-      temp11 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+11]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+11])<<(q_fraqP1);
-        #endif
-        #if OUTPUTBUFFER > 14
-      temp12 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+12]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+12])<<(q_fraqP1);
-        #endif
-      temp13 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+OUTPUTBUFFER-2]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+OUTPUTBUFFER-2])<<(q_fraqP1);
-      temp14 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+OUTPUTBUFFER-1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+OUTPUTBUFFER-1])<<(q_fraqP1);
-
-
-
-      for(int turn=0; turn<2; turn++) {
-        if(turn==0) {
-          weight_ptr = weight_ptr1;
-          inFeaturesSizeP2 = inFeaturesSize1/2;
-          inFeatures = inFeatures1;
-        // #ifdef FMINTILING
-        // inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        // #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        // #endif
-      } else {
-        weight_ptr = weight_ptr2;
-        inFeatures = inFeatures2;
-        inFeaturesSizeP2 = inFeaturesSize2/2;
-        // NO FMINTILING as this does not give any benefit (to implement uncomment all #ifdef FMINTLING parts and change indexing to 2i and 2i+1)
-        // #ifdef FMINTILING
-        // inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        // #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        // #endif
-      }
 
 
 
-      addr0  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 0))];
-      addr1  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 1))];
-      addr2  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 2))];
-      addr3  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 3))];
-      addr4  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 4))];
-      addr5  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 5))];
-      addr6  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 6))];
-      addr7  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 7))];
-      addr8  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 8))];
-      addr9  = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+ 9))];
-      addr10 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+10))];
-      addr11 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+11))];
-      addr12 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+12))];
-      addr13 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+OUTPUTBUFFER-2))];
-      addr14 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+OUTPUTBUFFER-1))];
-        // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-        // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
-        in_addr = (uint32_t)(((v2s*)inFeatures));
-        for(int i=0; i<inFeaturesSizeP4; i++) {
-          v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-          v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
-
-
-            // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-// #ifdef FMINTILING
-//             asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-// #endif
-            // MANUAL loop unfolding
-            // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-            // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-             #if OUTPUTBUFFER > 2
-            SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 3
-            SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 4
-            SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 5
-            SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 6
-            SDOTP_GENERIC(temp4, ((v2s*)addr4)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 7
-            SDOTP_GENERIC(temp5, ((v2s*)addr5)[i], inF_temp) ;
-             #endif
-             #if OUTPUTBUFFER > 9
-            SDOTP_GENERIC(temp6, ((v2s*)addr6)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 9
-            SDOTP_GENERIC(temp7, ((v2s*)addr7)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 10
-            SDOTP_GENERIC(temp8, ((v2s*)addr8)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 11
-            SDOTP_GENERIC(temp9, ((v2s*)addr9)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 12
-            SDOTP_GENERIC(temp10, ((v2s*)addr10)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 13
-            SDOTP_GENERIC(temp11, ((v2s*)addr11)[i], inF_temp);
-             #endif
-             #if OUTPUTBUFFER > 14
-            SDOTP_GENERIC(temp12, ((v2s*)addr12)[i], inF_temp);
-             #endif
-            SDOTP_GENERIC(temp13, ((v2s*)addr13)[i], inF_temp);
-            SDOTP_GENERIC(temp14, ((v2s*)addr14)[i], inF_temp);
-
-// #ifdef FMINTILING
-//              #if OUTPUTBUFFER > 2
-//             SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 3
-//             SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 4
-//             SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 5
-//             SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 6
-//             SDOTP_GENERIC(temp4, ((v2s*)addr4)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 7
-//             SDOTP_GENERIC(temp5, ((v2s*)addr5)[i], inF_temp2) ;
-//              #endif
-//              #if OUTPUTBUFFER > 9
-//             SDOTP_GENERIC(temp6, ((v2s*)addr6)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 9
-//             SDOTP_GENERIC(temp7, ((v2s*)addr7)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 10
-//             SDOTP_GENERIC(temp8, ((v2s*)addr8)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 11
-//             SDOTP_GENERIC(temp9, ((v2s*)addr9)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 12
-//             SDOTP_GENERIC(temp10, ((v2s*)addr10)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 13
-//             SDOTP_GENERIC(temp11, ((v2s*)addr11)[i], inF_temp2);
-//              #endif
-//              #if OUTPUTBUFFER > 14
-//             SDOTP_GENERIC(temp12, ((v2s*)addr12)[i], inF_temp2);
-//              #endif
-//             SDOTP_GENERIC(temp13, ((v2s*)addr13)[i], inF_temp2);
-//             SDOTP_GENERIC(temp14, ((v2s*)addr14)[i], inF_temp2);
-// #endif
-          // }
-          }
-// #ifdef FMINTILING
-//         if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-//                     v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-//             // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-//             asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-//             // asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-            
-//             // MANUAL loop unfolding
-//             // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-//             // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-//                           #if OUTPUTBUFFER > 2
-//             SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 3
-//             SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 4
-//             SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 5
-//             SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 6
-//             SDOTP_GENERIC(temp4, ((v2s*)addr4)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 7
-//             SDOTP_GENERIC(temp5, ((v2s*)addr5)[i], inF_temp) ;
-//              #endif
-//              #if OUTPUTBUFFER > 9
-//             SDOTP_GENERIC(temp6, ((v2s*)addr6)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 9
-//             SDOTP_GENERIC(temp7, ((v2s*)addr7)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 10
-//             SDOTP_GENERIC(temp8, ((v2s*)addr8)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 11
-//             SDOTP_GENERIC(temp9, ((v2s*)addr9)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 12
-//             SDOTP_GENERIC(temp10, ((v2s*)addr10)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 13
-//             SDOTP_GENERIC(temp11, ((v2s*)addr11)[i], inF_temp);
-//              #endif
-//              #if OUTPUTBUFFER > 14
-//             SDOTP_GENERIC(temp12, ((v2s*)addr12)[i], inF_temp);
-//              #endif
-//             SDOTP_GENERIC(temp13, ((v2s*)addr13)[i], inF_temp);
-//             SDOTP_GENERIC(temp14, ((v2s*)addr14)[i], inF_temp);
-
-//           }
 
-// #endif
-} // loop for fm1 and fm2
-      // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-              #if OUTPUTBUFFER > 2
-outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 3
-outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = shiftAndAct(temp1, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 4
-outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = shiftAndAct(temp2, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 5
-outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = shiftAndAct(temp3, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 6
-outFeatures_ptr[(o_tile*outFeaturesPerTile+4)] = shiftAndAct(temp4, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 7
-outFeatures_ptr[(o_tile*outFeaturesPerTile+5)] = shiftAndAct(temp5, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 8
-outFeatures_ptr[(o_tile*outFeaturesPerTile+6)] = shiftAndAct(temp6, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 9
-outFeatures_ptr[(o_tile*outFeaturesPerTile+7)] = shiftAndAct(temp7, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 10
-outFeatures_ptr[(o_tile*outFeaturesPerTile+8)] = shiftAndAct(temp8, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 11
-outFeatures_ptr[(o_tile*outFeaturesPerTile+9)] = shiftAndAct(temp9, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 12
-outFeatures_ptr[(o_tile*outFeaturesPerTile+10)] = shiftAndAct(temp10, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 13
-outFeatures_ptr[(o_tile*outFeaturesPerTile+11)] = shiftAndAct(temp11, activationFunction);
-              #endif
-              #if OUTPUTBUFFER > 14
-outFeatures_ptr[(o_tile*outFeaturesPerTile+12)] = shiftAndAct(temp12, activationFunction);
-              #endif
-outFeatures_ptr[(o_tile*outFeaturesPerTile+OUTPUTBUFFER-2)] = shiftAndAct(temp13, activationFunction);
-outFeatures_ptr[(o_tile*outFeaturesPerTile+OUTPUTBUFFER-1)] = shiftAndAct(temp14, activationFunction);
-              // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-      // }
 
-}
-break;
-   #endif
-   #if OUTPUTBUFFER > 8
-case 8:
 
-for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-{
 
-  temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-  temp1 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-  temp2 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+2]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+2])<<(q_fraqP1);
-  temp3 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+3]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+3])<<(q_fraqP1);
-  temp4 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+4]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+4])<<(q_fraqP1);
-  temp5 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+5]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+5])<<(q_fraqP1);
-  temp6 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+6]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+6])<<(q_fraqP1);
-  temp7 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+7]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+7])<<(q_fraqP1);
-
-        // }
-        // printf("wght=%i, addr before=%i (+%i)=%i\n", weight, addr0, inFeaturesSizeP2*outFeaturesPerTile, addr0+4*inFeaturesSizeP2*outFeaturesPerTile);
-  for(int turn=0; turn<2; turn++) {
-    if(turn==0) {
-      weight_ptr = weight_ptr1;
-      inFeaturesSizeP2 = inFeaturesSize1/2;
-      inFeatures = inFeatures1;
-        // #ifdef FMINTILING
-        // inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        // #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        // #endif
-      } else {
-        weight_ptr = weight_ptr2;
-        inFeatures = inFeatures2;
-        inFeaturesSizeP2 = inFeaturesSize2/2;
-        // #ifdef FMINTILING
-        // inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-        // #else
-        inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-        // #endif
-      }
-      addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-      addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-      addr2 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-      addr3 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-      addr4 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+4))];
-      addr5 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+5))];
-      addr6 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+6))];
-      addr7 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+7))];
+// inline data_t  ALWAYS_INLINE  Tanh_old(data_t value) {
+// #ifdef TURNOFF
+//   #ifdef ASIP  
+//   int tmp = Max(Min(15, (((int)value+18432-2048)>>11)),0);
+// #else // ASIP
+//   #ifndef USE_INTRINSICS
+//   int tmp = Max(Min(15, (((int)value+18432-2048)>>11)),0);
+//   #else // USET_INTRINSICS
+// // [START clipur version]
+//    int tmp = (((int)value+18432-2048)>>11);
+//    asm volatile ("p.clipur" " %[c], %[a],%[b]\n"
+//         : [c] "=r" (tmp)
+//         : [a] "r" (tmp), [b] "r" (lb_lut_numelements)); // TODO: check puts p.clipu instead!!
+// // [END clipur version]
+//   #endif // USET_INTRINSICS
+// #endif // ASIP
+//   return ((lut_Tanh_m[tmp]*value) >> (q_fraqP1))+lut_Tanh_q[tmp];
 
+// #else // TURNOFF
+// #ifdef FixedPt 
+//   //printf("%i, ", PIHalf);
+//   if(Abs(value) < tanh_threshold) 
+//   {
 
-        // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-        // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
+//     int x_power = value;
+//     int partSum = value;
 
-        in_addr = (((v2s*)inFeatures));
-        for(int i=0; i<inFeaturesSizeP4; i++) {
-          v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-          v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
+//     for(int i = 1; i<4; i++) {
+//       x_power = ((x_power * value) >> (q_fraqP1)) * value >> (q_fraqP1);
+//       // printf("%i, ", x_power);
+//       partSum = partSum + (tanh_coeff[i]*x_power >> (q_fraqP1));
+//     }
+//     // printf("%i==%i, ", partSum, (data_t)((1.0f - 2.0/(expTailor(tailorPrecission, 2*(float)(value)/(1<<(q_fraqP1)))+1))*(1<<(q_fraqP1))));
+//     return partSum;
+//   } else {
+//     // printf("tanh");
+//     return (data_t)((1.0f - 2.0/(expTailor(tailorPrecission, 2*(float)(value)/(1<<(q_frac)))+1))*(1<<(q_frac)));
+//   }  
+// #else // FixedPt
+//          return (1.0f - 2.0/(expTailor(tailorPrecission, 2*value)+1));
+// #endif // FixedPt
+//   #endif // TURNOFF
+// }
+// // inline v2s ALWAYS_INLINE sig_SIMD(v2s value)
+// // {
+// //    // TODO: NOT WORKING at the moment
+// // #ifdef SIMD
+// // #ifdef TURNOFF
+// //   // return value;
+// // // printf("qwer\n");
+// //   int tmp = Max(Min(8, Abs(((int)value+2048)/4096)),0);
+// //   return ((lut_fakeTanh_m[tmp]*value) >> (q_fraqP1))+lut_fakeTanh_q[tmp];
+// // #endif // TURNOFF
+// // #endif // SIMD
 
+// //   printf("This function should not be called this way!");
 
-            // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-// #ifdef FMINTILING
-//             asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-// #endif
-            // MANUAL loop unfolding
-            // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-            // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-            SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp);
-            SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp);
-            SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp);
-            SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp);
-            SDOTP_GENERIC(temp4, ((v2s*)addr4)[i], inF_temp);
-            SDOTP_GENERIC(temp5, ((v2s*)addr5)[i], inF_temp);
-            SDOTP_GENERIC(temp6, ((v2s*)addr6)[i], inF_temp);
-            SDOTP_GENERIC(temp7, ((v2s*)addr7)[i], inF_temp);
-// #ifdef FMINTILING
-//             SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp2);
-//             SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp2);
-//             SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp2);
-//             SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp2);
-//             SDOTP_GENERIC(temp4, ((v2s*)addr4)[i], inF_temp2);
-//             SDOTP_GENERIC(temp5, ((v2s*)addr5)[i], inF_temp2);
-//             SDOTP_GENERIC(temp6, ((v2s*)addr6)[i], inF_temp2);
-//             SDOTP_GENERIC(temp7, ((v2s*)addr7)[i], inF_temp2);
-// #endif
-          // }
-          }
-// #ifdef FMINTILING
-//         if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-//             v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-//             asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-//             SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp);
-//             SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp);
-//             SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp);
-//             SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp);
-//             SDOTP_GENERIC(temp4, ((v2s*)addr4)[i], inF_temp);
-//             SDOTP_GENERIC(temp5, ((v2s*)addr5)[i], inF_temp);
-//             SDOTP_GENERIC(temp6, ((v2s*)addr6)[i], inF_temp);
-//             SDOTP_GENERIC(temp7, ((v2s*)addr7)[i], inF_temp);
-
-//           }
-// #endif
-      } // fm in1 and in2
-      // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = shiftAndAct(temp1, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = shiftAndAct(temp2, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = shiftAndAct(temp3, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+4)] = shiftAndAct(temp4, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+5)] = shiftAndAct(temp5, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+6)] = shiftAndAct(temp6, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+7)] = shiftAndAct(temp7, activationFunction);
-      // }
-    }
-    break;
-   #endif
-   #if OUTPUTBUFFER > 4
-    case 4:
+// // }
 
-    for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-    {
 
-      temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-      temp1 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-      temp2 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+2]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+2])<<(q_fraqP1);
-      temp3 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+3]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+3])<<(q_fraqP1);
-      for(int turn=0; turn<2; turn++) {
-        if(turn==0) {
-          weight_ptr = weight_ptr1;
-          inFeaturesSizeP2 = inFeaturesSize1/2;
-          inFeatures = inFeatures1;
-          #ifdef FMINTILING
-          inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-          #else
-          inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-          #endif
-        } else {
-          weight_ptr = weight_ptr2;
-          inFeatures = inFeatures2;
-          inFeaturesSizeP2 = inFeaturesSize2/2;
-          #ifdef FMINTILING
-          inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-          #else
-          inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-          #endif
-        }
-        // }
-        addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-        addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-        addr2 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-        addr3 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
+// inline data_t ALWAYS_INLINE sig_old(data_t value)
+// {
 
+// #ifdef TURNOFF
+// #ifdef ASIP
+//   int tmp = Max(Min(15, (((int)value+18432-2048)>>11)),0);
+// #else // ASIP
+//   #ifndef USE_INTRINSICS
+//   int tmp = Max(Min(15, (((int)value+18432-2048)>>11)),0);
+//   #else // USET_INTRINSICS
+// // [START clipur version]
+//    int tmp = (((int)value+2048)/4096);
+//    asm volatile ("p.clipur" " %[c], %[a],%[b]\n"
+//         : [c] "=r" (tmp)
+//         : [a] "r" (tmp), [b] "r" (lb_lut_numelements)); // TODO: check puts p.clipu instead!!
+// // [END clipur version]
+//   #endif // USET_INTRINSICS
+// #endif //ASIP
+//   return ((lut_sig_m[tmp]*value) >> (q_fraqP1))+lut_sig_q[tmp];
 
-       // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload first weight
-       // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload first weight
+// #else
+//   #ifdef FixedPt
+//     if(Abs(value) < sig_threshold) 
+//   {
+//     int x_power = value;
+//     int partSum = sig_coeff[0]+ (sig_coeff[1]*value >> (q_fraqP1));;
 
-       in_addr = (uint32_t)(((v2s*)inFeatures));
-       for(int i=0; i<inFeaturesSizeP4; i++) {
-            v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-            v2s inF_temp2;// = ((v2s*)inFeatures)[2*i+1];
+//     for(int i = 2; i<4; i++) {
+//       x_power = (x_power * value >> (q_fraqP1)) * value >> (q_fraqP1);
+//       // printf("(%i), ", sig_coeff[3]);
+//       partSum = partSum + ((sig_coeff[i]*x_power) >> (q_frac));
+      
+//     }
+//     // printf("%i==%i, ", partSum, (data_t)((1.0f - 2.0/(expTailor(tailorPrecission, 2*(float)(value)/(1<<(q_fraqP1)))+1))*(1<<(q_fraqP1))));
+//     return partSum;
+//   } else {
+//          // printf("sig, %i>>%i:", value, q_frac);
+//          //printFloat((data_t)((1.0/(1.0+expTailor(tailorPrecission, -(float)(value)/(1<<(q_frac)))))*(1<<(q_frac))));
 
+//          return (data_t)((1.0/(1.0+expTailor(tailorPrecission, -(float)(value)/(1<<(q_frac)))))*(1<<(q_frac)));
+//   }
+//   #else
 
-            // [INFO] lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
-            asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-// #ifdef FMINTILING
-//             asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp2), "+r" (in_addr)); // v2s inF_temp2 = ((v2s*)inFeatures)[2i+1];
-// #endif
-            // MANUAL loop unfolding
-            // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-            // __SUMDOTP2(inF_temp, ((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+o_rel)) + i], temp[o_rel]);
-            SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp);
-            SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp);
-            SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp);
-            SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp);
-// #ifdef FMINTILING
-            
-//             SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp2);
-//             SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp2);
-//             SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp2);
-//             SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp2);
-// #endif
-          // }
-          }
-// # ifdef FMINTILING
-//         if(inFeaturesSizeP2%2==1) { // add contribution of left over input channel (input channels not multiple of 4)
-//             v2s inF_temp;//  = ((v2s*)inFeatures)[2*i];
-            
-//             asm volatile("p.lw %0, 4(%1!)" : "=r" (inF_temp), "+r" (in_addr));  // v2s inF_temp  = ((v2s*)inFeatures)[2i+0];
-//             SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp);
-//             SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp);
-//             SDOTP_GENERIC(temp2, ((v2s*)addr2)[i], inF_temp);
-//             SDOTP_GENERIC(temp3, ((v2s*)addr3)[i], inF_temp);
-
-//           }
-// # endif
-      } // fm in1 and in2
-      // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = shiftAndAct(temp1, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+2)] = shiftAndAct(temp2, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+3)] = shiftAndAct(temp3, activationFunction);
-              // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-      // }
-    }
-    break;
-#endif
-    case 2:
+//          return 1.0/(1.0+expTailor(tailorPrecission, -((float)value)));
+//   #endif
+// #endif  
+// }
 
-    for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-    {
 
-      temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-      temp1 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+1]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+1])<<(q_fraqP1);
-        // temp2 = (int32_t)bias[o_tile*outFeaturesPerTile+2]<<(q_fraqP1);
-        // temp3 = (int32_t)bias[o_tile*outFeaturesPerTile+3]<<(q_fraqP1);
-        // }
-
-      for(int turn=0; turn<2; turn++) {
-        if(turn==0) {
-          weight_ptr = &weight_ptr1[0];
-          inFeaturesSizeP2 = inFeaturesSize1/2;
-          inFeatures = inFeatures1;
-          // #ifdef FMINTILING
-          // inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-          // #else
-          inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-          // #endif
-        } else {
-          weight_ptr = &weight_ptr2[0];
-          inFeatures = inFeatures2;
-          inFeaturesSizeP2 = inFeaturesSize2/2;
-          // #ifdef FMINTILING
-          // inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-          // #else
-          inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-          // #endif
-        }
-        addr0 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+0))];
-        addr1 = (uint32_t) &((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+1))];
-        // addr2 = &((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+2))];
-        // addr3 = &((v2s*)weight)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile+3))];
-        // asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (x0), "+r" (addr0) : "r" (x0) ); // preload no compute
-        // asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (x0), "+r" (addr1) : "r" (x0) ); // preload no compute
-        for(int i=0; i<inFeaturesSizeP2; i++) {
-          v2s inF_temp = ((v2s*)inFeatures)[i];
-          
-          // int o_rel;
-          // for (o_rel=0; o_rel < outFeaturesPerTile; o_rel++) {    
-          SDOTP_GENERIC(temp0, ((v2s*)addr0)[i], inF_temp);
-          SDOTP_GENERIC(temp1, ((v2s*)addr1)[i], inF_temp);
-             // asm volatile("pl.sdotsp.h %0, %1, %2" : "+r" (temp2) : "r" (addr3), "r" (inF_temp) );
-             // asm volatile("pl.sdotsp.h %0, %1, %2" : "+r" (temp3) : "r" (addr0), "r" (inF_temp) );
-          // }
-        }
-      } // fm in1 in2 
-      // for(int o_rel =0;o_rel<outFeaturesPerTile;o_rel++) {
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
-      outFeatures_ptr[(o_tile*outFeaturesPerTile+1)] = shiftAndAct(temp1, activationFunction);
-              // outFeatures[(o_tile*outFeaturesPerTile+2)] = temp2>>(q_fraqP1);
-              // outFeatures[(o_tile*outFeaturesPerTile+3)] = temp3>>(q_fraqP1);
-              // printf("outFeatures[%i]=%i\n", o_rel, outFeatures[(o_tile*outFeaturesPerTile+o_rel)]);
-      // }
 
-    }
-    break;
-    case 1:
 
 
-    for (int o_tile=0; o_tile< outFeatureTiles; o_tile++) 
-    {
-     // iterate through both input FMs
-     for(int turn=0; turn<2; turn++) {
-      if(turn==0) {
-        weight_ptr = &weight_ptr1[0];
-        inFeaturesSizeP2 = inFeaturesSize1/2;
-        inFeatures = inFeatures1;
-      } else {
-        weight_ptr = &weight_ptr2[0];
-        inFeatures = inFeatures2;
-        inFeaturesSizeP2 = inFeaturesSize2/2;
-      }
-      // #ifdef FMINTILING
-      // inFeaturesSizeP4 = inFeaturesSizeP2/2; // input FM tiling
-      // #else
-      inFeaturesSizeP4 = inFeaturesSizeP2; // input FM tiling
-      // #endif
-      temp0 = ((int32_t)bias_ptr1[o_tile*outFeaturesPerTile+0]+(int32_t)bias_ptr2[o_tile*outFeaturesPerTile+0])<<(q_fraqP1);
-      for(int i=0; i<inFeaturesSizeP2; i++) {
-        v2s inF_temp = ((v2s*)inFeatures)[i];
-        temp0 = __SUMDOTP2(inF_temp, ((v2s*)weight_ptr)[(inFeaturesSizeP2*(o_tile*outFeaturesPerTile)) + i], temp0);
-      }
-   } // fm in1 and in2 
-   outFeatures_ptr[(o_tile*outFeaturesPerTile+0)] = shiftAndAct(temp0, activationFunction);
- }
- break;
-}
- // updat pointer for next iteration
-bias_ptr1                = &bias_ptr1[outFeatureTiles*outFeaturesPerTile];
-bias_ptr2                = &bias_ptr2[outFeatureTiles*outFeaturesPerTile];
-weight_ptr1              = &weight_ptr1[(inFeaturesSize1/2*(outFeatureTiles*outFeaturesPerTile))];
-weight_ptr2              = &weight_ptr2[(inFeaturesSize2/2*(outFeatureTiles*outFeaturesPerTile))];
-outFeatures_ptr         = &outFeatures_ptr[(outFeatureTiles*outFeaturesPerTile)];
-outFeaturesSize_remain -= outFeatureTiles*outFeaturesPerTile;
-if (outFeaturesSize_remain==0) break;
-}
-PROFILING_TWOLINEAR_END
-}
- ///////////////////////////////////////////////////////////////////////////////////////////////
- // ______  _______ _______ _______ _     _        _______      _____ _______  _____          //
- // |     \ |______ |______ |_____| |     | |         |           |   |  |  | |_____] |       //
- // |_____/ |______ |       |     | |_____| |_____    |         __|__ |  |  | |       |_____  //
- //                                                                                           //
- ///////////////////////////////////////////////////////////////////////////////////////////////
-#else // no FM Tiling or not ASIP
-/** @brief Calculates Two Linear Layers which are accumulated.
- *
- *  Some networks like LSTM calculate a FC layer for two different input (e.g. x and c)
- *  which are then summed together to calculate the output feature map. 
- *  This is an optimization to avoid storing back all the intermediate output FM's to
- *  calculate the 2nd layer.
+/** @brief Calculates an RNN layer
  *
- *  @param inFeaturesSize1 Number of input neurons of the FC layer 1
- *  @param inFeaturesSize2 Number of input neurons of the FC layer 2
- *  @param outFeaturesSize Number of output neurons
- *  @param activationFunction Type of activation function (ACT_NONE: no activation function is used, ACT_TANH: tangent hyperbolicus, ACT_SIG: sigmoid)
- *  @param weight1 Weights of FC1
- *  @param weight2 Weights of FC2
- *  @param bias1 Bias FC1
- *  @param bias2 Bias FC2
- *  @param inFeatures1 Pointer to input FM for FC1
- *  @param inFeatures2 Pointer to input FM for FC2
- *  @param outFeatures Pointer where to store output FM
+ *  Calculates an RNN layer based on 
+ *  h_t = \\tanh(w_{ih} x_t + b_{ih}  +  w_{hh} h_{(t-1)} + b_{hh})
+ *  The input projections w_{ih} x_t + b_{ih} of all the time steps are computed up front with
+ *  LinearLayerSeq, only the recurrent part is computed step by step.
+ *  @param inFeaturesSize Number of input neurons
+ *  @param hiddenFeaturesSize Number of hidden neurons
+ *  @param seqSize Number of time steps
+ *  @param weight_ih_l Weights mapping input neurons to hidden neurons
+ *  @param weight_hh_l Weights mapping hidden neurons to hidden neurons
+ *  @param bias_ih_l Bias mapping input neurons to hidden neurons
+ *  @param bias_hh_l Bias mapping hidden neurons to hidden neurons
+ *  @param inFeatures Input Feature Map [seqSize x inFeaturesSize]
+ *  @param outFeatures Output Feature Map [seqSize x hiddenFeaturesSize]
+ *  @param hiddenFeatures Hidden Feature Map
+ *  @param hiddenOut Intermediate node [hiddenFeaturesSize]: w_{hh} h_{(t-1)} + b_{hh} (per layer, see layerScratchSize)
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (see struct tiling)
  */
-void NOINLINE TwoLinearLayersAccumulate (
+void NOINLINE RNNLayer (
         // Layer Attributes
-  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, int activationFunction, 
+  int inFeaturesSize, int hiddenFeaturesSize, int seqSize,
         // Layer Parameters
-  data_t * __restrict__ weight1,
-  data_t * __restrict__ weight2,
-  data_t * __restrict__ bias1,
-  data_t * __restrict__ bias2,
+  data_t * __restrict__ weight_ih_l,
+  data_t * __restrict__ weight_hh_l,
+  data_t * __restrict__ bias_ih_l,
+  data_t * __restrict__ bias_hh_l,
         // Input and Output Features
-  data_t * __restrict__ inFeatures1,
-  data_t * __restrict__ inFeatures2,
-  data_t * __restrict__ outFeatures)
+  data_t * __restrict__ inFeatures,
+        data_t * __restrict__ outFeatures, // out and hidden
+        // Hidden Features
+        data_t * __restrict__ hiddenFeatures,
+        // intermediate nodes
+        data_t * __restrict__ hiddenOut,
+        int shift,
+        struct tiling tiling)
 {
+  LinearLayerParallel(inFeaturesSize, hiddenFeaturesSize, seqSize, True, (data_t*)weight_ih_l, bias_ih_l, inFeatures, outFeatures, shift, EPILOGUE_NONE, tiling); //w_{ih} x_t + b_{ih} 
+  for(int seq=0; seq< seqSize; seq++) {
+      data_t * out = &outFeatures[seq*hiddenFeaturesSize];
+      LinearLayerParallel(hiddenFeaturesSize,hiddenFeaturesSize,1,True,(data_t*)weight_hh_l, bias_hh_l, hiddenFeatures, hiddenOut, shift, EPILOGUE_NONE, tiling); //w_{hh} h_{(t-1)}
+
+      AddTensor(hiddenFeaturesSize, out, hiddenOut);
+      TanhLayer(hiddenFeaturesSize, out);
+      CopyTensor(hiddenFeaturesSize, hiddenFeatures, out);
+    }
+  }
 
+#if !defined ASIP && defined FixedPt && defined SIMD && defined FMOUTTILING && defined DOACTONTHEFLY && !defined HOST_SIMD
+/// LSTMLayer computes the gates and the state update in one pass if the activation is done on-the-fly
+#define LSTM_FUSEDCELL
+LSTM_TILE_KERNEL_FAMILY(LSTM_TILE_KERNEL)
+/// LSTM cell kernels of all the tile sizes (index: units per tile)
+static void (* const lstmCellTiles[LSTM_TILE_MAXUNITS+1])(int, int, int, data_t *, data_t *, data_t *, data_t *,
+  data_t *, int32_t *, data_t *, data_t *, data_t *, int, int) = {NULL, LSTMCellTile1, LSTMCellTile2, LSTMCellTile3, LSTMCellTile4};
 
-  PROFILING_TWOLINEAR_START
-  int inFeaturesSize1P2=inFeaturesSize1/2;
-  int inFeaturesSize2P2=inFeaturesSize2/2;
-  for (int o=0; o< outFeaturesSize; o++) 
-  {
-    outFeatures[o] = True?
-    bias1[o]+bias2[o]:
-    ((data_t)0);
-    int32_t temp;
-    temp = ((int32_t)bias1[o]+(int32_t)bias2[o])<<(q_fraqP1);
-
-#ifdef SIMD
-
-    for(int i=0; i<inFeaturesSize1P2; i++)
-#else
-      for(int i=0; i<inFeaturesSize1; i++)
-#endif
-      {
-#ifdef SIMD
-#ifdef ASIP 
-        temp = temp + ((v2s*)inFeatures1)[i] * ((v2s*)weight1)[(inFeaturesSize1P2*o) + i];
-#else //not ASIP
-        temp = __SUMDOTP2(((v2s*)inFeatures1)[i], ((v2s*)weight1)[(inFeaturesSize1P2*o) + i], temp);
-#endif //ASIP
-#else // not SIMD
-        temp += inFeatures1[i]*weight1[inFeaturesSize1*o + i];
-#endif  
-      }
-
-#ifdef SIMD
-      for(int i=0; i<inFeaturesSize2P2; i++)
-#else
-        for(int i=0; i<inFeaturesSize2; i++)
-#endif
-        {
-#ifdef SIMD
-#ifdef ASIP 
-          temp = temp + ((v2s*)inFeatures2)[i] * ((v2s*)weight2)[(inFeaturesSize2P2*o) + i];
-#else // not ASIP
-          temp = __SUMDOTP2(((v2s*)inFeatures2)[i], ((v2s*)weight2)[(inFeaturesSize2P2*o) + i], temp);
-#endif //ASIP
-#else // not SIMD
-          temp += inFeatures2[i]*weight2[inFeaturesSize2*o + i];
-#endif // end SIMD
-
-        }
-
-
+/** @brief Units firstUnit..firstUnit+numUnits-1 of one time step of the fused LSTM cell (see LSTMCellFused)
+ */
+static void LSTMCellFusedUnits (
+  int firstUnit, int numUnits,
+  int inFeaturesSize, int hiddenFeaturesSize,
+  data_t * __restrict__ weight_ih_l,
+  data_t * __restrict__ weight_hh_l,
+  data_t * __restrict__ bias_ih_l,
+  data_t * __restrict__ bias_hh_l,
+  data_t * __restrict__ inFeatures,
+  int32_t * __restrict__ proj,
+  data_t * __restrict__ lstm_h,
+  data_t * __restrict__ lstm_c,
+  data_t * __restrict__ lstm_hNew,
+  int shift,
+  struct tiling tiling)
+{
+  int inTiling = tilingInTiling(tiling);
+  int tileUnits = Min(LSTM_TILE_MAXUNITS, Max(1, tilingOutTile(tiling)/4));
+  int unitTiles = numUnits/tileUnits;
+  int unitsRemain = numUnits - unitTiles*tileUnits;
+
+  int j = firstUnit;
+  lstmCellTiles[tileUnits](unitTiles, inFeaturesSize, hiddenFeaturesSize,
+    WEIGHT_ROWS(weight_ih_l, j, inFeaturesSize), WEIGHT_ROWS(weight_hh_l, j, hiddenFeaturesSize),
+    &bias_ih_l[j], &bias_hh_l[j], inFeatures, proj ? &proj[j] : NULL, lstm_h, &lstm_c[j], &lstm_hNew[j], shift, inTiling);
+  if(unitsRemain) {
+    j = firstUnit + unitTiles*tileUnits;
+    lstmCellTiles[unitsRemain](1, inFeaturesSize, hiddenFeaturesSize,
+      WEIGHT_ROWS(weight_ih_l, j, inFeaturesSize), WEIGHT_ROWS(weight_hh_l, j, hiddenFeaturesSize),
+      &bias_ih_l[j], &bias_hh_l[j], inFeatures, proj ? &proj[j] : NULL, lstm_h, &lstm_c[j], &lstm_hNew[j], shift, inTiling);
+  }
+}
 
-#ifdef DOACTONTHEFLY
-        temp = temp>>(q_fraqP1); 
-        switch(activationFunction) {
-          case ACT_NONE: outFeatures[o] = temp; break;
-          case ACT_TANH: outFeatures[o] = generic_tanh(temp); break;
-          case ACT_SIG:  outFeatures[o] = generic_sig(temp); break;
-        }
-#else
-        outFeatures[o] = temp>>(q_fraqP1);
+#ifdef NUM_CORES
+/// Task of the fused LSTM cell: units
+static void parallelLSTMCell(void * arg, int first, int count)
+{
+  struct parallelJob * job = (struct parallelJob *)arg;
+  LSTMCellFusedUnits(first, count, job->inSize1, job->outSize, job->weight1, job->weight2, job->bias1, job->bias2,
+    job->in1, job->acc, job->in2, job->state, job->out, job->shift, job->tiling);
+}
 #endif
 
-
-
-      }
-      PROFILING_TWOLINEAR_END
-    }
+/** @brief Calculates one time step of an LSTM layer in a single pass (fused gates and state update)
+ *
+ *  The weights of the four gates are streamed once, the input FM and the hidden state are read
+ *  once per tile of units instead of once per gate. The output FM tile size of the tiling selects
+ *  the number of accumulators (4 per unit). With NUM_CORES the tiles of units are run as tasks on
+ *  all the cores (parallelRunTasks), the hidden state is updated after all of them are done.
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param hiddenFeaturesSize Number of hidden neurons
+ *  @param weight_ih_l Weights mapping input neurons to hidden neurons
+ *  @param weight_hh_l Weights mapping hidden neurons to hidden neurons
+ *  @param bias_ih_l Bias mapping input neurons to hidden neurons
+ *  @param bias_hh_l Bias mapping hidden neurons to hidden neurons
+ *  @param inFeatures input feature map of the time step
+ *  @param proj input projection w_{ih} x_t + b_{ih} of the time step (accumulators of LinearLayerSeqTiled, [4 x hiddenFeaturesSize]) or NULL
+ *  @param lstm_h hidden state tensor
+ *  @param lstm_c cell state tensor
+ *  @param lstm_hNew temporary tensor for the new hidden state
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+static void LSTMCellFused (
+  int inFeaturesSize, int hiddenFeaturesSize,
+  data_t * __restrict__ weight_ih_l,
+  data_t * __restrict__ weight_hh_l,
+  data_t * __restrict__ bias_ih_l,
+  data_t * __restrict__ bias_hh_l,
+  data_t * __restrict__ inFeatures,
+  int32_t * __restrict__ proj,
+  data_t * __restrict__ lstm_h,
+  data_t * __restrict__ lstm_c,
+  data_t * __restrict__ lstm_hNew,
+  int shift,
+  struct tiling tiling)
+{
+#ifdef NUM_CORES
+  int tileUnits = Min(LSTM_TILE_MAXUNITS, Max(1, tilingOutTile(tiling)/4));
+  if(!parallelInside() && hiddenFeaturesSize > tileUnits) {
+    struct parallelJob job = {0};
+    job.inSize1 = inFeaturesSize;
+    job.outSize = hiddenFeaturesSize;
+    job.weight1 = weight_ih_l;
+    job.weight2 = weight_hh_l;
+    job.bias1   = bias_ih_l;
+    job.bias2   = bias_hh_l;
+    job.in1     = inFeatures;
+    job.acc     = proj;
+    job.in2     = lstm_h;
+    job.state   = lstm_c;
+    job.out     = lstm_hNew;
+    job.shift   = shift;
+    job.tiling  = tiling;
+    parallelJob = job;
+    parallelRunTasks(parallelLSTMCell, &parallelJob, hiddenFeaturesSize, tileUnits);
+  } else
 #endif
+  LSTMCellFusedUnits(0, hiddenFeaturesSize, inFeaturesSize, hiddenFeaturesSize, weight_ih_l, weight_hh_l,
+    bias_ih_l, bias_hh_l, inFeatures, proj, lstm_h, lstm_c, lstm_hNew, shift, tiling);
+  CopyTensor(hiddenFeaturesSize, lstm_h, lstm_hNew);
+}
 #endif
 
-#ifndef FixedPt
-    void NOINLINE TwoLinearLayersAccumulate (
-        // Layer Attributes
-      int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, int activationFunction,
+/** @brief Calculates an LSTM layer
+ *
+ *  With activation on-the-fly and the tiled kernels (LSTM_FUSEDCELL) each time step is computed
+ *  with LSTMCellFused(), otherwise with four TwoLinearLayersAccumulate and the element-wise passes.
+ *  For sequences the fused path computes the input projections w_{ih} x_t + b_{ih} of (chunks of
+ *  SEQ_BUFFER_SIZE/(4*hiddenFeaturesSize)) time steps up front with the weight stationary kernels.
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param hiddenFeaturesSize Number of hidden neurons
+ *  @param seqSize Number of time steps
+ *  @param weight_ih_l Weights mapping input neurons to hidden neurons
+ *  @param weight_hh_l Weights mapping hidden neurons to hidden neurons
+ *  @param bias_ih_l Bias mapping input neurons to hidden neurons
+ *  @param bias_hh_l Bias mapping hidden neurons to hidden neurons
+ *  @param lstm_h hidden state tensor
+ *  @param lstm_c cell state tensor
+ *  @param lstm_f forget gate activation tensor
+ *  @param inFeatures input feature map [seqSize x inFeaturesSize]
+ *  @param outFeatures hidden state of all the time steps [seqSize x hiddenFeaturesSize], NULL: only lstm_h
+ *  @param lstm_i input/update gate activation tensor
+ *  @param lstm_g g tensor 
+ *  @param lstm_o output gate tensor
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+  void NOINLINE LSTMLayer (
+// Layer Attributes
+    int inFeaturesSize, int hiddenFeaturesSize, int seqSize,
         // Layer Parameters
-      data_t * __restrict__ weight1,
-      data_t * __restrict__ weight2,
-      data_t * __restrict__ bias1,
-      data_t * __restrict__ bias2,
+    data_t * __restrict__ weight_ih_l,
+    data_t * __restrict__ weight_hh_l,
+    data_t * __restrict__ bias_ih_l,
+    data_t * __restrict__ bias_hh_l,
         // Input and Output Features
-      data_t * __restrict__ inFeatures1,
-      data_t * __restrict__ inFeatures2,
-      data_t * __restrict__ outFeatures)
-    {
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    data_t * __restrict__ lstm_h,
+        // Hidden Features
+    data_t * __restrict__ lstm_c,
+        // intermediate nodes
+    data_t * __restrict__ lstm_f,
+    data_t * __restrict__ lstm_i,
+    data_t * __restrict__ lstm_g,
+    data_t * __restrict__ lstm_o,
+    int shift,
+    struct tiling tiling
+    )
+  {
+    PROFILING_LSTM_START
+    int actOnTheFly = tilingActOnTheFly(tiling);
+  #ifdef DEBUG_LSTM
+    printf("lstm_in: ");PrintTensor(inFeaturesSize, inFeatures);
+    #endif
+#ifdef LSTM_FUSEDCELL
+    // time steps per matrix-matrix product of the input projections
+    int seqChunk = seqSize > 1 ? Min(seqSize, SEQ_BUFFER_SIZE/(4*hiddenFeaturesSize)) : 0;
+#endif
+    for(int seq=0; seq< seqSize; seq++) {
+#ifdef LSTM_FUSEDCELL
+      if(actOnTheFly) {
+        int32_t * proj = NULL;
+        if(seqChunk > 0) {
+          if(seq%seqChunk == 0)
+            LinearLayerSeqTiled(inFeaturesSize, 4*hiddenFeaturesSize, Min(seqChunk, seqSize-seq), weight_ih_l, bias_ih_l,
+              inFeatures+seq*inFeaturesSize, NULL, seqBuffer, shift, EPILOGUE_NONE, tiling);
+          proj = &seqBuffer[(seq%seqChunk)*4*hiddenFeaturesSize];
+        }
+        LSTMCellFused(inFeaturesSize, hiddenFeaturesSize, weight_ih_l, weight_hh_l, bias_ih_l, bias_hh_l,
+          inFeatures+seq*inFeaturesSize, proj, lstm_h, lstm_c, outFeatures ? &outFeatures[seq*hiddenFeaturesSize] : lstm_o, shift, tiling);
+        continue;
+      }
+#endif
 
-      PROFILING_TWOLINEAR_START
-      int inFeaturesSize1P2=inFeaturesSize1/2;
-      int inFeaturesSize2P2=inFeaturesSize2/2;
-      for (int o=0; o< outFeaturesSize; o++) 
-      {
-        outFeatures[o] = True?
-        bias1[o]+bias2[o]:
-        ((data_t)0);
-        data_t temp;
-        temp = bias1[o]+bias2[o];
+  //it=σ(Wiixt+bii+Whih(t−1)+bhi)
+      TwoLinearLayersAccumulateParallel (
+          // Layer Attributes
+        inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, EPILOGUE_ACT(actOnTheFly ? ACT_SIG : ACT_NONE),
 
+          // Layer Parameters
+          weight_ih_l+0*inFeaturesSize*hiddenFeaturesSize, // weight1
+          weight_hh_l+0*hiddenFeaturesSize*hiddenFeaturesSize, // weight2
+          bias_ih_l+0*hiddenFeaturesSize,   // bias1
+          bias_hh_l+0*hiddenFeaturesSize,   // bias2 
+          inFeatures+seq*inFeaturesSize,    // in1
+          lstm_h,        // in2
+          lstm_i,        // out
+          shift,
+          tiling);
+#ifdef DEBUG_LSTM
+      printf("lstm_i: ");PrintTensor(hiddenFeaturesSize, lstm_i);
+#endif
+      if(!actOnTheFly)
+        SigLayer(hiddenFeaturesSize, lstm_i);
+#ifdef DEBUG_LSTM
+      printf("lstm_i: ");PrintTensor(hiddenFeaturesSize, lstm_i);
+#endif
+  //ft=σ(Wif xt+bif+Whf h(t−1)+bhf)
+      TwoLinearLayersAccumulateParallel (
+          // Layer Attributes
+        inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, EPILOGUE_ACT(actOnTheFly ? ACT_SIG : ACT_NONE),
 
+          // Layer Parameters
+          weight_ih_l+1*inFeaturesSize*hiddenFeaturesSize, // weight1
+          weight_hh_l+1*hiddenFeaturesSize*hiddenFeaturesSize, // weight2
+          bias_ih_l+1*hiddenFeaturesSize,   // bias1
+          bias_hh_l+1*hiddenFeaturesSize,   // bias2 
+          inFeatures+seq*inFeaturesSize,    // in1
+          lstm_h,        // in2
+          lstm_f,        // out
+          shift,
+          tiling);
+        #ifdef DEBUG_LSTM
+      printf("lstm_f: ");PrintTensor(hiddenFeaturesSize, lstm_f);
+    #endif
+      if(!actOnTheFly)
+        SigLayer(hiddenFeaturesSize, lstm_f);
+    #ifdef DEBUG_LSTM
+      printf("lstm_f: ");PrintTensor(hiddenFeaturesSize, lstm_f);
+    #endif
 
-        for(int i=0; i<inFeaturesSize1; i++)
-        {
-         temp += inFeatures1[i]*weight1[inFeaturesSize1*o + i];
-       }
-       for(int i=0; i<inFeaturesSize2; i++)
-       {
-         temp += inFeatures2[i]*weight2[inFeaturesSize2*o + i];
-       }
-       outFeatures[o] = temp;
+    //gt=tanh(Wigxt+big+Whgh(t−1)+bhg)
+      TwoLinearLayersAccumulateParallel (
+          // Layer Attributes
+        inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, EPILOGUE_ACT(actOnTheFly ? ACT_TANH : ACT_NONE),
 
-     }
-     PROFILING_TWOLINEAR_END
-   }
-#endif
+          // Layer Parameters
+          weight_ih_l+2*inFeaturesSize*hiddenFeaturesSize, // weight1
+          weight_hh_l+2*hiddenFeaturesSize*hiddenFeaturesSize, // weight2
+          bias_ih_l+2*hiddenFeaturesSize,   // bias1
+          bias_hh_l+2*hiddenFeaturesSize,   // bias2 
+          inFeatures+seq*inFeaturesSize,    // in1
+          lstm_h,        // in2
+          lstm_g,        // out
+          shift,
+          tiling);
+    #ifdef DEBUG_LSTM
+      printf("lstm_g: ");PrintTensor(hiddenFeaturesSize, lstm_g);
+    #endif
+      if(!actOnTheFly)
+        TanhLayer(hiddenFeaturesSize, lstm_g);
+    #ifdef DEBUG_LSTM
+      printf("lstm_g: ");PrintTensor(hiddenFeaturesSize, lstm_g);
+    #endif
 
+    //ot=σ(Wioxt+bio+Whoh(t−1)+bho)
+      TwoLinearLayersAccumulateParallel (
+          // Layer Attributes
+        inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, EPILOGUE_ACT(actOnTheFly ? ACT_SIG : ACT_NONE),
 
+          // Layer Parameters
+          weight_ih_l+3*inFeaturesSize*hiddenFeaturesSize, // weight1
+          weight_hh_l+3*hiddenFeaturesSize*hiddenFeaturesSize, // weight2
+          bias_ih_l+3*hiddenFeaturesSize,   // bias1
+          bias_hh_l+3*hiddenFeaturesSize,   // bias2 
+          inFeatures+seq*inFeaturesSize,    // in1
+          lstm_h,        // in2
+          lstm_o,        // out
+          shift,
+          tiling);
+      if(!actOnTheFly)
+        SigLayer(hiddenFeaturesSize, lstm_o);
+    #ifdef DEBUG_LSTM
+      printf("lstm_o: ");PrintTensor(hiddenFeaturesSize, lstm_o);
+    #endif
+    //ct=ft*c(t−1)+it*gt
+      HadMulTensor(hiddenFeaturesSize, lstm_c, lstm_f);
+      HadMulTensor(hiddenFeaturesSize, lstm_i, lstm_g);
+      AddTensor(hiddenFeaturesSize, lstm_c, lstm_i);
+    #ifdef DEBUG_LSTM
+      printf("lstm_c: ");PrintTensor(hiddenFeaturesSize, lstm_c);
+    #endif
+    //ht=ottanh(ct)
+    CopyTensor(hiddenFeaturesSize, lstm_h, lstm_c); // h=c
+    TanhLayer(hiddenFeaturesSize, lstm_h); // tanh(c_t)
+    HadMulTensor(hiddenFeaturesSize, lstm_h, lstm_o);
+    #ifdef DEBUG_LSTM
+    printf("lstm_h: ");PrintTensor(hiddenFeaturesSize, lstm_h);
+    #endif
+    if(outFeatures)
+      CopyTensor(hiddenFeaturesSize, &outFeatures[seq*hiddenFeaturesSize], lstm_h);
+  }   
+  PROFILING_LSTM_END
 
+}
 
+/** @brief Candidate and new hidden state of one GRU time step (element-wise, tanh on-the-fly)
+ *
+ *  n_t = tanh(w_{in} x_t + b_{in} + r_t*(w_{hn} h_{(t-1)} + b_{hn})), h_t = (1-z_t)*n_t + z_t*h_{(t-1)}
+ *  computed as n_t + z_t*(h_{(t-1)}-n_t)
+ *
+ *  @param hiddenFeaturesSize Number of hidden neurons
+ *  @param gru_n input part of the candidate w_{in} x_t + b_{in} (in), new hidden state (out)
+ *  @param gru_nh hidden part of the candidate w_{hn} h_{(t-1)} + b_{hn}
+ *  @param gru_r reset gate
+ *  @param gru_z update gate
+ *  @param gru_h hidden state tensor (updated)
+ */
+static void GRUStateUpdate (
+  int hiddenFeaturesSize,
+  data_t * __restrict__ gru_n,
+  data_t * __restrict__ gru_nh,
+  data_t * __restrict__ gru_r,
+  data_t * __restrict__ gru_z,
+  data_t * __restrict__ gru_h)
+{
+  for(int j=0; j<hiddenFeaturesSize; j++) {
+    data_t cand = generic_tanh(SATURATE_DATA(gru_n[j]+((gru_r[j]*gru_nh[j])>>(q_frac))));
+    gru_n[j] = SATURATE_DATA(cand+((gru_z[j]*(gru_h[j]-cand))>>(q_frac)));
+    gru_h[j] = gru_n[j];
+  }
+}
 
-/** @brief Calculates point-wise Addition of Tensors (A+=B)
+/** @brief Calculates a GRU layer
  *
- *  @param TensorSize Input Value
- *  @param FeaturesA Accumulation Tensor
- *  @param FeaturesB Addend Tensor
+ *  r_t = sig(w_{ir} x_t + b_{ir} + w_{hr} h_{(t-1)} + b_{hr}), z_t = sig(w_{iz} x_t + b_{iz} + w_{hz} h_{(t-1)} + b_{hz})
+ *  n_t = tanh(w_{in} x_t + b_{in} + r_t*(w_{hn} h_{(t-1)} + b_{hn})), h_t = (1-z_t)*n_t + z_t*h_{(t-1)}
+ *  The weights are stacked in the order of nn.GRU (reset, update, candidate), 3 instead of 4 gates
+ *  of the LSTM, i.e. 25% fewer MACs per time step. The input part of the candidate of all the time
+ *  steps is computed up front with LinearLayerParallel (in the output FM). Per time step the reset and the
+ *  update gate are one TwoLinearLayersAccumulate (their rows are consecutive in w_{ih} and w_{hh},
+ *  sigmoid on-the-fly with the tiling of the layer), followed by the hidden part of the candidate
+ *  and the element-wise state update (GRUStateUpdate).
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param hiddenFeaturesSize Number of hidden neurons
+ *  @param seqSize Number of time steps
+ *  @param weight_ih_l Weights mapping input neurons to hidden neurons [3 x hiddenFeaturesSize x inFeaturesSize]
+ *  @param weight_hh_l Weights mapping hidden neurons to hidden neurons [3 x hiddenFeaturesSize x hiddenFeaturesSize]
+ *  @param bias_ih_l Bias mapping input neurons to hidden neurons
+ *  @param bias_hh_l Bias mapping hidden neurons to hidden neurons
+ *  @param inFeatures input feature map [seqSize x inFeaturesSize]
+ *  @param outFeatures hidden state of all the time steps [seqSize x hiddenFeaturesSize]
+ *  @param gru_h hidden state tensor
+ *  @param nodes intermediate nodes [3 x hiddenFeaturesSize]: reset gate, update gate, hidden part of the candidate
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (see struct tiling)
  */
-    void NOINLINE AddTensor (
-        // Layer Attributes
-      int TensorSize,
+void NOINLINE GRULayer (
+// Layer Attributes
+  int inFeaturesSize, int hiddenFeaturesSize, int seqSize,
         // Layer Parameters
-      data_t * __restrict__ FeaturesA,
-      data_t * __restrict__ FeaturesB)
-    {
-      PROFILING_ADDT_START
+  data_t * __restrict__ weight_ih_l,
+  data_t * __restrict__ weight_hh_l,
+  data_t * __restrict__ bias_ih_l,
+  data_t * __restrict__ bias_hh_l,
+        // Input and Output Features
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+        // Hidden Features
+  data_t * __restrict__ gru_h,
+        // intermediate nodes
+  data_t * __restrict__ nodes,
+  int shift,
+  struct tiling tiling)
+{
+  PROFILING_LSTM_START
+  int actOnTheFly = tilingActOnTheFly(tiling);
+  data_t * gru_r  = nodes;                        // reset gate, followed by the update gate
+  data_t * gru_z  = nodes + 1*hiddenFeaturesSize; // update gate
+  data_t * gru_nh = nodes + 2*hiddenFeaturesSize; // w_{hn} h_{(t-1)} + b_{hn}
+
+  //w_{in} x_t + b_{in} of all the time steps
+  LinearLayerParallel(inFeaturesSize, hiddenFeaturesSize, seqSize, True,
+    weight_ih_l+2*hiddenFeaturesSize*inFeaturesSize, bias_ih_l+2*hiddenFeaturesSize,
+    inFeatures, outFeatures, shift, EPILOGUE_NONE, tiling);
+  for(int seq=0; seq< seqSize; seq++) {
+    //r_t and z_t
+    TwoLinearLayersAccumulateParallel (
+      inFeaturesSize, hiddenFeaturesSize, 2*hiddenFeaturesSize, EPILOGUE_ACT(actOnTheFly ? ACT_SIG : ACT_NONE),
+      weight_ih_l,                   // weight1
+      weight_hh_l,                   // weight2
+      bias_ih_l,                     // bias1
+      bias_hh_l,                     // bias2
+      inFeatures+seq*inFeaturesSize, // in1
+      gru_h,                         // in2
+      gru_r,                         // out
+      shift,
+      tiling);
+    if(!actOnTheFly)
+      SigLayer(2*hiddenFeaturesSize, gru_r);
+    //w_{hn} h_{(t-1)} + b_{hn}
+    LinearLayerParallel(hiddenFeaturesSize, hiddenFeaturesSize, 1, True,
+      weight_hh_l+2*hiddenFeaturesSize*hiddenFeaturesSize, bias_hh_l+2*hiddenFeaturesSize,
+      gru_h, gru_nh, shift, EPILOGUE_NONE, tiling);
+    GRUStateUpdate(hiddenFeaturesSize, &outFeatures[seq*hiddenFeaturesSize], gru_nh, gru_r, gru_z, gru_h);
+#ifdef DEBUG_LSTM
+    printf("gru_h: ");PrintTensor(hiddenFeaturesSize, gru_h);
+#endif
+  }
+  PROFILING_LSTM_END
+}
 
-#ifdef ASIP
-  // TODO implement SIMD add on tzscale
-      for(int o=0; o<TensorSize; o++)
-        FeaturesA[o] += FeaturesB[o];
+/** @brief Calculates one time step of an LSTM layer for a batch of independent streams
+ *
+ *  With the fused LSTM cell (LSTM_FUSEDCELL and activation on-the-fly) the gates of all the streams
+ *  are computed as two matrix-matrix products (w_{ih} with the input FMs and w_{hh} with the hidden
+ *  states of the streams, chunks of SEQ_BUFFER_SIZE/(8*hiddenFeaturesSize) streams) with the weight
+ *  stationary kernels, i.e. each weight is read once per tile of streams, followed by the element-wise
+ *  state update. Otherwise LSTMLayer is called for every stream.
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param hiddenFeaturesSize Number of hidden neurons
+ *  @param batchSize Number of streams
+ *  @param weight_ih_l Weights mapping input neurons to hidden neurons
+ *  @param weight_hh_l Weights mapping hidden neurons to hidden neurons
+ *  @param bias_ih_l Bias mapping input neurons to hidden neurons
+ *  @param bias_hh_l Bias mapping hidden neurons to hidden neurons
+ *  @param inFeatures input feature maps [batchSize x inFeaturesSize]
+ *  @param outFeatures new hidden states [batchSize x hiddenFeaturesSize]
+ *  @param lstm_h hidden states of the streams [batchSize x hiddenFeaturesSize]
+ *  @param lstm_c cell states of the streams [batchSize x hiddenFeaturesSize]
+ *  @param nodes intermediate nodes of LSTMLayer [4 x hiddenFeaturesSize]
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+void NOINLINE LSTMLayerBatch (
+  int inFeaturesSize, int hiddenFeaturesSize, int batchSize,
+  data_t * __restrict__ weight_ih_l,
+  data_t * __restrict__ weight_hh_l,
+  data_t * __restrict__ bias_ih_l,
+  data_t * __restrict__ bias_hh_l,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  data_t * __restrict__ lstm_h,
+  data_t * __restrict__ lstm_c,
+  data_t * __restrict__ nodes,
+  int shift,
+  struct tiling tiling)
+{
+#ifdef LSTM_FUSEDCELL
+  // streams per pair of matrix-matrix products (input and recurrent part)
+  int batchChunk = Min(batchSize, SEQ_BUFFER_SIZE/(8*hiddenFeaturesSize));
+  // (odd hidden sizes: the weight rows of w_hh are not packed like the ones of a Linear layer)
+  if(batchSize > 1 && batchChunk > 0 && hiddenFeaturesSize%2 == 0 && tilingActOnTheFly(tiling)) {
+    PROFILING_LSTM_START
+    for(int b0 = 0; b0 < batchSize; b0 += batchChunk) {
+      int streams = Min(batchChunk, batchSize-b0);
+      int32_t * projIH = seqBuffer;
+      int32_t * projHH = &seqBuffer[streams*4*hiddenFeaturesSize];
+      LinearLayerSeqTiled(inFeaturesSize, 4*hiddenFeaturesSize, streams, weight_ih_l, bias_ih_l,
+        &inFeatures[b0*inFeaturesSize], NULL, projIH, shift, EPILOGUE_NONE, tiling);
+      LinearLayerSeqTiled(hiddenFeaturesSize, 4*hiddenFeaturesSize, streams, weight_hh_l, bias_hh_l,
+        &lstm_h[b0*hiddenFeaturesSize], NULL, projHH, shift, EPILOGUE_NONE, tiling);
+      for(int b = 0; b < streams; b++) {
+        int32_t * accIH = &projIH[b*4*hiddenFeaturesSize];
+        int32_t * accHH = &projHH[b*4*hiddenFeaturesSize];
+        data_t * h = &lstm_h[(b0+b)*hiddenFeaturesSize];
+        data_t * c = &lstm_c[(b0+b)*hiddenFeaturesSize];
+        for(int j = 0; j < hiddenFeaturesSize; j++) {
+          // same fixed-point operations as LSTMCellTileU
+          data_t i_t = generic_sig(SATURATE_DATA((accIH[0*hiddenFeaturesSize+j]+accHH[0*hiddenFeaturesSize+j])>>(shift)));
+          data_t f_t = generic_sig(SATURATE_DATA((accIH[1*hiddenFeaturesSize+j]+accHH[1*hiddenFeaturesSize+j])>>(shift)));
+          data_t g_t = generic_tanh(SATURATE_DATA((accIH[2*hiddenFeaturesSize+j]+accHH[2*hiddenFeaturesSize+j])>>(shift)));
+          data_t o_t = generic_sig(SATURATE_DATA((accIH[3*hiddenFeaturesSize+j]+accHH[3*hiddenFeaturesSize+j])>>(shift)));
+          data_t c_f = (c[j]*f_t)>>(q_fraqP1);   // c_t = f_t*c_(t-1) + i_t*g_t
+          data_t i_g = (i_t*g_t)>>(q_fraqP1);
+          c[j] = SATURATE_DATA(c_f + i_g);
+          h[j] = (generic_tanh(c[j])*o_t)>>(q_fraqP1); // h_t = o_t*tanh(c_t)
+        }
+        CopyTensor(hiddenFeaturesSize, &outFeatures[(b0+b)*hiddenFeaturesSize], h);
+      }
+    }
+    PROFILING_LSTM_END
+    return;
+  }
+#endif
+  for(int b = 0; b < batchSize; b++)
+    LSTMLayer(inFeaturesSize, hiddenFeaturesSize, 1, weight_ih_l, weight_hh_l, bias_ih_l, bias_hh_l,
+      &inFeatures[b*inFeaturesSize], &outFeatures[b*hiddenFeaturesSize],
+      &lstm_h[b*hiddenFeaturesSize], &lstm_c[b*hiddenFeaturesSize],
+      nodes + 1*hiddenFeaturesSize, //f
+      nodes + 2*hiddenFeaturesSize, //i
+      nodes + 3*hiddenFeaturesSize, //g
+      nodes,                        //o
+      shift,
+      tiling);
+}
 
-      return;
-#else //ASIP
+/** @brief Calculates one time step of a GRU layer for a batch of independent streams
+ *
+ *  With the weight stationary kernels (LINEAR_SEQTILES) and activation on-the-fly the gates of all
+ *  the streams are computed as two matrix-matrix products (w_{ih} with the input FMs and w_{hh} with
+ *  the hidden states of the streams, chunks of SEQ_BUFFER_SIZE/(6*hiddenFeaturesSize) streams), i.e.
+ *  each weight is read once per tile of streams like in LSTMLayerBatch, followed by the element-wise
+ *  state update (GRUStateUpdate). Otherwise GRULayer is called for every stream.
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param hiddenFeaturesSize Number of hidden neurons
+ *  @param batchSize Number of streams
+ *  @param weight_ih_l Weights mapping input neurons to hidden neurons
+ *  @param weight_hh_l Weights mapping hidden neurons to hidden neurons
+ *  @param bias_ih_l Bias mapping input neurons to hidden neurons
+ *  @param bias_hh_l Bias mapping hidden neurons to hidden neurons
+ *  @param inFeatures input feature maps [batchSize x inFeaturesSize]
+ *  @param outFeatures new hidden states [batchSize x hiddenFeaturesSize]
+ *  @param gru_h hidden states of the streams [batchSize x hiddenFeaturesSize]
+ *  @param nodes intermediate nodes of GRULayer [3 x hiddenFeaturesSize]
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+void NOINLINE GRULayerBatch (
+  int inFeaturesSize, int hiddenFeaturesSize, int batchSize,
+  data_t * __restrict__ weight_ih_l,
+  data_t * __restrict__ weight_hh_l,
+  data_t * __restrict__ bias_ih_l,
+  data_t * __restrict__ bias_hh_l,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  data_t * __restrict__ gru_h,
+  data_t * __restrict__ nodes,
+  int shift,
+  struct tiling tiling)
+{
+#if defined LINEAR_SEQTILES && defined DOACTONTHEFLY
+  // streams per pair of matrix-matrix products (input and recurrent part)
+  int batchChunk = Min(batchSize, SEQ_BUFFER_SIZE/(6*hiddenFeaturesSize));
+  // (odd hidden sizes: the weight rows of w_hh are not packed like the ones of a Linear layer)
+  if(batchSize > 1 && batchChunk > 0 && hiddenFeaturesSize%2 == 0 && tilingActOnTheFly(tiling)) {
+    PROFILING_LSTM_START
+    data_t * gru_r  = nodes;
+    data_t * gru_z  = nodes + 1*hiddenFeaturesSize;
+    data_t * gru_nh = nodes + 2*hiddenFeaturesSize;
+    for(int b0 = 0; b0 < batchSize; b0 += batchChunk) {
+      int streams = Min(batchChunk, batchSize-b0);
+      int32_t * projIH = seqBuffer;
+      int32_t * projHH = &seqBuffer[streams*3*hiddenFeaturesSize];
+      LinearLayerSeqTiled(inFeaturesSize, 3*hiddenFeaturesSize, streams, weight_ih_l, bias_ih_l,
+        &inFeatures[b0*inFeaturesSize], NULL, projIH, shift, EPILOGUE_NONE, tiling);
+      LinearLayerSeqTiled(hiddenFeaturesSize, 3*hiddenFeaturesSize, streams, weight_hh_l, bias_hh_l,
+        &gru_h[b0*hiddenFeaturesSize], NULL, projHH, shift, EPILOGUE_NONE, tiling);
+      for(int b = 0; b < streams; b++) {
+        int32_t * accIH = &projIH[b*3*hiddenFeaturesSize];
+        int32_t * accHH = &projHH[b*3*hiddenFeaturesSize];
+        data_t * gru_n = &outFeatures[(b0+b)*hiddenFeaturesSize];
+        for(int j = 0; j < hiddenFeaturesSize; j++) {
+          // same fixed-point operations as TwoLinearLayersAccumulate and LinearLayer in GRULayer
+          gru_r[j]  = generic_sig(SATURATE_DATA((accIH[0*hiddenFeaturesSize+j]+accHH[0*hiddenFeaturesSize+j])>>(shift)));
+          gru_z[j]  = generic_sig(SATURATE_DATA((accIH[1*hiddenFeaturesSize+j]+accHH[1*hiddenFeaturesSize+j])>>(shift)));
+          gru_n[j]  = SATURATE_DATA(accIH[2*hiddenFeaturesSize+j]>>(shift));
+          gru_nh[j] = SATURATE_DATA(accHH[2*hiddenFeaturesSize+j]>>(shift));
+        }
+        GRUStateUpdate(hiddenFeaturesSize, gru_n, gru_nh, gru_r, gru_z, &gru_h[(b0+b)*hiddenFeaturesSize]);
+      }
+    }
+    PROFILING_LSTM_END
+    return;
+  }
+#endif
+  for(int b = 0; b < batchSize; b++)
+    GRULayer(inFeaturesSize, hiddenFeaturesSize, 1, weight_ih_l, weight_hh_l, bias_ih_l, bias_hh_l,
+      &inFeatures[b*inFeaturesSize], &outFeatures[b*hiddenFeaturesSize],
+      &gru_h[b*hiddenFeaturesSize], nodes, shift, tiling);
+}
 
-#ifdef SIMD
-      int TensorSizeP2 = TensorSize/2;
-      v2s * SIMD_FeaturesA = (v2s*) FeaturesA;
-      v2s * SIMD_FeaturesB = (v2s*) FeaturesB;
-      for(int o=0; o<TensorSizeP2; o++)
-        SIMD_FeaturesA[o] += SIMD_FeaturesB[o];
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Int8/int4 weights: int8_t or packed int4 weights with one scale per output neuron (channel),
+// 16-bit activations. The weight in Q-format is weight*scale>>WEIGHT_SCALE_SHIFT, i.e. the scaled
+// dot product has the same format as the accumulators of the data_t kernels and the bias, the
+// output shift and the activations are the same.
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+/** @brief Dot product of n int8 weights with n inputs added to acc (wraps around like the sdotp chain)
+ */
+static inline int32_t dotInt8(int8_t * __restrict__ weight, data_t * __restrict__ inFeatures, int n, int32_t acc)
+{
+#ifdef HOST
+  return hostSumDotpI8N(weight, inFeatures, n, acc);
+#elif defined SIMD
+  // the weight pairs are sign-extended to v2s and fed to the 16-bit dot product
+  for(int i=0; i<n/2; i++) {
+    v2s w = {weight[2*i], weight[2*i+1]};
+    SDOTP_GENERIC(acc, w, ((v2s*)inFeatures)[i]);
+  }
+  if(n%2 == 1)
+    acc += weight[n-1]*inFeatures[n-1];
+  return acc;
 #else
-      for(int o=0; o<TensorSize; o++)
-        FeaturesA[o] += FeaturesB[o];
-#endif
-      PROFILING_ADDT_END
+  for(int i=0; i<n; i++)
+    acc += weight[i]*inFeatures[i];
+  return acc;
 #endif
-    }
+}
 
-/** @brief Calculates point-wise Multiplication of Tensors (A*=B) also known as Hadamard Product
- *
- *  @param TensorSize Input Value
- *  @param FeaturesA Accumulation Tensor
- *  @param FeaturesB Multiplicand Tensor
+/** @brief Dot product of n packed int4 weights with n inputs added to acc, the nibbles are unpacked in registers
  */
-    void NOINLINE HadMulTensor (
-        // Layer Attributes
-      int TensorSize,
-        // Layer Parameters
-      data_t * __restrict__ FeaturesA,
-      data_t * __restrict__ FeaturesB)
-    {
-      PROFILING_HADM_START
-      for (int o=0; o< TensorSize; o++) 
-      {
-#ifdef FixedPt
-       FeaturesA[o] = (FeaturesA[o]*FeaturesB[o])>>(q_fraqP1);
+static inline int32_t dotInt4(uint8_t * __restrict__ weight, data_t * __restrict__ inFeatures, int n, int32_t acc)
+{
+#ifdef HOST
+  return hostSumDotpI4N(weight, inFeatures, n, acc);
+#elif defined SIMD
+  // one byte holds the weight pair of a v2s input pair
+  for(int i=0; i<n/2; i++) {
+    v2s w = {INT4_LO(weight[i]), INT4_HI(weight[i])};
+    SDOTP_GENERIC(acc, w, ((v2s*)inFeatures)[i]);
+  }
+  if(n%2 == 1)
+    acc += INT4_LO(weight[n/2])*inFeatures[n-1];
+  return acc;
 #else
-       FeaturesA[o] *= FeaturesB[o];
+  for(int i=0; i<n/2; i++)
+    acc += INT4_LO(weight[i])*inFeatures[2*i] + INT4_HI(weight[i])*inFeatures[2*i+1];
+  if(n%2 == 1)
+    acc += INT4_LO(weight[n/2])*inFeatures[n-1];
+  return acc;
 #endif
-     }
-     PROFILING_HADM_END
-   }
+}
+
+/// Scaled dot product of an int8 weight row (same format as the accumulators of the data_t kernels)
+static inline int32_t scaleInt8(int32_t acc, int32_t scale)
+{
+  return (int32_t)(((int64_t)acc*scale)>>WEIGHT_SCALE_SHIFT);
+}
 
+#ifdef PACKED_TILES
+#define LINEAR_INT8_TILE_KERNEL(N) LINEAR_PACKED_TILE_KERNEL(Int8, N)
+#define TWOLINEAR_INT8_TILE_KERNEL(N) TWOLINEAR_PACKED_TILE_KERNEL(Int8, N)
+#define LINEAR_INT4_TILE_KERNEL(N) LINEAR_PACKED_TILE_KERNEL(Int4, N)
+#define TWOLINEAR_INT4_TILE_KERNEL(N) TWOLINEAR_PACKED_TILE_KERNEL(Int4, N)
+TILE_KERNEL_FAMILY(LINEAR_INT8_TILE_KERNEL)
+TILE_KERNEL_FAMILY(TWOLINEAR_INT8_TILE_KERNEL)
+TILE_KERNEL_FAMILY(CONV2D_INT8_TILE_KERNEL)
+TILE_KERNEL_FAMILY(LINEAR_INT4_TILE_KERNEL)
+TILE_KERNEL_FAMILY(TWOLINEAR_INT4_TILE_KERNEL)
+/// LinearLayerInt8 kernels of all the output FM tile sizes (index: tile size)
+static void (* const linearLayerInt8Tiles[TILE_MAXSIZE+1])(int, int, int, uint8_t *, int32_t *, data_t *, data_t *, data_t *,
+  int, struct epilogue) = TILE_KERNEL_TABLE(LinearLayerInt8Tile);
+/// TwoLinearLayersAccumulateInt8 kernels of all the output FM tile sizes (index: tile size)
+static void (* const twoLinearLayersAccumulateInt8Tiles[TILE_MAXSIZE+1])(int, int, int, int, int, struct epilogue,
+  uint8_t *, uint8_t *, int32_t *, int32_t *, data_t *, data_t *, data_t *, data_t *, data_t *, int) = TILE_KERNEL_TABLE(TwoLinearLayersAccumulateInt8Tile);
+/// Conv2dLayerInt8 kernels of all the output FM tile sizes (index: tile size)
+static void (* const conv2dLayerInt8Tiles[TILE_MAXSIZE+1])(int, int, int, int, int, int8_t *, int32_t *, data_t *, data_t *, data_t *,
+  int, struct epilogue) = TILE_KERNEL_TABLE(Conv2dLayerInt8Tile);
+/// LinearLayerInt4 kernels of all the output FM tile sizes (index: tile size)
+static void (* const linearLayerInt4Tiles[TILE_MAXSIZE+1])(int, int, int, uint8_t *, int32_t *, data_t *, data_t *, data_t *,
+  int, struct epilogue) = TILE_KERNEL_TABLE(LinearLayerInt4Tile);
+/// TwoLinearLayersAccumulateInt4 kernels of all the output FM tile sizes (index: tile size)
+static void (* const twoLinearLayersAccumulateInt4Tiles[TILE_MAXSIZE+1])(int, int, int, int, int, struct epilogue,
+  uint8_t *, uint8_t *, int32_t *, int32_t *, data_t *, data_t *, data_t *, data_t *, data_t *, int) = TILE_KERNEL_TABLE(TwoLinearLayersAccumulateInt4Tile);
+#endif
 
-/** @brief Copy of Tensor A to B
+/** @brief Calculates a Linear Layer with int8 weights
  *
- *  @param TensorSize Input Value
- *  @param FeaturesA Source Tensor
- *  @param FeaturesB Destination Tensor
- */
-   void NOINLINE CopyTensor (
-        // Layer Attributes
-    int TensorSize,
-        // Layer Parameters
-    data_t * __restrict__ FeaturesA,
-    data_t * __restrict__ FeaturesB)
-   {
-    PROFILING_COPY_START
-    for (int o=0; o< TensorSize; o++) 
-    {
-      FeaturesA[o] = FeaturesB[o];
-    }
-    PROFILING_COPY_END
-  }
-/** @brief In-Place application of tangent hyperbolic on Tensor
+ *  With PACKED_TILES the output neurons are computed in output FM tiles (LinearLayerInt8TileN, the
+ *  weights are unpacked in registers and the inputs are read once per tile), otherwise neuron by
+ *  neuron.
  *
- *  @param TensorSize Input Value
- *  @param Features Input and Output of Activation Fucntion
+ *  @param inFeaturesSize Number of input neurons
+ *  @param outFeaturesSize Number of output neurons
+ *  @param hasBias FC with bias or not?
+ *  @param weight int8 weights [outFeaturesSize x inFeaturesSize]
+ *  @param scale Scale of every output neuron
+ *  @param bias Pointer to bias
+ *  @param inFeatures Input Feature Map
+ *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (output FM tile size, see struct tiling)
  */
-#ifdef ASIP_USETANHSIG
-  void NOINLINE TanhLayer (
-        // Layer Attributes
-    int TensorSize,
-    data_t * __restrict__ Features)
+void NOINLINE LinearLayerInt8 (
+  int inFeaturesSize, int outFeaturesSize,
+  short hasBias,
+  int8_t * __restrict__ weight,
+  int32_t * __restrict__ scale,
+  data_t * __restrict__ bias,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct epilogue epilogue,
+  struct tiling tiling)
+{
+  PROFILING_LINEAR_START
+#ifdef PACKED_TILES
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(tiling), tileOptions);
+  int o = 0;
+  for(int i=0; i<numTileOptions && o<outFeaturesSize; i++) {
+    int tiles = (outFeaturesSize-o)/tileOptions[i];
+    if(tiles == 0) continue;
+    linearLayerInt8Tiles[tileOptions[i]](tiles, inFeaturesSize, inFeaturesSize, (uint8_t*)&weight[o*inFeaturesSize], &scale[o],
+      hasBias ? &bias[o] : NULL, inFeatures, &outFeatures[o], shift, epilogue);
+    o += tiles*tileOptions[i];
+  }
+#else
+  (void)tiling; // neuron by neuron
+  for(int o=0; o<outFeaturesSize; o++)
   {
-    PROFILING_TANH_START
-    for(int i=0; i<TensorSize; i++) {
-      Features[i] = tzscale_tanh(Features[i]); //tzscale_tanh(Features[i],0);
-    }
-    PROFILING_TANH_END
+    int32_t temp = hasBias ? (int32_t)bias[o]<<(shift) : 0;
+    temp += scaleInt8(dotInt8(&weight[o*inFeaturesSize], inFeatures, inFeaturesSize, 0), scale[o]);
+    outFeatures[o] = shiftAndEpilogue(temp, shift, epilogue);
+  }
+#endif
+  PROFILING_LINEAR_END
+}
+
+/** @brief TwoLinearLayersAccumulate with int8 weights: activation(W1*in1 + b1 + W2*in2 + b2)
+ *
+ *  Output FM tiles with PACKED_TILES (see LinearLayerInt8).
+ *
+ *  @param inFeaturesSize1 Number of input neurons of the first product
+ *  @param inFeaturesSize2 Number of input neurons of the second product
+ *  @param outFeaturesSize Number of output neurons
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param weight1 int8 weights [outFeaturesSize x inFeaturesSize1]
+ *  @param weight2 int8 weights [outFeaturesSize x inFeaturesSize2]
+ *  @param scale1 Scale of every output neuron of weight1
+ *  @param scale2 Scale of every output neuron of weight2
+ *  @param bias1 Bias of the first product
+ *  @param bias2 Bias of the second product
+ *  @param inFeatures1 Input Feature Map of the first product
+ *  @param inFeatures2 Input Feature Map of the second product
+ *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (output FM tile size, see struct tiling)
+ */
+void NOINLINE TwoLinearLayersAccumulateInt8 (
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+  int8_t * __restrict__ weight1,
+  int8_t * __restrict__ weight2,
+  int32_t * __restrict__ scale1,
+  int32_t * __restrict__ scale2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling)
+{
+  PROFILING_TWOLINEAR_START
+#ifdef PACKED_TILES
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(tiling), tileOptions);
+  int o = 0;
+  for(int i=0; i<numTileOptions && o<outFeaturesSize; i++) {
+    int tiles = (outFeaturesSize-o)/tileOptions[i];
+    if(tiles == 0) continue;
+    twoLinearLayersAccumulateInt8Tiles[tileOptions[i]](tiles, inFeaturesSize1, inFeaturesSize2, inFeaturesSize1, inFeaturesSize2, epilogue,
+      (uint8_t*)&weight1[o*inFeaturesSize1], (uint8_t*)&weight2[o*inFeaturesSize2], &scale1[o], &scale2[o],
+      &bias1[o], &bias2[o], inFeatures1, inFeatures2, &outFeatures[o], shift);
+    o += tiles*tileOptions[i];
   }
 #else
-  void NOINLINE TanhLayer (
-        // Layer Attributes
-    int TensorSize,
-    data_t * __restrict__ Features)
+  (void)tiling; // neuron by neuron
+  for(int o=0; o<outFeaturesSize; o++)
   {
-    PROFILING_TANH_START
-    for (int o=0; o< TensorSize; o++) 
-      Features[o] = Tanh(Features[o]);
-
-    PROFILING_TANH_END
+    int32_t temp = ((int32_t)bias1[o]+(int32_t)bias2[o])<<(shift);
+    temp += scaleInt8(dotInt8(&weight1[o*inFeaturesSize1], inFeatures1, inFeaturesSize1, 0), scale1[o]);
+    temp += scaleInt8(dotInt8(&weight2[o*inFeaturesSize2], inFeatures2, inFeaturesSize2, 0), scale2[o]);
+    outFeatures[o] = shiftAndEpilogue(temp, shift, epilogue);
   }
 #endif
+  PROFILING_TWOLINEAR_END
+}
 
+/** @brief LinearLayerInt8 for seqSize time steps on NUM_CORES cores
+ *
+ *  Same split as LinearLayerParallel: a single time step into tasks of output FM tiles, sequences
+ *  into tasks of time steps. Without NUM_CORES, or if the caller is already one of the cores, the
+ *  time steps are computed one after the other. Returns after all the cores are done.
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param outFeaturesSize Number of output neurons
+ *  @param seqSize Number of time steps
+ *  @param hasBias FC with bias or not?
+ *  @param weight int8 weights [outFeaturesSize x inFeaturesSize]
+ *  @param scale Scale of every output neuron
+ *  @param bias Pointer to bias
+ *  @param inFeatures Input Feature Map [seqSize x inFeaturesSize]
+ *  @param outFeatures Output Feature Map [seqSize x outFeaturesSize]
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (see struct tiling)
+ */
+void NOINLINE LinearLayerInt8Parallel (
+  int inFeaturesSize, int outFeaturesSize, int seqSize,
+  short hasBias,
+  int8_t * __restrict__ weight,
+  int32_t * __restrict__ scale,
+  data_t * __restrict__ bias,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct epilogue epilogue,
+  struct tiling tiling)
+{
+#ifdef NUM_CORES
+  if(!parallelInside() && (seqSize == 1 ? outFeaturesSize : seqSize) > tilingOutTile(tiling)) {
+    struct parallelJob job = {0};
+    job.inSize1  = inFeaturesSize;
+    job.outSize  = outFeaturesSize;
+    job.rows     = seqSize;
+    job.hasBias  = hasBias;
+    job.weight1  = (data_t *)weight;
+    job.scale1   = scale;
+    job.bias1    = bias;
+    job.in1      = inFeatures;
+    job.out      = outFeatures;
+    job.shift    = shift;
+    job.epilogue = epilogue;
+    job.tiling   = tiling;
+    parallelJob = job;
+    parallelRunTasks(parallelLinearInt8, &parallelJob, seqSize == 1 ? outFeaturesSize : seqSize, tilingOutTile(tiling));
+    return;
+  }
+#endif
+  for(int seq=0; seq<seqSize; seq++)
+    LinearLayerInt8(inFeaturesSize, outFeaturesSize, hasBias, weight, scale, bias,
+      &inFeatures[seq*inFeaturesSize], &outFeatures[seq*outFeaturesSize], shift, epilogue, tiling);
+}
 
-
-/** @brief In-Place application of sigmoid activation on Tensor
+/** @brief TwoLinearLayersAccumulateInt8 on NUM_CORES cores (tasks of output FM tiles), returns
+ *  after all the cores are done
  *
- *  @param TensorSize Input Value
- *  @param Features Input and Output of Activation Fucntion
+ *  Same parameters as TwoLinearLayersAccumulateInt8.
  */
-#ifdef ASIP_USETANHSIG
-  void NOINLINE SigLayer (
-        // Layer Attributes
-    int TensorSize,
-    data_t * __restrict__ Features)
-  {
-    PROFILING_TANH_START
+void NOINLINE TwoLinearLayersAccumulateInt8Parallel (
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+  int8_t * __restrict__ weight1,
+  int8_t * __restrict__ weight2,
+  int32_t * __restrict__ scale1,
+  int32_t * __restrict__ scale2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling)
+{
+#ifdef NUM_CORES
+  if(!parallelInside() && outFeaturesSize > tilingOutTile(tiling)) {
+    struct parallelJob job = {0};
+    job.inSize1  = inFeaturesSize1;
+    job.inSize2  = inFeaturesSize2;
+    job.outSize  = outFeaturesSize;
+    job.epilogue = epilogue;
+    job.weight1  = (data_t *)weight1;
+    job.weight2  = (data_t *)weight2;
+    job.scale1   = scale1;
+    job.scale2   = scale2;
+    job.bias1    = bias1;
+    job.bias2    = bias2;
+    job.in1      = inFeatures1;
+    job.in2      = inFeatures2;
+    job.out      = outFeatures;
+    job.shift    = shift;
+    job.tiling   = tiling;
+    parallelJob = job;
+    parallelRunTasks(parallelTwoLinearInt8, &parallelJob, outFeaturesSize, tilingOutTile(tiling));
+    return;
+  }
+#endif
+  TwoLinearLayersAccumulateInt8(inFeaturesSize1, inFeaturesSize2, outFeaturesSize, epilogue,
+    weight1, weight2, scale1, scale2, bias1, bias2, inFeatures1, inFeatures2, outFeatures, shift, tiling);
+}
 
-    for(int i=0; i<TensorSize; i++) {
-      //ext_nop();chess_separator_scheduler();
-      Features[i] = tzscale_sig(Features[i]); //tzscale_tanh(Features[i],0);
-    }
-    PROFILING_TANH_END
+/** @brief Calculates a Linear Layer with packed int4 weights
+ *
+ *  Output FM tiles with PACKED_TILES (LinearLayerInt4TileN, every word load holds the weights of 8
+ *  inputs), otherwise neuron by neuron (see LinearLayerInt8).
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param outFeaturesSize Number of output neurons
+ *  @param hasBias FC with bias or not?
+ *  @param weight int4 weights [outFeaturesSize x INT4_ROW_BYTES(inFeaturesSize)]
+ *  @param scale Scale of every output neuron
+ *  @param bias Pointer to bias
+ *  @param inFeatures Input Feature Map
+ *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (output FM tile size, see struct tiling)
+ */
+void NOINLINE LinearLayerInt4 (
+  int inFeaturesSize, int outFeaturesSize,
+  short hasBias,
+  uint8_t * __restrict__ weight,
+  int32_t * __restrict__ scale,
+  data_t * __restrict__ bias,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct epilogue epilogue,
+  struct tiling tiling)
+{
+  PROFILING_LINEAR_START
+  int rowBytes = INT4_ROW_BYTES(inFeaturesSize);
+#ifdef PACKED_TILES
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(tiling), tileOptions);
+  int o = 0;
+  for(int i=0; i<numTileOptions && o<outFeaturesSize; i++) {
+    int tiles = (outFeaturesSize-o)/tileOptions[i];
+    if(tiles == 0) continue;
+    linearLayerInt4Tiles[tileOptions[i]](tiles, inFeaturesSize, rowBytes, &weight[o*rowBytes], &scale[o],
+      hasBias ? &bias[o] : NULL, inFeatures, &outFeatures[o], shift, epilogue);
+    o += tiles*tileOptions[i];
   }
 #else
-  void NOINLINE SigLayer (
-        // Layer Attributes
-    int TensorSize,
-    data_t * __restrict__ Features)
+  (void)tiling; // neuron by neuron
+  for(int o=0; o<outFeaturesSize; o++)
   {
-    PROFILING_TANH_START
-    for (int o=0; o< TensorSize; o++) 
-      Features[o] = sig(Features[o]);
-
-    PROFILING_TANH_END
+    int32_t temp = hasBias ? (int32_t)bias[o]<<(shift) : 0;
+    temp += scaleInt8(dotInt4(&weight[o*rowBytes], inFeatures, inFeaturesSize, 0), scale[o]);
+    outFeatures[o] = shiftAndEpilogue(temp, shift, epilogue);
   }
 #endif
+  PROFILING_LINEAR_END
+}
 
-
-
-
-
-/** @brief Fills Tensor with contstant
+/** @brief TwoLinearLayersAccumulate with packed int4 weights: activation(W1*in1 + b1 + W2*in2 + b2)
  *
- *  @param TensorSize Input Value
- *  @param Tensor Input and Output of Activation Fucntion
- *  @param fillValue constant value
+ *  Output FM tiles with PACKED_TILES (see LinearLayerInt4).
+ *
+ *  @param inFeaturesSize1 Number of input neurons of the first product
+ *  @param inFeaturesSize2 Number of input neurons of the second product
+ *  @param outFeaturesSize Number of output neurons
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param weight1 int4 weights [outFeaturesSize x INT4_ROW_BYTES(inFeaturesSize1)]
+ *  @param weight2 int4 weights [outFeaturesSize x INT4_ROW_BYTES(inFeaturesSize2)]
+ *  @param scale1 Scale of every output neuron of weight1
+ *  @param scale2 Scale of every output neuron of weight2
+ *  @param bias1 Bias of the first product
+ *  @param bias2 Bias of the second product
+ *  @param inFeatures1 Input Feature Map of the first product
+ *  @param inFeatures2 Input Feature Map of the second product
+ *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (output FM tile size, see struct tiling)
  */
-  void NOINLINE fillTensor (
-  // Layer Attributes
-    int TensorSize,
-    data_t * __restrict__ Tensor,
-    data_t fillValue)
+void NOINLINE TwoLinearLayersAccumulateInt4 (
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+  uint8_t * __restrict__ weight1,
+  uint8_t * __restrict__ weight2,
+  int32_t * __restrict__ scale1,
+  int32_t * __restrict__ scale2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling)
+{
+  PROFILING_TWOLINEAR_START
+  int rowBytes1 = INT4_ROW_BYTES(inFeaturesSize1);
+  int rowBytes2 = INT4_ROW_BYTES(inFeaturesSize2);
+#ifdef PACKED_TILES
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(tiling), tileOptions);
+  int o = 0;
+  for(int i=0; i<numTileOptions && o<outFeaturesSize; i++) {
+    int tiles = (outFeaturesSize-o)/tileOptions[i];
+    if(tiles == 0) continue;
+    twoLinearLayersAccumulateInt4Tiles[tileOptions[i]](tiles, inFeaturesSize1, inFeaturesSize2, rowBytes1, rowBytes2, epilogue,
+      &weight1[o*rowBytes1], &weight2[o*rowBytes2], &scale1[o], &scale2[o],
+      &bias1[o], &bias2[o], inFeatures1, inFeatures2, &outFeatures[o], shift);
+    o += tiles*tileOptions[i];
+  }
+#else
+  (void)tiling; // neuron by neuron
+  for(int o=0; o<outFeaturesSize; o++)
   {
-    PROFILING_FILL_START
-    for (int o=0; o< TensorSize; o++) 
-    {
-      Tensor[o] = fillValue;
-    }
-    PROFILING_FILL_END
+    int32_t temp = ((int32_t)bias1[o]+(int32_t)bias2[o])<<(shift);
+    temp += scaleInt8(dotInt4(&weight1[o*rowBytes1], inFeatures1, inFeaturesSize1, 0), scale1[o]);
+    temp += scaleInt8(dotInt4(&weight2[o*rowBytes2], inFeatures2, inFeaturesSize2, 0), scale2[o]);
+    outFeatures[o] = shiftAndEpilogue(temp, shift, epilogue);
   }
+#endif
+  PROFILING_TWOLINEAR_END
+}
 
-
-
-
-
-
-
-
-
-
-
-
-
-// inline data_t  ALWAYS_INLINE  Tanh_old(data_t value) {
-// #ifdef TURNOFF
-//   #ifdef ASIP  
-//   int tmp = Max(Min(15, (((int)value+18432-2048)>>11)),0);
-// #else // ASIP
-//   #ifndef USE_INTRINSICS
-//   int tmp = Max(Min(15, (((int)value+18432-2048)>>11)),0);
-//   #else // USET_INTRINSICS
-// // [START clipur version]
-//    int tmp = (((int)value+18432-2048)>>11);
-//    asm volatile ("p.clipur" " %[c], %[a],%[b]\n"
-//         : [c] "=r" (tmp)
-//         : [a] "r" (tmp), [b] "r" (lb_lut_numelements)); // TODO: check puts p.clipu instead!!
-// // [END clipur version]
-//   #endif // USET_INTRINSICS
-// #endif // ASIP
-//   return ((lut_Tanh_m[tmp]*value) >> (q_fraqP1))+lut_Tanh_q[tmp];
-
-// #else // TURNOFF
-// #ifdef FixedPt 
-//   //printf("%i, ", PIHalf);
-//   if(Abs(value) < tanh_threshold) 
-//   {
-
-//     int x_power = value;
-//     int partSum = value;
-
-//     for(int i = 1; i<4; i++) {
-//       x_power = ((x_power * value) >> (q_fraqP1)) * value >> (q_fraqP1);
-//       // printf("%i, ", x_power);
-//       partSum = partSum + (tanh_coeff[i]*x_power >> (q_fraqP1));
-//     }
-//     // printf("%i==%i, ", partSum, (data_t)((1.0f - 2.0/(expTailor(tailorPrecission, 2*(float)(value)/(1<<(q_fraqP1)))+1))*(1<<(q_fraqP1))));
-//     return partSum;
-//   } else {
-//     // printf("tanh");
-//     return (data_t)((1.0f - 2.0/(expTailor(tailorPrecission, 2*(float)(value)/(1<<(q_frac)))+1))*(1<<(q_frac)));
-//   }  
-// #else // FixedPt
-//          return (1.0f - 2.0/(expTailor(tailorPrecission, 2*value)+1));
-// #endif // FixedPt
-//   #endif // TURNOFF
-// }
-// // inline v2s ALWAYS_INLINE sig_SIMD(v2s value)
-// // {
-// //    // TODO: NOT WORKING at the moment
-// // #ifdef SIMD
-// // #ifdef TURNOFF
-// //   // return value;
-// // // printf("qwer\n");
-// //   int tmp = Max(Min(8, Abs(((int)value+2048)/4096)),0);
-// //   return ((lut_fakeTanh_m[tmp]*value) >> (q_fraqP1))+lut_fakeTanh_q[tmp];
-// // #endif // TURNOFF
-// // #endif // SIMD
-
-// //   printf("This function should not be called this way!");
-
-// // }
-
-
-// inline data_t ALWAYS_INLINE sig_old(data_t value)
-// {
-
-// #ifdef TURNOFF
-// #ifdef ASIP
-//   int tmp = Max(Min(15, (((int)value+18432-2048)>>11)),0);
-// #else // ASIP
-//   #ifndef USE_INTRINSICS
-//   int tmp = Max(Min(15, (((int)value+18432-2048)>>11)),0);
-//   #else // USET_INTRINSICS
-// // [START clipur version]
-//    int tmp = (((int)value+2048)/4096);
-//    asm volatile ("p.clipur" " %[c], %[a],%[b]\n"
-//         : [c] "=r" (tmp)
-//         : [a] "r" (tmp), [b] "r" (lb_lut_numelements)); // TODO: check puts p.clipu instead!!
-// // [END clipur version]
-//   #endif // USET_INTRINSICS
-// #endif //ASIP
-//   return ((lut_sig_m[tmp]*value) >> (q_fraqP1))+lut_sig_q[tmp];
-
-// #else
-//   #ifdef FixedPt
-//     if(Abs(value) < sig_threshold) 
-//   {
-//     int x_power = value;
-//     int partSum = sig_coeff[0]+ (sig_coeff[1]*value >> (q_fraqP1));;
-
-//     for(int i = 2; i<4; i++) {
-//       x_power = (x_power * value >> (q_fraqP1)) * value >> (q_fraqP1);
-//       // printf("(%i), ", sig_coeff[3]);
-//       partSum = partSum + ((sig_coeff[i]*x_power) >> (q_frac));
-      
-//     }
-//     // printf("%i==%i, ", partSum, (data_t)((1.0f - 2.0/(expTailor(tailorPrecission, 2*(float)(value)/(1<<(q_fraqP1)))+1))*(1<<(q_fraqP1))));
-//     return partSum;
-//   } else {
-//          // printf("sig, %i>>%i:", value, q_frac);
-//          //printFloat((data_t)((1.0/(1.0+expTailor(tailorPrecission, -(float)(value)/(1<<(q_frac)))))*(1<<(q_frac))));
-
-//          return (data_t)((1.0/(1.0+expTailor(tailorPrecission, -(float)(value)/(1<<(q_frac)))))*(1<<(q_frac)));
-//   }
-//   #else
-
-//          return 1.0/(1.0+expTailor(tailorPrecission, -((float)value)));
-//   #endif
-// #endif  
-// }
-
-
-
-
-
-/** @brief Calculates an RNN layer
+/** @brief LinearLayerInt4 for seqSize time steps on NUM_CORES cores (same split as
+ *  LinearLayerInt8Parallel), returns after all the cores are done
  *
- *  Calculates an RNN layer based on 
- *  h_t = \\tanh(w_{ih} x_t + b_{ih}  +  w_{hh} h_{(t-1)} + b_{hh})
- *  @param inFeaturesSize Number of input neurons
- *  @param hiddenFeaturesSize Number of hidden neurons
- *  @param weight_ih_l Weights mapping input neurons to hidden neurons
- *  @param weight_hh_l Weights mapping hidden neurons to hidden neurons
- *  @param bias_ih_l Bias mapping input neurons to hidden neurons
- *  @param bias_hh_l Bias mapping hidden neurons to hidden neurons
- *  @param inFeatures Input Feature Map
- *  @param outFeatures Output Feature Map
- *  @param hiddenFeatures Hidden Feature Map
+ *  Same parameters as LinearLayerInt8Parallel, the weights are packed int4
+ *  [outFeaturesSize x INT4_ROW_BYTES(inFeaturesSize)].
  */
-void NOINLINE RNNLayer (
-        // Layer Attributes
-  int inFeaturesSize, int hiddenFeaturesSize,
-        // Layer Parameters
-  data_t * __restrict__ weight_ih_l,
-  data_t * __restrict__ weight_hh_l,
-  data_t * __restrict__ bias_ih_l,
-  data_t * __restrict__ bias_hh_l,
-        // Input and Output Features
+void NOINLINE LinearLayerInt4Parallel (
+  int inFeaturesSize, int outFeaturesSize, int seqSize,
+  short hasBias,
+  uint8_t * __restrict__ weight,
+  int32_t * __restrict__ scale,
+  data_t * __restrict__ bias,
   data_t * __restrict__ inFeatures,
-        data_t * __restrict__ outFeatures, // out and hidden
-        // Hidden Features
-        data_t * __restrict__ hiddenFeatures)
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct epilogue epilogue,
+  struct tiling tiling)
 {
-  for(int seq=0; seq< rnn_seqSize; seq++) {
-      LinearLayer(hiddenFeaturesSize,hiddenFeaturesSize,True,(data_t*)weight_hh_l, bias_hh_l, hiddenFeatures, outFeatures); //w_{hh} h_{(t-1)}
-      LinearLayer(inFeaturesSize,hiddenFeaturesSize,True,(data_t*)weight_ih_l, bias_ih_l, inFeatures+seq*inFeaturesSize, hiddenFeatures); //w_{ih} x_t + b_{ih} 
+#ifdef NUM_CORES
+  if(!parallelInside() && (seqSize == 1 ? outFeaturesSize : seqSize) > tilingOutTile(tiling)) {
+    struct parallelJob job = {0};
+    job.inSize1  = inFeaturesSize;
+    job.outSize  = outFeaturesSize;
+    job.rows     = seqSize;
+    job.hasBias  = hasBias;
+    job.weight1  = (data_t *)weight;
+    job.scale1   = scale;
+    job.bias1    = bias;
+    job.in1      = inFeatures;
+    job.out      = outFeatures;
+    job.shift    = shift;
+    job.epilogue = epilogue;
+    job.tiling   = tiling;
+    parallelJob = job;
+    parallelRunTasks(parallelLinearInt4, &parallelJob, seqSize == 1 ? outFeaturesSize : seqSize, tilingOutTile(tiling));
+    return;
+  }
+#endif
+  for(int seq=0; seq<seqSize; seq++)
+    LinearLayerInt4(inFeaturesSize, outFeaturesSize, hasBias, weight, scale, bias,
+      &inFeatures[seq*inFeaturesSize], &outFeatures[seq*outFeaturesSize], shift, epilogue, tiling);
+}
 
-      AddTensor(hiddenFeaturesSize, outFeatures, hiddenFeatures);
-      TanhLayer(hiddenFeaturesSize, outFeatures);
-      CopyTensor(hiddenFeaturesSize, hiddenFeatures, outFeatures);
-    }
+/** @brief TwoLinearLayersAccumulateInt4 on NUM_CORES cores (tasks of output FM tiles), returns
+ *  after all the cores are done
+ *
+ *  Same parameters as TwoLinearLayersAccumulateInt4.
+ */
+void NOINLINE TwoLinearLayersAccumulateInt4Parallel (
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+  uint8_t * __restrict__ weight1,
+  uint8_t * __restrict__ weight2,
+  int32_t * __restrict__ scale1,
+  int32_t * __restrict__ scale2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling)
+{
+#ifdef NUM_CORES
+  if(!parallelInside() && outFeaturesSize > tilingOutTile(tiling)) {
+    struct parallelJob job = {0};
+    job.inSize1  = inFeaturesSize1;
+    job.inSize2  = inFeaturesSize2;
+    job.outSize  = outFeaturesSize;
+    job.epilogue = epilogue;
+    job.weight1  = (data_t *)weight1;
+    job.weight2  = (data_t *)weight2;
+    job.scale1   = scale1;
+    job.scale2   = scale2;
+    job.bias1    = bias1;
+    job.bias2    = bias2;
+    job.in1      = inFeatures1;
+    job.in2      = inFeatures2;
+    job.out      = outFeatures;
+    job.shift    = shift;
+    job.tiling   = tiling;
+    parallelJob = job;
+    parallelRunTasks(parallelTwoLinearInt4, &parallelJob, outFeaturesSize, tilingOutTile(tiling));
+    return;
   }
+#endif
+  TwoLinearLayersAccumulateInt4(inFeaturesSize1, inFeaturesSize2, outFeaturesSize, epilogue,
+    weight1, weight2, scale1, scale2, bias1, bias2, inFeatures1, inFeatures2, outFeatures, shift, tiling);
+}
 
-/** @brief Calculates an LSTM layer
- *  @param inFeaturesSize Number of input neurons
- *  @param hiddenFeaturesSize Number of hidden neurons
- *  @param weight_ih_l Weights mapping input neurons to hidden neurons
- *  @param weight_hh_l Weights mapping hidden neurons to hidden neurons
- *  @param bias_ih_l Bias mapping input neurons to hidden neurons
- *  @param bias_hh_l Bias mapping hidden neurons to hidden neurons
+/** @brief Calculates an LSTM layer with int8, packed int4 or 2:4 sparse weights (weightFormat of the layer)
+ *
+ *  The gates are computed with TwoLinearLayersAccumulateInt8Parallel/Int4Parallel/2of4 (activation in the
+ *  output stage), the state update is the same as in LSTMLayer.
+ *
+ *  @param _layer Layer Properties (weights and scales or positions of the gates i, f, g, o)
+ *  @param seqSize Number of time steps
+ *  @param inFeatures input feature map [seqSize x inFeaturesSize]
+ *  @param outFeatures hidden state of all the time steps [seqSize x hiddenFeaturesSize]
  *  @param lstm_h hidden state tensor
  *  @param lstm_c cell state tensor
- *  @param lstm_f forget gate activation tensor
- *  @param inFeatures input feature map
- *  @param lstm_i input/update gate activation tensor
- *  @param lstm_g g tensor 
- *  @param lstm_o output gate tensor
+ *  @param nodes intermediate nodes [4 x hiddenFeaturesSize]
  */
-  void NOINLINE LSTMLayer (
-// Layer Attributes
-    int inFeaturesSize, int hiddenFeaturesSize,
-        // Layer Parameters
-    data_t * __restrict__ weight_ih_l,
-    data_t * __restrict__ weight_hh_l,
-    data_t * __restrict__ bias_ih_l,
-    data_t * __restrict__ bias_hh_l,
-        // Input and Output Features
-    data_t * __restrict__ inFeatures,
-    data_t * __restrict__ lstm_h,
-        // Hidden Features
-    data_t * __restrict__ lstm_c,
-        // intermediate nodes
-    data_t * __restrict__ lstm_f,
-    data_t * __restrict__ lstm_i,
-    data_t * __restrict__ lstm_g,
-    data_t * __restrict__ lstm_o
-    )
+void NOINLINE LSTMLayerQuantized (
+  struct layer * _layer, int seqSize,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  data_t * __restrict__ lstm_h,
+  data_t * __restrict__ lstm_c,
+  data_t * __restrict__ nodes)
+{
+  PROFILING_LSTM_START
+  int inFeaturesSize = _layer->attributes[LAY_LSTM_IN];
+  int hiddenFeaturesSize = _layer->attributes[LAY_LSTM_HID];
+  int isInt4 = _layer->weightFormat == WEIGHT_INT4;
+  int is2of4 = _layer->weightFormat == WEIGHT_2OF4;
+  // bytes per weight row
+  int rowBytesIH = isInt4 ? INT4_ROW_BYTES(inFeaturesSize) : inFeaturesSize;
+  int rowBytesHH = isInt4 ? INT4_ROW_BYTES(hiddenFeaturesSize) : hiddenFeaturesSize;
+  int8_t * weight_ih_l = (int8_t *)_layer->parameters[LSTM_WGHT_IH];
+  int8_t * weight_hh_l = (int8_t *)_layer->parameters[LSTM_WGHT_HH];
+  int32_t * scale_ih_l = (int32_t *)_layer->parameters[LSTM_SCALE_IH];
+  int32_t * scale_hh_l = (int32_t *)_layer->parameters[LSTM_SCALE_HH];
+  data_t * bias_ih_l = _layer->parameters[LSTM_BIAS_IH];
+  data_t * bias_hh_l = _layer->parameters[LSTM_BIAS_HH];
+  // i, f, g, o
+  const struct epilogue gateEpilogue[4] = {EPILOGUE_ACT(ACT_SIG), EPILOGUE_ACT(ACT_SIG), EPILOGUE_ACT(ACT_TANH), EPILOGUE_ACT(ACT_SIG)};
+  int shift = layerShift(_layer);
+  for(int seq=0; seq<seqSize; seq++)
   {
-    PROFILING_LSTM_START
-  #ifdef DEBUG_LSTM
-    printf("lstm_in: ");PrintTensor(inFeaturesSize, inFeatures);
-    #endif
-    for(int seq=0; seq< lstm_seqSize; seq++) {
-
-  //it=σ(Wiixt+bii+Whih(t−1)+bhi)
-      TwoLinearLayersAccumulate (
-          // Layer Attributes
-        inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, ACT_SIG, 
+    for(int g=0; g<4; g++)
+      if(is2of4)
+        TwoLinearLayersAccumulate2of4(inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, gateEpilogue[g],
+          &_layer->parameters[LSTM_WGHT_IH][g*hiddenFeaturesSize*NM_ROW_WEIGHTS(inFeaturesSize)],
+          &_layer->parameters[LSTM_WGHT_HH][g*hiddenFeaturesSize*NM_ROW_WEIGHTS(hiddenFeaturesSize)],
+          &((uint8_t *)_layer->parameters[LSTM_INDEX_IH])[g*hiddenFeaturesSize*NM_ROW_BYTES(inFeaturesSize)],
+          &((uint8_t *)_layer->parameters[LSTM_INDEX_HH])[g*hiddenFeaturesSize*NM_ROW_BYTES(hiddenFeaturesSize)],
+          &bias_ih_l[g*hiddenFeaturesSize], &bias_hh_l[g*hiddenFeaturesSize],
+          &inFeatures[seq*inFeaturesSize], lstm_h, &nodes[g*hiddenFeaturesSize], shift, _layer->tiling);
+      else if(isInt4)
+        TwoLinearLayersAccumulateInt4Parallel(inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, gateEpilogue[g],
+          (uint8_t *)&weight_ih_l[g*hiddenFeaturesSize*rowBytesIH], (uint8_t *)&weight_hh_l[g*hiddenFeaturesSize*rowBytesHH],
+          &scale_ih_l[g*hiddenFeaturesSize], &scale_hh_l[g*hiddenFeaturesSize],
+          &bias_ih_l[g*hiddenFeaturesSize], &bias_hh_l[g*hiddenFeaturesSize],
+          &inFeatures[seq*inFeaturesSize], lstm_h, &nodes[g*hiddenFeaturesSize], shift, _layer->tiling);
+      else
+        TwoLinearLayersAccumulateInt8Parallel(inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, gateEpilogue[g],
+          &weight_ih_l[g*hiddenFeaturesSize*rowBytesIH], &weight_hh_l[g*hiddenFeaturesSize*rowBytesHH],
+          &scale_ih_l[g*hiddenFeaturesSize], &scale_hh_l[g*hiddenFeaturesSize],
+          &bias_ih_l[g*hiddenFeaturesSize], &bias_hh_l[g*hiddenFeaturesSize],
+          &inFeatures[seq*inFeaturesSize], lstm_h, &nodes[g*hiddenFeaturesSize], shift, _layer->tiling);
+    data_t * lstm_i = &nodes[0*hiddenFeaturesSize];
+    data_t * lstm_f = &nodes[1*hiddenFeaturesSize];
+    data_t * lstm_g = &nodes[2*hiddenFeaturesSize];
+    data_t * lstm_o = &nodes[3*hiddenFeaturesSize];
+    //ct=ft*c(t−1)+it*gt
+    HadMulTensor(hiddenFeaturesSize, lstm_c, lstm_f);
+    HadMulTensor(hiddenFeaturesSize, lstm_i, lstm_g);
+    AddTensor(hiddenFeaturesSize, lstm_c, lstm_i);
+    //ht=ottanh(ct)
+    CopyTensor(hiddenFeaturesSize, lstm_h, lstm_c);
+    TanhLayer(hiddenFeaturesSize, lstm_h);
+    HadMulTensor(hiddenFeaturesSize, lstm_h, lstm_o);
+    if(outFeatures)
+      CopyTensor(hiddenFeaturesSize, &outFeatures[seq*hiddenFeaturesSize], lstm_h);
+  }
+  PROFILING_LSTM_END
+}
 
-          // Layer Parameters
-          weight_ih_l+0*inFeaturesSize*hiddenFeaturesSize, // weight1
-          weight_hh_l+0*hiddenFeaturesSize*hiddenFeaturesSize, // weight2
-          bias_ih_l+0*hiddenFeaturesSize,   // bias1
-          bias_hh_l+0*hiddenFeaturesSize,   // bias2 
-          inFeatures+seq*inFeaturesSize,    // in1
-          lstm_h,        // in2
-          lstm_i);       // out
-#ifdef DEBUG_LSTM
-      printf("lstm_i: ");PrintTensor(hiddenFeaturesSize, lstm_i);
+/** @brief Calculates a 2D Convolution Layer with int8 weights
+ *
+ *  Same data layout as Conv2dLayer (weights [c_out][kh][kw][c_in], input FM [h][w][c_in], output
+ *  FM [c_out][h][w], zero padding), one scale per output channel. Output channel tiles with
+ *  PACKED_TILES (see LinearLayerInt8).
+ *
+ *  @param _layer Layer Properties
+ *  @param inFeatures Input Feature Map
+ *  @param outFeatures Output Feature Map
+ */
+void NOINLINE Conv2dLayerInt8 (
+  struct layer * _layer,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures)
+{
+  int inChannels  = _layer->attributes[LAY_CONV_IN];
+  int outChannels = _layer->attributes[LAY_CONV_OUT];
+  int kernelSize  = _layer->attributes[LAY_CONV_KER];
+  int h_im = _layer->attributes[LAY_CONV_H];
+  int w_im = _layer->attributes[LAY_CONV_W];
+  int8_t * weight = (int8_t *)_layer->parameters[CONV_WGHT];
+  int32_t * scale = (int32_t *)_layer->parameters[CONV_SCALE];
+  data_t * bias   = _layer->parameters[CONV_BIAS];
+  int shift = layerShift(_layer);
+#ifdef PACKED_TILES
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(_layer->tiling), tileOptions);
+  int c = 0;
+  for(int i=0; i<numTileOptions && c<outChannels; i++) {
+    int tiles = (outChannels-c)/tileOptions[i];
+    if(tiles == 0) continue;
+    conv2dLayerInt8Tiles[tileOptions[i]](tiles, inChannels, kernelSize, h_im, w_im, &weight[c*kernelSize*kernelSize*inChannels],
+      &scale[c], &bias[c], inFeatures, &outFeatures[c*h_im*w_im], shift, _layer->epilogue);
+    c += tiles*tileOptions[i];
+  }
+#else
+  int ker_half = kernelSize/2;
+  for(int c_out=0; c_out<outChannels; c_out++)
+    for(int h_out=0; h_out<h_im; h_out++)
+      for(int w_out=0; w_out<w_im; w_out++)
+      {
+        int32_t acc = 0;
+        for(int kh=Max(-h_out, -ker_half); kh<=Min(h_im-1-h_out, ker_half); kh++)
+          for(int kw=Max(-w_out, -ker_half); kw<=Min(w_im-1-w_out, ker_half); kw++)
+            acc = dotInt8(&weight[((c_out*kernelSize+kh+ker_half)*kernelSize+kw+ker_half)*inChannels],
+              &inFeatures[((h_out+kh)*w_im+w_out+kw)*inChannels], inChannels, acc);
+        int32_t temp = ((int32_t)bias[c_out]<<(shift)) + scaleInt8(acc, scale[c_out]);
+        outFeatures[(c_out*h_im+h_out)*w_im+w_out] = shiftAndEpilogue(temp, shift, _layer->epilogue);
+      }
 #endif
-#ifndef DOACTONTHEFLY
-      SigLayer(hiddenFeaturesSize, lstm_i);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Block-sparse weights: the weight matrix is cut into blocks of SPARSE_BLOCK_OUT output neurons x
+// 2 inputs (one v2s per output neuron) and only the non-zero blocks are stored. Block row b (output
+// neurons b*SPARSE_BLOCK_OUT..) has the blocks blockRows[b]..blockRows[b+1]-1, blockCols[k] is the
+// input pair of block k (block-compressed sparse rows).
+/////////////////////////////////////////////////////////////////////////////////////////////
+#if SPARSE_BLOCK_OUT < 1 || SPARSE_BLOCK_OUT > TILE_MAXSIZE
+#error "SPARSE_BLOCK_OUT: one register per output neuron of a block, 1..TILE_MAXSIZE"
 #endif
-#ifdef DEBUG_LSTM
-      printf("lstm_i: ");PrintTensor(hiddenFeaturesSize, lstm_i);
+/// Accumulator, MAC and store of output neuron k of a block (repeated with TILE_REP_N, see tileKernel.h)
+#define SPARSE_DECLARE(k, next) register_attribute int32_t temp##k = acc[k];
+#define SPARSE_MAC(k, next) SDOTP_GENERIC(temp##k, block[k], inF_temp);
+#define SPARSE_STORE(k, next) acc[k] = temp##k;
+/// TILE_REP_N(M) with N after macro expansion (e.g. SPARSE_BLOCK_OUT)
+#define SPARSE_REP(N, M) SPARSE_REP_(N, M)
+#define SPARSE_REP_(N, M) TILE_REP_##N(M)
+
+/** @brief Calculates a Linear Layer with block-sparse weights
+ *
+ *  A block row is accumulated in SPARSE_BLOCK_OUT registers (output FM tiling like LinearLayer), the
+ *  input pair of a block is loaded once for all of its output neurons and the zero blocks are
+ *  skipped, i.e. the weight loads and the MACs scale with the number of non-zero blocks.
+ *
+ *  @param inFeaturesSize Number of input neurons (even)
+ *  @param outFeaturesSize Number of output neurons
+ *  @param hasBias FC with bias or not?
+ *  @param weight Non-zero blocks [blocks x SPARSE_BLOCK_OUT x 2]
+ *  @param blockRows First block of every block row [ceil(outFeaturesSize/SPARSE_BLOCK_OUT)+1]
+ *  @param blockCols Input pair of every block [blocks]
+ *  @param bias Pointer to bias
+ *  @param inFeatures Input Feature Map
+ *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ */
+void NOINLINE LinearLayerSparse (
+  int inFeaturesSize, int outFeaturesSize,
+  short hasBias,
+  data_t * __restrict__ weight,
+  int32_t * __restrict__ blockRows,
+  uint16_t * __restrict__ blockCols,
+  data_t * __restrict__ bias,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct epilogue epilogue)
+{
+  PROFILING_LINEAR_START
+  (void)inFeaturesSize; // the inputs are addressed by blockCols
+  int numBlockRows = (outFeaturesSize+SPARSE_BLOCK_OUT-1)/SPARSE_BLOCK_OUT;
+  for(int b=0; b<numBlockRows; b++)
+  {
+    int o = b*SPARSE_BLOCK_OUT;
+    int32_t acc[SPARSE_BLOCK_OUT];
+    for(int j=0; j<SPARSE_BLOCK_OUT; j++)
+      acc[j] = (hasBias && o+j<outFeaturesSize) ? (int32_t)bias[o+j]<<(shift) : 0;
+#ifdef SIMD
+    // one register per output neuron of the block
+    v2s * block = &((v2s*)weight)[SPARSE_BLOCK_OUT*blockRows[b]];
+    SPARSE_REP(SPARSE_BLOCK_OUT, SPARSE_DECLARE)
+    for(int k=blockRows[b]; k<blockRows[b+1]; k++)
+    {
+      v2s inF_temp = ((v2s*)inFeatures)[blockCols[k]];
+      SPARSE_REP(SPARSE_BLOCK_OUT, SPARSE_MAC)
+      block += SPARSE_BLOCK_OUT;
+    }
+    SPARSE_REP(SPARSE_BLOCK_OUT, SPARSE_STORE)
+#else
+    data_t * block = &weight[2*SPARSE_BLOCK_OUT*blockRows[b]];
+    for(int k=blockRows[b]; k<blockRows[b+1]; k++)
+    {
+      int i = 2*blockCols[k];
+      for(int j=0; j<SPARSE_BLOCK_OUT; j++)
+        acc[j] += block[2*j]*inFeatures[i] + block[2*j+1]*inFeatures[i+1];
+      block += 2*SPARSE_BLOCK_OUT;
+    }
 #endif
-  //ft=σ(Wif xt+bif+Whf h(t−1)+bhf)
-      TwoLinearLayersAccumulate (
-          // Layer Attributes
-        inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, ACT_SIG, 
+    for(int j=0; j<SPARSE_BLOCK_OUT && o+j<outFeaturesSize; j++)
+      outFeatures[o+j] = shiftAndEpilogue(acc[j], shift, epilogue);
+  }
+  PROFILING_LINEAR_END
+}
 
-          // Layer Parameters
-          weight_ih_l+1*inFeaturesSize*hiddenFeaturesSize, // weight1
-          weight_hh_l+1*hiddenFeaturesSize*hiddenFeaturesSize, // weight2
-          bias_ih_l+1*hiddenFeaturesSize,   // bias1
-          bias_hh_l+1*hiddenFeaturesSize,   // bias2 
-          inFeatures+seq*inFeaturesSize,    // in1
-          lstm_h,        // in2
-          lstm_f);       // out
-        #ifdef DEBUG_LSTM
-      printf("lstm_f: ");PrintTensor(hiddenFeaturesSize, lstm_f);
-    #endif
-#ifndef DOACTONTHEFLY
-      SigLayer(hiddenFeaturesSize, lstm_f);
-#endif
-    #ifdef DEBUG_LSTM
-      printf("lstm_f: ");PrintTensor(hiddenFeaturesSize, lstm_f);
-    #endif
+/////////////////////////////////////////////////////////////////////////////////////////////
+// 2:4 structured sparse weights: every group of 4 inputs of a row has (at most) 2 non-zero weights,
+// the 2 weights are stored as v2s pair with their positions in the group (2 bit each, see
+// NM_ROW_WEIGHTS and NM_ROW_BYTES).
+/////////////////////////////////////////////////////////////////////////////////////////////
 
-    //gt=tanh(Wigxt+big+Whgh(t−1)+bhg)
-      TwoLinearLayersAccumulate (
-          // Layer Attributes
-        inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize, ACT_TANH, 
+/** @brief Dot product of a 2:4 sparse weight row of n inputs with the inputs added to acc
+ *
+ *  The two inputs selected by the positions of a group are gathered into a v2s pair and fed with
+ *  the weight pair to the 16-bit dot product, i.e. half of the MACs of the dense row.
+ */
+static inline int32_t dot2of4(data_t * __restrict__ weight, uint8_t * __restrict__ index, data_t * __restrict__ inFeatures, int n, int32_t acc)
+{
+  int groups = (n+3)/4;
+  int g = 0;
+#ifdef SIMD
+  // two groups per index byte
+  for(; 4*g+8<=n; g+=2) {
+    uint8_t idx = index[g/2];
+    data_t * x = &inFeatures[4*g];
+    v2s x0 = {x[idx&3], x[(idx>>2)&3]};
+    v2s x1 = {x[4+((idx>>4)&3)], x[4+(idx>>6)]};
+    SDOTP_GENERIC(acc, ((v2s*)weight)[g], x0);
+    SDOTP_GENERIC(acc, ((v2s*)weight)[g+1], x1);
+  }
+  for(; g<groups; g++) {
+    int idx = index[g/2]>>(4*(g%2));
+    v2s x = {inFeatures[4*g+(idx&3)], inFeatures[4*g+((idx>>2)&3)]};
+    SDOTP_GENERIC(acc, ((v2s*)weight)[g], x);
+  }
+#else
+  for(; g<groups; g++) {
+    int idx = index[g/2]>>(4*(g%2));
+    acc += weight[2*g]*inFeatures[4*g+(idx&3)] + weight[2*g+1]*inFeatures[4*g+((idx>>2)&3)];
+  }
+#endif
+  return acc;
+}
 
-          // Layer Parameters
-          weight_ih_l+2*inFeaturesSize*hiddenFeaturesSize, // weight1
-          weight_hh_l+2*hiddenFeaturesSize*hiddenFeaturesSize, // weight2
-          bias_ih_l+2*hiddenFeaturesSize,   // bias1
-          bias_hh_l+2*hiddenFeaturesSize,   // bias2 
-          inFeatures+seq*inFeaturesSize,    // in1
-          lstm_h,        // in2
-          lstm_g);       // out
-    #ifdef DEBUG_LSTM
-      printf("lstm_g: ");PrintTensor(hiddenFeaturesSize, lstm_g);
-    #endif
-#ifndef DOACTONTHEFLY
-      TanhLayer(hiddenFeaturesSize, lstm_g);
+#ifdef PACKED_TILES
+TILE_KERNEL_FAMILY(LINEAR_2OF4_TILE_KERNEL)
+TILE_KERNEL_FAMILY(TWOLINEAR_2OF4_TILE_KERNEL)
+/// LinearLayer2of4 kernels of all the output FM tile sizes (index: tile size)
+static void (* const linearLayer2of4Tiles[TILE_MAXSIZE+1])(int, int, data_t *, uint8_t *, data_t *, data_t *, data_t *,
+  int, struct epilogue) = TILE_KERNEL_TABLE(LinearLayer2of4Tile);
+/// TwoLinearLayersAccumulate2of4 kernels of all the output FM tile sizes (index: tile size)
+static void (* const twoLinearLayersAccumulate2of4Tiles[TILE_MAXSIZE+1])(int, int, int, struct epilogue,
+  data_t *, data_t *, uint8_t *, uint8_t *, data_t *, data_t *, data_t *, data_t *, data_t *, int) = TILE_KERNEL_TABLE(TwoLinearLayersAccumulate2of4Tile);
 #endif
-    #ifdef DEBUG_LSTM
-      printf("lstm_g: ");PrintTensor(hiddenFeaturesSize, lstm_g);
-    #endif
 
-    //ot=σ(Wioxt+bio+Whoh(t−1)+bho)
-      TwoLinearLayersAccumulate (
-          // Layer Attributes
-        inFeaturesSize, hiddenFeaturesSize, hiddenFeaturesSize,ACT_SIG, 
+/** @brief Calculates a Linear Layer with 2:4 sparse weights
+ *
+ *  With PACKED_TILES the output neurons are computed in output FM tiles (LinearLayer2of4TileN, the
+ *  inputs of two groups are loaded once per tile and every neuron selects its inputs in registers),
+ *  otherwise neuron by neuron.
+ *
+ *  @param inFeaturesSize Number of input neurons
+ *  @param outFeaturesSize Number of output neurons
+ *  @param hasBias FC with bias or not?
+ *  @param weight Weights [outFeaturesSize x NM_ROW_WEIGHTS(inFeaturesSize)]
+ *  @param index Positions of the weights [outFeaturesSize x NM_ROW_BYTES(inFeaturesSize)]
+ *  @param bias Pointer to bias
+ *  @param inFeatures Input Feature Map
+ *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param tiling Tiling of the layer (output FM tile size, see struct tiling)
+ */
+void NOINLINE LinearLayer2of4 (
+  int inFeaturesSize, int outFeaturesSize,
+  short hasBias,
+  data_t * __restrict__ weight,
+  uint8_t * __restrict__ index,
+  data_t * __restrict__ bias,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct epilogue epilogue,
+  struct tiling tiling)
+{
+  PROFILING_LINEAR_START
+  int rowWeights = NM_ROW_WEIGHTS(inFeaturesSize);
+  int rowBytes = NM_ROW_BYTES(inFeaturesSize);
+#ifdef PACKED_TILES
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(tiling), tileOptions);
+  int o = 0;
+  for(int i=0; i<numTileOptions && o<outFeaturesSize; i++) {
+    int tiles = (outFeaturesSize-o)/tileOptions[i];
+    if(tiles == 0) continue;
+    linearLayer2of4Tiles[tileOptions[i]](tiles, inFeaturesSize, &weight[o*rowWeights], &index[o*rowBytes],
+      hasBias ? &bias[o] : NULL, inFeatures, &outFeatures[o], shift, epilogue);
+    o += tiles*tileOptions[i];
+  }
+#else
+  (void)tiling; // neuron by neuron
+  for(int o=0; o<outFeaturesSize; o++)
+  {
+    int32_t temp = hasBias ? (int32_t)bias[o]<<(shift) : 0;
+    temp = dot2of4(&weight[o*rowWeights], &index[o*rowBytes], inFeatures, inFeaturesSize, temp);
+    outFeatures[o] = shiftAndEpilogue(temp, shift, epilogue);
+  }
+#endif
+  PROFILING_LINEAR_END
+}
 
-          // Layer Parameters
-          weight_ih_l+3*inFeaturesSize*hiddenFeaturesSize, // weight1
-          weight_hh_l+3*hiddenFeaturesSize*hiddenFeaturesSize, // weight2
-          bias_ih_l+3*hiddenFeaturesSize,   // bias1
-          bias_hh_l+3*hiddenFeaturesSize,   // bias2 
-          inFeatures+seq*inFeaturesSize,    // in1
-          lstm_h,        // in2
-          lstm_o);       // out
-#ifndef DOACTONTHEFLY
-      SigLayer(hiddenFeaturesSize, lstm_o);
+/** @brief TwoLinearLayersAccumulate with 2:4 sparse weights: activation(W1*in1 + b1 + W2*in2 + b2)
+ *
+ *  Output FM tiles with PACKED_TILES (see LinearLayer2of4).
+ *
+ *  @param inFeaturesSize1 Number of input neurons of the first product
+ *  @param inFeaturesSize2 Number of input neurons of the second product
+ *  @param outFeaturesSize Number of output neurons
+ *  @param epilogue Activation and clamping of the output neurons (see struct epilogue)
+ *  @param weight1 Weights [outFeaturesSize x NM_ROW_WEIGHTS(inFeaturesSize1)]
+ *  @param weight2 Weights [outFeaturesSize x NM_ROW_WEIGHTS(inFeaturesSize2)]
+ *  @param index1 Positions of weight1 [outFeaturesSize x NM_ROW_BYTES(inFeaturesSize1)]
+ *  @param index2 Positions of weight2 [outFeaturesSize x NM_ROW_BYTES(inFeaturesSize2)]
+ *  @param bias1 Bias of the first product
+ *  @param bias2 Bias of the second product
+ *  @param inFeatures1 Input Feature Map of the first product
+ *  @param inFeatures2 Input Feature Map of the second product
+ *  @param outFeatures Output Feature Map
+ *  @param shift Output shift (see layerShift)
+ *  @param tiling Tiling of the layer (output FM tile size, see struct tiling)
+ */
+void NOINLINE TwoLinearLayersAccumulate2of4 (
+  int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+  data_t * __restrict__ weight1,
+  data_t * __restrict__ weight2,
+  uint8_t * __restrict__ index1,
+  uint8_t * __restrict__ index2,
+  data_t * __restrict__ bias1,
+  data_t * __restrict__ bias2,
+  data_t * __restrict__ inFeatures1,
+  data_t * __restrict__ inFeatures2,
+  data_t * __restrict__ outFeatures,
+  int shift,
+  struct tiling tiling)
+{
+  PROFILING_TWOLINEAR_START
+  int rowWeights1 = NM_ROW_WEIGHTS(inFeaturesSize1), rowBytes1 = NM_ROW_BYTES(inFeaturesSize1);
+  int rowWeights2 = NM_ROW_WEIGHTS(inFeaturesSize2), rowBytes2 = NM_ROW_BYTES(inFeaturesSize2);
+#ifdef PACKED_TILES
+  int tileOptions[5];
+  int numTileOptions = getTileOptions(tilingOutTile(tiling), tileOptions);
+  int o = 0;
+  for(int i=0; i<numTileOptions && o<outFeaturesSize; i++) {
+    int tiles = (outFeaturesSize-o)/tileOptions[i];
+    if(tiles == 0) continue;
+    twoLinearLayersAccumulate2of4Tiles[tileOptions[i]](tiles, inFeaturesSize1, inFeaturesSize2, epilogue,
+      &weight1[o*rowWeights1], &weight2[o*rowWeights2], &index1[o*rowBytes1], &index2[o*rowBytes2],
+      &bias1[o], &bias2[o], inFeatures1, inFeatures2, &outFeatures[o], shift);
+    o += tiles*tileOptions[i];
+  }
+#else
+  (void)tiling; // neuron by neuron
+  for(int o=0; o<outFeaturesSize; o++)
+  {
+    int32_t temp = ((int32_t)bias1[o]+(int32_t)bias2[o])<<(shift);
+    temp = dot2of4(&weight1[o*rowWeights1], &index1[o*rowBytes1], inFeatures1, inFeaturesSize1, temp);
+    temp = dot2of4(&weight2[o*rowWeights2], &index2[o*rowBytes2], inFeatures2, inFeaturesSize2, temp);
+    outFeatures[o] = shiftAndEpilogue(temp, shift, epilogue);
+  }
 #endif
-    #ifdef DEBUG_LSTM
-      printf("lstm_o: ");PrintTensor(hiddenFeaturesSize, lstm_o);
-    #endif
-    //ct=ft*c(t−1)+it*gt
-      HadMulTensor(hiddenFeaturesSize, lstm_c, lstm_f);
-      HadMulTensor(hiddenFeaturesSize, lstm_i, lstm_g);
-      AddTensor(hiddenFeaturesSize, lstm_c, lstm_i);
-    #ifdef DEBUG_LSTM
-      printf("lstm_c: ");PrintTensor(hiddenFeaturesSize, lstm_c);
-    #endif
-    //ht=ottanh(ct)
-    CopyTensor(hiddenFeaturesSize, lstm_h, lstm_c); // h=c
-    TanhLayer(hiddenFeaturesSize, lstm_h); // tanh(c_t)
-    HadMulTensor(hiddenFeaturesSize, lstm_h, lstm_o);
-    #ifdef DEBUG_LSTM
-    printf("lstm_h: ");PrintTensor(hiddenFeaturesSize, lstm_h);
-    #endif
-  }   
-  PROFILING_LSTM_END
+  PROFILING_TWOLINEAR_END
+}
 
+/** @brief Runs a layer with compressed weights (weightFormat other than WEIGHT_Q16)
+ *
+ *  Linear layers are computed time step by time step (or stream by stream), int8 and int4 Linear
+ *  layers with the tiled kernels and split across the cores (see LinearLayerInt8Parallel). The LSTM state is taken
+ *  from the layer or from batchState for independent streams (see inferNetworkBatch).
+ *
+ *  @param _layer Layer Properties
+ *  @param rows Number of time steps (batchState NULL) or streams
+ *  @param inFeatures Input Feature Map [rows x input neurons]
+ *  @param outFeatures Output Feature Map [rows x output neurons]
+ *  @param nodes Intermediate nodes (LSTM, see planNetwork)
+ *  @param batchState LSTM states of the streams (h [rows x hidden] followed by c) or NULL
+ *  @return 0 on success, -1 if the format is not supported for the layer type or the layer does not
+ *  support sequences (Conv2d)
+ */
+int NOINLINE QuantizedLayer (
+  struct layer * _layer, int rows,
+  data_t * __restrict__ inFeatures,
+  data_t * __restrict__ outFeatures,
+  data_t * __restrict__ nodes,
+  data_t * __restrict__ batchState)
+{
+  int inSize  = layerInSize(_layer);
+  int outSize = layerOutSize(_layer);
+  if(_layer->weightFormat == WEIGHT_INT8 && _layer->type == LINEAR)
+  {
+    LinearLayerInt8Parallel(inSize, outSize, rows, True, (int8_t *)_layer->parameters[LAY_LIN_WEIGHTS],
+      (int32_t *)_layer->parameters[LAY_LIN_SCALE], _layer->parameters[LAY_LIN_BIAS],
+      inFeatures, outFeatures, layerShift(_layer), _layer->epilogue, _layer->tiling);
+    return 0;
+  }
+  if(_layer->weightFormat == WEIGHT_INT4 && _layer->type == LINEAR)
+  {
+    LinearLayerInt4Parallel(inSize, outSize, rows, True, (uint8_t *)_layer->parameters[LAY_LIN_WEIGHTS],
+      (int32_t *)_layer->parameters[LAY_LIN_SCALE], _layer->parameters[LAY_LIN_BIAS],
+      inFeatures, outFeatures, layerShift(_layer), _layer->epilogue, _layer->tiling);
+    return 0;
+  }
+  if(_layer->weightFormat == WEIGHT_2OF4 && _layer->type == LINEAR)
+  {
+    for(int r=0; r<rows; r++)
+      LinearLayer2of4(inSize, outSize, True, _layer->parameters[LAY_LIN_WEIGHTS],
+        (uint8_t *)_layer->parameters[LAY_LIN_INDEX], _layer->parameters[LAY_LIN_BIAS],
+        &inFeatures[r*inSize], &outFeatures[r*outSize], layerShift(_layer), _layer->epilogue, _layer->tiling);
+    return 0;
+  }
+  if((_layer->weightFormat == WEIGHT_INT8 || _layer->weightFormat == WEIGHT_INT4 || _layer->weightFormat == WEIGHT_2OF4) && _layer->type == LSTM)
+  {
+    if(batchState == NULL) {
+      LSTMLayerQuantized(_layer, rows, inFeatures, outFeatures, _layer->parameters[LSTM_H], _layer->parameters[LSTM_C], nodes);
+      return 0;
+    }
+    for(int r=0; r<rows; r++)
+      LSTMLayerQuantized(_layer, 1, &inFeatures[r*inSize], &outFeatures[r*outSize],
+        &batchState[r*outSize], &batchState[(rows+r)*outSize], nodes);
+    return 0;
+  }
+  if(_layer->weightFormat == WEIGHT_SPARSE && _layer->type == LINEAR)
+  {
+    if(inSize%2 != 0) {
+      printf("\033[91mERROR: block-sparse weights need an even number of inputs (%d)\033[0m\n", inSize);
+      return -1;
+    }
+    for(int r=0; r<rows; r++)
+      LinearLayerSparse(inSize, outSize, True, _layer->parameters[LAY_LIN_WEIGHTS],
+        (int32_t *)_layer->parameters[LAY_LIN_BLOCK_ROWS], (uint16_t *)_layer->parameters[LAY_LIN_BLOCK_COLS],
+        _layer->parameters[LAY_LIN_BIAS], &inFeatures[r*inSize], &outFeatures[r*outSize], layerShift(_layer), _layer->epilogue);
+    return 0;
+  }
+  if(_layer->weightFormat == WEIGHT_INT8 && _layer->type == Conv2d)
+  {
+    if(rows > 1 && batchState == NULL) {
+      printf("\033[91mERROR: Conv2d layer does not support sequences\033[0m\n");
+      return -1;
+    }
+    for(int r=0; r<rows; r++)
+      Conv2dLayerParallel(_layer, &inFeatures[r*inSize], &outFeatures[r*outSize]);
+    return 0;
+  }
+  printf("\033[91mERROR: weight format %d not supported for layer type %d\033[0m\n", _layer->weightFormat, _layer->type);
+  return -1;
 }
 
 /** @brief Print 2D Tensor
@@ -5689,7 +6330,7 @@ inline int  Abs(int  a)           {return (((a)>(0.0))?(a):(-a));}
  */
 inline int pulpRNNExt_tanh(int tanh_value) {
   int tmp;
-  asm volatile("pl.tanh %0, %1" : "=r" (tmp) : "r" (tanh_value) );
+  PL_TANH(tmp, tanh_value);
   return tmp;
 }
  /** @brief Intrinsic for the PULP sigmoid extension
@@ -5697,7 +6338,7 @@ inline int pulpRNNExt_tanh(int tanh_value) {
  */
 inline int pulpRNNExt_sig(int sig_value) {
   int tmp;
-  asm volatile("pl.sig %0, %1" : "=r" (tmp) : "r" (sig_value) );
+  PL_SIG(tmp, sig_value);
   return tmp;
 }
 
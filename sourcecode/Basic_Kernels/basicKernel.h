@@ -9,7 +9,9 @@
 
 #include <config.h>
 #include <config_profiling.h>
-#ifndef ASIP
+#if defined HOST
+#include "hostEmul.h"
+#elif !defined ASIP
 #include "pulp.h"
 // #include "rt/rt_api.h"
 #endif
@@ -36,8 +38,12 @@ typedef short int data_t;
 #define q_int 3
 /// For fixed-point implementation fractional part Q3,12
 #define q_frac 12
-/// Fixed-Point Format used for shifting
+/// Fixed-Point Format used for shifting (default output shift of the layers, see struct qFormat)
 #define q_fraqP1 q_frac // to be checked
+#ifndef ACT_LUT_SEGMENTS
+/// Segments of the piecewise linear tanh and sigmoid (tables in actLut.h), 16 as pl.tanh/pl.sig
+#define ACT_LUT_SEGMENTS 16
+#endif
 /// PI in fixed-point format
 #define PI ((data_t)(3.1415927*(1<<q_frac)) & 0xffff)
 /// Half of pi in fixed-point format
@@ -108,6 +114,21 @@ inline int pulpRNNExt_sig(int tanh_value);
 #define Max(a, b)               (((a)>(b))?(a):(b))
 #define Abs(a)                  (((a)>(0.0))?(a):(-a))
 #endif
+
+#if !defined HOST && !defined ASIP
+/// Clamps a 32-bit value to the range of data_t with p.clip rD, rs, 16 ([-2^15, 2^15-1])
+#define CLIP16(x) ({ int32_t clip_rD; asm("p.clip %0, %1, 16" : "=r" (clip_rD) : "r" ((int32_t)(x))); clip_rD; })
+#else
+/// Clamps a 32-bit value to the range of data_t (same as p.clip rD, rs, 16, see also hostClip16)
+#define CLIP16(x) (((x)<-32768)?-32768:(((x)>32767)?32767:(x)))
+#endif
+#if defined SATURATE && defined FixedPt
+/// Output neurons and element-wise results saturate to the range of data_t (see SATURATE in config.h)
+#define SATURATE_DATA(x) CLIP16(x)
+#else
+/// Output neurons and element-wise results wrap around when stored to data_t
+#define SATURATE_DATA(x) (x)
+#endif
 /// Number of elements for taylor expansion
 #define tailorPrecission 32
 
@@ -117,19 +138,150 @@ enum layerType
     LINEAR = 0, /**< Linear Layer/Fully-Connected Layer */
     RNN    = 1, /**< Recurrent Neural Layer */
     LSTM   = 2, /**< Long short-term Memory Layer */
-    Conv2d = 3  /**< 2D Convolution Layer */
+    Conv2d = 3, /**< 2D Convolution Layer */
+    ACTIVATION = 4, /**< Element-wise activation and clamping of its epilogue (ActivationLayer) */
+    GRU    = 5  /**< Gated Recurrent Unit Layer */
+};
+/// Largest output FM tile size supported by the tiled kernels (see tileKernel.h)
+#define TILE_MAXSIZE 16
+/// Input FM tiling of a layer
+enum inTilingType
+{
+    IN_TILING_DEFAULT = 0, /**< FMINTILING of config_profiling.h */
+    IN_TILING_OFF     = 1, /**< One input per iteration */
+    IN_TILING_ON      = 2  /**< Two inputs per iteration */
+};
+/// Activation of the LSTM and GRU gates
+enum actOnTheFlyType
+{
+    ACT_ONTHEFLY_DEFAULT = 0, /**< DOACTONTHEFLY of config.h */
+    ACT_ONTHEFLY_OFF     = 1, /**< SigLayer/TanhLayer after the gate */
+    ACT_ONTHEFLY_ON      = 2  /**< In the output stage of TwoLinearLayersAccumulate or the fused LSTM cell (needs DOACTONTHEFLY) */
+};
+/// Tiling of a layer, zero-initialized fields select the compile-time defaults (OUTPUTBUFFER, FMINTILING, DOACTONTHEFLY)
+struct tiling {
+    int outTile;                       /**< Output FM tile size (1..TILE_MAXSIZE), 0: OUTPUTBUFFER */
+    enum inTilingType inTiling;        /**< Input FM tiling */
+    enum actOnTheFlyType actOnTheFly;  /**< Activation of the LSTM and GRU gates */
+};
+/// Format of the weights of a layer
+enum weightFormat
+{
+    WEIGHT_Q16  = 0, /**< data_t in the fixed-point format (q_int, q_frac) */
+    WEIGHT_INT8 = 1, /**< int8_t with one int32_t scale per output neuron/channel (see WEIGHT_SCALE_SHIFT) */
+    WEIGHT_INT4 = 2, /**< int4 packed into uint8_t (first weight in the low nibble, rows padded to whole bytes), scales like WEIGHT_INT8 */
+    WEIGHT_SPARSE = 3, /**< data_t, only the non-zero blocks of SPARSE_BLOCK_OUT output neurons x 2 inputs (Linear only, see LinearLayerSparse) */
+    WEIGHT_2OF4 = 4  /**< data_t, 2 weights of every group of 4 inputs and their positions (2:4 structured sparsity, Linear and LSTM) */
+};
+/// Fractional bits of the scales of the int8/int4 weights: weight in fixed-point = int weight*scale>>WEIGHT_SCALE_SHIFT
+#define WEIGHT_SCALE_SHIFT 16
+/// Bytes of a row of n packed int4 weights (WEIGHT_INT4)
+#define INT4_ROW_BYTES(n) (((n)+1)/2)
+/// Sign-extended low (first) and high (second) int4 weight of a byte
+#define INT4_LO(b) ((int8_t)((b)<<4)>>4)
+#define INT4_HI(b) ((int8_t)(b)>>4)
+/// Output neurons of a block of the block-sparse weights (WEIGHT_SPARSE), one accumulator register each (1..TILE_MAXSIZE, same as sparse_block_out in scripts/pyTorch_Kernels.py)
+#define SPARSE_BLOCK_OUT 4
+/// Weights of a 2:4 sparse row of n inputs (WEIGHT_2OF4): 2 per group of 4 inputs, rows padded to whole groups
+#define NM_ROW_WEIGHTS(n) (2*(((n)+3)/4))
+/// Bytes of the positions of a 2:4 sparse row of n inputs: 4 bits per group (first weight in bits 1:0, second in bits 3:2), first group in the low nibble
+#define NM_ROW_BYTES(n) (((n)+7)/8)
+/// Fixed-point formats of the tensors of a layer (fractional bits, 0: integer tensor), zero-initialized: q_frac for all tensors
+struct qFormat {
+    int in;                  /**< Input FM */
+    int weight;              /**< Weights (int8/int4: format of weight*scale>>WEIGHT_SCALE_SHIFT) */
+    int out;                 /**< Output FM and bias */
+    int set;                 /**< Nonzero: in, weight and out are the formats, 0: all tensors in q_frac */
+};
+/// Output stage of the Linear and Conv2d layers, applied to the accumulators before they are stored (see shiftAndEpilogue)
+struct epilogue {
+    int act;                 /**< Activation after the shift (ACT_NONE, ACT_TANH, ..., see generic_act) */
+    int clampMin;            /**< Lower bound of the output after the activation (e.g. 0 for ReLU6) */
+    int clampMax;            /**< Upper bound of the output after the activation, clampMin == clampMax: no clamping */
+    int slope;               /**< Slope of ACT_LEAKY_RELU for negative inputs in Q(q_frac), 0: LEAKY_RELU_SLOPE */
 };
 /// Layer Data
 struct layer {
     enum layerType type;     /**< Layer Type (FC, RNN, ...) */
     int attributes[5];       /**< Layer Attributes */
-    data_t * parameters[6];  /**< Parameters (weights, bias, ...) */
+    data_t * parameters[10]; /**< Parameters (weights, bias, ...), every ID has its own slot (see checkWeightFormats) */
+    struct tiling tiling;    /**< Tiling used for the layer (FMOUTTILING and MANUALLOOPUNFOLDING only) */
+    enum weightFormat weightFormat; /**< Format of the weights, zero-initialized: WEIGHT_Q16 */
+    struct qFormat qFormat;  /**< Fixed-point formats, zero-initialized: Q3.12 (q_int, q_frac) */
+    struct epilogue epilogue; /**< Output stage (Linear, Conv2d) or function (Activation), zero-initialized: shift only */
+};
+/// Largest number of layers of a memory plan
+#define MEMPLAN_MAXDEPTH 32
+/// Memory plan of a network: offsets of all the intermediate FMs in one arena (see planNetwork)
+struct memPlan {
+    int depth;                             /**< Number of layers */
+    int rows;                              /**< Number of time steps or streams the plan has been computed for */
+    int outOffset[MEMPLAN_MAXDEPTH];       /**< Offset of the output FM of each layer */
+    int scratchOffset[MEMPLAN_MAXDEPTH];   /**< Offset of the intermediate nodes of each (LSTM) layer */
+    int arenaSize;                         /**< Required arena size (data_t) */
+};
+/// Largest number of kernel calls of an execution plan
+#define EXECPLAN_MAXSTEPS 64
+/// Kernel call of an execution plan with all the arguments resolved (see compileNetwork)
+struct planStep {
+    void (*run)(struct planStep * step, data_t * netIn); /**< Kernel wrapper of the step */
+    struct layer * lay;      /**< Layer */
+    data_t * in;             /**< Input FM, NULL: input FM of the network */
+    data_t * out;            /**< Output FM */
+    data_t * nodes;          /**< Intermediate nodes (LSTM, GRU, RNN) */
+    data_t * weight;         /**< Weights (Linear) */
+    int32_t * scale;         /**< Scales (int8 and int4 Linear) */
+    data_t * bias;           /**< Bias (Linear) */
+    int inSize;              /**< Number of input neurons */
+    int outSize;             /**< Number of output neurons */
+    int rows;                /**< Number of time steps */
+    int shift;               /**< Output shift (see layerShift) */
+    void (*tileKernel)(int, int, data_t *, data_t *, data_t *, data_t *, int, struct epilogue, int); /**< Output FM tile kernel (tiled Linear) */
+    void (*packedTileKernel)(int, int, int, uint8_t *, int32_t *, data_t *, data_t *, data_t *, int, struct epilogue); /**< Output FM tile kernel (tiled int8 and int4 Linear) */
+    int tiles;               /**< Number of output FM tiles (tiled Linear) */
+    int inTiling;            /**< Input FM tiling (tiled Linear) */
+};
+/// Execution plan of a network: flat list of kernel calls which can be run repeatedly (see runPlan)
+struct execPlan {
+    int numSteps;                               /**< Number of valid steps */
+    struct planStep steps[EXECPLAN_MAXSTEPS];   /**< Steps */
+    struct memPlan mem;                         /**< Memory plan of the intermediate FMs */
+    data_t * out;                               /**< Output FM of the network */
+};
+/// Largest number of stages of a pipeline
+#define PIPE_MAXSTAGES 8
+/// Number of FMs in the ring buffer between two pipeline stages (samples in flight per stage boundary)
+#define PIPE_SLOTS 2
+/// Single-producer/single-consumer ring buffer of FMs between two pipeline stages
+struct pipeRing {
+    volatile int head;       /**< Number of FMs written (producer) */
+    volatile int tail;       /**< Number of FMs read (consumer) */
+    int slotSize;            /**< Size of an FM slot (data_t) */
+    data_t * slots;          /**< PIPE_SLOTS FMs */
+};
+/// Pipeline of a network: consecutive layers per stage, every stage runs on its own core (see compilePipeline)
+struct pipeline {
+    struct layer * network;                       /**< Layers */
+    int numStages;                                /**< Number of stages */
+    int firstLayer[PIPE_MAXSTAGES+1];             /**< First layer of each stage (and depth) */
+    struct memPlan plan[PIPE_MAXSTAGES];          /**< Memory plan of the layers of each stage */
+    data_t * arena[PIPE_MAXSTAGES];               /**< Arena of each stage */
+    struct pipeRing ring[PIPE_MAXSTAGES];         /**< Ring buffer from stage s to s+1 */
+    int inSize;                                   /**< Size of the input FM of a sample */
+    int outSize;                                  /**< Size of the output FM of a sample */
+    int numSamples;                               /**< Number of samples of the current run */
+    data_t * in;                                  /**< Input FMs of the current run */
+    data_t * out;                                 /**< Output FMs of the current run */
 };
 // attributes
 #define LAY_LIN_IN      0   ///< Layer Attribute ID for Input Neurons in FC Layer
 #define LAY_LIN_OUT     1   ///< Layer Attribute ID for Output Neurons in FC Layer
 #define LAY_LIN_BIAS    0   ///< Parameter ID in FC Layer
 #define LAY_LIN_WEIGHTS 1   ///< Weight ID in FC Layer
+#define LAY_LIN_SCALE   2   ///< Scale ID in FC Layer (int8 weights)
+#define LAY_LIN_BLOCK_ROWS 3 ///< First block of every block row ID in FC Layer (block-sparse weights)
+#define LAY_LIN_BLOCK_COLS 4 ///< Input pair of every block ID in FC Layer (block-sparse weights)
+#define LAY_LIN_INDEX   5   ///< Positions of the weights ID in FC Layer (2:4 sparse weights)
 #define LAY_LSTM_IN     0   ///< Layer Attribute ID for Input Neurons in LSTM
 #define LAY_LSTM_HID    1   ///< Layer Attribute ID for Hideen Neurons in LSTM
 #define LSTM_WGHT_IH    0   ///< Weight input to hidden ID in LSTM Layer
@@ -138,17 +290,49 @@ struct layer {
 #define LSTM_BIAS_HH    3   ///< Bias hidden to hidden ID in LSTM Layer
 #define LSTM_H          4   ///< Number of hidden neurons in LSTM Layer
 #define LSTM_C          5   ///< Number of internal states LSTM Layer
+#define LSTM_SCALE_IH   6   ///< Scale of the weights input to hidden ID in LSTM Layer (int8 weights)
+#define LSTM_SCALE_HH   7   ///< Scale of the weights hidden to hidden ID in LSTM Layer (int8 weights)
+#define LSTM_INDEX_IH   8   ///< Positions of the weights input to hidden ID in LSTM Layer (2:4 sparse weights)
+#define LSTM_INDEX_HH   9   ///< Positions of the weights hidden to hidden ID in LSTM Layer (2:4 sparse weights)
 #define CONV_WGHT       0   ///< Weight Parameter ID in 2D Conv Layer
 #define CONV_BIAS       1   ///< Bias Parameter ID in 2D Conv Layer
+#define CONV_SCALE      2   ///< Scale Parameter ID in 2D Conv Layer (int8 weights)
 #define LAY_CONV_IN     0   ///< Layer Attribute ID for spatial Input FM size in 2D Conv Layer
 #define LAY_CONV_OUT    1   ///< Layer Attribute ID for spatial Output FM size in 2D Conv Layer
 #define LAY_CONV_KER    2   ///< Layer Attribute ID for kernel size in 2D Conv Layer
 #define LAY_CONV_H      3   ///< Layer Attribute ID for height of input FM in 2D Conv Layer
 #define LAY_CONV_W      4   ///< Layer Attribute ID for width of input FM in 2D Conv Layer
+#define LAY_ACT_SIZE    0   ///< Layer Attribute ID for the number of neurons in Activation Layer
+#define LAY_GRU_IN      0   ///< Layer Attribute ID for Input Neurons in GRU
+#define LAY_GRU_HID     1   ///< Layer Attribute ID for Hidden Neurons in GRU
+#define GRU_WGHT_IH     0   ///< Weight input to hidden ID in GRU Layer (reset, update and candidate rows)
+#define GRU_WGHT_HH     1   ///< Weight hidden to hidden ID in GRU Layer
+#define GRU_BIAS_IH     2   ///< Bias input to hidden ID in GRU Layer
+#define GRU_BIAS_HH     3   ///< Bias hidden to hidden ID in GRU Layer
+#define GRU_H           4   ///< Hidden state ID in GRU Layer
+#define LAY_RNN_IN      0   ///< Layer Attribute ID for Input Neurons in RNN
+#define LAY_RNN_HID     1   ///< Layer Attribute ID for Hidden Neurons in RNN
+#define RNN_WGHT_IH     0   ///< Weight input to hidden ID in RNN Layer
+#define RNN_WGHT_HH     1   ///< Weight hidden to hidden ID in RNN Layer
+#define RNN_BIAS_IH     2   ///< Bias input to hidden ID in RNN Layer
+#define RNN_BIAS_HH     3   ///< Bias hidden to hidden ID in RNN Layer
+#define RNN_H           4   ///< Hidden state ID in RNN Layer
 
 #define ACT_NONE 0
 #define ACT_TANH 1
 #define ACT_SIG 2
+#define ACT_RELU 3
+#define ACT_LEAKY_RELU 4
+#define ACT_HSIG 5
+#define ACT_HTANH 6
+/// Default slope of ACT_LEAKY_RELU (0.01 in Q(q_frac), as nn.LeakyReLU)
+#define LEAKY_RELU_SLOPE ((int)(0.01*(1<<q_frac)+0.5))
+/// Slope of the hard sigmoid (1/6 in Q16, as nn.Hardsigmoid: x/6+0.5 clamped to [0, 1])
+#define HSIG_SLOPE 10923
+/// Epilogue without activation and clamping (plain shift of the accumulators)
+#define EPILOGUE_NONE ((struct epilogue){ACT_NONE, 0, 0, 0})
+/// Epilogue with an activation function and without clamping (e.g. the gates of the LSTM and GRU)
+#define EPILOGUE_ACT(act) ((struct epilogue){(act), 0, 0, 0})
 
 #ifdef ASIP
 #ifdef ASIP_USETANHSIG
@@ -166,19 +350,24 @@ inline data_t sig(data_t value);
 // #endif
 #endif
 
+// external definitions in basicKernel.c (not inline: parallel.c and autoTune.c only call them)
 #ifdef PULP_USETANHSIG
 /// Select tanh function to be used
-inline data_t generic_tanh(data_t value);
+data_t generic_tanh(data_t value);
 /// Select sigmoid function to be used
-inline data_t generic_sig(data_t value);
+data_t generic_sig(data_t value);
 #else
-inline data_t generic_tanh(data_t value);
-inline data_t generic_sig(data_t value);
+data_t generic_tanh(data_t value);
+data_t generic_sig(data_t value);
 #endif
 
 #define BUFFER_SIZE 2048
 #define BUFFER_SIZE2 BUFFER_SIZE/2
 #define BUFFER_SIZE4 BUFFER_SIZE/4
+/// Size (int32_t) of the buffer for the input projections of the time steps of a sequence
+#define SEQ_BUFFER_SIZE 4096
+/// Size (data_t) of each of the two L1 buffers of the streamed weights (WEIGHT_STREAM), at most 32767 (16-bit DMA length)
+#define WEIGHT_STREAM_SIZE 4096
 
 #define CODE_SEGMENT "NONE"
 #ifdef PROFILING_ALL
@@ -272,8 +461,17 @@ inline data_t generic_sig(data_t value);
 #define register_attribute register
 // int32_t rD; v2s rs1, rs2;
 #define SDOTP_GENERIC(rD, rs1, rs2) rD = __SUMDOTP2(rs1, rs2, rD);
+#ifndef HOST // emulated versions in hostEmul.h
+// rD += SPR*rB; SPR = *rAddr; rAddr += 4
 #define PL_SDOTP0(rD, rAddr, rB) asm volatile("pl.sdotsp.h.0 %0, %1, %2" : "+r" (rD),  "+r" (rAddr) : "r" (rB) )
 #define PL_SDOTP1(rD, rAddr, rB) asm volatile("pl.sdotsp.h.1 %0, %1, %2" : "+r" (rD),  "+r" (rAddr) : "r" (rB) )
+// lwincr with 2i, 2i+1 not mapped by compiler => inline assembly
+#define P_LW_INCR(rD, rAddr) asm volatile("p.lw %0, 4(%1!)" : "=r" (rD), "+r" (rAddr))
+#define PL_TANH(rD, rs) asm volatile("pl.tanh %0, %1" : "=r" (rD) : "r" (rs) )
+#define PL_SIG(rD, rs) asm volatile("pl.sig %0, %1" : "=r" (rD) : "r" (rs) )
+/// x0 is used as source and destination for the weight preloads
+#define PL_DECLARE_REGISTERS register int x0 asm("x0")
+#endif
 #endif
 
 
@@ -286,18 +484,48 @@ void  endPerf ();
 #endif
 
 
-inline int shiftAndAct(int value, int activationFunction) {
-    int temp;
-#ifdef DOACTONTHEFLY
-      temp = value>>(q_fraqP1); // TODO merging shifting and tanh/sigmoid instruction
-      switch(activationFunction) {
-        case ACT_NONE: return temp; break;
-        case ACT_TANH: return generic_tanh(temp); break;
-        case ACT_SIG:  return generic_sig(temp); break;
-      }
-#else
-      return value>>(q_fraqP1);
-#endif
+/** @brief Activation function of the epilogues and TwoLinearLayersAccumulate in Q(q_frac)
+ *
+ *  ACT_RELU: max(x, 0), ACT_LEAKY_RELU: x<0 ? x*slope : x, ACT_HSIG: x/6+0.5 clamped to [0, 1],
+ *  ACT_HTANH: x clamped to [-1, 1] (as nn.ReLU, nn.LeakyReLU, nn.Hardsigmoid and nn.Hardtanh)
+ *
+ *  @param value Input in Q(q_frac) (ReLU and leaky ReLU: any format)
+ *  @param act Activation function (ACT_*)
+ *  @param slope Slope of ACT_LEAKY_RELU for negative inputs in Q(q_frac), 0: LEAKY_RELU_SLOPE
+ */
+static inline data_t generic_act(data_t value, int act, int slope) {
+  int one = 1<<q_frac;
+  int temp;
+  switch(act) {
+    case ACT_TANH:       return generic_tanh(value);
+    case ACT_SIG:        return generic_sig(value);
+    case ACT_RELU:       return value < 0 ? 0 : value;
+    case ACT_LEAKY_RELU: return value < 0 ? (value*(slope ? slope : LEAKY_RELU_SLOPE))>>q_frac : value;
+    case ACT_HSIG:
+      temp = ((value*HSIG_SLOPE)>>16)+(one>>1);
+      return temp < 0 ? 0 : (temp > one ? one : temp);
+    case ACT_HTANH:      return value < -one ? -one : (value > one ? one : value);
+    default:             return value;
+  }
+}
+
+/** @brief Output neuron of the Linear and Conv2d kernels: shift of the accumulator, activation and
+ *  clamping of the epilogue (always applied, not only with DOACTONTHEFLY)
+ *
+ *  Activation and clamping work on the output in data_t, the same results as ActivationLayer on the
+ *  stored output.
+ */
+static inline data_t shiftAndEpilogue(int32_t value, int shift, struct epilogue epilogue) {
+    data_t temp = SATURATE_DATA(value>>(shift));
+    switch(epilogue.act) {
+      case ACT_NONE: break;
+      case ACT_TANH: temp = generic_tanh(temp); break;
+      case ACT_SIG:  temp = generic_sig(temp); break;
+      default:       temp = generic_act(temp, epilogue.act, epilogue.slope); break;
+    }
+    if(epilogue.clampMin != epilogue.clampMax)
+      temp = temp<epilogue.clampMin ? epilogue.clampMin : (temp>epilogue.clampMax ? epilogue.clampMax : temp);
+    return temp;
     }
 
 void NOINLINE LinearLayer (
@@ -309,17 +537,73 @@ void NOINLINE LinearLayer (
     data_t * __restrict__ bias,
         // Input and Output Features
     data_t * __restrict__ inFeatures,
-    data_t * __restrict__ outFeatures
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct epilogue epilogue,
+    struct tiling tiling
 ); //property(functional);
 
-data_t * NOINLINE inferNetwork(struct layer * network, int depth, data_t * __restrict__ inFeatures,  data_t * __restrict__ buffer);
+void NOINLINE LinearLayerSeq (
+        // Layer Attributes
+    int inFeaturesSize, int outFeaturesSize, int seqSize,
+    short hasBias,
+        // Layer Parameters
+    data_t * __restrict__ weight,
+    data_t * __restrict__ bias,
+        // Input and Output Features
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct epilogue epilogue,
+    struct tiling tiling
+);
+
+void NOINLINE LinearLayerParallel (
+    int inFeaturesSize, int outFeaturesSize, int seqSize,
+    short hasBias,
+    data_t * __restrict__ weight,
+    data_t * __restrict__ bias,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct epilogue epilogue,
+    struct tiling tiling
+);
+
+int layerInSize(struct layer * lay);
+
+int layerOutSize(struct layer * lay);
+
+int qFrac(const struct qFormat * q, int frac);
+
+int layerShift(struct layer * lay);
+
+int planNetwork(struct layer * network, int depth, int rows, struct memPlan * plan);
+
+void PrintMemPlan(struct layer * network, struct memPlan * plan);
+
+data_t * NOINLINE inferNetworkPlanned(struct layer * network, int depth, int rows, data_t * __restrict__ inFeatures, data_t ** batchStates, struct memPlan * plan, data_t * __restrict__ arena);
+
+int compileNetwork(struct layer * network, int depth, int seqSize, data_t * arena, int arenaSize, struct execPlan * plan);
+
+data_t * NOINLINE runPlan(struct execPlan * plan, data_t * __restrict__ inFeatures);
+
+int compilePipeline(struct layer * network, int depth, int numStages, data_t * arena, int arenaSize, struct pipeline * pipe);
+
+void NOINLINE runPipeline(struct pipeline * pipe, int numSamples, data_t * __restrict__ inFeatures, data_t * __restrict__ outFeatures);
+
+data_t * NOINLINE inferNetwork(struct layer * network, int depth, int seqSize, data_t * __restrict__ inFeatures,  data_t * __restrict__ buffer);
+
+data_t * NOINLINE inferNetworkBatch(struct layer * network, int depth, int batchSize, data_t * __restrict__ inFeatures, data_t ** batchStates, data_t * __restrict__ buffer);
+
+void setNetworkTiling(struct layer * network, int depth, struct tiling tiling);
 
 
 
 void NOINLINE TwoLinearLayersAccumulate (
         // Layer Attributes
     int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, 
-    int activationFunction,
+    struct epilogue epilogue,
         // Layer Parameters
     data_t * __restrict__ weight1,
     data_t * __restrict__ weight2,
@@ -328,11 +612,26 @@ void NOINLINE TwoLinearLayersAccumulate (
         // Input and Output Features
     data_t * __restrict__ inFeatures1,
     data_t * __restrict__ inFeatures2,
-    data_t * __restrict__ outFeatures);
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct tiling tiling);
+
+void NOINLINE TwoLinearLayersAccumulateParallel (
+    int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize,
+    struct epilogue epilogue,
+    data_t * __restrict__ weight1,
+    data_t * __restrict__ weight2,
+    data_t * __restrict__ bias1,
+    data_t * __restrict__ bias2,
+    data_t * __restrict__ inFeatures1,
+    data_t * __restrict__ inFeatures2,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct tiling tiling);
 
 void NOINLINE RNNLayer (
         // Layer Attributes
-    int inFeaturesSize, int hiddenFeaturesSize,
+    int inFeaturesSize, int hiddenFeaturesSize, int seqSize,
         // Layer Parameters
     data_t * __restrict__ weight_ih_l,
     data_t * __restrict__ weight_hh_l,
@@ -342,11 +641,15 @@ void NOINLINE RNNLayer (
     data_t * __restrict__ inFeatures,
         data_t * __restrict__ outFeatures, // out and hidden
         // Hidden Features
-        data_t * __restrict__ hiddenFeatures);
+        data_t * __restrict__ hiddenFeatures,
+        // intermediate nodes
+        data_t * __restrict__ hiddenOut,
+        int shift,
+        struct tiling tiling);
 
 void NOINLINE LSTMLayer (
 // Layer Attributes
-    int inFeaturesSize, int hiddenFeaturesSize,
+    int inFeaturesSize, int hiddenFeaturesSize, int seqSize,
         // Layer Parameters
     data_t * __restrict__ weight_ih_l,
     data_t * __restrict__ weight_hh_l,
@@ -354,14 +657,72 @@ void NOINLINE LSTMLayer (
     data_t * __restrict__ bias_hh_l,
         // Input and Output Features
     data_t * __restrict__ inFeatures,
-        data_t * __restrict__ outFeatures, // out and hidden
+        data_t * __restrict__ outFeatures, // hidden state of all time steps
         // Hidden Features
         data_t * __restrict__ lstm_h,
         data_t * __restrict__ lstm_c,
         // intermediate nodes
         data_t * __restrict__ lstm_f,
         data_t * __restrict__ lstm_i,
-        data_t * __restrict__ lstm_g);
+        data_t * __restrict__ lstm_g,
+        data_t * __restrict__ lstm_o,
+        int shift,
+        struct tiling tiling);
+
+void NOINLINE GRULayer (
+// Layer Attributes
+    int inFeaturesSize, int hiddenFeaturesSize, int seqSize,
+        // Layer Parameters
+    data_t * __restrict__ weight_ih_l,
+    data_t * __restrict__ weight_hh_l,
+    data_t * __restrict__ bias_ih_l,
+    data_t * __restrict__ bias_hh_l,
+        // Input and Output Features
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+        // Hidden Features
+    data_t * __restrict__ gru_h,
+        // intermediate nodes
+    data_t * __restrict__ nodes,
+    int shift,
+    struct tiling tiling);
+
+void NOINLINE LSTMLayerBatch (
+// Layer Attributes
+    int inFeaturesSize, int hiddenFeaturesSize, int batchSize,
+        // Layer Parameters
+    data_t * __restrict__ weight_ih_l,
+    data_t * __restrict__ weight_hh_l,
+    data_t * __restrict__ bias_ih_l,
+    data_t * __restrict__ bias_hh_l,
+        // Input and Output Features
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+        // Hidden Features of the streams
+    data_t * __restrict__ lstm_h,
+    data_t * __restrict__ lstm_c,
+        // intermediate nodes
+    data_t * __restrict__ nodes,
+    int shift,
+    struct tiling tiling);
+
+void NOINLINE GRULayerBatch (
+// Layer Attributes
+    int inFeaturesSize, int hiddenFeaturesSize, int batchSize,
+        // Layer Parameters
+    data_t * __restrict__ weight_ih_l,
+    data_t * __restrict__ weight_hh_l,
+    data_t * __restrict__ bias_ih_l,
+    data_t * __restrict__ bias_hh_l,
+        // Input and Output Features
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+        // Hidden Features of the streams
+    data_t * __restrict__ gru_h,
+        // intermediate nodes
+    data_t * __restrict__ nodes,
+    int shift,
+    struct tiling tiling);
 
 int NOINLINE Conv2dLayer (
 // Layer Attributes
@@ -371,6 +732,173 @@ int NOINLINE Conv2dLayer (
     data_t * __restrict__ inFeatures,
     data_t * __restrict__ outFeatures);
 
+void NOINLINE Conv2dLayerParallel (
+    struct layer * _layer,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures);
+
+void NOINLINE LinearLayerInt8 (
+    int inFeaturesSize, int outFeaturesSize,
+    short hasBias,
+    int8_t * __restrict__ weight,
+    int32_t * __restrict__ scale,
+    data_t * __restrict__ bias,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct epilogue epilogue,
+    struct tiling tiling);
+
+void NOINLINE TwoLinearLayersAccumulateInt8 (
+    int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+    int8_t * __restrict__ weight1,
+    int8_t * __restrict__ weight2,
+    int32_t * __restrict__ scale1,
+    int32_t * __restrict__ scale2,
+    data_t * __restrict__ bias1,
+    data_t * __restrict__ bias2,
+    data_t * __restrict__ inFeatures1,
+    data_t * __restrict__ inFeatures2,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct tiling tiling);
+
+void NOINLINE LinearLayerInt8Parallel (
+    int inFeaturesSize, int outFeaturesSize, int seqSize,
+    short hasBias,
+    int8_t * __restrict__ weight,
+    int32_t * __restrict__ scale,
+    data_t * __restrict__ bias,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct epilogue epilogue,
+    struct tiling tiling);
+
+void NOINLINE TwoLinearLayersAccumulateInt8Parallel (
+    int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+    int8_t * __restrict__ weight1,
+    int8_t * __restrict__ weight2,
+    int32_t * __restrict__ scale1,
+    int32_t * __restrict__ scale2,
+    data_t * __restrict__ bias1,
+    data_t * __restrict__ bias2,
+    data_t * __restrict__ inFeatures1,
+    data_t * __restrict__ inFeatures2,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct tiling tiling);
+
+void NOINLINE LinearLayerInt4 (
+    int inFeaturesSize, int outFeaturesSize,
+    short hasBias,
+    uint8_t * __restrict__ weight,
+    int32_t * __restrict__ scale,
+    data_t * __restrict__ bias,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct epilogue epilogue,
+    struct tiling tiling);
+
+void NOINLINE TwoLinearLayersAccumulateInt4 (
+    int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+    uint8_t * __restrict__ weight1,
+    uint8_t * __restrict__ weight2,
+    int32_t * __restrict__ scale1,
+    int32_t * __restrict__ scale2,
+    data_t * __restrict__ bias1,
+    data_t * __restrict__ bias2,
+    data_t * __restrict__ inFeatures1,
+    data_t * __restrict__ inFeatures2,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct tiling tiling);
+
+void NOINLINE LinearLayerInt4Parallel (
+    int inFeaturesSize, int outFeaturesSize, int seqSize,
+    short hasBias,
+    uint8_t * __restrict__ weight,
+    int32_t * __restrict__ scale,
+    data_t * __restrict__ bias,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct epilogue epilogue,
+    struct tiling tiling);
+
+void NOINLINE TwoLinearLayersAccumulateInt4Parallel (
+    int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+    uint8_t * __restrict__ weight1,
+    uint8_t * __restrict__ weight2,
+    int32_t * __restrict__ scale1,
+    int32_t * __restrict__ scale2,
+    data_t * __restrict__ bias1,
+    data_t * __restrict__ bias2,
+    data_t * __restrict__ inFeatures1,
+    data_t * __restrict__ inFeatures2,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct tiling tiling);
+
+void NOINLINE LinearLayerSparse (
+    int inFeaturesSize, int outFeaturesSize,
+    short hasBias,
+    data_t * __restrict__ weight,
+    int32_t * __restrict__ blockRows,
+    uint16_t * __restrict__ blockCols,
+    data_t * __restrict__ bias,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct epilogue epilogue);
+
+void NOINLINE LinearLayer2of4 (
+    int inFeaturesSize, int outFeaturesSize,
+    short hasBias,
+    data_t * __restrict__ weight,
+    uint8_t * __restrict__ index,
+    data_t * __restrict__ bias,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct epilogue epilogue,
+    struct tiling tiling);
+
+void NOINLINE TwoLinearLayersAccumulate2of4 (
+    int inFeaturesSize1, int inFeaturesSize2, int outFeaturesSize, struct epilogue epilogue,
+    data_t * __restrict__ weight1,
+    data_t * __restrict__ weight2,
+    uint8_t * __restrict__ index1,
+    uint8_t * __restrict__ index2,
+    data_t * __restrict__ bias1,
+    data_t * __restrict__ bias2,
+    data_t * __restrict__ inFeatures1,
+    data_t * __restrict__ inFeatures2,
+    data_t * __restrict__ outFeatures,
+    int shift,
+    struct tiling tiling);
+
+void NOINLINE LSTMLayerQuantized (
+    struct layer * _layer, int seqSize,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    data_t * __restrict__ lstm_h,
+    data_t * __restrict__ lstm_c,
+    data_t * __restrict__ nodes);
+
+void NOINLINE Conv2dLayerInt8 (
+    struct layer * _layer,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures);
+
+int NOINLINE QuantizedLayer (
+    struct layer * _layer, int rows,
+    data_t * __restrict__ inFeatures,
+    data_t * __restrict__ outFeatures,
+    data_t * __restrict__ nodes,
+    data_t * __restrict__ batchState);
+
 // inline float  ALWAYS_INLINE  expTailor(int n, float x);
 
 // inline v2s ALWAYS_INLINE Tanh_SIMD(v2s value);
@@ -380,6 +908,14 @@ void NOINLINE SigLayer (
     int TensorSize,
     data_t * __restrict__ Features);
 
+void NOINLINE ActivationLayer (
+        // Layer Attributes
+    int TensorSize,
+        // Input and Output Features
+    data_t * inFeatures,
+    data_t * outFeatures,
+    struct epilogue epilogue);
+
 
 // inline v2s sig_SIMD(v2s value);
 
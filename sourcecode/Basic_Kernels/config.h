@@ -33,6 +33,19 @@
 #define DOACTONTHEFLY
 /// On RISC-Y use TANH and sigmoid extension
 #define PULP_USETANHSIG
+/// Split the layers across the cores (PULP cluster PEs, threads on the host), see parallel.c
+// #define NUM_CORES 8
+/// Stream the weights of the Linear layers which do not fit into L1 with double-buffered DMA transfers, see WEIGHT_STREAM_SIZE
+// #define WEIGHT_STREAM
+/// Saturate the outputs of the kernels and the element-wise ops to the range of data_t instead of wrapping around (p.clip)
+// #define SATURATE
+/// Segments of the piecewise linear tanh and sigmoid (8, 16, 32 or 64, see actLut.h and scripts/actLut.py), pl.tanh/pl.sig are only used with 16
+// #define ACT_LUT_SEGMENTS 32
+
+#ifdef HOST
+/// On the x86 host use the SSE2/AVX2 kernels instead of the emulated RISC-Y kernels (make HOST=1 HOST_SIMD=1)
+// #define HOST_SIMD
+#endif
 
 
 #endif
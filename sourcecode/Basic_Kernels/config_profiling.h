@@ -15,3 +15,10 @@
 #define FMINTILING
 #define FMOUTTILING
 #define MANUALLOOPUNFOLDING
+//#define TILING_SWEEP
+//#define AUTOTUNE
+//#define BATCH_SIZE 12
+//#define MEMPLAN_REPORT
+//#define EXECPLAN_REPEAT 100
+//#define PIPELINE_SAMPLES 64
+//#define ACCURACY_REPORT
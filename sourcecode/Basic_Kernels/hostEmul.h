@@ -0,0 +1,262 @@
+/** Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri
+ *  @file hostEmul.h
+ *  @brief Host (x86-64) replacement for pulp.h and the RNN extension intrinsics
+ *
+ *  Included by basicKernel.h instead of pulp.h if HOST is defined (i.e. make HOST=1). Provides
+ *  bit-exact C emulations of __SUMDOTP2, p.lw (post-increment load), pl.sdotsp.h.0/1 (incl. the
+ *  two special purpose registers) and pl.tanh/pl.sig, stubs for the rt_perf API used by testKernel.c
+ *  and for the rt_dma API (synchronous memcpy),
+ *  SSE2/AVX2 implementations of a chain of sdotp instructions (hostSumDotp2N) and of the int8 and
+ *  packed int4 weight dot products (hostSumDotpI8N, hostSumDotpI4N), p.clip and the saturating
+ *  additions of SATURATE (hostClip16, hostAddClip16N) and the CPUID based selection of the x86
+ *  kernels (hostIsaLevel).
+ *
+ * @author Renzo Andri (andrire)
+ */
+#ifndef HOSTEMUL_H
+#define HOSTEMUL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined __AVX2__ || defined __SSE2__
+#include <immintrin.h>
+#endif
+
+/// L1/L2 placement attributes of the PULP SDK, there is only one memory on the host
+#define RT_L2_DATA
+#define RT_L1_DATA
+
+/// Packed 2x16-bit SIMD vector (like pulp.h), data_t arrays are only guaranteed to be 2-byte aligned
+typedef short v2s __attribute__((vector_size (4), aligned (2)));
+
+/** @brief Emulation of p.sdotsp.h (acc + a[0]*b[0] + a[1]*b[1]), wraps around like the 32-bit datapath
+ */
+static inline int32_t hostSumDotp2(v2s a, v2s b, int32_t acc) {
+  return (int32_t)((uint32_t)acc + (uint32_t)((int32_t)a[0]*b[0]) + (uint32_t)((int32_t)a[1]*b[1]));
+}
+#define __SUMDOTP2(a, b, c) hostSumDotp2((v2s)(a), (v2s)(b), (c))
+
+/** @brief Chain of n sdotp instructions: acc + sum_i a[i]*b[i]
+ *
+ *  Same result as calling __SUMDOTP2 n times (all additions are modulo 2^32), but uses
+ *  vpmaddwd on 8 (AVX2) or 4 (SSE2) v2s pairs per iteration.
+ */
+static inline int32_t hostSumDotp2N(const v2s * a, const v2s * b, int n, int32_t acc) {
+  int i = 0;
+#if defined __AVX2__
+  __m256i vacc = _mm256_setzero_si256();
+  for(; i+8<=n; i+=8)
+    vacc = _mm256_add_epi32(vacc, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i*)&a[i]), _mm256_loadu_si256((const __m256i*)&b[i])));
+  __m128i vacc4 = _mm_add_epi32(_mm256_castsi256_si128(vacc), _mm256_extracti128_si256(vacc, 1));
+#elif defined __SSE2__
+  __m128i vacc4 = _mm_setzero_si128();
+#endif
+#if defined __AVX2__ || defined __SSE2__
+  for(; i+4<=n; i+=4)
+    vacc4 = _mm_add_epi32(vacc4, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)&a[i]), _mm_loadu_si128((const __m128i*)&b[i])));
+  vacc4 = _mm_add_epi32(vacc4, _mm_shuffle_epi32(vacc4, _MM_SHUFFLE(1,0,3,2)));
+  vacc4 = _mm_add_epi32(vacc4, _mm_shuffle_epi32(vacc4, _MM_SHUFFLE(2,3,0,1)));
+  acc = (int32_t)((uint32_t)acc + (uint32_t)_mm_cvtsi128_si32(vacc4));
+#endif
+  for(; i<n; i++)
+    acc = hostSumDotp2(a[i], b[i], acc);
+  return acc;
+}
+
+/** @brief Emulation of p.clip rD, rs, 16 (saturation to [-2^15, 2^15-1])
+ */
+static inline int32_t hostClip16(int32_t x) {
+  return x < -32768 ? -32768 : (x > 32767 ? 32767 : x);
+}
+
+/** @brief a[i] = clip16(a[i]+b[i]) for n elements, 8 elements per iteration with paddsw (SSE2)
+ */
+static inline void hostAddClip16N(short * a, const short * b, int n) {
+  int i = 0;
+#if defined __SSE2__
+  for(; i+8<=n; i+=8)
+    _mm_storeu_si128((__m128i*)&a[i], _mm_adds_epi16(_mm_loadu_si128((const __m128i*)&a[i]), _mm_loadu_si128((const __m128i*)&b[i])));
+#endif
+  for(; i<n; i++)
+    a[i] = hostClip16((int32_t)a[i]+b[i]);
+}
+
+/** @brief Dot product of n int8 weights with n 16-bit inputs added to acc (wraps around like the sdotp chain)
+ *
+ *  The weights are sign-extended to 16 bit and multiplied with vpmaddwd, 16 (AVX2) or 8 (SSE2)
+ *  weights per iteration.
+ */
+static inline int32_t hostSumDotpI8N(const int8_t * w, const short * x, int n, int32_t acc) {
+  int i = 0;
+#if defined __AVX2__
+  __m256i vacc = _mm256_setzero_si256();
+  for(; i+16<=n; i+=16)
+    vacc = _mm256_add_epi32(vacc, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)&w[i])),
+      _mm256_loadu_si256((const __m256i*)&x[i])));
+  __m128i vacc4 = _mm_add_epi32(_mm256_castsi256_si128(vacc), _mm256_extracti128_si256(vacc, 1));
+#elif defined __SSE2__
+  __m128i vacc4 = _mm_setzero_si128();
+#endif
+#if defined __AVX2__ || defined __SSE2__
+  for(; i+8<=n; i+=8) {
+    __m128i w8 = _mm_loadl_epi64((const __m128i*)&w[i]);
+    __m128i w16 = _mm_srai_epi16(_mm_unpacklo_epi8(w8, w8), 8);
+    vacc4 = _mm_add_epi32(vacc4, _mm_madd_epi16(w16, _mm_loadu_si128((const __m128i*)&x[i])));
+  }
+  vacc4 = _mm_add_epi32(vacc4, _mm_shuffle_epi32(vacc4, _MM_SHUFFLE(1,0,3,2)));
+  vacc4 = _mm_add_epi32(vacc4, _mm_shuffle_epi32(vacc4, _MM_SHUFFLE(2,3,0,1)));
+  acc = (int32_t)((uint32_t)acc + (uint32_t)_mm_cvtsi128_si32(vacc4));
+#endif
+  for(; i<n; i++)
+    acc = (int32_t)((uint32_t)acc + (uint32_t)((int32_t)w[i]*x[i]));
+  return acc;
+}
+
+/** @brief Dot product of n packed int4 weights (two per byte, first one in the low nibble) with n
+ *  16-bit inputs added to acc (wraps around like the sdotp chain)
+ *
+ *  Every byte is copied to both 16-bit halves of a 32-bit lane, the multiplication with 2^12
+ *  (lower half) and 2^8 (upper half) moves the low and the high nibble to the top and the
+ *  arithmetic shift sign-extends them, i.e. every lane holds the weight pair of one byte for
+ *  vpmaddwd. 16 (AVX2) or 8 (SSE2) weights per iteration.
+ */
+static inline int32_t hostSumDotpI4N(const uint8_t * w, const short * x, int n, int32_t acc) {
+  int i = 0;
+#if defined __AVX2__
+  __m256i vacc = _mm256_setzero_si256();
+  const __m256i nib8 = _mm256_set1_epi32(0x01001000);
+  for(; i+16<=n; i+=16) {
+    __m256i b = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&w[i/2]));
+    __m256i w16 = _mm256_srai_epi16(_mm256_mullo_epi16(_mm256_or_si256(b, _mm256_slli_epi32(b, 16)), nib8), 12);
+    vacc = _mm256_add_epi32(vacc, _mm256_madd_epi16(w16, _mm256_loadu_si256((const __m256i*)&x[i])));
+  }
+  __m128i vacc4 = _mm_add_epi32(_mm256_castsi256_si128(vacc), _mm256_extracti128_si256(vacc, 1));
+#elif defined __SSE2__
+  __m128i vacc4 = _mm_setzero_si128();
+#endif
+#if defined __AVX2__ || defined __SSE2__
+  const __m128i nib4 = _mm_set1_epi32(0x01001000);
+  for(; i+8<=n; i+=8) {
+    int32_t w4;
+    memcpy(&w4, &w[i/2], sizeof(w4));
+    __m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(w4), _mm_setzero_si128());
+    __m128i w16 = _mm_srai_epi16(_mm_mullo_epi16(_mm_unpacklo_epi16(b, b), nib4), 12);
+    vacc4 = _mm_add_epi32(vacc4, _mm_madd_epi16(w16, _mm_loadu_si128((const __m128i*)&x[i])));
+  }
+  vacc4 = _mm_add_epi32(vacc4, _mm_shuffle_epi32(vacc4, _MM_SHUFFLE(1,0,3,2)));
+  vacc4 = _mm_add_epi32(vacc4, _mm_shuffle_epi32(vacc4, _MM_SHUFFLE(2,3,0,1)));
+  acc = (int32_t)((uint32_t)acc + (uint32_t)_mm_cvtsi128_si32(vacc4));
+#endif
+  for(; i<n; i++) {
+    int32_t wi = i%2 == 0 ? (int8_t)(w[i/2]<<4)>>4 : (int8_t)w[i/2]>>4;
+    acc = (int32_t)((uint32_t)acc + (uint32_t)(wi*x[i]));
+  }
+  return acc;
+}
+
+/// x86 instruction set levels of the HOST_SIMD kernels
+enum hostIsa {
+  HOST_ISA_SSE2       = 0, /**< SSE2 (baseline of x86-64) */
+  HOST_ISA_AVX2       = 1, /**< AVX2, vpmaddwd on 256 bit */
+  HOST_ISA_AVX512     = 2, /**< AVX-512F/BW, vpmaddwd on 512 bit */
+  HOST_ISA_AVX512VNNI = 3  /**< AVX-512 VNNI, vpdpwssd */
+};
+
+/** @brief Best instruction set level supported by the CPU (CPUID)
+ *
+ *  Can be limited with the environment variable HOST_ISA=sse2|avx2|avx512|avx512vnni, e.g. to
+ *  check all the kernels on the same machine.
+ */
+static inline int hostIsaLevel() {
+  static int level = -1;
+  if(level < 0) {
+    const char * names[] = {"sse2", "avx2", "avx512", "avx512vnni"};
+    const char * limit = getenv("HOST_ISA");
+    level = HOST_ISA_SSE2;
+    if(__builtin_cpu_supports("avx2")) level = HOST_ISA_AVX2;
+    if(level == HOST_ISA_AVX2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) level = HOST_ISA_AVX512;
+    if(level == HOST_ISA_AVX512 && __builtin_cpu_supports("avx512vnni")) level = HOST_ISA_AVX512VNNI;
+    for(int i=0; limit && i<(int)(sizeof(names)/sizeof(names[0])); i++)
+      if(strcmp(limit, names[i]) == 0 && i < level) level = i;
+  }
+  return level;
+}
+
+/// Adds the byte offset incr to an address register (works for uintptr_t and pointer addresses)
+#define HOST_ADDR_INCR(rAddr, incr) (rAddr) = (__typeof__(rAddr))((uintptr_t)(rAddr) + (incr))
+
+/** @brief Declares the x0 register and the two special purpose registers of pl.sdotsp.h.0/1
+ *
+ *  As on the core, writes to x0 are lost (the emulated sdotp only adds 0*SPR to it).
+ */
+#define PL_DECLARE_REGISTERS int x0 = 0; v2s pl_spr0 = {0, 0}, pl_spr1 = {0, 0}; (void)x0; (void)pl_spr0; (void)pl_spr1
+
+/** @brief Emulation of p.lw rD, 4(rAddr!)
+ */
+#define P_LW_INCR(rD, rAddr) do { (rD) = *(v2s *)(rAddr); HOST_ADDR_INCR(rAddr, 4); } while(0)
+
+/** @brief Emulation of pl.sdotsp.h.0/1 rD, rAddr, rB
+ *
+ *  rD += SPR*rB (with the SPR value loaded by the previous instruction), then SPR = *rAddr and
+ *  rAddr += 4
+ */
+#define PL_SDOTP_EMUL(spr, rD, rAddr, rB) do { \
+    (rD) = hostSumDotp2((spr), (v2s)(rB), (rD)); \
+    (spr) = *(v2s *)(rAddr); \
+    HOST_ADDR_INCR(rAddr, 4); \
+  } while(0)
+#define PL_SDOTP0(rD, rAddr, rB) PL_SDOTP_EMUL(pl_spr0, rD, rAddr, rB)
+#define PL_SDOTP1(rD, rAddr, rB) PL_SDOTP_EMUL(pl_spr1, rD, rAddr, rB)
+
+/// pl.tanh and pl.sig implement the same piece-wise linear approximation as Tanh() and sig()
+#define PL_TANH(rD, rs) (rD) = Tanh((data_t)(rs))
+#define PL_SIG(rD, rs)  (rD) = sig((data_t)(rs))
+
+/// Performance counters of the PULP SDK, only RT_PERF_CYCLES (wall-clock in ns) is counted on the host
+enum {
+  RT_PERF_CYCLES = 0, RT_PERF_INSTR, RT_PERF_ACTIVE_CYCLES, RT_PERF_LD_STALL, RT_PERF_JR_STALL,
+  RT_PERF_IMISS, RT_PERF_LD, RT_PERF_ST, RT_PERF_JUMP, RT_PERF_BRANCH, RT_PERF_BTAKEN, RT_PERF_RVC,
+  RT_PERF_LD_EXT, RT_PERF_ST_EXT, RT_PERF_LD_EXT_CYC, RT_PERF_ST_EXT_CYC, RT_PERF_TCDM_CONT,
+  RT_PERF_NB_EVENTS
+};
+typedef struct {
+  unsigned int events;
+  int64_t start;
+  int64_t values[RT_PERF_NB_EVENTS];
+} rt_perf_t;
+
+static inline int64_t hostTimeNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+static inline void rt_perf_init(rt_perf_t * perf) {
+  perf->events = 0;
+  perf->start = 0;
+  for(int i=0; i<RT_PERF_NB_EVENTS; i++) perf->values[i] = 0;
+}
+static inline void rt_perf_conf(rt_perf_t * perf, unsigned int events) {perf->events = events;}
+static inline void rt_perf_reset(rt_perf_t * perf) {(void)perf;}
+static inline void rt_perf_start(rt_perf_t * perf) {perf->start = hostTimeNs();}
+static inline void rt_perf_stop(rt_perf_t * perf) {
+  if(perf->events & (1<<RT_PERF_CYCLES)) perf->values[RT_PERF_CYCLES] += hostTimeNs() - perf->start;
+}
+static inline void rt_perf_save(rt_perf_t * perf) {(void)perf;}
+static inline unsigned int rt_perf_get(rt_perf_t * perf, int id) {return (unsigned int)perf->values[id];}
+
+/// Cluster DMA of the PULP SDK, the copy is done by rt_dma_memcpy (memcpy) and rt_dma_wait returns immediately
+#define RT_DMA_DIR_LOC2EXT 0
+#define RT_DMA_DIR_EXT2LOC 1
+typedef struct {
+  int id;
+} rt_dma_copy_t;
+static inline void rt_dma_memcpy(uintptr_t ext, uintptr_t loc, unsigned short size, int dir, int merge, rt_dma_copy_t * copy) {
+  (void)merge; (void)copy;
+  if(dir == RT_DMA_DIR_EXT2LOC) memcpy((void *)loc, (const void *)ext, size);
+  else memcpy((void *)ext, (const void *)loc, size);
+}
+static inline void rt_dma_wait(rt_dma_copy_t * copy) {(void)copy;}
+
+#endif
@@ -0,0 +1,312 @@
+/** Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri
+ *  @file parallel.c
+ *  @brief Fork/join of a function on NUM_CORES cores
+ *
+ *  parallelRun() runs a function on all the cores and returns when all of them are done, i.e. the
+ *  return is the barrier.
+ *
+ *  parallelRunTasks() splits a layer into tasks of whole output FM tiles (the task function calls
+ *  the single-core kernel on its part, see the *Parallel functions in basicKernel.c), which are distributed in
+ *  contiguous blocks to fixed-size per-core deques. Every core pops the tasks of its own deque from
+ *  the head and, once it is empty, steals tasks from the tail of the other deques, i.e. the cores
+ *  which are done early (ragged tails, cheaper tasks) take over work of the others.
+ *
+ *  PULP: the function is offloaded to the cluster (rt_cluster_call) and forked on NUM_CORES
+ *  processing elements (rt_team_fork), the cluster is mounted by the first call. The deques are
+ *  protected by the team critical section.
+ *  Host: NUM_CORES-1 worker threads (pthreads) are started by the first call, the calling thread
+ *  is core 0. Every deque has its own spin lock.
+ *  Without NUM_CORES the function is called on a single core, on PULP with WEIGHT_STREAM on one PE
+ *  of the cluster (the L1 buffers and the cluster DMA of the streamed weights).
+ *
+ *  parallelBarrier() synchronizes the cores within a function run by parallelRun() (e.g. per
+ *  chunk of the streamed weights).
+ *
+ * @author Renzo Andri (andrire)
+ */
+#include <stdio.h>
+#include <config.h>
+#include "basicKernel.h"
+#include "parallel.h"
+
+/// Set while a function is run by parallelRun(), nested calls of the layers are not split again
+static volatile int parallelActive = False;
+
+/** @brief Tells if the caller is run by parallelRun(), i.e. is already one of the cores
+ *
+ *  @return True inside parallelRun()
+ */
+int parallelInside(void)
+{
+  return parallelActive;
+}
+
+#if defined NUM_CORES && defined HOST
+#include <pthread.h>
+
+#define PARALLEL_LOCK(deque)   while(__atomic_exchange_n(&(deque)->lock, 1, __ATOMIC_ACQUIRE))
+#define PARALLEL_UNLOCK(deque) __atomic_store_n(&(deque)->lock, 0, __ATOMIC_RELEASE)
+
+/// Worker threads of the cores 1..NUM_CORES-1
+static pthread_t parallelThreads[NUM_CORES];
+static pthread_mutex_t parallelMutex = PTHREAD_MUTEX_INITIALIZER;
+/// Signals a new fork to the workers
+static pthread_cond_t parallelStart = PTHREAD_COND_INITIALIZER;
+/// Signals the last finished worker to the calling thread
+static pthread_cond_t parallelDone = PTHREAD_COND_INITIALIZER;
+/// Number of forks so far, a worker runs the function once per fork
+static unsigned int parallelGeneration = 0;
+/// Number of workers which have not finished the current fork
+static int parallelPending = 0;
+static parallelFunc parallelCurFunc;
+static void * parallelCurArg;
+
+static void * parallelWorker(void * coreArg)
+{
+  int core = (int)(intptr_t)coreArg;
+  unsigned int seen = 0;
+  for(;;)
+  {
+    pthread_mutex_lock(&parallelMutex);
+    while(parallelGeneration == seen)
+      pthread_cond_wait(&parallelStart, &parallelMutex);
+    seen = parallelGeneration;
+    parallelFunc func = parallelCurFunc;
+    void * arg = parallelCurArg;
+    pthread_mutex_unlock(&parallelMutex);
+
+    func(arg, core, NUM_CORES);
+
+    pthread_mutex_lock(&parallelMutex);
+    if(--parallelPending == 0)
+      pthread_cond_signal(&parallelDone);
+    pthread_mutex_unlock(&parallelMutex);
+  }
+  return NULL;
+}
+
+/// Number of cores which have reached the current barrier
+static volatile int parallelBarrierCount = 0;
+/// Number of barriers so far, incremented by the last core which reaches a barrier
+static volatile unsigned int parallelBarrierGeneration = 0;
+
+/** @brief Waits until all the cores of the current parallelRun() have reached the barrier
+ */
+void parallelBarrier(void)
+{
+  unsigned int generation = __atomic_load_n(&parallelBarrierGeneration, __ATOMIC_ACQUIRE);
+  if(__atomic_add_fetch(&parallelBarrierCount, 1, __ATOMIC_ACQ_REL) == NUM_CORES) {
+    __atomic_store_n(&parallelBarrierCount, 0, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&parallelBarrierGeneration, 1, __ATOMIC_RELEASE);
+  } else
+    while(__atomic_load_n(&parallelBarrierGeneration, __ATOMIC_ACQUIRE) == generation)
+      PARALLEL_PAUSE();
+}
+
+/** @brief Runs func on all the cores (worker threads) and waits until all of them are done
+ *
+ *  @param func Function to be run
+ *  @param arg Argument of func
+ */
+void parallelRun(parallelFunc func, void * arg)
+{
+  static int started = False;
+  if(!started)
+  {
+    for(int core = 1; core < NUM_CORES; core++)
+      if(pthread_create(&parallelThreads[core], NULL, parallelWorker, (void *)(intptr_t)core) != 0) {
+        printf("\033[91mERROR: cannot start worker thread %d\033[0m\n", core);
+        exit(1);
+      }
+    started = True;
+  }
+  parallelActive = True;
+  pthread_mutex_lock(&parallelMutex);
+  parallelCurFunc = func;
+  parallelCurArg  = arg;
+  parallelPending = NUM_CORES-1;
+  parallelGeneration++;
+  pthread_cond_broadcast(&parallelStart);
+  pthread_mutex_unlock(&parallelMutex);
+
+  func(arg, 0, NUM_CORES);
+
+  pthread_mutex_lock(&parallelMutex);
+  while(parallelPending > 0)
+    pthread_cond_wait(&parallelDone, &parallelMutex);
+  pthread_mutex_unlock(&parallelMutex);
+  parallelActive = False;
+}
+
+#elif (defined NUM_CORES || defined WEIGHT_STREAM) && !defined HOST && !defined ASIP
+#include "rt/rt_api.h"
+
+#define PARALLEL_LOCK(deque)   rt_team_critical_enter()
+#define PARALLEL_UNLOCK(deque) rt_team_critical_exit()
+
+/// Function and argument of the current fork (in L2, the cluster cannot access the FC stack)
+RT_L2_DATA static struct {
+  parallelFunc func;
+  void * arg;
+} parallelCall;
+
+/// Runs on every processing element of the cluster
+static void parallelEntry(void * unused)
+{
+  (void)unused;
+  parallelCall.func(parallelCall.arg, rt_core_id(), PARALLEL_CORES);
+}
+
+/// Runs on the cluster controller, rt_team_fork returns after the barrier of all the PEs
+static void parallelClusterEntry(void * unused)
+{
+  rt_team_fork(PARALLEL_CORES, parallelEntry, unused);
+}
+
+/** @brief Runs func on all the processing elements of the cluster and waits until all of them are
+ *  done
+ *
+ *  @param func Function to be run
+ *  @param arg Argument of func (has to be accessible by the cluster, e.g. L2)
+ */
+void parallelRun(parallelFunc func, void * arg)
+{
+  static int mounted = False;
+  if(!mounted)
+  {
+    rt_cluster_mount(1, 0, 0, NULL);
+    mounted = True;
+  }
+  parallelCall.func = func;
+  parallelCall.arg  = arg;
+  parallelActive = True;
+  rt_cluster_call(NULL, 0, parallelClusterEntry, NULL, NULL, 0, 0, PARALLEL_CORES, NULL);
+  parallelActive = False;
+}
+
+/** @brief Waits until all the processing elements of the cluster have reached the barrier
+ */
+void parallelBarrier(void)
+{
+  rt_team_barrier();
+}
+
+#else
+/** @brief Runs func on a single core (no NUM_CORES)
+ *
+ *  @param func Function to be run
+ *  @param arg Argument of func
+ */
+void parallelRun(parallelFunc func, void * arg)
+{
+  parallelActive = True;
+  func(arg, 0, 1);
+  parallelActive = False;
+}
+
+/** @brief Barrier of a single core (returns immediately)
+ */
+void parallelBarrier(void)
+{
+}
+#endif
+
+#ifdef NUM_CORES
+/// Task deques of the cores (only one layer is run at a time)
+RT_L2_DATA static struct parallelDeque parallelDeques[NUM_CORES];
+
+/// Takes the next task from the head of the deque of the core
+static int parallelPop(int core, struct parallelTask * task)
+{
+  struct parallelDeque * deque = &parallelDeques[core];
+  int found = False;
+  PARALLEL_LOCK(deque);
+  if(deque->head < deque->tail) {
+    *task = deque->tasks[deque->head++];
+    found = True;
+  }
+  PARALLEL_UNLOCK(deque);
+  return found;
+}
+
+/// Steals the last task of the next core (in ring order) which has tasks left
+static int parallelSteal(int core, int numCores, struct parallelTask * task)
+{
+  for(int i = 1; i < numCores; i++)
+  {
+    struct parallelDeque * deque = &parallelDeques[(core+i)%numCores];
+    int found = False;
+    PARALLEL_LOCK(deque);
+    if(deque->head < deque->tail) {
+      *task = deque->tasks[--deque->tail];
+      found = True;
+    }
+    PARALLEL_UNLOCK(deque);
+    if(found)
+      return True;
+  }
+  return False;
+}
+
+/// Runs on every core until all the deques are empty (no tasks are added while running)
+static void parallelTaskWorker(void * unused, int core, int numCores)
+{
+  (void)unused;
+  struct parallelTask task;
+  while(parallelPop(core, &task) || parallelSteal(core, numCores, &task))
+    task.func(task.arg, task.first, task.count);
+}
+
+/** @brief Runs the elements 0..size-1 of a layer as tasks on all the cores and waits until all of
+ *  them are done
+ *
+ *  The tasks are multiples of granularity elements (except the last one), about
+ *  PARALLEL_TASKS_PER_CORE per core, and are distributed in contiguous blocks to the deques.
+ *
+ *  @param func Task function of the layer
+ *  @param arg Argument of func (has to be accessible by all the cores, e.g. L2)
+ *  @param size Number of elements (e.g. output neurons)
+ *  @param granularity Elements per tile (e.g. output FM tile size)
+ */
+void parallelRunTasks(parallelTaskFunc func, void * arg, int size, int granularity)
+{
+  if(size <= 0)
+    return;
+  int tiles = (size+granularity-1)/granularity;
+  int tilesPerTask = (tiles+NUM_CORES*PARALLEL_TASKS_PER_CORE-1)/(NUM_CORES*PARALLEL_TASKS_PER_CORE);
+  int taskSize = tilesPerTask*granularity;
+  int numTasks = (size+taskSize-1)/taskSize;
+  for(int core = 0; core < NUM_CORES; core++)
+  {
+    struct parallelDeque * deque = &parallelDeques[core];
+    int firstTask;
+    int coreTasks = parallelSplit(numTasks, 1, core, NUM_CORES, &firstTask);
+    deque->lock = 0;
+    deque->head = 0;
+    deque->tail = 0;
+    for(int t = firstTask; t < firstTask+coreTasks; t++)
+    {
+      struct parallelTask * task = &deque->tasks[deque->tail++];
+      task->func  = func;
+      task->arg   = arg;
+      task->first = t*taskSize;
+      task->count = Min(taskSize, size-t*taskSize);
+    }
+  }
+  parallelRun(parallelTaskWorker, NULL);
+}
+#else
+/** @brief Runs the elements 0..size-1 of a layer as one task (no NUM_CORES)
+ *
+ *  @param func Task function of the layer
+ *  @param arg Argument of func
+ *  @param size Number of elements
+ *  @param granularity Elements per tile (unused)
+ */
+void parallelRunTasks(parallelTaskFunc func, void * arg, int size, int granularity)
+{
+  (void)granularity;
+  if(size > 0)
+    func(arg, 0, size);
+}
+#endif
@@ -0,0 +1,87 @@
+/** Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri
+ *  @file parallel.h
+ *  @brief Fork/join of a function on NUM_CORES cores (see parallel.c)
+ *
+ *  Has to be included after basicKernel.h.
+ *
+ * @author Renzo Andri (andrire)
+ */
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/// Busy waiting of a core (e.g. on a ring buffer), the host threads give up their time slice
+#ifdef HOST
+#include <sched.h>
+#define PARALLEL_PAUSE() sched_yield()
+#else
+#define PARALLEL_PAUSE()
+#endif
+
+/// Number of cores of parallelRun() (one without NUM_CORES, on PULP still on the cluster with WEIGHT_STREAM)
+#ifdef NUM_CORES
+#define PARALLEL_CORES NUM_CORES
+#else
+#define PARALLEL_CORES 1
+#endif
+
+/** @brief Function which is run on every core
+ *
+ *  @param arg Argument passed to parallelRun()
+ *  @param core Index of the core (0..numCores-1)
+ *  @param numCores Number of cores
+ */
+typedef void (*parallelFunc)(void * arg, int core, int numCores);
+
+/** @brief Task of a layer, computes the elements first..first+count-1 (e.g. output neurons)
+ *
+ *  @param arg Argument passed to parallelRunTasks()
+ *  @param first First element
+ *  @param count Number of elements
+ */
+typedef void (*parallelTaskFunc)(void * arg, int first, int count);
+
+/// Number of tasks per core a layer is split into (more tasks balance better, fewer have less overhead)
+#define PARALLEL_TASKS_PER_CORE 4
+/// Capacity of the task deque of a core
+#define PARALLEL_DEQUE_SIZE 16
+
+/// Task in the deque of a core
+struct parallelTask {
+    parallelTaskFunc func;   /**< Function of the layer */
+    void * arg;              /**< Argument of func */
+    int first;               /**< First element */
+    int count;               /**< Number of elements */
+};
+/// Task deque of a core: the owner pops from the head, the other cores steal from the tail
+struct parallelDeque {
+    volatile int lock;                                /**< Spin lock (host) */
+    int head;                                         /**< Next task of the owner */
+    int tail;                                         /**< One after the last task */
+    struct parallelTask tasks[PARALLEL_DEQUE_SIZE];   /**< Tasks */
+};
+
+void parallelRun(parallelFunc func, void * arg);
+
+int parallelInside(void);
+
+void parallelBarrier(void);
+
+void parallelRunTasks(parallelTaskFunc func, void * arg, int size, int granularity);
+
+/** @brief Splits size elements in chunks of granularity elements evenly over the cores
+ *
+ *  @param size Number of elements (e.g. output neurons)
+ *  @param granularity Every chunk except the last one is a multiple of it (e.g. output FM tile size)
+ *  @param core Index of the core
+ *  @param numCores Number of cores
+ *  @param first First element of the core (output)
+ *  @return Number of elements of the core (0 if it is idle)
+ */
+static inline int parallelSplit(int size, int granularity, int core, int numCores, int * first) {
+  int chunks = (size+granularity-1)/granularity;
+  int chunk = (chunks+numCores-1)/numCores*granularity;
+  *first = core*chunk < size ? core*chunk : size;
+  return size-*first < chunk ? size-*first : chunk;
+}
+
+#endif
@@ -8,7 +8,7 @@ import os
 import sys
 sys.path.insert(0, '../')
 from math import ceil
-from pyTorch_Kernels import _1DTensor2C, _2DTensor2C, num2format
+from pyTorch_Kernels import _1DTensor2C, _2DTensor2C, num2format, _tensorRows, quantizedRows2C, weight_formats, q_frac, calibratedFrac, sparseRows2C, pruneBlocks, prune2of4, nmRows2C
 from enum import Enum
 from functools import reduce
 nn=torch.nn
@@ -16,6 +16,31 @@ nn=torch.nn
 numAntenna = 4
 freqBands = 3
 
+# format of the exported weights: "q16" (data_t), "int8" or "int4" (one scale per output neuron/channel, see
+# WEIGHT_INT8/WEIGHT_INT4, int4 only for Linear and LSTM layers) or "2of4" (WEIGHT_2OF4, Linear and LSTM layers are
+# pruned to 2 weights per group of 4 inputs before the reference outputs are computed), the accuracy of the quantised
+# network against m*_Out is printed by testKernel.c with ACCURACY_REPORT
+weightFormat = "q16"
+
+# block-sparse Linear layers (WEIGHT_SPARSE, q16 weights only): True exports only the non-zero blocks of the weights
+# (sparse_block_out output neurons x 2 inputs), blockPruneRatio is the fraction of the blocks with the smallest
+# magnitude which are set to zero before the export (0.0 for networks which have been pruned in training)
+sparseLinear = False
+blockPruneRatio = 0.0
+
+# per-layer fixed-point formats (struct qFormat): False exports all the tensors in q_format, True chooses the
+# fractional bits of the weights and of the output FM (and bias) of every layer from the weights and the activations
+# of the exported input (calibration data). The input of the network, the output of the last layer and the input
+# and output of LSTM and GRU layers (Q3.12 gates and state) stay in q_format.
+calibrateQFormat = False
+
+# activations which are folded into the epilogue of the preceding Linear or Conv2d layer (struct epilogue), i.e. they
+# are applied to the accumulators before the output FM is stored and are not exported as layers. Activations which
+# cannot be folded (e.g. after an LSTM/GRU or a second activation) are exported as ACTIVATION layers. The input of tanh,
+# sigmoid and hard sigmoid stays in q_format.
+epilogueActs = (nn.Tanh, nn.Sigmoid, nn.ReLU, nn.LeakyReLU, nn.Hardsigmoid, nn.Hardtanh)
+qFormatActs = (nn.Tanh, nn.Sigmoid, nn.Hardsigmoid)
+
 copyright="// Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri"
 
 def bash(cmd):
@@ -43,15 +68,28 @@ class myLSTM(nn.LSTM):
       print("hx=")
       print(self.hx)
 
-      output, hn = super().forward(input, self.hx)
+      # (seq_len, batch=1, input_size), the output of a Linear layer is (seq_len, input_size)
+      output, hn = super().forward(input.reshape(-1, 1, self.input_size), self.hx)
       print("output=")
       print(output)
       print("hn=")
       print(hn)
       self.hx = hn
-      return hn[0]
+      return output # hidden state of all the time steps
       # self.hx = tmp[1]
       # return tmp[0]
+class myGRU(nn.GRU):
+   def __init__(self, inNodes, hiddenNodes):
+      super().__init__(inNodes, hiddenNodes)
+      num_directions = 2 if self.bidirectional else 1
+      max_batch_size = 1 # batch size 1
+      self.hx = torch.randn(self.num_layers * num_directions, max_batch_size, self.hidden_size)
+   def forward(self, input):
+      # (seq_len, batch=1, input_size), the output of a Linear layer is (seq_len, input_size)
+      output, hn = super().forward(input.reshape(-1, 1, self.input_size), self.hx)
+      self.hx = hn
+      return output # hidden state of all the time steps
+
 inputFM = torch.randn(1, 1, 3)
 a=myLSTM(3,4)
 a.forward(inputFM)
@@ -85,6 +123,50 @@ class bcolors:
     ENDC = '\033[0m'
     BOLD = '\033[1m'
     UNDERLINE = '\033[4m'
+
+def qFormat2C(inFrac, weightFrac, outFrac):
+   # initializer of the qFormat field of struct layer (none: default Q3.12), the last field marks the formats as set,
+   # i.e. 0 fractional bits (calibratedFrac of large tensors) is an integer tensor and not the default
+   if weightFrac is None:
+      return ""
+   return ", .qFormat={{{},{},{},1}}".format(inFrac, weightFrac, outFrac)
+
+def epilogue2C(act, frac):
+   # initializer of the epilogue field of struct layer for an activation module, clamping bounds in Q(frac), slope of
+   # the leaky ReLU in Q(q_frac)
+   if isinstance(act, nn.Tanh):
+      return ", .epilogue={ACT_TANH,0,0}"
+   if isinstance(act, nn.Sigmoid):
+      return ", .epilogue={ACT_SIG,0,0}"
+   if isinstance(act, nn.Hardsigmoid):
+      return ", .epilogue={ACT_HSIG,0,0}"
+   if isinstance(act, nn.LeakyReLU):
+      slope = int(round(act.negative_slope*2**q_frac))
+      if not -2**15 <= slope < 2**15:
+         error("slope of the leaky ReLU does not fit into data_t")
+      if slope != 0: # 0 selects LEAKY_RELU_SLOPE
+         return ", .epilogue={{ACT_LEAKY_RELU,0,0,{}}}".format(slope)
+   if isinstance(act, (nn.ReLU, nn.LeakyReLU)):
+      return ", .epilogue={ACT_RELU,0,0}"
+   if act.min_val == -1 and act.max_val == 1 and frac == q_frac:
+      return ", .epilogue={ACT_HTANH,0,0}"
+   bound = lambda x: max(-2**15, min(2**15-1, int(round(x*2**frac))))
+   return ", .epilogue={{ACT_NONE,{},{}}}".format(bound(act.min_val), bound(act.max_val))
+
+def foldedActs(layers):
+   # activations which are folded into the epilogue of the preceding Linear or Conv2d layer (one per layer)
+   return [isinstance(layer, epilogueActs) and i > 0 and isinstance(layers[i-1], (nn.Linear, nn.Conv2d)) for i, layer in enumerate(layers)]
+
+def calibrateLayer(inFrac, weights, outputs, keepOut):
+   # fractional bits of the weights and the output FM of a layer, keepOut: output has to stay in q_format
+   if not calibrateQFormat:
+      return None, None
+   outFrac = q_frac if keepOut else calibratedFrac(outputs)
+   # the output shift weightFrac+inFrac-outFrac is at most 16 (the int32 accumulators hold the output with
+   # shift more fractional bits) and not negative
+   weightFrac = min(calibratedFrac(weights), outFrac+16-inFrac)
+   return weightFrac, min(outFrac, weightFrac+inFrac)
+
 def todo(what, importance=Importance.LOW):
    if importance==Importance.LOW:
       print(bcolors.WARNING+"TODO: "+what+bcolors.ENDC)
@@ -96,9 +178,10 @@ def error(what):
    print(bcolors.FAIL+"ERROR: "+what+bcolors.ENDC)
 
 class netModel():
-   def __init__(self, model, h_im=0, w_im=0):
+   def __init__(self, model, h_im=0, w_im=0, seq_len=1):
         self.model = model
         self.numLayers = len(model)
+        self.seq_len = seq_len # number of time steps (Conv2d only supports 1)
         self.h_im = h_im
         self.w_im = w_im
         if self.numLayers == 0:
@@ -107,20 +190,21 @@ class netModel():
             return;
         if isinstance(model[0], nn.Linear):
             self.in_features  = model[0].in_features
-        elif isinstance(model[0], myLSTM):
+        elif isinstance(model[0], (myLSTM, myGRU)):
             self.in_features  = model[0].input_size
         elif isinstance(model[0], nn.Conv2d):
             self.in_features  = model[0].in_channels
         else: 
              error(str(type(model[0]))+"not defined")
-        if isinstance(model[self.numLayers-1], nn.Linear):
-            self.out_features = model[self.numLayers-1].out_features
-        elif isinstance(model[self.numLayers-1], myLSTM):
-            self.out_features = model[self.numLayers-1].hidden_size
-        elif isinstance(model[self.numLayers-1], nn.Conv2d):
-            self.out_features  = model[self.numLayers-1].out_channels
+        lastLayer = [layer for layer in model if not isinstance(layer, epilogueActs)][-1]
+        if isinstance(lastLayer, nn.Linear):
+            self.out_features = lastLayer.out_features
+        elif isinstance(lastLayer, (myLSTM, myGRU)):
+            self.out_features = lastLayer.hidden_size
+        elif isinstance(lastLayer, nn.Conv2d):
+            self.out_features  = lastLayer.out_channels
         else: 
-             error(str(type(model[self.numLayers-1]))+"not defined")
+             error(str(type(lastLayer))+"not defined")
    def __repr__(self):
         return "netModel(model={}, numLayers={}, in_features={}, out_features{})".format(self.model.__repr__(), self.numLayers,  self.in_features,  self.out_features)
 
@@ -139,14 +223,16 @@ class netModel():
    #                 print(layer.bias.size()[0])
                    numParams += layer.weight.size()[0]*layer.weight.size()[1]
                    numParams += layer.bias.size()[0]
-               elif isinstance(layer, myLSTM):
+               elif isinstance(layer, (myLSTM, myGRU)):
                    if layer.num_layers >1:
-                       error("Multi-layer LSTM blocks not implemnted. use several units")
+                       error("Multi-layer LSTM/GRU blocks not implemnted. use several units")
                    numParams += layer.weight_ih_l0.size()[0]*layer.weight_ih_l0.size()[1]+layer.bias_ih_l0.size()[0];
                    numParams += layer.weight_hh_l0.size()[0]*layer.weight_hh_l0.size()[1]+layer.bias_hh_l0.size()[0];
                    numParams += 0
                elif isinstance(layer, nn.Conv2d):
                    numParams +=  reduce(lambda x, y: x*y, layer.weight.size(), 1)+layer.bias.size()[0];
+               elif isinstance(layer, epilogueActs):
+                   a=None# no parameters
                else: 
                    error(str(type(layer))+" not defined")
         return numParams
@@ -188,11 +274,12 @@ class netModel():
             continue;
          _h_im = _netModel.h_im if _netModel.h_im != 0 else h_im
          _w_im = _netModel.w_im if _netModel.w_im != 0 else w_im
-         inputFM = torch.randn(1, _netModel.in_features) if isinstance(_netModel.model[0], nn.Linear) else \
+         seq_len = _netModel.seq_len
+         inputFM = torch.randn(seq_len, _netModel.in_features) if isinstance(_netModel.model[0], nn.Linear) else \
          torch.randn(1, _netModel.in_features, _h_im, _w_im) if isinstance(_netModel.model[0], nn.Conv2d) else \
-         torch.randn(1, 1, _netModel.in_features);
+         torch.randn(seq_len, 1, _netModel.in_features);
          # inputFM = inputFM.fill_(torch.ones(2).mul(3)
-         info("rnn/lstm first layers are accounted as 1x1xin for batch=1, seq=1")
+         info("rnn/lstm first layers are accounted as seq_len x 1 x in for batch=1")
 
          # debug session
          # inputFM[0][1].data.fill_(0)
@@ -223,12 +310,25 @@ class netModel():
          
          print("inputfm=")
          print(inputFM)
-         write2file("#define DEPTH{} {}\n".format(modelID, len(_netModel.model)))
-         netDef_c = "struct layer model{}[{}] = {{".format(modelID, len(_netModel.model))
-         for layer in _netModel.model.children():
+         layers = list(_netModel.model.children())
+         folded = foldedActs(layers)
+         depth = len([f for f in folded if not f])
+         write2file("#define DEPTH{} {}\n".format(modelID, depth))
+         write2file("#define SEQ{} {}\n".format(modelID, seq_len))
+         netDef_c = "struct layer model{}[{}] = {{".format(modelID, depth)
+         inFrac = q_frac # fractional bits of the input FM of the current layer
+         for layer in layers:
+            # the output FM of the last layer (m*_Out), the input of LSTM/GRU layers and of qFormatActs stay in q_format
+            nextID = layID+1
+            while nextID < len(layers) and isinstance(layers[nextID], epilogueActs) and not isinstance(layers[nextID], qFormatActs):
+               nextID += 1 # same format at the input and the output (ReLU, clamping), the layer after it decides
+            nextLayer = layers[nextID] if nextID < len(layers) else None
+            keepOut = nextLayer is None or isinstance(nextLayer, (myLSTM, myGRU)+qFormatActs)
+            weightFrac, outFrac = None, None
             # print(layer)
             info(str(layID))
-            netDef_c += ", \\\n " if layID != 0 else "\\\n "
+            if not folded[layID]:
+               netDef_c += ", \\\n " if layID != 0 else "\\\n "
             if isinstance(layer, nn.Linear):
                
                dbgPrint("Linear Layer")
@@ -242,6 +342,11 @@ class netModel():
 
                if len(inputFM.size()) == 4:
                 inputFM = inputFM.view(-1)
+               isSparse = sparseLinear and weightFormat == "q16"
+               if isSparse and blockPruneRatio > 0.0:
+                  layer.weight.data = torch.tensor(pruneBlocks(_tensorRows(layer.weight), blockPruneRatio))
+               if weightFormat == "2of4":
+                  layer.weight.data = torch.tensor(prune2of4(_tensorRows(layer.weight)))
                outputFM = layer.forward(inputFM)
                
 
@@ -255,18 +360,34 @@ class netModel():
                write2file("*/\n");
                # write2file("data_t "+prefix+"OutExp["+str(len(outputFM[0]))+"];")
                # print(_1DTensor2C(prefix+"In", inputFM))
-               write2file(_1DTensor2C(prefix+"Bias", layer.bias))
-               write2file(_2DTensor2C(prefix+"Weights", layer.weight))
+               weightFrac, outFrac = calibrateLayer(inFrac, layer.weight.data.reshape(-1).tolist(),
+                  outputFM.data.reshape(-1).tolist()+layer.bias.data.tolist(), keepOut)
+               write2file(_1DTensor2C(prefix+"Bias", layer.bias, outFrac))
+               if weightFormat in weight_formats:
+                  write2file(quantizedRows2C(prefix+"Weights", prefix+"Scale", _tensorRows(layer.weight), weightFormat, weightFrac))
+               elif weightFormat == "2of4":
+                  write2file(nmRows2C(prefix+"Weights", prefix+"Index", _tensorRows(layer.weight), weightFrac))
+               elif isSparse:
+                  write2file(sparseRows2C(prefix+"Weights", _tensorRows(layer.weight), weightFrac))
+               else:
+                  write2file(_2DTensor2C(prefix+"Weights", layer.weight, weightFrac))
          #
                print("int "+prefix+"inFeatureSize = "+str(inFeaturesSize)+";")
                print("int "+prefix+"outFeatureSize = "+str(outFeaturesSize)+";")
               
                netDef_c += "{{.type=LINEAR, .attributes={{{},{},{},{},{}}}, ".format(inFeaturesSize, outFeaturesSize, 0,0,0)
-               netDef_c += ".parameters={{{},{}[0],{},{},{},{}}}}}".format(prefix+"Bias", prefix+"Weights",0,0,0,0)
+               if weightFormat in weight_formats:
+                  netDef_c += ".parameters={{{},(data_t*){}[0],(data_t*){},{},{},{}}}, .weightFormat={}".format(prefix+"Bias", prefix+"Weights", prefix+"Scale",0,0,0, weight_formats[weightFormat][1])
+               elif weightFormat == "2of4":
+                  netDef_c += ".parameters={{{},{}[0],{},{},{},(data_t*){}[0]}}, .weightFormat=WEIGHT_2OF4".format(prefix+"Bias", prefix+"Weights",0,0,0, prefix+"Index")
+               elif isSparse:
+                  netDef_c += ".parameters={{{},{},{},(data_t*){},(data_t*){},{}}}, .weightFormat=WEIGHT_SPARSE".format(prefix+"Bias", prefix+"Weights",0, prefix+"WeightsBlockRows", prefix+"WeightsBlockCols",0)
+               else:
+                  netDef_c += ".parameters={{{},{}[0],{},{},{},{}}}".format(prefix+"Bias", prefix+"Weights",0,0,0,0)
+               netDef_c += qFormat2C(inFrac, weightFrac, outFrac)+"}"
             elif isinstance(layer, myLSTM):
                dbgPrint("LSTM")
                write2file("// LSTM Layer")
-               seq_len = 1 # sequence length is 1! TODO
                inFeaturesSize = layer.input_size
                outFeaturesSize = layer.hidden_size
                hiddenFeaturesSize = outFeaturesSize
@@ -276,6 +397,9 @@ class netModel():
                write2file(_1DTensor2C(prefix+"h", layer.hx[0]))
                write2file(_1DTensor2C(prefix+"c", layer.hx[1]))
                write2file("// inputFM.size = "+inputFM.size().__repr__()+"\n");
+               if weightFormat == "2of4":
+                  layer.weight_ih_l0.data = torch.tensor(prune2of4(_tensorRows(layer.weight_ih_l0)))
+                  layer.weight_hh_l0.data = torch.tensor(prune2of4(_tensorRows(layer.weight_hh_l0)))
                outputFM = layer.forward(inputFM)
 
                write2file("// outputFM.size = "+outputFM.size().__repr__()+"\n");
@@ -287,8 +411,17 @@ class netModel():
                
                
                layer_id = 0
-               write2file(_2DTensor2C(prefix+"weight_ih_l"+str(layer_id), eval("layer.weight_ih_l"+str(layer_id))))
-               write2file(_2DTensor2C(prefix+"weight_hh_l"+str(layer_id), eval("layer.weight_hh_l"+str(layer_id))))
+               # only the weights are calibrated (one format for w_ih and w_hh), the gates and the state are Q3.12
+               weightFrac, outFrac = calibrateLayer(inFrac, layer.weight_ih_l0.data.reshape(-1).tolist()+layer.weight_hh_l0.data.reshape(-1).tolist(), [], True)
+               if weightFormat in weight_formats:
+                  for w in ["ih", "hh"]:
+                     write2file(quantizedRows2C(prefix+"weight_"+w+"_l"+str(layer_id), prefix+"scale_"+w+"_l"+str(layer_id), _tensorRows(eval("layer.weight_"+w+"_l"+str(layer_id))), weightFormat, weightFrac))
+               elif weightFormat == "2of4":
+                  for w in ["ih", "hh"]:
+                     write2file(nmRows2C(prefix+"weight_"+w+"_l"+str(layer_id), prefix+"index_"+w+"_l"+str(layer_id), _tensorRows(eval("layer.weight_"+w+"_l"+str(layer_id))), weightFrac))
+               else:
+                  write2file(_2DTensor2C(prefix+"weight_ih_l"+str(layer_id), eval("layer.weight_ih_l"+str(layer_id)), weightFrac))
+                  write2file(_2DTensor2C(prefix+"weight_hh_l"+str(layer_id), eval("layer.weight_hh_l"+str(layer_id)), weightFrac))
                write2file(_1DTensor2C(prefix+"bias_ih_l"+str(layer_id), eval("layer.bias_ih_l"+str(layer_id))))
                write2file(_1DTensor2C(prefix+"bias_hh_l"+str(layer_id), eval("layer.bias_hh_l"+str(layer_id))))
 
@@ -312,7 +445,36 @@ class netModel():
                print("*/")
 
                netDef_c += "{{.type=LSTM, .attributes={{{},{},{},{},{}}}, ".format(inFeaturesSize, hiddenFeaturesSize, 0,0,0)
-               netDef_c += ".parameters={{{}[0],{}[0],{},{},{},{}}}}}".format(prefix+"weight_ih_l"+str(layer_id),prefix+"weight_hh_l"+str(layer_id),prefix+"bias_ih_l"+str(layer_id),prefix+"bias_hh_l"+str(layer_id), prefix+"h", prefix+"c")
+               if weightFormat in weight_formats:
+                  netDef_c += ".parameters={{(data_t*){}[0],(data_t*){}[0],{},{},{},{},(data_t*){},(data_t*){}}}, .weightFormat={}".format(prefix+"weight_ih_l"+str(layer_id),prefix+"weight_hh_l"+str(layer_id),prefix+"bias_ih_l"+str(layer_id),prefix+"bias_hh_l"+str(layer_id), prefix+"h", prefix+"c", prefix+"scale_ih_l"+str(layer_id), prefix+"scale_hh_l"+str(layer_id), weight_formats[weightFormat][1])
+               elif weightFormat == "2of4":
+                  netDef_c += ".parameters={{{}[0],{}[0],{},{},{},{},{},{},(data_t*){}[0],(data_t*){}[0]}}, .weightFormat=WEIGHT_2OF4".format(prefix+"weight_ih_l"+str(layer_id),prefix+"weight_hh_l"+str(layer_id),prefix+"bias_ih_l"+str(layer_id),prefix+"bias_hh_l"+str(layer_id), prefix+"h", prefix+"c",0,0, prefix+"index_ih_l"+str(layer_id), prefix+"index_hh_l"+str(layer_id))
+               else:
+                  netDef_c += ".parameters={{{}[0],{}[0],{},{},{},{}}}".format(prefix+"weight_ih_l"+str(layer_id),prefix+"weight_hh_l"+str(layer_id),prefix+"bias_ih_l"+str(layer_id),prefix+"bias_hh_l"+str(layer_id), prefix+"h", prefix+"c")
+               netDef_c += qFormat2C(inFrac, weightFrac, outFrac)+"}"
+            elif isinstance(layer, myGRU):
+               dbgPrint("GRU")
+               write2file("// GRU Layer")
+               inFeaturesSize = layer.input_size
+               hiddenFeaturesSize = layer.hidden_size
+               prefix = "m{}_gru{}_".format(modelID, layID)
+               write2file(_1DTensor2C(prefix+"h", layer.hx))
+               write2file("// inputFM.size = "+inputFM.size().__repr__()+"\n");
+               outputFM = layer.forward(inputFM)
+               write2file("// outputFM.size = "+outputFM.size().__repr__()+"\n");
+
+               # only the weights are calibrated (one format for w_ih and w_hh), the gates and the state are Q3.12
+               weightFrac, outFrac = calibrateLayer(inFrac, layer.weight_ih_l0.data.reshape(-1).tolist()+layer.weight_hh_l0.data.reshape(-1).tolist(), [], True)
+               if weightFormat != "q16":
+                  error(weightFormat+" weights are not supported for GRU layers, exported as q16")
+               write2file(_2DTensor2C(prefix+"weight_ih_l0", layer.weight_ih_l0, weightFrac))
+               write2file(_2DTensor2C(prefix+"weight_hh_l0", layer.weight_hh_l0, weightFrac))
+               write2file(_1DTensor2C(prefix+"bias_ih_l0", layer.bias_ih_l0))
+               write2file(_1DTensor2C(prefix+"bias_hh_l0", layer.bias_hh_l0))
+
+               netDef_c += "{{.type=GRU, .attributes={{{},{},{},{},{}}}, ".format(inFeaturesSize, hiddenFeaturesSize, 0,0,0)
+               netDef_c += ".parameters={{{}[0],{}[0],{},{},{},{}}}".format(prefix+"weight_ih_l0",prefix+"weight_hh_l0",prefix+"bias_ih_l0",prefix+"bias_hh_l0", prefix+"h", 0)
+               netDef_c += qFormat2C(inFrac, weightFrac, outFrac)+"}"
             elif isinstance(layer, nn.Conv2d):
               write2file("// Conv2D Layer")
               # layer.weight.data.fill_(2**-5)
@@ -328,30 +490,53 @@ class netModel():
               dimension_order = [0,2,3,1];   
               print("weight=") 
               print(layer.weight.data)
+              values = [] # weights in dimension_order, for the int8 export
               # layer.weight.data.fill_(1)
               for a in range(0, layer.weight.size()[dimension_order[0]]):
                 for b in range(0, layer.weight.size()[dimension_order[1]]):
                   for c in range(0, layer.weight.size()[dimension_order[2]]):
                     for d in range(0, layer.weight.size()[dimension_order[3]]):
                       # print(num2format(layer.weight.data[eval(chr(ord('a')+dimension_order.index(0)))][eval(chr(ord('a')+dimension_order.index(1)))][eval(chr(ord('a')+dimension_order.index(2)))][eval(chr(ord('a')+dimension_order.index(3)))]))
-                      tmp +=str(num2format(layer.weight.data[eval(chr(ord('a')+dimension_order.index(0)))][eval(chr(ord('a')+dimension_order.index(1)))][eval(chr(ord('a')+dimension_order.index(2)))][eval(chr(ord('a')+dimension_order.index(3)))])) # take order like in dimension_order
-                      tmp +=", "
-              write2file(tmp)
-              moveFilePointer(3)
-
-              write2file("};\n");
+                      value = layer.weight.data[eval(chr(ord('a')+dimension_order.index(0)))][eval(chr(ord('a')+dimension_order.index(1)))][eval(chr(ord('a')+dimension_order.index(2)))][eval(chr(ord('a')+dimension_order.index(3)))] # take order like in dimension_order
+                      values.append(float(value))
+              outputFM = layer.forward(inputFM)
+              weightFrac, outFrac = calibrateLayer(inFrac, values, outputFM.data.reshape(-1).tolist()+layer.bias.data.tolist(), keepOut)
+              tmp += ", ".join([str(num2format(value, weightFrac)) for value in values])
+              if weightFormat == "int4" or weightFormat == "2of4":
+                 error(weightFormat+" weights are not supported for Conv2d layers, exported as q16")
+              if weightFormat == "int8":
+                 # one row (and scale) per output channel: [c_out][kh][kw][c_in]
+                 rowSize = len(values)//outFeaturesSize
+                 write2file(quantizedRows2C(prefix+"weight", prefix+"scale", [values[i*rowSize:(i+1)*rowSize] for i in range(0, outFeaturesSize)], weightFormat, weightFrac))
+              else:
+                 write2file(tmp+"};\n")
               print("bias=") 
               print(layer.bias.data)
-              write2file(_1DTensor2C(prefix+"bias", layer.bias))
+              write2file(_1DTensor2C(prefix+"bias", layer.bias, outFrac))
 
-              outputFM = layer.forward(inputFM)
               print("out=") 
               print(outputFM)
               netDef_c += "{{.type=Conv2d, .attributes={{{},{},{},{},{}}}, ".format(inFeaturesSize, outFeaturesSize, kernelSize, _h_im, _w_im)
-              netDef_c += ".parameters={{{},{},{},{},{},{}}}}}".format(prefix+"weight",prefix+"bias",0,0,0,0)
+              if weightFormat == "int8":
+                 netDef_c += ".parameters={{(data_t*){}[0],{},(data_t*){},{},{},{}}}, .weightFormat=WEIGHT_INT8".format(prefix+"weight",prefix+"bias",prefix+"scale",0,0,0)
+              else:
+                 netDef_c += ".parameters={{{},{},{},{},{},{}}}".format(prefix+"weight",prefix+"bias",0,0,0,0)
+              netDef_c += qFormat2C(inFrac, weightFrac, outFrac)+"}"
+            elif isinstance(layer, epilogueActs) and folded[layID]:
+              write2file("// "+type(layer).__name__+" in the epilogue of the previous layer")
+              netDef_c = netDef_c[:-1]+epilogue2C(layer, inFrac)+"}"
+              outputFM = layer(inputFM)
+            elif isinstance(layer, epilogueActs):
+              write2file("// "+type(layer).__name__+" Activation Layer")
+              # element-wise, same format at the input and the output
+              outputFM = layer(inputFM)
+              netDef_c += "{{.type=ACTIVATION, .attributes={{{},{},{},{},{}}}".format(inputFM[0].numel(), 0,0,0,0)
+              netDef_c += qFormat2C(inFrac, q_frac if calibrateQFormat else None, inFrac)+epilogue2C(layer, inFrac)+"}"
             else:
                error("not implemented")
             inputFM = outputFM.clone()
+            if outFrac is not None:
+               inFrac = outFrac
             layID += 1
             
          write2file(_1DTensor2C("m{}_Out".format(modelID), outputFM.clone().view(-1)))
@@ -0,0 +1,144 @@
+# Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri
+# Generator of the piecewise linear tanh/sigmoid tables (actLut.h) with error and cycle report
+#
+# Every segment is a least-squares line (as evalClass.m in funcApprox), |x| is split into
+# segments of 2^shift LSB, inputs beyond the last segment saturate to 1 (tanh) or 0/1 (sigmoid).
+# The errors are calculated with the integer arithmetic of Tanh()/sig() in basicKernel.c for all
+# 16-bit inputs. The tables are in the format of the kernels (q_frac of basicKernel.h), the 16 segment
+# tables of Q3.12 are the ones of pl.tanh/pl.sig (interval [0, 4)) whatever the ranges are.
+#
+# Usage: python3 actLut.py [--tanh-range 4] [--sig-range 8] [--segments 8 16 32 64] [-o ../actLut.h]
+import argparse
+import math
+import os
+import re
+
+# fitting grids of funcApprox/tanh_eval.m and sig.m, they reproduce the 16 segment tables of pl.tanh/pl.sig
+FUNCS = [
+  ("Tanh", "TANH", math.tanh, None),
+  ("sig", "SIG", lambda x: 1.0/(1.0+math.exp(-x)), 0.01),
+]
+HW_SEGMENTS = 16 # pl.tanh/pl.sig
+HW_FRAC = 12
+HW_RANGE = 4
+KERNEL_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "basicKernel.h")
+
+def kernelFrac():
+  """ q_frac of basicKernel.h (ACT_LUT_FRAC has to match it) """
+  with open(KERNEL_HEADER) as f:
+    match = re.search(r"^#define q_frac (\d+)", f.read(), re.M)
+  if match is None:
+    raise SystemExit("q_frac not found in %s" % KERNEL_HEADER)
+  return int(match.group(1))
+
+def fitSegment(f, lo, hi, step):
+  n = int(round((hi-lo)/step))+1
+  xs = [lo+i*step for i in range(n)]
+  ys = [f(x) for x in xs]
+  mx = sum(xs)/n
+  my = sum(ys)/n
+  m = sum((x-mx)*(y-my) for x, y in zip(xs, ys))/sum((x-mx)**2 for x in xs)
+  return m, my-m*mx
+
+def quant(value, frac):
+  return int(math.floor(value*2**frac+0.5))
+
+def makeTable(f, step, frac, rng, segments):
+  width = rng/segments
+  m = []
+  q = []
+  for k in range(segments):
+    sm, sq = fitSegment(f, k*width, (k+1)*width, step)
+    m.append(quant(sm, frac)) # Q(frac)
+    q.append(quant(sq, 2*frac)) # Q(2*frac), added to m*|x| before the shift
+  return m, q
+
+def toData(v):
+  return ((v+0x8000) & 0xffff)-0x8000
+
+def evalPwl(name, m, q, frac, shift, x):
+  """ Tanh()/sig() of basicKernel.c """
+  a = -x if x < 0 else x
+  idx = a >> shift
+  one = 1 << frac
+  if idx >= len(m):
+    if name == "Tanh":
+      return -one if x < 0 else one
+    return 0 if x < 0 else one
+  mac = (m[idx]*a+q[idx]) >> frac
+  if x < 0:
+    mac = ~mac if name == "Tanh" else one-1+~mac
+  return toData(mac)
+
+def errors(name, f, m, q, frac, shift):
+  maxErr = 0.0
+  sumErr = 0.0
+  for x in range(-0x8000, 0x8000):
+    err = abs(evalPwl(name, m, q, frac, shift, x)-f(x/2.0**frac)*2**frac)
+    maxErr = max(maxErr, err)
+    sumErr += err
+  return maxErr, sumErr/0x10000
+
+def cArray(ctype, name, values):
+  return "const %s %s[%d] = {%s};\n" % (ctype, name, len(values), ", ".join(str(v) for v in values))
+
+def main():
+  parser = argparse.ArgumentParser(description="Generate the piecewise linear tanh/sigmoid tables (actLut.h)")
+  parser.add_argument("--tanh-range", type=int, default=HW_RANGE, help="end of the approximated interval [0, range) of tanh, power of 2")
+  parser.add_argument("--sig-range", type=int, default=8, help="end of the approximated interval [0, range) of the sigmoid, power of 2 (1-sig(4) is 74 LSB)")
+  parser.add_argument("--segments", type=int, nargs="+", default=[8, 16, 32, 64], help="table sizes, powers of 2")
+  parser.add_argument("--sw-cycles", type=int, default=24, help="cycles of one software activation on RISC-Y (branch-free pwlAct, measure with PROFILING_TANH)")
+  parser.add_argument("--activations", type=int, default=5*256, help="activations per layer of the cycle report (default: LSTM with 256 hidden units)")
+  parser.add_argument("-o", "--output", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "actLut.h"))
+  args = parser.parse_args()
+  args.frac = kernelFrac()
+
+  ranges = {"Tanh": args.tanh_range, "sig": args.sig_range}
+  if any(r < 1 or r & (r-1) or r << args.frac > 0x8000 for r in ranges.values()):
+    parser.error("the ranges must be powers of 2 within the data_t range")
+  isHw = args.frac == HW_FRAC
+  out = ["/** Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri\n",
+         " *  @file actLut.h\n",
+         " *  @brief Coefficients of the piecewise linear approximation of tangent hyperbolic and sigmoid\n",
+         " *\n",
+         " *  Generated by scripts/actLut.py --tanh-range %d --sig-range %d --segments %s (q_frac %d), do not edit.\n" % (args.tanh_range, args.sig_range, " ".join(str(s) for s in args.segments), args.frac),
+         " *  f(x) = (lut_m[|x|>>shift]*|x|+lut_q[|x|>>shift])>>ACT_LUT_FRAC on [0, range), select with ACT_LUT_SEGMENTS.\n",
+         " *  Errors in LSB of the output over all inputs.\n",
+         " *\n",
+         " * @author Renzo Andri (andrire)\n",
+         " */\n",
+         "/// Fractional bits of the tables (inputs and outputs)\n",
+         "#define ACT_LUT_FRAC %d\n" % args.frac]
+  print("%8s %12s %12s %12s %12s %8s %10s %12s" % ("segments", "tanh max", "tanh mean", "sig max", "sig mean", "bytes", "cyc/act", "cyc/layer"))
+  for i, segments in enumerate(args.segments):
+    if segments < 1 or segments & (segments-1):
+      parser.error("%d segments: not a power of 2" % segments)
+    out.append("%s ACT_LUT_SEGMENTS == %d\n" % ("#if" if i == 0 else "#elif", segments))
+    hw = isHw and segments == HW_SEGMENTS
+    if hw:
+      out.append("/// Same tables as pl.tanh/pl.sig\n#define ACT_LUT_PLTANH\n")
+    report = []
+    for name, macro, f, step in FUNCS:
+      rng = HW_RANGE if hw else ranges[name]
+      shift = args.frac+int(math.log2(rng))-int(math.log2(segments))
+      if shift < 0:
+        parser.error("%d segments: smaller than 1 LSB" % segments)
+      m, q = makeTable(f, step if step else 2.0**-args.frac, args.frac, rng, segments)
+      if max(m) >= 2**15 or max(q) >= 2**31:
+        parser.error("the coefficients do not fit into short/int")
+      maxErr, meanErr = errors(name, f, m, q, args.frac, shift)
+      report += [maxErr, meanErr]
+      out.append("// %s on [0, %d): max. error %.2f LSB, mean error %.3f LSB\n" % (name, rng, maxErr, meanErr))
+      out.append("#define ACT_LUT_%s_SHIFT %d\n" % (macro, shift))
+      out.append(cArray("short", "lut_%s_m" % name, m))
+      out.append(cArray("int", "lut_%s_q" % name, q))
+    cycles = 1 if hw else args.sw_cycles
+    print("%8d %12.2f %12.3f %12.2f %12.3f %8d %10d %12d" % tuple([segments]+report+[len(FUNCS)*6*segments, cycles, cycles*args.activations]))
+  out.append("#else\n#error \"ACT_LUT_SEGMENTS: no table in actLut.h, see scripts/actLut.py\"\n#endif\n")
+  with open(args.output, "w") as f:
+    f.writelines(out)
+  print("errors in LSB, cyc/act: pl.tanh/pl.sig (%d segments, range %d, Q3.%d) or --sw-cycles, cyc/layer: %d activations" % (HW_SEGMENTS, HW_RANGE, HW_FRAC, args.activations))
+  print("written to %s" % os.path.normpath(args.output))
+
+if __name__ == "__main__":
+  main()
@@ -24,7 +24,7 @@ f.write("#define FixedPt 1" if mode=="fixedPt" else "//#define FixedPt 1"); f.cl
 # helper functions
 def float2fixedPt(q_format, number):
    p_int = int(q_format)
-   p_frac = int((q_format-p_int)*100)
+   p_frac = int(round((q_format-p_int)*100))
    # print(number)
    temp =  int(number * 2**(p_frac)) & (2**(1+p_int+p_frac)-1)
    # print(number)
@@ -35,13 +35,31 @@ def float2fixedPt(q_format, number):
    # print(temp)
    return temp
 
-def num2format(number):
+def num2format(number, frac=None):
+   # frac: fractional bits of the tensor (struct qFormat), None: q_format
    if mode == "fixedPt":
-      return float2fixedPt(q_format, number)
+      return float2fixedPt(q_format if frac is None else qFormatOf(frac), number)
    else:
       return float(number)
 
-def _1DTensor2C(var_name, tensor):
+# per-layer fixed-point formats (struct qFormat): fractional bits of a 16-bit tensor chosen from calibration data
+q_frac = int(round((q_format-int(q_format))*100))
+# the calibrated range is the largest magnitude seen times q_calib_headroom (inputs which are not in the calibration data)
+q_calib_headroom = 2.0
+
+def qFormatOf(frac):
+   # q_format notation (int.frac) of a 16-bit format with frac fractional bits
+   return (15-frac)+frac/100.0
+
+def calibratedFrac(values, maxFrac=15):
+   # most fractional bits (up to maxFrac) for which the largest magnitude of values (with headroom) fits into 16 bit
+   maxAbs = max([abs(float(x)) for x in values]+[0.0])*q_calib_headroom
+   frac = maxFrac
+   while frac > 0 and maxAbs*2**frac > 2**15-1:
+      frac -= 1
+   return frac
+
+def _1DTensor2C(var_name, tensor, frac=None):
    # print(tensor)
    # print(len(tensor[0]))
    length = len(tensor)
@@ -60,15 +78,15 @@ def _1DTensor2C(var_name, tensor):
       if i!=0:
          tmp += ", "
       if tensor3D:
-         tmp += str(num2format(tensor.data[0][0][i]))
+         tmp += str(num2format(tensor.data[0][0][i], frac))
       elif tensor2D:
-         tmp += str(num2format(tensor.data[0][i]))
+         tmp += str(num2format(tensor.data[0][i], frac))
       else:
-         tmp += str(num2format(tensor.data[i]))
+         tmp += str(num2format(tensor.data[i], frac))
    tmp += "};"
    return tmp
 
-def _2DTensor2C(var_name, tensor):
+def _2DTensor2C(var_name, tensor, frac=None):
    # print(tensor)
    # print(len(tensor[0]))
    tmp = ""
@@ -81,11 +99,139 @@ def _2DTensor2C(var_name, tensor):
       for i in range(0, len(tensor[0])):
          if i!=0:
             tmp += ", "
-         tmp += str(num2format(tensor.data[j][i]))
+         tmp += str(num2format(tensor.data[j][i], frac))
       tmp += "}"
    tmp += "};"
    return tmp
 
+# int8/int4 weights: one int32 scale per row (output neuron/channel), weight in fixed-point = int*scale>>weight_scale_shift
+weight_scale_shift = 16
+# largest magnitude and enum weightFormat of the quantised formats
+weight_formats = {"int8": (127, "WEIGHT_INT8"), "int4": (7, "WEIGHT_INT4")}
+
+def _tensorRows(tensor):
+   return [[float(tensor.data[j][i]) for i in range(0, len(tensor[0]))] for j in range(0, len(tensor))]
+
+def quantizeRows(rows, qMax, frac=None):
+   # rows: list of rows of float weights, returns the rows quantised to -qMax..qMax and the scale of every row
+   # (frac: fractional bits of the weights, None: q_format)
+   qRows = []
+   scales = []
+   for row in rows:
+      fixed = [float2fixedPt(q_format if frac is None else qFormatOf(frac), x) for x in row]
+      maxAbs = max([abs(x) for x in fixed]+[0])
+      scale = max(1, int(round(maxAbs*2**weight_scale_shift/float(qMax))))
+      qRows.append([max(-qMax, min(qMax, int(round(x*2**weight_scale_shift/float(scale))))) for x in fixed])
+      scales.append(scale)
+   return qRows, scales
+
+def _int8Rows2C(var_name, rows):
+   tmp = ""
+   tmp += "RT_L2_DATA int8_t "+var_name+"["+str(len(rows))+"]["+str(len(rows[0]))+"] = "
+   tmp += "{"+", ".join(["{"+", ".join([str(x) for x in row])+"}" for row in rows])+"};"
+   return tmp
+
+def _int32List2C(var_name, values):
+   return "RT_L2_DATA int32_t "+var_name+"["+str(len(values))+"] = {"+", ".join([str(x) for x in values])+"};"
+
+def _int4Rows2C(var_name, rows):
+   # two weights per byte, the first one in the low nibble, every row padded to whole bytes (INT4_ROW_BYTES)
+   packed = []
+   for row in rows:
+      padded = row+[0]*(len(row)%2)
+      packed.append([(padded[i] & 0xF) | ((padded[i+1] & 0xF)<<4) for i in range(0, len(padded), 2)])
+   tmp = ""
+   tmp += "RT_L2_DATA uint8_t "+var_name+"["+str(len(packed))+"]["+str(len(packed[0]))+"] = "
+   tmp += "{"+", ".join(["{"+", ".join([str(x) for x in row])+"}" for row in packed])+"};"
+   return tmp
+
+def quantizedRows2C(var_name, scale_name, rows, weightFormat, frac=None):
+   # weights (int8_t or packed int4) and scales of the rows in the format weightFormat ("int8" or "int4")
+   qRows, scales = quantizeRows(rows, weight_formats[weightFormat][0], frac)
+   if weightFormat == "int4":
+      weights = _int4Rows2C(var_name, qRows)
+   else:
+      weights = _int8Rows2C(var_name, qRows)
+   return weights+"\n"+_int32List2C(scale_name, scales)
+
+# block-sparse weights (WEIGHT_SPARSE): blocks of sparse_block_out rows (output neurons) x 2 columns (one v2s)
+sparse_block_out = 4
+
+def _blocks(rows):
+   # (block row, input pair) of all the blocks of rows, rows padded with zeros to whole blocks
+   return [(b, c) for b in range(0, (len(rows)+sparse_block_out-1)//sparse_block_out) for c in range(0, (len(rows[0])+1)//2)]
+
+def _blockValues(rows, b, c):
+   # weights of a block, row by row (one pair per output neuron)
+   values = []
+   for j in range(b*sparse_block_out, (b+1)*sparse_block_out):
+      row = rows[j] if j < len(rows) else []
+      values += [row[i] if i < len(row) else 0.0 for i in (2*c, 2*c+1)]
+   return values
+
+def pruneBlocks(rows, ratio):
+   # magnitude pruning: sets the fraction ratio of the blocks with the smallest L1 norm to zero
+   blocks = sorted(_blocks(rows), key=lambda bc: sum([abs(x) for x in _blockValues(rows, bc[0], bc[1])]))
+   pruned = [list(row) for row in rows]
+   for (b, c) in blocks[:int(ratio*len(blocks))]:
+      for j in range(b*sparse_block_out, min((b+1)*sparse_block_out, len(rows))):
+         for i in range(2*c, min(2*c+2, len(rows[0]))):
+            pruned[j][i] = 0.0
+   return pruned
+
+def sparseRows2C(var_name, rows, frac=None):
+   # non-zero blocks (data_t), first block of every block row (int32_t, var_name+"BlockRows") and input pair of every
+   # block (uint16_t, var_name+"BlockCols"), blocks which are zero in fixed-point are dropped
+   values, blockRows, blockCols = [], [0], []
+   for b in range(0, (len(rows)+sparse_block_out-1)//sparse_block_out):
+      for c in range(0, (len(rows[0])+1)//2):
+         block = [num2format(x, frac) for x in _blockValues(rows, b, c)]
+         if any(block):
+            values += block
+            blockCols.append(c)
+      blockRows.append(len(blockCols))
+   if len(blockCols) == 0: # no empty arrays in C
+      values, blockCols = [0]*(2*sparse_block_out), [0]
+   tmp = ""
+   tmp += "RT_L2_DATA data_t "+var_name+"["+str(len(values))+"] = {"+", ".join([str(x) for x in values])+"};\n"
+   tmp += _int32List2C(var_name+"BlockRows", blockRows)+"\n"
+   tmp += "RT_L2_DATA uint16_t "+var_name+"BlockCols["+str(len(blockCols))+"] = {"+", ".join([str(x) for x in blockCols])+"};"
+   return tmp
+
+# 2:4 structured sparse weights (WEIGHT_2OF4): 2 weights of every group of 4 inputs and their positions (2 bit each)
+def prune2of4(rows):
+   # magnitude pruning: keeps the 2 weights with the largest magnitude of every group of 4 inputs
+   pruned = []
+   for row in rows:
+      kept = [0.0]*len(row)
+      for g in range(0, len(row), 4):
+         for i in sorted(range(g, min(g+4, len(row))), key=lambda i: -abs(row[i]))[:2]:
+            kept[i] = row[i]
+      pruned.append(kept)
+   return pruned
+
+def nmRows2C(var_name, index_name, rows, frac=None):
+   # weights (data_t, 2 per group, NM_ROW_WEIGHTS) and positions (uint8_t, 4 bit per group: first weight in bits 1:0,
+   # second in bits 3:2, first group in the low nibble, NM_ROW_BYTES) of rows which have been pruned to 2:4
+   wRows, iRows = [], []
+   for row in rows:
+      weights, nibbles = [], []
+      for g in range(0, len(row), 4):
+         pos = [i for i in range(0, min(4, len(row)-g)) if row[g+i] != 0.0]
+         assert len(pos) <= 2, "more than 2 non-zero weights in a group of 4, prune with prune2of4 first"
+         pos += [0]*(2-len(pos)) # unused positions with weight 0
+         weights += [num2format(row[g+pos[0]], frac), num2format(row[g+pos[1]], frac) if pos[1] != pos[0] else 0]
+         nibbles.append(pos[0] | (pos[1]<<2))
+      nibbles += [0]*(len(nibbles)%2)
+      wRows.append(weights)
+      iRows.append([nibbles[i] | (nibbles[i+1]<<4) for i in range(0, len(nibbles), 2)])
+   tmp = ""
+   tmp += "RT_L2_DATA data_t "+var_name+"["+str(len(wRows))+"]["+str(len(wRows[0]))+"] = "
+   tmp += "{"+", ".join(["{"+", ".join([str(x) for x in row])+"}" for row in wRows])+"};\n"
+   tmp += "RT_L2_DATA uint8_t "+index_name+"["+str(len(iRows))+"]["+str(len(iRows[0]))+"] = "
+   tmp += "{"+", ".join(["{"+", ".join([str(x) for x in row])+"}" for row in iRows])+"};"
+   return tmp
+
 
 if __name__ == "__main__":
    # Linear Layer
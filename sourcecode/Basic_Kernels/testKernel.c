@@ -17,6 +17,9 @@
   #include "config_profiling.h"
 #endif
 #include "basicKernel.h"
+#if defined AUTOTUNE && !defined ASIP
+#include "autoTune.h"
+#endif
 /// @cond DOXYGEN_EXCLUDE
 #include "benchmarks.h"
 /// @endcond
@@ -34,9 +37,454 @@ int event_mask;
 RT_L2_DATA data_t buffer[BUFFER_SIZE];
 
 
+#if defined AUTOTUNE && !defined ASIP
+/// Tuning cache of the autotuner
+RT_L2_DATA struct tuneCache tuneCache;
+#ifdef TUNE_CACHE_INC
+/// Tuning cache of a previous run (output of tuneCachePrint())
+struct tuneEntry tuneCacheInit[] = {
+#include TUNE_CACHE_INC
+};
+#endif
+#endif
+
+#if ((defined TILING_SWEEP || defined BATCH_SIZE || defined EXECPLAN_REPEAT || defined PIPELINE_SAMPLES) && !defined ASIP) || defined MEMPLAN_REPORT
+/// Benchmark modes which compare their outputs with the ones of inferNetwork()
+#define BENCH_CHECK
+#endif
+#if defined BENCH_CHECK || defined ACCURACY_REPORT || (defined AUTOTUNE && !defined ASIP)
+/// Benchmark modes of config_profiling.h, they run all the models of benchModels
+#define BENCH_MODE
+#endif
+
+#ifdef BENCH_MODE
+/// Model of the benchmark suite selected with MODEL<n> in config_profiling.h (see benchmarks.h)
+struct benchModel {
+    int id;                  /**< Model ID */
+    struct layer * network;  /**< Layers of the network, NULL: end of benchModels */
+    int depth;               /**< Number of layers */
+    int seqSize;             /**< Number of time steps */
+    data_t * inFeatures;     /**< Input FM [seqSize x input neurons] */
+    data_t * reference;      /**< Output FM of the PyTorch model [seqSize x output neurons] */
+    int inSize;              /**< Size of the input FM (all time steps) */
+    int outSize;             /**< Size of the output FM (all time steps) */
+};
+
+/// Entry of benchModels for model n
+#define BENCH_MODEL(n) {n, model##n, DEPTH##n, SEQ##n, m##n##_In, m##n##_Out, \
+  sizeof(m##n##_In)/sizeof(data_t), sizeof(m##n##_Out)/sizeof(data_t)}
+
+/// Selected models, every benchmark mode iterates over them
+static struct benchModel benchModels[] = {
+#ifdef MODEL0
+  BENCH_MODEL(0),
+#endif
+#ifdef MODEL1
+  BENCH_MODEL(1),
+#endif
+#ifdef MODEL2
+  BENCH_MODEL(2),
+#endif
+#ifdef MODEL3
+  BENCH_MODEL(3),
+#endif
+#ifdef MODEL5
+  BENCH_MODEL(5),
+#endif
+#ifdef MODEL6
+  BENCH_MODEL(6),
+#endif
+#ifdef MODEL7
+  BENCH_MODEL(7),
+#endif
+#ifdef MODEL8
+  BENCH_MODEL(8),
+#endif
+#ifdef MODEL9
+  BENCH_MODEL(9),
+#endif
+#ifdef MODEL10
+  BENCH_MODEL(10),
+#endif
+  {0, NULL, 0, 0, NULL, NULL, 0, 0}
+};
+#endif
+
+#ifdef BENCH_CHECK
+/// Size of the saved LSTM and GRU states of the benchmarked network
+#define NETWORK_STATE_SIZE 4096
+RT_L2_DATA data_t networkStateBuf[NETWORK_STATE_SIZE];
+/// Output FM of inferNetwork() the benchmark modes are compared with
+RT_L2_DATA data_t benchRef[BUFFER_SIZE];
+
+/** @brief Saves (or restores) the LSTM and GRU states of all the layers of a network
+ *
+ *  @return 0 on success, -1 if the states do not fit into NETWORK_STATE_SIZE
+ */
+static int networkState(struct layer * network, int depth, int restore)
+{
+  int k = 0;
+  for(int i=0; i<depth; i++) {
+    if(network[i].type == GRU) {
+      int numHidden = network[i].attributes[LAY_GRU_HID];
+      if(k+numHidden > NETWORK_STATE_SIZE) return -1;
+      for(int j=0; j<numHidden; j++, k++) {
+        if(restore)
+          network[i].parameters[GRU_H][j] = networkStateBuf[k];
+        else
+          networkStateBuf[k] = network[i].parameters[GRU_H][j];
+      }
+      continue;
+    }
+    if(network[i].type != LSTM) continue;
+    int numHidden = network[i].attributes[LAY_LSTM_HID];
+    if(k+2*numHidden > NETWORK_STATE_SIZE) return -1;
+    for(int j=0; j<numHidden; j++, k+=2) {
+      if(restore) {
+        network[i].parameters[LSTM_H][j] = networkStateBuf[k];
+        network[i].parameters[LSTM_C][j] = networkStateBuf[k+1];
+      } else {
+        networkStateBuf[k]   = network[i].parameters[LSTM_H][j];
+        networkStateBuf[k+1] = network[i].parameters[LSTM_C][j];
+      }
+    }
+  }
+  return 0;
+}
+
+/** @brief Runs the first seqSize time steps of a model with inferNetwork() into benchRef and saves the
+ *  LSTM and GRU states of the network before (networkState), i.e. the benchmark modes start from the
+ *  same states as the reference
+ *
+ *  @return 0 on success, -1 if inferNetwork() fails or the output FM or the states do not fit
+ */
+int referenceOutput(struct benchModel * model, int seqSize)
+{
+  int outSize = model->outSize/model->seqSize*seqSize;
+  if(outSize > BUFFER_SIZE || networkState(model->network, model->depth, False) < 0)
+    return -1;
+  data_t * out = inferNetwork(model->network, model->depth, seqSize, model->inFeatures, buffer);
+  networkState(model->network, model->depth, True);
+  if(out == NULL)
+    return -1;
+  CopyTensor(outSize, benchRef, out);
+  return 0;
+}
+
+/** @brief Compares the output FM of a benchmark mode with the one of inferNetwork(), a mismatch is
+ *  printed as error
+ *
+ *  @param mode Name of the benchmark mode
+ *  @param model Benchmarked model
+ *  @param size Size of the output FM
+ *  @param out Output FM of the benchmark mode (NULL: the mode failed, all outputs are mismatches)
+ *  @param reference Output FM of inferNetwork()
+ *  @return Number of mismatches
+ */
+static int checkOutput(const char * mode, struct benchModel * model, int size, data_t * out, data_t * reference)
+{
+  int mismatches = 0;
+  for(int j=0; j<size; j++)
+    mismatches += out == NULL || out[j] != reference[j];
+  if(mismatches > 0)
+    printf("\033[91mERROR: %s of model %d differs from inferNetwork() in %d of %d outputs\033[0m\n", mode, model->id, mismatches, size);
+  return mismatches;
+}
+#endif
+
+#ifdef MEMPLAN_REPORT
+/** @brief Prints the memory plan of a model and runs it with inferNetworkPlanned() in an arena of
+ *  the planned size, the output is compared with inferNetwork()
+ *
+ *  @param model Benchmarked model
+ *  @return Number of mismatches, -1 if the network cannot be planned
+ */
+int reportMemPlan(struct benchModel * model)
+{
+  struct memPlan plan;
+  int arenaSize = planNetwork(model->network, model->depth, model->seqSize, &plan);
+  if(arenaSize < 0 || arenaSize > BUFFER_SIZE || referenceOutput(model, model->seqSize) < 0) {
+    printf("\033[91mERROR: network too large for the memory plan report\033[0m\n");
+    return -1;
+  }
+  PrintMemPlan(model->network, &plan);
+  data_t * out = inferNetworkPlanned(model->network, model->depth, model->seqSize, model->inFeatures, NULL, &plan, buffer);
+  networkState(model->network, model->depth, True);
+  return checkOutput("inferNetworkPlanned()", model, model->outSize, out, benchRef);
+}
+#endif
+
+#if defined TILING_SWEEP && !defined ASIP
+/** @brief Runs the network with all output FM tile sizes (1..TILE_MAXSIZE) with and without input
+ *  FM tiling and prints the cycles of each tiling, i.e. the whole sweep is done with one binary.
+ *  The outputs of all the tilings are compared with inferNetwork() with the tiling of the model.
+ *
+ *  @param model Benchmarked model
+ *  @return Number of mismatches of all the tilings, -1 if the reference cannot be computed
+ */
+int sweepTiling(struct benchModel * model)
+{
+  if(referenceOutput(model, model->seqSize) < 0) {
+    printf("\033[91mERROR: network too large for the tiling sweep\033[0m\n");
+    return -1;
+  }
+  int mismatches = 0;
+  printf("outTile, inTiling, cycles, mismatches\n");
+  for(int outTile=1; outTile<=TILE_MAXSIZE; outTile++) {
+    for(int inTiling=IN_TILING_OFF; inTiling<=IN_TILING_ON; inTiling++) {
+      struct tiling tiling = {outTile, (enum inTilingType)inTiling, ACT_ONTHEFLY_DEFAULT};
+      setNetworkTiling(model->network, model->depth, tiling);
+      rt_perf_init(&perf);
+      rt_perf_conf(&perf, (1<<RT_PERF_CYCLES));
+      rt_perf_reset(&perf);
+      rt_perf_start(&perf);
+      data_t * out = inferNetwork(model->network, model->depth, model->seqSize, model->inFeatures, buffer);
+      rt_perf_stop(&perf);
+      networkState(model->network, model->depth, True);
+      int tilingMismatches = checkOutput("tiling sweep", model, model->outSize, out, benchRef);
+      printf("%d, %d, %d, %d\n", outTile, inTiling==IN_TILING_ON, rt_perf_get(&perf, RT_PERF_CYCLES), tilingMismatches);
+      mismatches += tilingMismatches;
+    }
+  }
+  return mismatches;
+}
+#endif
+
+#if defined BATCH_SIZE && !defined ASIP
+/// Size of the LSTM and GRU states of all the streams of the batch benchmark
+#define BATCH_STATE_SIZE 8192
+/// Largest number of layers of the batch benchmark
+#define BATCH_MAXDEPTH 16
+RT_L2_DATA data_t batchIn[BUFFER_SIZE2];
+RT_L2_DATA data_t batchStateBuffer[BATCH_STATE_SIZE];
+
+/** @brief Runs BATCH_SIZE streams with the same input FM (first time step) and LSTM/GRU state through
+ *  the network with inferNetworkBatch(), compares all of them with inferNetwork() and prints the
+ *  cycles of both
+ *
+ *  @param model Benchmarked model
+ *  @return Number of mismatches of all the streams, -1 if the network does not fit
+ */
+int benchBatch(struct benchModel * model)
+{
+  struct layer * network = model->network;
+  int depth = model->depth;
+  int inSize = model->inSize/model->seqSize;
+  int outSize = model->outSize/model->seqSize;
+  data_t * batchStates[BATCH_MAXDEPTH];
+  int stateSize = 0;
+  if(depth > BATCH_MAXDEPTH || BATCH_SIZE*inSize > BUFFER_SIZE2 || BATCH_SIZE*outSize > BUFFER_SIZE2) {
+    printf("\033[91mERROR: network too large for the batch benchmark\033[0m\n");
+    return -1;
+  }
+  for(int b=0; b<BATCH_SIZE; b++)
+    CopyTensor(inSize, &batchIn[b*inSize], model->inFeatures);
+  for(int i=0; i<depth; i++) {
+    batchStates[i] = NULL;
+    if(network[i].type != LSTM && network[i].type != GRU) continue;
+    int numHidden = network[i].attributes[LAY_LSTM_HID];
+    int numStates = network[i].type == LSTM ? 2 : 1; // h and c (LSTM) or h (GRU)
+    if(stateSize+numStates*BATCH_SIZE*numHidden > BATCH_STATE_SIZE) {
+      printf("\033[91mERROR: recurrent states too large for the batch benchmark (BATCH_STATE_SIZE)\033[0m\n");
+      return -1;
+    }
+    batchStates[i] = &batchStateBuffer[stateSize];
+    for(int b=0; b<BATCH_SIZE; b++) {
+      CopyTensor(numHidden, &batchStates[i][b*numHidden], network[i].parameters[LSTM_H]);
+      if(network[i].type == LSTM)
+        CopyTensor(numHidden, &batchStates[i][(BATCH_SIZE+b)*numHidden], network[i].parameters[LSTM_C]);
+    }
+    stateSize += numStates*BATCH_SIZE*numHidden;
+  }
+
+  if(referenceOutput(model, 1) < 0) {
+    printf("\033[91mERROR: network too large for the batch benchmark\033[0m\n");
+    return -1;
+  }
+  rt_perf_init(&perf);
+  rt_perf_conf(&perf, (1<<RT_PERF_CYCLES));
+  rt_perf_reset(&perf);
+  rt_perf_start(&perf);
+  inferNetwork(network, depth, 1, model->inFeatures, buffer);
+  rt_perf_stop(&perf);
+  unsigned int singleCycles = rt_perf_get(&perf, RT_PERF_CYCLES);
+  networkState(network, depth, True);
+
+  rt_perf_init(&perf);
+  rt_perf_conf(&perf, (1<<RT_PERF_CYCLES));
+  rt_perf_reset(&perf);
+  rt_perf_start(&perf);
+  data_t * out = inferNetworkBatch(network, depth, BATCH_SIZE, batchIn, batchStates, buffer);
+  rt_perf_stop(&perf);
+  unsigned int batchCycles = rt_perf_get(&perf, RT_PERF_CYCLES);
+
+  int mismatches = 0;
+  if(out == NULL)
+    mismatches = checkOutput("inferNetworkBatch()", model, BATCH_SIZE*outSize, NULL, benchRef);
+  for(int b=0; b<BATCH_SIZE && out != NULL; b++)
+    mismatches += checkOutput("inferNetworkBatch()", model, outSize, &out[b*outSize], benchRef);
+  printf("batch, cycles, cycles/stream, single cycles, mismatches\n");
+  printf("%d, %u, %u, %u, %d\n", BATCH_SIZE, batchCycles, batchCycles/BATCH_SIZE, singleCycles, mismatches);
+  return mismatches;
+}
+#endif
+
+#if defined EXECPLAN_REPEAT && !defined ASIP
+/// Execution plan of the benchmarked network
+RT_L2_DATA struct execPlan execPlan;
+
+/** @brief Runs the network EXECPLAN_REPEAT times with inferNetwork() and with its compiled execution
+ *  plan (runPlan), compares the outputs of the last run and prints the cycles of both
+ *
+ *  @param model Benchmarked model
+ *  @return Number of mismatches, -1 if the network does not fit
+ */
+int benchPlan(struct benchModel * model)
+{
+  struct layer * network = model->network;
+  int depth = model->depth;
+  int numSteps = compileNetwork(network, depth, model->seqSize, buffer, BUFFER_SIZE, &execPlan);
+  if(numSteps < 0 || model->outSize > BUFFER_SIZE || networkState(network, depth, False) < 0) {
+    printf("\033[91mERROR: network too large for the execution plan benchmark\033[0m\n");
+    return -1;
+  }
+  data_t * out = NULL;
+  rt_perf_init(&perf);
+  rt_perf_conf(&perf, (1<<RT_PERF_CYCLES));
+  rt_perf_reset(&perf);
+  rt_perf_start(&perf);
+  for(int r=0; r<EXECPLAN_REPEAT; r++)
+    out = inferNetwork(network, depth, model->seqSize, model->inFeatures, buffer);
+  rt_perf_stop(&perf);
+  unsigned int inferCycles = rt_perf_get(&perf, RT_PERF_CYCLES);
+  if(out != NULL)
+    CopyTensor(model->outSize, benchRef, out);
+
+  networkState(network, depth, True);
+  rt_perf_init(&perf);
+  rt_perf_conf(&perf, (1<<RT_PERF_CYCLES));
+  rt_perf_reset(&perf);
+  rt_perf_start(&perf);
+  for(int r=0; r<EXECPLAN_REPEAT; r++)
+    out = runPlan(&execPlan, model->inFeatures);
+  rt_perf_stop(&perf);
+  unsigned int planCycles = rt_perf_get(&perf, RT_PERF_CYCLES);
+  networkState(network, depth, True);
+
+  int mismatches = checkOutput("runPlan()", model, model->outSize, out, benchRef);
+  printf("steps, repeat, inferNetwork cycles, plan cycles, mismatches\n");
+  printf("%d, %d, %u, %u, %d\n", numSteps, EXECPLAN_REPEAT, inferCycles, planCycles, mismatches);
+  return mismatches;
+}
+#endif
+
+#ifdef ACCURACY_REPORT
+/** @brief Runs the network once and prints the accuracy of the output FM against the reference
+ *  (m*_Out, the output of the PyTorch model), e.g. for networks exported with int8 or int4 weights
+ *
+ *  The errors are in LSB of the fixed-point format, the mean absolute error with two decimals.
+ *
+ *  @param model Benchmarked model
+ *  @return 0 on success, -1 if inferNetwork() fails
+ */
+int benchAccuracy(struct benchModel * model)
+{
+  data_t * out = inferNetwork(model->network, model->depth, model->seqSize, model->inFeatures, buffer);
+  if(out == NULL)
+    return -1;
+  int outSize = model->outSize;
+  int exact = 0, maxError = 0;
+  long sumError = 0, sumSquare = 0;
+  for(int j=0; j<outSize; j++)
+  {
+    int error = (int)out[j]-(int)model->reference[j];
+    error = error < 0 ? -error : error;
+    exact += error == 0;
+    maxError = Max(maxError, error);
+    sumError += error;
+    sumSquare += (long)error*error;
+  }
+  long meanError100 = 100*sumError/outSize;
+  printf("out size, exact, max abs error, mean abs error, mse\n");
+  printf("%d, %d, %d, %ld.%02ld, %ld\n", outSize, exact, maxError, meanError100/100, meanError100%100, sumSquare/outSize);
+  return 0;
+}
+#endif
+
+#if defined PIPELINE_SAMPLES && !defined ASIP
+/// Size of the input and output FMs of all the samples of the pipeline benchmark
+#define PIPELINE_IO_SIZE 16384
+/// Pipeline of the benchmarked network
+RT_L2_DATA struct pipeline pipeline;
+RT_L2_DATA data_t pipelineIn[PIPELINE_IO_SIZE];
+RT_L2_DATA data_t pipelineRef[PIPELINE_IO_SIZE];
+RT_L2_DATA data_t pipelineOut[PIPELINE_IO_SIZE];
+
+/** @brief Runs a stream of PIPELINE_SAMPLES samples (the input FM rotated by the sample index)
+ *  sample by sample with inferNetwork() and with the pipeline (one stage per core), compares the
+ *  outputs and prints the cycles of both
+ *
+ *  @param model Benchmarked model (input FM of the first time step)
+ *  @return Number of mismatches of all the samples, -1 if the network does not fit
+ */
+int benchPipeline(struct benchModel * model)
+{
+  struct layer * network = model->network;
+  int depth = model->depth;
+  int inSize = layerInSize(&network[0]);
+  int outSize = layerOutSize(&network[depth-1]);
+#ifdef NUM_CORES
+  int numStages = compilePipeline(network, depth, NUM_CORES, buffer, BUFFER_SIZE, &pipeline);
+#else
+  int numStages = compilePipeline(network, depth, 1, buffer, BUFFER_SIZE, &pipeline);
+#endif
+  if(numStages < 0 || PIPELINE_SAMPLES*Max(inSize, outSize) > PIPELINE_IO_SIZE || networkState(network, depth, False) < 0) {
+    printf("\033[91mERROR: network too large for the pipeline benchmark\033[0m\n");
+    return -1;
+  }
+  for(int n=0; n<PIPELINE_SAMPLES; n++)
+    for(int j=0; j<inSize; j++)
+      pipelineIn[n*inSize+j] = model->inFeatures[(j+n)%inSize];
+
+  int failedSamples = 0;
+  rt_perf_init(&perf);
+  rt_perf_conf(&perf, (1<<RT_PERF_CYCLES));
+  rt_perf_reset(&perf);
+  rt_perf_start(&perf);
+  for(int n=0; n<PIPELINE_SAMPLES; n++) {
+    data_t * out = inferNetwork(network, depth, 1, &pipelineIn[n*inSize], buffer);
+    if(out != NULL)
+      CopyTensor(outSize, &pipelineRef[n*outSize], out);
+    failedSamples += out == NULL;
+  }
+  rt_perf_stop(&perf);
+  unsigned int inferCycles = rt_perf_get(&perf, RT_PERF_CYCLES);
+
+  networkState(network, depth, True);
+  rt_perf_init(&perf);
+  rt_perf_conf(&perf, (1<<RT_PERF_CYCLES));
+  rt_perf_reset(&perf);
+  rt_perf_start(&perf);
+  runPipeline(&pipeline, PIPELINE_SAMPLES, pipelineIn, pipelineOut);
+  rt_perf_stop(&perf);
+  unsigned int pipeCycles = rt_perf_get(&perf, RT_PERF_CYCLES);
+  networkState(network, depth, True);
+
+  int mismatches = checkOutput("pipeline", model, PIPELINE_SAMPLES*outSize, failedSamples > 0 ? NULL : pipelineOut, pipelineRef);
+  printf("stages, first layers, samples, inferNetwork cycles, pipeline cycles, mismatches\n");
+  printf("%d, ", numStages);
+  for(int k=0; k<numStages; k++)
+    printf("%d%s", pipeline.firstLayer[k], k<numStages-1 ? "/" : ", ");
+  printf("%d, %u, %u, %d\n", PIPELINE_SAMPLES, inferCycles, pipeCycles, mismatches);
+  return mismatches;
+}
+#endif
+
+
 int main()
 {
   data_t tmp_avgerror = 0;
+  int failed = 0; // a benchmark mode failed or its output differs from inferNetwork()
 
 #ifdef ASIP
   long cycles_before = chess_cycle_count();
@@ -46,6 +494,62 @@ int main()
   // pointer to output FM
  data_t * m0_OutAct;
 
+#ifdef MEMPLAN_REPORT
+  // memory plans of the intermediate FMs, run in an arena of the planned size
+  for(struct benchModel * model = benchModels; model->network != NULL; model++)
+    failed |= reportMemPlan(model) != 0;
+#endif
+
+#if defined TILING_SWEEP && !defined ASIP
+  for(struct benchModel * model = benchModels; model->network != NULL; model++)
+    failed |= sweepTiling(model) != 0;
+  return failed;
+#endif
+
+#if defined BATCH_SIZE && !defined ASIP
+  for(struct benchModel * model = benchModels; model->network != NULL; model++)
+    failed |= benchBatch(model) != 0;
+  return failed;
+#endif
+
+#if defined EXECPLAN_REPEAT && !defined ASIP
+  for(struct benchModel * model = benchModels; model->network != NULL; model++)
+    failed |= benchPlan(model) != 0;
+  return failed;
+#endif
+
+#ifdef ACCURACY_REPORT
+  for(struct benchModel * model = benchModels; model->network != NULL; model++)
+    failed |= benchAccuracy(model) != 0;
+  return failed;
+#endif
+
+#if defined PIPELINE_SAMPLES && !defined ASIP
+  for(struct benchModel * model = benchModels; model->network != NULL; model++)
+    failed |= benchPipeline(model) != 0;
+  return failed;
+#endif
+
+#if defined AUTOTUNE && !defined ASIP
+  // select the fastest tiling of every layer, shapes in the cache are not tuned again
+#ifdef TUNE_CACHE_INC
+  for(unsigned int i=0; i<sizeof(tuneCacheInit)/sizeof(tuneCacheInit[0]); i++)
+    tuneCache.entries[tuneCache.size++] = tuneCacheInit[i];
+#endif
+#ifdef HOST
+  const char * tuneCacheFile = getenv("TUNE_CACHE") ? getenv("TUNE_CACHE") : TUNE_CACHE_FILE;
+  tuneCacheLoad(&tuneCache, tuneCacheFile);
+#endif
+  for(struct benchModel * model = benchModels; model->network != NULL; model++)
+    tuneNetwork(model->network, model->depth, model->seqSize, model->inFeatures, buffer, &tuneCache);
+#ifdef HOST
+  tuneCacheSave(&tuneCache, tuneCacheFile);
+#else
+  printf("Tuning cache:\n");
+  tuneCachePrint(&tuneCache);
+#endif
+#endif
+
   #ifdef PROFILING
 
  numFunctionCalls = 0;
@@ -78,7 +582,7 @@ int main()
      printf("%s\n", "Start");
   // #endif
   #ifdef MODEL0 
-      m0_OutAct = inferNetwork(model0, DEPTH0, m0_In, buffer);
+      m0_OutAct = inferNetwork(model0, DEPTH0, SEQ0, m0_In, buffer);
       putchar('\n');
   // putchar('\n');
      
@@ -91,14 +595,14 @@ int main()
   #endif
   #endif
   #ifdef MODEL1 
-      m0_OutAct = inferNetwork(model1, DEPTH1, m1_In, buffer);
+      m0_OutAct = inferNetwork(model1, DEPTH1, SEQ1, m1_In, buffer);
       putchar('\n');
       PrintTensor((int)(sizeof(m1_Out)/sizeof(data_t)), m0_OutAct);
       PrintTensor((int)(sizeof(m1_Out)/sizeof(data_t)), m1_Out);
       PrintTensorDiff((int)(sizeof(m1_Out)/sizeof(data_t)), m0_OutAct, m1_Out);
   #endif
   #ifdef MODEL2 
-      m0_OutAct = inferNetwork(model2, DEPTH2, m2_In, buffer);
+      m0_OutAct = inferNetwork(model2, DEPTH2, SEQ2, m2_In, buffer);
       putchar('\n');
 
   #ifdef PRINTF_ACTIVE
@@ -110,7 +614,7 @@ int main()
 
 
   #ifdef MODEL3 
-      m0_OutAct = inferNetwork(model3, DEPTH3, m3_In, buffer);
+      m0_OutAct = inferNetwork(model3, DEPTH3, SEQ3, m3_In, buffer);
       putchar('\n');
     // putchar('\n');
   #ifdef PRINTF_ACTIVE
@@ -132,7 +636,7 @@ int main()
   #endif
   #ifdef MODEL5 
 
-      m0_OutAct = inferNetwork(model5, DEPTH5, m5_In, buffer);
+      m0_OutAct = inferNetwork(model5, DEPTH5, SEQ5, m5_In, buffer);
       putchar('\n');
       // putchar('\n');
   #ifdef PRINTF_ACTIVE
@@ -146,7 +650,7 @@ int main()
 // PrintTensor((int)(sizeof(m6_Out)/sizeof(data_t)), m6_Out); 
  #ifdef MODEL6 
       // PrintTensor((int)(sizeof(m6_In)/sizeof(data_t)), m6_In);
-      m0_OutAct = inferNetwork(model6, DEPTH6, m6_In, buffer);
+      m0_OutAct = inferNetwork(model6, DEPTH6, SEQ6, m6_In, buffer);
       putchar('\n');
       PrintTensor((int)(sizeof(m6_Out)/sizeof(data_t)), m6_Out);
       PrintTensor((int)(sizeof(m6_Out)/sizeof(data_t)), m0_OutAct);
@@ -159,7 +663,7 @@ int main()
 // printf("model3 was executed");
   #endif
   #ifdef MODEL7 
-      m0_OutAct = inferNetwork(model7, DEPTH7, m7_In, buffer);
+      m0_OutAct = inferNetwork(model7, DEPTH7, SEQ7, m7_In, buffer);
   #ifdef PRINTF_ACTIVE
       PrintTensor((int)(sizeof(m7_Out)/sizeof(data_t)), m0_OutAct);
       PrintTensor((int)(sizeof(m7_Out)/sizeof(data_t)), m7_Out);
@@ -168,7 +672,7 @@ int main()
   #endif
 
   #ifdef MODEL8 
-      m0_OutAct = inferNetwork(model8, DEPTH8, m8_In, buffer);
+      m0_OutAct = inferNetwork(model8, DEPTH8, SEQ8, m8_In, buffer);
       putchar('\n');
       // putchar('\n');
 #ifdef PRINTF_ACTIVE
@@ -182,7 +686,7 @@ int main()
 
   #ifdef MODEL9 
    // printf("%s\n", "model9 start");
-      m0_OutAct = inferNetwork(model9, DEPTH9, m9_In, buffer);
+      m0_OutAct = inferNetwork(model9, DEPTH9, SEQ9, m9_In, buffer);
       putchar('\n');
    #ifdef PRINTF_ACTIVE
    PrintTensor((int)(sizeof(m9_Out)/sizeof(data_t)), m0_OutAct);//printf("%s\n", "model9 start");
@@ -192,7 +696,7 @@ int main()
   #endif
 
   #ifdef MODEL10 
-   m0_OutAct = inferNetwork(model10, DEPTH10, m10_In, buffer);
+   m0_OutAct = inferNetwork(model10, DEPTH10, SEQ10, m10_In, buffer);
    putchar('\n');
   #ifdef PRINTF_ACTIVE
    PrintTensor((int)(sizeof(m10_Out)/sizeof(data_t)), m0_OutAct);//printf("%s\n", "model9 start");
@@ -289,6 +793,6 @@ int main()
 #    endif
 #  endif
 #endif
- return 0;
+ return failed;
 
 }
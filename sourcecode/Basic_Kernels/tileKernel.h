@@ -0,0 +1,549 @@
+/** Copyright (c) 2019 ETH Zurich, Integrated System Laboratory, Renzo Andri
+ *  @file tileKernel.h
+ *  @brief Template of the output FM tiled kernels (LinearLayer, TwoLinearLayersAccumulate, Conv2dLayer, LSTM cell)
+ *  and of their variants with int8, packed int4 and 2:4 sparse weights
+ *
+ *  The inner kernels for a tile of N output neurons (N=1..16) are all generated from the macros in
+ *  this file: each neuron of the tile gets its own accumulator tempK and weight address addrK (i.e.
+ *  manual loop unfolding with explicit register allocation), TILE_REP_N() repeats a macro for all
+ *  the neurons of the tile. All the tile sizes are compiled into the binary, the tile size and the
+ *  input FM tiling are selected per layer at runtime (struct tiling).
+ *
+ *  VLIWEXT: pl.sdotsp.h.0/1 computes the MAC with the weight in its SPR and loads the weight of
+ *  the instruction after the next one, therefore the instruction of neuron k loads the weight of
+ *  neuron (k+2)%N. The instructions alternate between SPR0 and SPR1, for odd N the assignment flips
+ *  after every input and two inputs are processed per iteration.
+ *
+ * @author Renzo Andri (andrire)
+ */
+#ifndef TILEKERNEL_H
+#define TILEKERNEL_H
+
+/// TILE_REP_N(M) expands M(k, next) for all neurons k of a tile with N neurons (next=(k+2)%N)
+#define TILE_REP_1(M)  M(0,0)
+#define TILE_REP_2(M)  M(0,0) M(1,1)
+#define TILE_REP_3(M)  M(0,2) M(1,0) M(2,1)
+#define TILE_REP_4(M)  M(0,2) M(1,3) M(2,0) M(3,1)
+#define TILE_REP_5(M)  M(0,2) M(1,3) M(2,4) M(3,0) M(4,1)
+#define TILE_REP_6(M)  M(0,2) M(1,3) M(2,4) M(3,5) M(4,0) M(5,1)
+#define TILE_REP_7(M)  M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,0) M(6,1)
+#define TILE_REP_8(M)  M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,7) M(6,0) M(7,1)
+#define TILE_REP_9(M)  M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,7) M(6,8) M(7,0) M(8,1)
+#define TILE_REP_10(M) M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,7) M(6,8) M(7,9) M(8,0) M(9,1)
+#define TILE_REP_11(M) M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,7) M(6,8) M(7,9) M(8,10) M(9,0) M(10,1)
+#define TILE_REP_12(M) M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,7) M(6,8) M(7,9) M(8,10) M(9,11) M(10,0) M(11,1)
+#define TILE_REP_13(M) M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,7) M(6,8) M(7,9) M(8,10) M(9,11) M(10,12) M(11,0) M(12,1)
+#define TILE_REP_14(M) M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,7) M(6,8) M(7,9) M(8,10) M(9,11) M(10,12) M(11,13) M(12,0) M(13,1)
+#define TILE_REP_15(M) M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,7) M(6,8) M(7,9) M(8,10) M(9,11) M(10,12) M(11,13) M(12,14) M(13,0) M(14,1)
+#define TILE_REP_16(M) M(0,2) M(1,3) M(2,4) M(3,5) M(4,6) M(5,7) M(6,8) M(7,9) M(8,10) M(9,11) M(10,12) M(11,13) M(12,14) M(13,15) M(14,0) M(15,1)
+
+/// Name of the kernel of a given tile size, e.g. TILE_KERNEL(LinearLayerTile, OUTPUTBUFFER)
+#define TILE_KERNEL(name, N) TILE_KERNEL_(name, N)
+#define TILE_KERNEL_(name, N) name##N
+
+/// Accumulator and weight address of neuron k
+#define TILE_DECLARE(k, next) register_attribute int32_t temp##k; register_attribute uintptr_t addr##k;
+/// Address of the first weight of neuron k of the tile (neuron k%groupSize of group k/groupSize)
+#define TILE_INIT_ADDR(k, next) addr##k = (uintptr_t) &tileWeight[tileRowStride*((k)%tileGroupSize)+tileGroupStride*((k)/tileGroupSize)];
+
+#ifdef VLIWEXT
+/// pl.sdotsp.h.0 or pl.sdotsp.h.1 (spr is known at compile time)
+#define PL_SDOTP(spr, rD, rAddr, rB) do { if(spr) PL_SDOTP1(rD, rAddr, rB); else PL_SDOTP0(rD, rAddr, rB); } while(0)
+/// Preload the weights of neuron 0 into SPR0 and of neuron 1 (or 0 for N=1) into SPR1
+#define TILE_PRELOAD(k, next) \
+  if((k) == 0) PL_SDOTP0(x0, addr##k, x0); \
+  if((k) == 1%tileSize) PL_SDOTP1(x0, addr##k, x0);
+#define TILE_MAC(step, inF, k, next) PL_SDOTP(((step)*tileSize+(k))%2, temp##k, addr##next, inF);
+#else
+#define TILE_PRELOAD(k, next)
+#define TILE_MAC(step, inF, k, next) SDOTP_GENERIC(temp##k, *(v2s*)addr##k, inF); addr##k += sizeof(v2s);
+#endif
+#define TILE_MAC_STEP0(k, next) TILE_MAC(0, inF_temp, k, next)
+#define TILE_MAC_STEP1(k, next) TILE_MAC(1, inF_temp2, k, next)
+
+/** @brief Adds the dot products of the N weight rows (length v2s each) with inFeatures to the
+ *  accumulators temp0..tempN-1
+ *
+ *  The rows are in groups of groupSize rows which are rowStride data_t apart, the groups are
+ *  groupStride data_t apart (e.g. the four gates of the LSTM units).
+ *  With input FM tiling (inTiling, and always for odd N on the VLIW path) two inputs are processed
+ *  per iteration. Requires tileSize, inTiling, in_addr and PL_DECLARE_REGISTERS in the scope.
+ */
+#define TILE_ACCUMULATE_GROUPED(N, weight, rowStride, groupSize, groupStride, inFeatures, length) do { \
+    data_t * tileWeight = (data_t*)(weight); \
+    int tileRowStride = (rowStride); \
+    const int tileGroupSize = (groupSize); \
+    int tileGroupStride = (groupStride); \
+    int tileLength = (length); \
+    TILE_REP_##N(TILE_INIT_ADDR) \
+    TILE_REP_##N(TILE_PRELOAD) \
+    in_addr = (uintptr_t)(inFeatures); \
+    if(inTiling || tileSize%2 == 1) { \
+      for(int i=0; i<tileLength/2; i++) { \
+        v2s inF_temp, inF_temp2; \
+        P_LW_INCR(inF_temp, in_addr);  /* v2s inF_temp  = ((v2s*)inFeatures)[2i+0]; */ \
+        P_LW_INCR(inF_temp2, in_addr); /* v2s inF_temp2 = ((v2s*)inFeatures)[2i+1]; */ \
+        TILE_REP_##N(TILE_MAC_STEP0) \
+        TILE_REP_##N(TILE_MAC_STEP1) \
+      } \
+      if(tileLength%2 == 1) { /* left over input channel (input channels not multiple of 4) */ \
+        v2s inF_temp; \
+        P_LW_INCR(inF_temp, in_addr); \
+        TILE_REP_##N(TILE_MAC_STEP0) \
+      } \
+    } else { \
+      for(int i=0; i<tileLength; i++) { \
+        v2s inF_temp; \
+        P_LW_INCR(inF_temp, in_addr); \
+        TILE_REP_##N(TILE_MAC_STEP0) \
+      } \
+    } \
+  } while(0)
+/// Dot products of N weight rows which are rowStride v2s apart
+#define TILE_ACCUMULATE(N, weight, rowStride, inFeatures, length) \
+  TILE_ACCUMULATE_GROUPED(N, weight, 2*(rowStride), N, 0, inFeatures, length)
+
+#define TILE_LINEAR_BIAS(k, next) temp##k = bias != NULL ? (int32_t)bias[o_tile*tileSize+(k)]<<(shift) : 0;
+#define TILE_LINEAR_STORE(k, next) outFeatures[o_tile*tileSize+(k)] = shiftAndEpilogue(temp##k, shift, epilogue);
+
+/** @brief Defines LinearLayerTileN(): outFeatureTiles tiles of N neurons of a LinearLayer (bias NULL: no bias)
+ */
+#define LINEAR_TILE_KERNEL(N) \
+static inline void LinearLayerTile##N(int outFeatureTiles, int inFeaturesSizeP2, \
+  data_t * __restrict__ weight, data_t * __restrict__ bias, \
+  data_t * __restrict__ inFeatures, data_t * __restrict__ outFeatures, int shift, struct epilogue epilogue, int inTiling) \
+{ \
+  const int tileSize = N; \
+  TILE_REP_##N(TILE_DECLARE) \
+  register_attribute uintptr_t in_addr; \
+  PL_DECLARE_REGISTERS; \
+  for (int o_tile=0; o_tile<outFeatureTiles; o_tile++) { \
+    TILE_REP_##N(TILE_LINEAR_BIAS) \
+    TILE_ACCUMULATE(N, &((v2s*)weight)[inFeaturesSizeP2*o_tile*tileSize], inFeaturesSizeP2, inFeatures, inFeaturesSizeP2); \
+    TILE_REP_##N(TILE_LINEAR_STORE) \
+  } \
+}
+
+#define TILE_TWOLINEAR_BIAS(k, next) temp##k = ((int32_t)bias1[o_tile*tileSize+(k)]+(int32_t)bias2[o_tile*tileSize+(k)])<<(shift);
+#define TILE_TWOLINEAR_STORE(k, next) outFeatures[o_tile*tileSize+(k)] = shiftAndEpilogue(temp##k, shift, epilogue);
+
+/** @brief Defines TwoLinearLayersAccumulateTileN(): outFeatureTiles tiles of N neurons of TwoLinearLayersAccumulate
+ */
+#define TWOLINEAR_TILE_KERNEL(N) \
+static inline void TwoLinearLayersAccumulateTile##N(int outFeatureTiles, \
+  int inFeaturesSize1P2, int inFeaturesSize2P2, struct epilogue epilogue, \
+  data_t * __restrict__ weight1, data_t * __restrict__ weight2, \
+  data_t * __restrict__ bias1, data_t * __restrict__ bias2, \
+  data_t * __restrict__ inFeatures1, data_t * __restrict__ inFeatures2, \
+  data_t * __restrict__ outFeatures, int shift, int inTiling) \
+{ \
+  const int tileSize = N; \
+  TILE_REP_##N(TILE_DECLARE) \
+  register_attribute uintptr_t in_addr; \
+  PL_DECLARE_REGISTERS; \
+  for (int o_tile=0; o_tile<outFeatureTiles; o_tile++) { \
+    TILE_REP_##N(TILE_TWOLINEAR_BIAS) \
+    TILE_ACCUMULATE(N, &((v2s*)weight1)[inFeaturesSize1P2*o_tile*tileSize], inFeaturesSize1P2, inFeatures1, inFeaturesSize1P2); \
+    TILE_ACCUMULATE(N, &((v2s*)weight2)[inFeaturesSize2P2*o_tile*tileSize], inFeaturesSize2P2, inFeatures2, inFeaturesSize2P2); \
+    TILE_REP_##N(TILE_TWOLINEAR_STORE) \
+  } \
+}
+
+#define TILE_SEQ_BIAS(k, next) temp##k = bias != NULL ? (int32_t)bias[o]<<(shift) : 0;
+#define TILE_SEQ_STORE(k, next) \
+  if(outAcc) outAcc[(t_tile*tileSize+(k))*outFeaturesSize+o] = temp##k; \
+  else outFeatures[(t_tile*tileSize+(k))*outFeaturesSize+o] = shiftAndEpilogue(temp##k, shift, epilogue);
+
+/** @brief Defines LinearLayerSeqTileN(): LinearLayer for seqTiles tiles of N time steps
+ *
+ *  Weight stationary: the input FMs of the N time steps take the place of the weight rows in
+ *  TILE_ACCUMULATE, i.e. the weights of each output neuron are read once per tile of time steps.
+ *  The output FM is [time step][neuron], with outAcc the accumulators are stored without shift and
+ *  epilogue (to add the recurrent part later). bias NULL: no bias.
+ */
+#define LINEAR_SEQ_TILE_KERNEL(N) \
+static inline void LinearLayerSeqTile##N(int seqTiles, int inFeaturesSize, int outFeaturesSize, \
+  data_t * __restrict__ weight, data_t * __restrict__ bias, data_t * __restrict__ inFeatures, \
+  data_t * __restrict__ outFeatures, int32_t * __restrict__ outAcc, int shift, struct epilogue epilogue, int inTiling) \
+{ \
+  const int tileSize = N; \
+  int inFeaturesSizeP2 = inFeaturesSize/2; \
+  TILE_REP_##N(TILE_DECLARE) \
+  register_attribute uintptr_t in_addr; \
+  PL_DECLARE_REGISTERS; \
+  for (int t_tile=0; t_tile<seqTiles; t_tile++) { \
+    for (int o=0; o<outFeaturesSize; o++) { \
+      TILE_REP_##N(TILE_SEQ_BIAS) \
+      TILE_ACCUMULATE_GROUPED(N, &inFeatures[t_tile*tileSize*inFeaturesSize], inFeaturesSize, N, 0, \
+        &((v2s*)weight)[inFeaturesSizeP2*o], inFeaturesSizeP2); \
+      TILE_REP_##N(TILE_SEQ_STORE) \
+    } \
+  } \
+}
+
+#define TILE_CONV_BIAS(k, next) temp##k = (int32_t)bias[o_tile*tileSize+(k)]<<(shift);
+#define TILE_CONV_STORE(k, next) outFeatures[((o_tile*tileSize+(k))*h_im+h_out)*w_im+w_out] = shiftAndEpilogue(temp##k, shift, epilogue);
+
+/** @brief Defines Conv2dLayerTileN(): outFeatureTiles tiles of N output channels of a Conv2dLayer
+ *
+ *  Same data layout as Conv2dLayer (weights [c_out][kh][kw][c_in], input FM [h][w][c_in], output
+ *  FM [c_out][h][w], zero padding), the input channels of each filter tap are one dot product.
+ */
+#define CONV2D_TILE_KERNEL(N) \
+static inline void Conv2dLayerTile##N(int outFeatureTiles, int inChannels, int kernelSize, \
+  int h_im, int w_im, data_t * __restrict__ weight, data_t * __restrict__ bias, \
+  data_t * __restrict__ inFeatures, data_t * __restrict__ outFeatures, int shift, struct epilogue epilogue, int inTiling) \
+{ \
+  const int tileSize = N; \
+  TILE_REP_##N(TILE_DECLARE) \
+  register_attribute uintptr_t in_addr; \
+  PL_DECLARE_REGISTERS; \
+  int ker_half = kernelSize/2; \
+  int inChannelsP2 = inChannels/2; \
+  int output_channel_offset = kernelSize*kernelSize*inChannelsP2; \
+  for (int o_tile=0; o_tile<outFeatureTiles; o_tile++) { \
+    for (int h_out=0; h_out<h_im; h_out++) { \
+      for (int w_out=0; w_out<w_im; w_out++) { \
+        TILE_REP_##N(TILE_CONV_BIAS) \
+        for (int kh=Max(-h_out, -ker_half); kh<=Min(h_im-1-h_out, ker_half); kh++) { \
+          for (int kw=Max(-w_out, -ker_half); kw<=Min(w_im-1-w_out, ker_half); kw++) { \
+            TILE_ACCUMULATE(N, &((v2s*)weight)[o_tile*tileSize*output_channel_offset+((kh+ker_half)*kernelSize+kw+ker_half)*inChannelsP2], \
+              output_channel_offset, &((v2s*)inFeatures)[((h_out+kh)*w_im+w_out+kw)*inChannelsP2], inChannelsP2); \
+          } \
+        } \
+        TILE_REP_##N(TILE_CONV_STORE) \
+      } \
+    } \
+  } \
+}
+
+/// Gate k%4 (i, f, g, o) of unit k/4 of the tile
+#define TILE_LSTM_BIAS(k, next) temp##k = ((int32_t)bias_ih[((k)%4)*hiddenFeaturesSize+o_tile*tileUnits+(k)/4] \
+  +(int32_t)bias_hh[((k)%4)*hiddenFeaturesSize+o_tile*tileUnits+(k)/4])<<(shift);
+#define TILE_LSTM_PROJ(k, next) temp##k = proj[((k)%4)*hiddenFeaturesSize+o_tile*tileUnits+(k)/4] \
+  +((int32_t)bias_hh[((k)%4)*hiddenFeaturesSize+o_tile*tileUnits+(k)/4]<<(shift));
+#define TILE_LSTM_GATE(k, next) gate[k] = ((k)%4 == 2) ? generic_tanh(SATURATE_DATA(temp##k>>(shift))) : generic_sig(SATURATE_DATA(temp##k>>(shift)));
+
+/** @brief Defines LSTMCellTileU(): unitTiles tiles of U units (N=4*U gates) of an LSTM cell
+ *
+ *  The four gates of the units are computed together (the input FM and the hidden state are only
+ *  read once per tile) and the cell and hidden state are updated directly from the registers, with
+ *  the same fixed-point operations as the unfused LSTMLayer. The new hidden state is written to
+ *  lstm_hNew, as lstm_h is still needed by the following tiles. With proj (input projections
+ *  computed up front for a sequence) only the recurrent part is accumulated.
+ */
+#define LSTM_TILE_KERNEL(U, N) \
+static inline void LSTMCellTile##U(int unitTiles, int inFeaturesSize, int hiddenFeaturesSize, \
+  data_t * __restrict__ weight_ih, data_t * __restrict__ weight_hh, \
+  data_t * __restrict__ bias_ih, data_t * __restrict__ bias_hh, \
+  data_t * __restrict__ inFeatures, int32_t * __restrict__ proj, data_t * __restrict__ lstm_h, \
+  data_t * __restrict__ lstm_c, data_t * __restrict__ lstm_hNew, int shift, int inTiling) \
+{ \
+  const int tileSize = N; \
+  const int tileUnits = U; \
+  int inFeaturesSizeP2 = inFeaturesSize/2; \
+  int hiddenFeaturesSizeP2 = hiddenFeaturesSize/2; \
+  TILE_REP_##N(TILE_DECLARE) \
+  register_attribute uintptr_t in_addr; \
+  PL_DECLARE_REGISTERS; \
+  data_t gate[N]; \
+  for (int o_tile=0; o_tile<unitTiles; o_tile++) { \
+    if(proj) { \
+      TILE_REP_##N(TILE_LSTM_PROJ) \
+    } else { \
+      TILE_REP_##N(TILE_LSTM_BIAS) \
+      TILE_ACCUMULATE_GROUPED(N, &((v2s*)weight_ih)[inFeaturesSizeP2*o_tile*tileUnits], hiddenFeaturesSize*inFeaturesSize, \
+        4, 2*inFeaturesSizeP2, inFeatures, inFeaturesSizeP2); \
+    } \
+    TILE_ACCUMULATE_GROUPED(N, &((v2s*)weight_hh)[hiddenFeaturesSizeP2*o_tile*tileUnits], hiddenFeaturesSize*hiddenFeaturesSize, \
+      4, 2*hiddenFeaturesSizeP2, lstm_h, hiddenFeaturesSizeP2); \
+    TILE_REP_##N(TILE_LSTM_GATE) \
+    for (int u=0; u<tileUnits; u++) { \
+      int j = o_tile*tileUnits+u; \
+      data_t c_f = (lstm_c[j]*gate[4*u+1])>>(q_fraqP1);   /* c_t = f_t*c_(t-1) + i_t*g_t */ \
+      data_t i_g = (gate[4*u+0]*gate[4*u+2])>>(q_fraqP1); \
+      lstm_c[j] = SATURATE_DATA(c_f + i_g); \
+      lstm_hNew[j] = (generic_tanh(lstm_c[j])*gate[4*u+3])>>(q_fraqP1); /* h_t = o_t*tanh(c_t) */ \
+    } \
+  } \
+}
+/// Largest number of LSTM units per tile (4 gates each, i.e. TILE_MAXSIZE accumulators)
+#define LSTM_TILE_MAXUNITS 4
+/// Instantiates the LSTM cell kernels of all tile sizes
+#define LSTM_TILE_KERNEL_FAMILY(KERNEL) KERNEL(1, 4) KERNEL(2, 8) KERNEL(3, 12) KERNEL(4, 16)
+
+/// Address of the first weight byte of neuron k of a tile of packed weights (rows tileRowBytes apart)
+#define TILE_PACKED_INIT_ADDR(k, next) addr##k = (uintptr_t) &tileWeight[tileRowBytes*(k)];
+#define TILE_PACKED_ZERO(k, next) temp##k = 0;
+
+/// Inputs per word of int8 weights
+#define TILE_WORD_Int8 4
+/// Low and high weight pair of a word of four int8 weights, sign-extended to v2s in registers
+#define TILE_INT8_LO(w) ((v2s){(int8_t)(w), (int8_t)((w)>>8)})
+#define TILE_INT8_HI(w) ((v2s){(int8_t)((w)>>16), (int8_t)((w)>>24)})
+/// Input pairs of a word of int8 weights
+#define TILE_LOAD_Int8 v2s inF_temp, inF_temp2; P_LW_INCR(inF_temp, in_addr); P_LW_INCR(inF_temp2, in_addr);
+#define TILE_MAC_Int8(k, next) { int32_t w = *(int32_t*)addr##k; addr##k += 4; \
+  SDOTP_GENERIC(temp##k, TILE_INT8_LO(w), inF_temp); SDOTP_GENERIC(temp##k, TILE_INT8_HI(w), inF_temp2); }
+/// Remaining input j (less than a word) of neuron k
+#define TILE_TAIL_Int8(k, next) temp##k += ((int8_t*)addr##k)[j]*inTail;
+
+/// Inputs per word of packed int4 weights
+#define TILE_WORD_Int4 8
+/// Weight pair of byte p of a word of eight int4 weights (low nibble first), sign-extended to v2s in registers
+#define TILE_INT4_PAIR(w, p) ((v2s){(int32_t)((w)<<(28-8*(p)))>>28, (int32_t)((w)<<(24-8*(p)))>>28})
+/// Input pairs of a word of int4 weights
+#define TILE_LOAD_Int4 v2s inF_temp, inF_temp2, inF_temp3, inF_temp4; \
+  P_LW_INCR(inF_temp, in_addr); P_LW_INCR(inF_temp2, in_addr); P_LW_INCR(inF_temp3, in_addr); P_LW_INCR(inF_temp4, in_addr);
+#define TILE_MAC_Int4(k, next) { uint32_t w = *(uint32_t*)addr##k; addr##k += 4; \
+  SDOTP_GENERIC(temp##k, TILE_INT4_PAIR(w, 0), inF_temp);  SDOTP_GENERIC(temp##k, TILE_INT4_PAIR(w, 1), inF_temp2); \
+  SDOTP_GENERIC(temp##k, TILE_INT4_PAIR(w, 2), inF_temp3); SDOTP_GENERIC(temp##k, TILE_INT4_PAIR(w, 3), inF_temp4); }
+/// Remaining input j (less than a word) of neuron k
+#define TILE_TAIL_Int4(k, next) { uint8_t b = ((uint8_t*)addr##k)[j/2]; temp##k += (j%2 ? INT4_HI(b) : INT4_LO(b))*inTail; }
+
+/** @brief Adds the dot products of N rows of packed weights (FMT: Int8 or Int4) with inFeatures to the
+ *  accumulators temp0..tempN-1
+ *
+ *  The rows are rowBytes bytes apart. Each neuron loads one word of weights per TILE_WORD_FMT inputs
+ *  and unpacks it in registers into the v2s operands of the dot products, the inputs are loaded once
+ *  for the whole tile. The remaining inputs are multiplied one by one. The rows do not need to be
+ *  word aligned (RI5CY splits misaligned loads). Requires in_addr in the scope.
+ */
+#define TILE_ACCUMULATE_PACKED(FMT, N, weight, rowBytes, inFeatures, length) do { \
+    uint8_t * tileWeight = (uint8_t*)(weight); \
+    int tileRowBytes = (rowBytes); \
+    data_t * tileIn = (inFeatures); \
+    int tileWords = (length)/TILE_WORD_##FMT; \
+    TILE_REP_##N(TILE_PACKED_INIT_ADDR) \
+    in_addr = (uintptr_t)tileIn; \
+    for(int i=0; i<tileWords; i++) { \
+      TILE_LOAD_##FMT \
+      TILE_REP_##N(TILE_MAC_##FMT) \
+    } \
+    for(int j=0; j<(length)-tileWords*TILE_WORD_##FMT; j++) { \
+      data_t inTail = tileIn[tileWords*TILE_WORD_##FMT+j]; \
+      TILE_REP_##N(TILE_TAIL_##FMT) \
+    } \
+  } while(0)
+
+#define TILE_LINEAR_PACKED_STORE(k, next) outFeatures[o_tile*tileSize+(k)] = shiftAndEpilogue( \
+  (bias != NULL ? (int32_t)bias[o_tile*tileSize+(k)]<<(shift) : 0)+scaleInt8(temp##k, scale[o_tile*tileSize+(k)]), shift, epilogue);
+
+/** @brief Defines LinearLayerFMTTileN(): outFeatureTiles tiles of N neurons of a LinearLayer with
+ *  packed weights (rows of rowBytes bytes, one scale per neuron, bias NULL: no bias)
+ */
+#define LINEAR_PACKED_TILE_KERNEL(FMT, N) \
+static inline void LinearLayer##FMT##Tile##N(int outFeatureTiles, int inFeaturesSize, int rowBytes, \
+  uint8_t * __restrict__ weight, int32_t * __restrict__ scale, data_t * __restrict__ bias, \
+  data_t * __restrict__ inFeatures, data_t * __restrict__ outFeatures, int shift, struct epilogue epilogue) \
+{ \
+  const int tileSize = N; \
+  TILE_REP_##N(TILE_DECLARE) \
+  register_attribute uintptr_t in_addr; \
+  for (int o_tile=0; o_tile<outFeatureTiles; o_tile++) { \
+    TILE_REP_##N(TILE_PACKED_ZERO) \
+    TILE_ACCUMULATE_PACKED(FMT, N, &weight[rowBytes*o_tile*tileSize], rowBytes, inFeatures, inFeaturesSize); \
+    TILE_REP_##N(TILE_LINEAR_PACKED_STORE) \
+  } \
+}
+
+#define TILE_PACKED_DECLARE_SUM(k, next) int32_t sum##k;
+#define TILE_TWOLINEAR_PACKED_SCALE(k, next) sum##k = scaleInt8(temp##k, scale1[o_tile*tileSize+(k)]); temp##k = 0;
+#define TILE_TWOLINEAR_PACKED_STORE(k, next) outFeatures[o_tile*tileSize+(k)] = shiftAndEpilogue( \
+  (((int32_t)bias1[o_tile*tileSize+(k)]+(int32_t)bias2[o_tile*tileSize+(k)])<<(shift)) \
+  +sum##k+scaleInt8(temp##k, scale2[o_tile*tileSize+(k)]), shift, epilogue);
+
+/** @brief Defines TwoLinearLayersAccumulateFMTTileN(): outFeatureTiles tiles of N neurons of
+ *  TwoLinearLayersAccumulate with packed weights (each product is scaled with its own scales)
+ */
+#define TWOLINEAR_PACKED_TILE_KERNEL(FMT, N) \
+static inline void TwoLinearLayersAccumulate##FMT##Tile##N(int outFeatureTiles, \
+  int inFeaturesSize1, int inFeaturesSize2, int rowBytes1, int rowBytes2, struct epilogue epilogue, \
+  uint8_t * __restrict__ weight1, uint8_t * __restrict__ weight2, \
+  int32_t * __restrict__ scale1, int32_t * __restrict__ scale2, \
+  data_t * __restrict__ bias1, data_t * __restrict__ bias2, \
+  data_t * __restrict__ inFeatures1, data_t * __restrict__ inFeatures2, \
+  data_t * __restrict__ outFeatures, int shift) \
+{ \
+  const int tileSize = N; \
+  TILE_REP_##N(TILE_DECLARE) \
+  TILE_REP_##N(TILE_PACKED_DECLARE_SUM) \
+  register_attribute uintptr_t in_addr; \
+  for (int o_tile=0; o_tile<outFeatureTiles; o_tile++) { \
+    TILE_REP_##N(TILE_PACKED_ZERO) \
+    TILE_ACCUMULATE_PACKED(FMT, N, &weight1[rowBytes1*o_tile*tileSize], rowBytes1, inFeatures1, inFeaturesSize1); \
+    TILE_REP_##N(TILE_TWOLINEAR_PACKED_SCALE) \
+    TILE_ACCUMULATE_PACKED(FMT, N, &weight2[rowBytes2*o_tile*tileSize], rowBytes2, inFeatures2, inFeaturesSize2); \
+    TILE_REP_##N(TILE_TWOLINEAR_PACKED_STORE) \
+  } \
+}
+
+#define TILE_CONV_INT8_STORE(k, next) outFeatures[((o_tile*tileSize+(k))*h_im+h_out)*w_im+w_out] = shiftAndEpilogue( \
+  ((int32_t)bias[o_tile*tileSize+(k)]<<(shift))+scaleInt8(temp##k, scale[o_tile*tileSize+(k)]), shift, epilogue);
+
+/** @brief Defines Conv2dLayerInt8TileN(): outFeatureTiles tiles of N output channels of a Conv2dLayer
+ *  with int8 weights (same data layout as Conv2dLayerTileN, one scale per output channel)
+ */
+#define CONV2D_INT8_TILE_KERNEL(N) \
+static inline void Conv2dLayerInt8Tile##N(int outFeatureTiles, int inChannels, int kernelSize, \
+  int h_im, int w_im, int8_t * __restrict__ weight, int32_t * __restrict__ scale, data_t * __restrict__ bias, \
+  data_t * __restrict__ inFeatures, data_t * __restrict__ outFeatures, int shift, struct epilogue epilogue) \
+{ \
+  const int tileSize = N; \
+  TILE_REP_##N(TILE_DECLARE) \
+  register_attribute uintptr_t in_addr; \
+  int ker_half = kernelSize/2; \
+  int output_channel_offset = kernelSize*kernelSize*inChannels; \
+  for (int o_tile=0; o_tile<outFeatureTiles; o_tile++) { \
+    for (int h_out=0; h_out<h_im; h_out++) { \
+      for (int w_out=0; w_out<w_im; w_out++) { \
+        TILE_REP_##N(TILE_PACKED_ZERO) \
+        for (int kh=Max(-h_out, -ker_half); kh<=Min(h_im-1-h_out, ker_half); kh++) { \
+          for (int kw=Max(-w_out, -ker_half); kw<=Min(w_im-1-w_out, ker_half); kw++) { \
+            TILE_ACCUMULATE_PACKED(Int8, N, &weight[o_tile*tileSize*output_channel_offset+((kh+ker_half)*kernelSize+kw+ker_half)*inChannels], \
+              output_channel_offset, &inFeatures[((h_out+kh)*w_im+w_out+kw)*inChannels], inChannels); \
+          } \
+        } \
+        TILE_REP_##N(TILE_CONV_INT8_STORE) \
+      } \
+    } \
+  } \
+}
+
+/// Position address of neuron k of a tile of 2:4 sparse rows
+#define TILE_NM_DECLARE(k, next) register_attribute uintptr_t iaddr##k;
+/// Addresses of the first weight pair and of the first positions of neuron k
+#define TILE_NM_INIT_ADDR(k, next) addr##k = (uintptr_t) &tileWeight[tileRowWeights*(k)]; iaddr##k = (uintptr_t) &tileIndex[tileRowBytes*(k)];
+/// The two inputs at the positions p (bits 3:0) of a group of 4 inputs held in the input pairs lo and hi (pv.shuffle2.h)
+#define TILE_NM_GATHER(lo, hi, p) __builtin_shuffle(lo, hi, (v2s){(p)&3, ((p)>>2)&3})
+/// Two groups of neuron k: one position byte and two weight pairs, the inputs are selected in registers
+#define TILE_MAC_NM(k, next) { uint8_t p = *(uint8_t*)iaddr##k; iaddr##k += 1; v2s w0, w1; \
+  P_LW_INCR(w0, addr##k); P_LW_INCR(w1, addr##k); \
+  SDOTP_GENERIC(temp##k, w0, TILE_NM_GATHER(inF_temp, inF_temp2, p)); \
+  SDOTP_GENERIC(temp##k, w1, TILE_NM_GATHER(inF_temp3, inF_temp4, p>>4)); }
+/// Remaining group g of neuron k (less than two groups), gathered from memory
+#define TILE_TAIL_NM(k, next) { int p = tileIndex[tileRowBytes*(k)+g/2]>>(4*(g%2)); \
+  temp##k += tileWeight[tileRowWeights*(k)+2*g]*tileIn[4*g+(p&3)] + tileWeight[tileRowWeights*(k)+2*g+1]*tileIn[4*g+((p>>2)&3)]; }
+
+/** @brief Adds the dot products of N 2:4 sparse rows of length inputs with inFeatures to the
+ *  accumulators temp0..tempN-1
+ *
+ *  The 8 inputs of two groups are loaded once for the whole tile, every neuron selects its two
+ *  inputs per group with its positions in registers, i.e. the gather is not repeated per neuron.
+ *  Requires in_addr in the scope.
+ */
+#define TILE_ACCUMULATE_NM(N, weight, index, inFeatures, length) do { \
+    data_t * tileWeight = (weight); \
+    uint8_t * tileIndex = (index); \
+    int tileRowWeights = NM_ROW_WEIGHTS(length); \
+    int tileRowBytes = NM_ROW_BYTES(length); \
+    data_t * tileIn = (inFeatures); \
+    int tilePairs = (length)/8; \
+    TILE_REP_##N(TILE_NM_INIT_ADDR) \
+    in_addr = (uintptr_t)tileIn; \
+    for(int i=0; i<tilePairs; i++) { \
+      v2s inF_temp, inF_temp2, inF_temp3, inF_temp4; \
+      P_LW_INCR(inF_temp, in_addr); P_LW_INCR(inF_temp2, in_addr); P_LW_INCR(inF_temp3, in_addr); P_LW_INCR(inF_temp4, in_addr); \
+      TILE_REP_##N(TILE_MAC_NM) \
+    } \
+    for(int g=2*tilePairs; g<((length)+3)/4; g++) { \
+      TILE_REP_##N(TILE_TAIL_NM) \
+    } \
+  } while(0)
+
+#define TILE_LINEAR_NM_STORE(k, next) outFeatures[o_tile*tileSize+(k)] = shiftAndEpilogue( \
+  (bias != NULL ? (int32_t)bias[o_tile*tileSize+(k)]<<(shift) : 0)+temp##k, shift, epilogue);
+
+/** @brief Defines LinearLayer2of4TileN(): outFeatureTiles tiles of N neurons of a LinearLayer with
+ *  2:4 sparse weights (bias NULL: no bias)
+ */
+#define LINEAR_2OF4_TILE_KERNEL(N) \
+static inline void LinearLayer2of4Tile##N(int outFeatureTiles, int inFeaturesSize, \
+  data_t * __restrict__ weight, uint8_t * __restrict__ index, data_t * __restrict__ bias, \
+  data_t * __restrict__ inFeatures, data_t * __restrict__ outFeatures, int shift, struct epilogue epilogue) \
+{ \
+  const int tileSize = N; \
+  TILE_REP_##N(TILE_DECLARE) \
+  TILE_REP_##N(TILE_NM_DECLARE) \
+  register_attribute uintptr_t in_addr; \
+  for (int o_tile=0; o_tile<outFeatureTiles; o_tile++) { \
+    TILE_REP_##N(TILE_PACKED_ZERO) \
+    TILE_ACCUMULATE_NM(N, &weight[NM_ROW_WEIGHTS(inFeaturesSize)*o_tile*tileSize], \
+      &index[NM_ROW_BYTES(inFeaturesSize)*o_tile*tileSize], inFeatures, inFeaturesSize); \
+    TILE_REP_##N(TILE_LINEAR_NM_STORE) \
+  } \
+}
+
+#define TILE_TWOLINEAR_NM_STORE(k, next) outFeatures[o_tile*tileSize+(k)] = shiftAndEpilogue( \
+  (((int32_t)bias1[o_tile*tileSize+(k)]+(int32_t)bias2[o_tile*tileSize+(k)])<<(shift))+temp##k, shift, epilogue);
+
+/** @brief Defines TwoLinearLayersAccumulate2of4TileN(): outFeatureTiles tiles of N neurons of
+ *  TwoLinearLayersAccumulate with 2:4 sparse weights
+ */
+#define TWOLINEAR_2OF4_TILE_KERNEL(N) \
+static inline void TwoLinearLayersAccumulate2of4Tile##N(int outFeatureTiles, \
+  int inFeaturesSize1, int inFeaturesSize2, struct epilogue epilogue, \
+  data_t * __restrict__ weight1, data_t * __restrict__ weight2, \
+  uint8_t * __restrict__ index1, uint8_t * __restrict__ index2, \
+  data_t * __restrict__ bias1, data_t * __restrict__ bias2, \
+  data_t * __restrict__ inFeatures1, data_t * __restrict__ inFeatures2, \
+  data_t * __restrict__ outFeatures, int shift) \
+{ \
+  const int tileSize = N; \
+  TILE_REP_##N(TILE_DECLARE) \
+  TILE_REP_##N(TILE_NM_DECLARE) \
+  register_attribute uintptr_t in_addr; \
+  for (int o_tile=0; o_tile<outFeatureTiles; o_tile++) { \
+    TILE_REP_##N(TILE_PACKED_ZERO) \
+    TILE_ACCUMULATE_NM(N, &weight1[NM_ROW_WEIGHTS(inFeaturesSize1)*o_tile*tileSize], \
+      &index1[NM_ROW_BYTES(inFeaturesSize1)*o_tile*tileSize], inFeatures1, inFeaturesSize1); \
+    TILE_ACCUMULATE_NM(N, &weight2[NM_ROW_WEIGHTS(inFeaturesSize2)*o_tile*tileSize], \
+      &index2[NM_ROW_BYTES(inFeaturesSize2)*o_tile*tileSize], inFeatures2, inFeaturesSize2); \
+    TILE_REP_##N(TILE_TWOLINEAR_NM_STORE) \
+  } \
+}
+
+/// Instantiates the kernels of all tile sizes
+#define TILE_KERNEL_FAMILY(KERNEL) \
+  KERNEL(1)  KERNEL(2)  KERNEL(3)  KERNEL(4)  KERNEL(5)  KERNEL(6)  KERNEL(7)  KERNEL(8) \
+  KERNEL(9)  KERNEL(10) KERNEL(11) KERNEL(12) KERNEL(13) KERNEL(14) KERNEL(15) KERNEL(16)
+/// Table of the kernels of all tile sizes, indexed by the tile size
+#define TILE_KERNEL_TABLE(name) {NULL, \
+  name##1,  name##2,  name##3,  name##4,  name##5,  name##6,  name##7,  name##8, \
+  name##9,  name##10, name##11, name##12, name##13, name##14, name##15, name##16}
+
+/// Output FM tile size of a layer (0 selects OUTPUTBUFFER)
+static inline int tilingOutTile(struct tiling tiling) {
+#ifdef OUTPUTBUFFER
+  if(tiling.outTile <= 0) return OUTPUTBUFFER;
+#else
+  if(tiling.outTile <= 0) return 1;
+#endif
+  return tiling.outTile > TILE_MAXSIZE ? TILE_MAXSIZE : tiling.outTile;
+}
+
+/// Input FM tiling of a layer (IN_TILING_DEFAULT selects FMINTILING)
+static inline int tilingInTiling(struct tiling tiling) {
+#ifdef FMINTILING
+  return tiling.inTiling != IN_TILING_OFF;
+#else
+  return tiling.inTiling == IN_TILING_ON;
+#endif
+}
+
+/** @brief Tile sizes used for the output FM: outTile as long as possible, the remaining neurons
+ *  with 8, 4, 2 and 1 neurons per tile
+ *
+ *  @param outTile Largest output FM tile size
+ *  @param tileOptions Array of at least 5 elements to store the tile sizes
+ *  @return Number of tile sizes
+ */
+static inline int getTileOptions(int outTile, int * tileOptions) {
+  int numTileOptions = 0;
+  tileOptions[numTileOptions++] = outTile;
+  for(int tileSize=8; tileSize>=1; tileSize/=2)
+    if(tileSize < outTile) tileOptions[numTileOptions++] = tileSize;
+  return numTileOptions;
+}
+
+#endif